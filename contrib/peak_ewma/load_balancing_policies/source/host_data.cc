@@ -5,8 +5,11 @@ namespace Extensions {
 namespace LoadBalancingPolicies {
 namespace PeakEwma {
 
-PeakEwmaHostLbPolicyData::PeakEwmaHostLbPolicyData(size_t max_samples)
-    : max_samples_(max_samples), rtt_samples_(max_samples), timestamps_(max_samples) {
+PeakEwmaHostLbPolicyData::PeakEwmaHostLbPolicyData(size_t max_samples,
+                                                   uint64_t initial_active_requests,
+                                                   uint64_t initial_pending_requests)
+    : ActiveRequestsHostLbPolicyData(initial_active_requests, initial_pending_requests),
+      max_samples_(max_samples), rtt_samples_(max_samples), timestamps_(max_samples) {
   // Vectors are initialized with max_samples atomic elements, each default-initialized to 0
 }
 
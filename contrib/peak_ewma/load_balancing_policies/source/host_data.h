@@ -7,6 +7,8 @@
 
 #include "envoy/upstream/load_balancer.h"
 
+#include "source/extensions/load_balancing_policies/common/active_request_tracker.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace LoadBalancingPolicies {
@@ -17,12 +19,15 @@ namespace PeakEwma {
  *
  * Stores RTT samples and EWMA state directly in Host objects using atomic variables
  * for thread-safe access. Workers write samples, main thread processes them.
+ * Active requests are tracked in the shared per-worker sharded counters of the base class.
  */
-struct PeakEwmaHostLbPolicyData : public Upstream::HostLbPolicyData {
+struct PeakEwmaHostLbPolicyData : public Common::ActiveRequestsHostLbPolicyData {
   bool receivesOrcaLoadReport() const override { return false; }
 
-  // Constructor that accepts configurable buffer size
-  explicit PeakEwmaHostLbPolicyData(size_t max_samples);
+  // Constructor that accepts configurable buffer size and the number of requests already
+  // active and pending on the host when the data is attached.
+  explicit PeakEwmaHostLbPolicyData(size_t max_samples, uint64_t initial_active_requests = 0,
+                                    uint64_t initial_pending_requests = 0);
 
   // Configurable buffer size (replaces kMaxSamples constant)
   const size_t max_samples_;
@@ -91,7 +91,10 @@ PeakEwmaLoadBalancer::PeakEwmaLoadBalancer(
 void PeakEwmaLoadBalancer::addPeakEwmaLbPolicyDataToHosts(const Upstream::HostVector& hosts) {
   for (const auto& host_ptr : hosts) {
     if (!host_ptr->typedLbPolicyData<PeakEwmaHostLbPolicyData>().has_value()) {
-      host_ptr->addLbPolicyData(std::make_unique<PeakEwmaHostLbPolicyData>(max_samples_));
+      const Upstream::HostStats* stats = host_ptr->statsIfAllocated();
+      host_ptr->addLbPolicyData(std::make_unique<PeakEwmaHostLbPolicyData>(
+          max_samples_, stats != nullptr ? stats->rq_active_.value() : 0,
+          stats != nullptr ? stats->rq_pending_active_.value() : 0));
     }
   }
 }
@@ -113,8 +116,15 @@ double PeakEwmaLoadBalancer::calculateHostCost(Upstream::HostConstSharedPtr host
   auto* peak_data = getPeakEwmaData(host);
   double ewma_rtt = peak_data ? peak_data->getEwmaRtt() : 0.0;
 
-  // Get active requests from host stats.
-  double active_requests = host->stats().rq_active_.value();
+  // Get active requests from the host-attached sharded counters, which avoid contending on the
+  // host stats atomics that every worker writes.
+  double active_requests = 0;
+  if (peak_data) {
+    active_requests = peak_data->activeRequests();
+  } else if (const Upstream::HostStats* host_stats = host->statsIfAllocated();
+             host_stats != nullptr) {
+    active_requests = host_stats->rq_active_.value();
+  }
 
   // Calculate cost using business logic.
   double default_rtt_ms = config_proto_.has_default_rtt()
@@ -202,6 +212,11 @@ void PeakEwmaLoadBalancer::aggregateWorkerData() {
       auto* peak_data = getPeakEwmaData(host);
       if (peak_data) {
         processHostSamples(host, peak_data);
+        // Correct the drift of the active request counts with the host stats, leaving the hosts
+        // which never had a request without allocated stats.
+        if (const Upstream::HostStats* stats = host->statsIfAllocated(); stats != nullptr) {
+          peak_data->reconcile(*stats);
+        }
       }
     }
   }
@@ -212,7 +227,7 @@ void PeakEwmaLoadBalancer::aggregateWorkerData() {
       auto* peak_data = getPeakEwmaData(host);
       if (peak_data) {
         double ewma_rtt = peak_data->getEwmaRtt();
-        double active_requests = host->stats().rq_active_.value();
+        double active_requests = peak_data->activeRequests();
         double cost =
             cost_.compute(ewma_rtt, active_requests,
                           config_proto_.has_default_rtt()
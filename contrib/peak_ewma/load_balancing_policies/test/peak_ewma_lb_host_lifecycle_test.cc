@@ -332,6 +332,31 @@ TEST_F(PeakEwmaHostLifecycleTest, AlphaUsesLastUpdateTimestampNotAggregationTime
                         << ewma;
 }
 
+// The active and pending request counts are seeded from the host stats, and the aggregation
+// corrects their drift.
+TEST_F(PeakEwmaHostLifecycleTest, ActiveRequestsSeededAndReconciled) {
+  hosts_[0]->stats().rq_active_.set(2);
+  hosts_[0]->stats().rq_pending_active_.set(1);
+  createLoadBalancer();
+
+  auto* data = hosts_[0]->typedLbPolicyData<PeakEwmaHostLbPolicyData>().ptr();
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(2, data->activeRequests());
+  EXPECT_EQ(1, data->pendingRequests());
+
+  // Requests outstanding before the data was seeded complete.
+  hosts_[0]->notifyActiveRequestsChanged(-3, -1);
+  hosts_[0]->stats().rq_active_.set(4);
+  hosts_[0]->stats().rq_pending_active_.set(0);
+  EXPECT_EQ(0, data->activeRequests());
+
+  ON_CALL(time_source_, monotonicTime())
+      .WillByDefault(Return(MonotonicTime(std::chrono::milliseconds(1000200))));
+  lb_->chooseHost(nullptr);
+  EXPECT_EQ(4, data->activeRequests());
+  EXPECT_EQ(0, data->pendingRequests());
+}
+
 // Coverage: inline aggregation triggers in chooseHost when interval elapses.
 TEST_F(PeakEwmaHostLifecycleTest, AggregationHappensInlineOnChooseHost) {
   createLoadBalancer();
@@ -330,6 +330,18 @@ Api::IoCallUint64Result VclIoHandle::sendmsg(const Buffer::RawSlice* slices, uin
   return vclCallResultToIoCallResult(result);
 }
 
+Api::IoCallUint64Result VclIoHandle::sendmmsg(absl::Span<const Buffer::RawSlice>,
+                                              const Envoy::Network::Address::Instance&) {
+  // VCL has no sendmmsg semantics, and supportsMmsg() is false.
+  return {0, Envoy::Network::IoSocketError::create(SOCKET_ERROR_NOT_SUP)};
+}
+
+Api::IoCallUint64Result VclIoHandle::sendWithControlMessage(const Buffer::RawSlice*, uint64_t, int,
+                                                            int, absl::Span<const uint8_t>) {
+  // VCL sessions have no ancillary data.
+  return {0, Envoy::Network::IoSocketError::create(SOCKET_ERROR_NOT_SUP)};
+}
+
 Api::IoCallUint64Result VclIoHandle::recvmsg(Buffer::RawSlice* slices, const uint64_t num_slice,
                                              uint32_t self_port, const UdpSaveCmsgConfig&,
                                              RecvMsgOutput& output) {
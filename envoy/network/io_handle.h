@@ -15,6 +15,7 @@
 #include "source/common/buffer/buffer_impl.h"
 
 #include "absl/container/fixed_array.h"
+#include "absl/types/span.h"
 
 namespace Envoy {
 namespace Buffer {
@@ -129,6 +130,34 @@ public:
                                           int flags, const Address::Ip* self_ip,
                                           const Address::Instance& peer_address) PURE;
 
+  /**
+   * Send several messages to the address in one call, each as a datagram of its own (see man 2
+   * sendmmsg). Only supported if supportsMmsg() returns true.
+   * @param datagrams the datagrams to be sent, one slice each.
+   * @param peer_address is the destination address.
+   * @return a Api::IoCallUint64Result with err_ = an Api::IoError instance or
+   * err_ = nullptr and rc_ = the number of datagrams sent for success, which may be less than the
+   * number of datagrams.
+   */
+  virtual Api::IoCallUint64Result sendmmsg(absl::Span<const Buffer::RawSlice> datagrams,
+                                           const Address::Instance& peer_address) PURE;
+
+  /**
+   * Send data on a connected socket along with a single ancillary control message (see man 2
+   * sendmsg and man 3 cmsg).
+   * @param slices points to the location of data to be sent.
+   * @param num_slice indicates number of slices |slices| contains.
+   * @param level the level of the control message, e.g. SOL_TLS.
+   * @param type the protocol specific type of the control message.
+   * @param control_data the payload of the control message.
+   * @return a Api::IoCallUint64Result with err_ = an Api::IoError instance or
+   * err_ = nullptr and rc_ = the bytes written for success. Handles which are not backed by a
+   * kernel socket fail with an error of code NoSupport.
+   */
+  virtual Api::IoCallUint64Result
+  sendWithControlMessage(const Buffer::RawSlice* slices, uint64_t num_slice, int level, int type,
+                         absl::Span<const uint8_t> control_data) PURE;
+
   struct RecvMsgPerPacketInfo {
     // The destination address from transport header.
     Address::InstanceConstSharedPtr local_address_;
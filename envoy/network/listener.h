@@ -431,6 +431,12 @@ public:
    */
   virtual void onReadReady() PURE;
 
+  /**
+   * Called at the end of a read event, after the datagrams read in it have all been passed to
+   * onData(). Called once after each onReadReady() call, even if no datagram was read.
+   */
+  virtual void onReadComplete() PURE;
+
   /**
    * Called when the underlying socket is ready for write.
    *
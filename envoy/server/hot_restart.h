@@ -13,6 +13,7 @@
 #include "envoy/network/address.h"
 #include "envoy/network/listener.h"
 #include "envoy/network/socket.h"
+#include "envoy/ssl/session_store.h"
 #include "envoy/stats/store.h"
 #include "envoy/thread/thread.h"
 
@@ -158,6 +159,12 @@ public:
    */
   virtual Thread::BasicLockable& accessLogLock() PURE;
 
+  /**
+   * @return Ssl::SessionStore* a store of TLS server sessions shared with the other processes of
+   *         the hot restart, or nullptr if there is none.
+   */
+  virtual Ssl::SessionStore* tlsSessionStore() PURE;
+
   /**
    * @return bool whether the server is currently in the initializing state during hot restart.
    */
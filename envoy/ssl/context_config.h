@@ -118,6 +118,12 @@ public:
    */
   virtual AccessLog::AccessLogManager& accessLogManager() const PURE;
 
+  /**
+   * @return true if the encryption of the sent records should be offloaded to the kernel once
+   *         the handshake completes, where supported.
+   */
+  virtual bool kernelTlsOffload() const PURE;
+
   /**
    * @return the compliance policy for the TLS context.
    */
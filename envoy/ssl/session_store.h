@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "envoy/common/pure.h"
+
+#include "absl/types/span.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Store of serialized TLS server sessions, keyed by session ID, used for stateful session
+ * resumption in place of the session cache private to each SSL context. Shared by all the server
+ * contexts, and possibly by the processes of a hot restart, so that a session can be resumed on
+ * any context with the same session ID context. Must be thread safe.
+ */
+class SessionStore {
+public:
+  // Longest session ID, as defined by TLS.
+  static constexpr size_t MaxSessionIdLength = 32;
+
+  virtual ~SessionStore() = default;
+
+  /**
+   * Inserts or replaces a session. The store may drop the session, e.g. if it is too large.
+   * @param session_id the ID of the session.
+   * @param session the serialized session.
+   * @return whether the session was stored.
+   */
+  virtual bool insert(absl::Span<const uint8_t> session_id,
+                      absl::Span<const uint8_t> session) PURE;
+
+  /**
+   * @param session_id the ID of the session.
+   * @param session receives the serialized session.
+   * @return whether the session was found.
+   */
+  virtual bool lookup(absl::Span<const uint8_t> session_id, std::vector<uint8_t>& session) PURE;
+};
+
+} // namespace Ssl
+} // namespace Envoy
@@ -12,6 +12,7 @@
 #include "envoy/stats/stats.h"
 #include "envoy/stats/stats_matcher.h"
 #include "envoy/stats/tag_producer.h"
+#include "envoy/thread/thread.h"
 #include "envoy/thread_local/thread_local.h"
 
 namespace Envoy {
@@ -252,6 +253,24 @@ public:
    */
   virtual void setUseExplicitTags(bool use_explicit_tags) PURE;
 
+  /**
+   * Attach a StatsMatcher selecting the counters that are sharded across threads, trading memory
+   * for uncontended increments. Must be called during single-threaded startup; only counters
+   * created afterwards are affected.
+   * @param matcher a StatsMatcher accepting the names of the counters to shard.
+   */
+  virtual void setShardedCounterMatcher(StatsMatcherPtr&& matcher) PURE;
+
+  /**
+   * Spread the merge of the histograms over up to the given number of threads, including the main
+   * thread, when there are enough histograms to make it worthwhile. The main thread waits for the
+   * merge to complete, as it does when merging alone.
+   * @param num_threads the number of threads merging histograms; 1 merges on the main thread only.
+   * @param thread_factory used to create the additional threads for each merge.
+   */
+  virtual void setHistogramMergeThreads(uint32_t num_threads,
+                                        Thread::ThreadFactory& thread_factory) PURE;
+
   /**
    * Initialize the store for threading. This will be called once after all worker threads have
    * been initialized. At this point the store can initialize itself for multi-threaded operation.
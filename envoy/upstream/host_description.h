@@ -121,6 +121,24 @@ public:
                                         OptRef<const StreamInfo::StreamInfo> /*stream_info*/) {
     return absl::OkStatus();
   }
+
+  /**
+   * @return true if this host data wants to be notified when the number of active or pending
+   *         requests to this upstream host changes.
+   */
+  virtual bool tracksActiveRequests() const { return false; }
+
+  /**
+   * Invoked by the connection pools whenever a request to this host becomes active or pending,
+   * or stops being so. This mirrors the updates of the host's ``rq_active`` and
+   * ``rq_pending_active`` gauges.
+   * NOTE: this method is called concurrently from all worker threads and is on the request
+   * path. Implementations must be thread-safe and cheap.
+   *
+   * @param active_delta supplies the change in the number of active requests.
+   * @param pending_delta supplies the change in the number of pending requests.
+   */
+  virtual void onActiveRequestsChanged(int64_t /*active_delta*/, int64_t /*pending_delta*/) {}
 };
 
 using HostLbPolicyDataPtr = std::unique_ptr<HostLbPolicyData>;
@@ -248,6 +266,13 @@ public:
    */
   virtual HostStats& stats() const PURE;
 
+  /**
+   * @return host specific stats if they were allocated, nullptr otherwise. Implementations may
+   *         allocate the stats on the first call to stats(), in which case all the stats of a host
+   *         for which this returns nullptr are zero. Unlike stats(), this never allocates them.
+   */
+  virtual HostStats* statsIfAllocated() const { return &stats(); }
+
   /**
    * @return custom stats for multi-dimensional load balancing.
    */
@@ -350,6 +375,19 @@ public:
     }
     return {};
   }
+
+  /**
+   * Forward a change in the number of active or pending requests to every attached load
+   * balancing policy data that tracks them. @see HostLbPolicyData::onActiveRequestsChanged().
+   */
+  void notifyActiveRequestsChanged(int64_t active_delta, int64_t pending_delta) const {
+    for (size_t i = 0; i < lbPolicyDataCount(); ++i) {
+      auto data = lbPolicyDataAt(i);
+      if (data.has_value() && data->tracksActiveRequests()) {
+        data->onActiveRequestsChanged(active_delta, pending_delta);
+      }
+    }
+  }
 };
 
 using HostDescriptionConstSharedPtr = std::shared_ptr<const HostDescription>;
@@ -777,7 +777,9 @@ public:
   COUNTER(upstream_cx_none_healthy)                                                                \
   COUNTER(upstream_cx_overflow)                                                                    \
   COUNTER(upstream_cx_pool_overflow)                                                               \
+  COUNTER(upstream_cx_preconnect_demand)                                                           \
   COUNTER(upstream_cx_preconnect_skipped)                                                          \
+  COUNTER(upstream_cx_preconnect_warm)                                                             \
   COUNTER(upstream_cx_protocol_error)                                                              \
   COUNTER(upstream_cx_rx_bytes_total)                                                              \
   COUNTER(upstream_cx_total)                                                                       \
@@ -796,6 +798,8 @@ public:
   COUNTER(upstream_rq_pending_failure_eject)                                                       \
   COUNTER(upstream_rq_pending_overflow)                                                            \
   COUNTER(upstream_rq_pending_total)                                                               \
+  COUNTER(upstream_rq_preconnect_hit)                                                              \
+  COUNTER(upstream_rq_preconnect_miss)                                                             \
   COUNTER(upstream_rq_0rtt)                                                                        \
   COUNTER(upstream_rq_per_try_timeout)                                                             \
   COUNTER(upstream_rq_per_try_idle_timeout)                                                        \
@@ -1101,6 +1105,18 @@ public:
    */
   virtual float peekaheadRatio() const PURE;
 
+  /**
+   * @return the time constant of the stream arrival rate average used by demand preconnect, or
+   * std::nullopt if demand preconnect is disabled.
+   */
+  virtual std::optional<std::chrono::milliseconds> demandPreconnectTimeConstant() const PURE;
+
+  /**
+   * @return the number of warm connections each connection pool keeps to its upstream, or 0 if
+   * none are kept.
+   */
+  virtual uint32_t warmConnections() const PURE;
+
   /**
    * @param host the upstream host being considered for a preconnect.
    * @return whether anticipatory connections may be opened to the host, per the cluster's
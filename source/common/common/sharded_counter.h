@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/non_copyable.h"
+
+#include "absl/base/optimization.h"
+
+namespace Envoy {
+
+/**
+ * A signed counter split across a fixed number of cache-line-padded atomic slots. Each thread
+ * is assigned a slot the first time it touches any sharded counter, so concurrent updates from
+ * different workers land on different cache lines instead of bouncing a single shared line.
+ * Reads sum all of the slots and are therefore O(num_shards); this trades a slightly more
+ * expensive read for contention-free writes, which suits values that are updated on every
+ * request but read comparatively rarely (e.g. once or twice per load balancer pick).
+ *
+ * The value is exact once all concurrent updates have completed. Reads racing with updates see
+ * an approximate value, which is never reported as negative.
+ */
+class ShardedCounter : NonCopyable {
+public:
+  // Enough shards to spread a typical worker count without making each counter too large. With
+  // 64-byte cache lines each counter costs kDefaultShards * 64 bytes.
+  static constexpr uint32_t kDefaultShards = 8;
+
+  explicit ShardedCounter(uint32_t num_shards = kDefaultShards)
+      : num_shards_(num_shards), shards_(std::make_unique<Shard[]>(num_shards)) {
+    ASSERT(num_shards_ > 0);
+  }
+
+  void add(int64_t amount) {
+    shards_[threadIndex() % num_shards_].value_.fetch_add(amount, std::memory_order_relaxed);
+  }
+  void sub(int64_t amount) { add(-amount); }
+  void inc() { add(1); }
+  void dec() { add(-1); }
+
+  /**
+   * @return the sum of all shards, clamped at zero. Slots may individually go negative when a
+   *         value is incremented on one thread and decremented on another.
+   */
+  uint64_t value() const {
+    const int64_t total = sum();
+    return total > 0 ? static_cast<uint64_t>(total) : 0;
+  }
+
+  /**
+   * @return the sum of all shards, which may be negative while it drifts from the value it
+   *         mirrors, e.g. before it is corrected with add().
+   */
+  int64_t sum() const {
+    int64_t total = 0;
+    for (uint32_t i = 0; i < num_shards_; ++i) {
+      total += shards_[i].value_.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  uint32_t numShards() const { return num_shards_; }
+
+  /**
+   * @return the slot index assigned to the calling thread. Indices are handed out round-robin on
+   *         first use and are stable for the lifetime of the thread.
+   */
+  static uint32_t threadIndex() {
+    static std::atomic<uint32_t> next_index{0};
+    thread_local const uint32_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+
+private:
+  struct alignas(ABSL_CACHELINE_SIZE) Shard {
+    std::atomic<int64_t> value_{0};
+  };
+
+  const uint32_t num_shards_;
+  const std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace Envoy
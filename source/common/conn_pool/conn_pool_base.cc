@@ -1,5 +1,7 @@
 #include "source/common/conn_pool/conn_pool_base.h"
 
+#include <cmath>
+
 #include "envoy/server/overload/load_shed_point.h"
 
 #include "source/common/common/assert.h"
@@ -140,6 +142,8 @@ void ConnPoolImplBase::deleteIsPendingImpl() {
 }
 
 void ConnPoolImplBase::destructAllConnections() {
+  // The connections closed below must not be replaced by warm connections.
+  destructing_ = true;
   for (auto* list : {&ready_clients_, &busy_clients_, &connecting_clients_, &early_data_clients_}) {
     while (!list->empty()) {
       list->front()->close();
@@ -172,7 +176,9 @@ bool ConnPoolImplBase::shouldConnect(size_t pending_streams, size_t active_strea
          connecting_and_connected_capacity + active_streams;
 }
 
-bool ConnPoolImplBase::shouldCreateNewConnection(float global_preconnect_ratio) const {
+bool ConnPoolImplBase::shouldCreateNewConnection(float global_preconnect_ratio,
+                                                 ConnectReason& reason) const {
+  reason = ConnectReason::Ratio;
   // If the host is not healthy, don't make it do extra work, especially as
   // upstream selection logic may result in bypassing this upstream entirely.
   // If an Envoy user wants preconnecting for degraded upstreams this could be
@@ -214,6 +220,39 @@ bool ConnPoolImplBase::shouldCreateNewConnection(float global_preconnect_ratio)
               perUpstreamPreconnectRatio());
   }
 
+  // With demand preconnect, also provision for the streams forecast to arrive before a new
+  // connection could be established.
+  bool demand_only = false;
+  if (!result) {
+    const std::optional<std::chrono::milliseconds> time_constant =
+        host_->cluster().demandPreconnectTimeConstant();
+    if (time_constant.has_value()) {
+      const uint64_t forecast = forecastStreams(time_constant.value());
+      demand_only = pendingStreamCount() + forecast > connecting_and_connected_stream_capacity_;
+      result = demand_only;
+      ENVOY_LOG(trace,
+                "demand shouldCreateNewConnection returns {} for pending {} forecast {} "
+                "connecting_and_connected_capacity {}",
+                result, pendingStreamCount(), forecast, connecting_and_connected_stream_capacity_);
+    }
+  }
+
+  // With warm connections, also keep the capacity to serve that many new streams without waiting,
+  // unless connections to the upstream are failing.
+  bool warm_only = false;
+  const uint32_t warm_connections = host_->cluster().warmConnections();
+  if (!result && warm_connections > 0 && !warm_connect_failed_ && !is_draining_for_deletion_ &&
+      !deferred_deleting_ && !destructing_) {
+    const uint64_t free_capacity =
+        connecting_and_connected_stream_capacity_ > pendingStreamCount()
+            ? connecting_and_connected_stream_capacity_ - pendingStreamCount()
+            : 0;
+    warm_only = free_capacity < warm_connections;
+    result = warm_only;
+    ENVOY_LOG(trace, "warm shouldCreateNewConnection returns {} for free capacity {} warm {}",
+              result, free_capacity, warm_connections);
+  }
+
   // Ineligible hosts get connections only for on-demand requests, not anticipatory ones.
   if (!host_->cluster().shouldPreconnect(*host_)) {
     const bool on_demand = pendingStreamCount() > connecting_stream_capacity_;
@@ -223,9 +262,39 @@ bool ConnPoolImplBase::shouldCreateNewConnection(float global_preconnect_ratio)
     return on_demand;
   }
 
+  if (demand_only) {
+    reason = ConnectReason::Demand;
+  } else if (warm_only) {
+    reason = ConnectReason::Warm;
+  }
   return result;
 }
 
+void ConnPoolImplBase::recordStreamArrival(std::chrono::milliseconds time_constant) {
+  const MonotonicTime now = dispatcher_.timeSource().monotonicTime();
+  const double tau = std::chrono::duration<double>(time_constant).count();
+  // Each arrival adds 1/tau to a rate that decays exponentially with time constant tau, which
+  // averages to the arrival rate in streams per second.
+  if (stream_arrival_rate_ > 0) {
+    const double elapsed = std::chrono::duration<double>(now - last_stream_arrival_).count();
+    stream_arrival_rate_ *= std::exp(-elapsed / tau);
+  }
+  stream_arrival_rate_ += 1.0 / tau;
+  last_stream_arrival_ = now;
+}
+
+uint64_t ConnPoolImplBase::forecastStreams(std::chrono::milliseconds time_constant) const {
+  if (stream_arrival_rate_ == 0 || connect_latency_ms_ == 0) {
+    return 0;
+  }
+  const double tau = std::chrono::duration<double>(time_constant).count();
+  const double elapsed = std::chrono::duration<double>(dispatcher_.timeSource().monotonicTime() -
+                                                       last_stream_arrival_)
+                             .count();
+  const double rate = stream_arrival_rate_ * std::exp(-elapsed / tau);
+  return std::llround(rate * connect_latency_ms_ / 1000);
+}
+
 float ConnPoolImplBase::perUpstreamPreconnectRatio() const {
   return host_->cluster().perUpstreamPreconnectRatio();
 }
@@ -252,7 +321,8 @@ ConnPoolImplBase::ConnectionResult ConnPoolImplBase::tryCreateNewConnections() {
 ConnPoolImplBase::ConnectionResult
 ConnPoolImplBase::tryCreateNewConnection(float global_preconnect_ratio) {
   // There are already enough Connecting connections for the number of queued streams.
-  if (!shouldCreateNewConnection(global_preconnect_ratio)) {
+  ConnectReason reason;
+  if (!shouldCreateNewConnection(global_preconnect_ratio, reason)) {
     return ConnectionResult::ShouldNotConnect;
   }
   ENVOY_LOG(trace, "creating new preconnect connection");
@@ -289,6 +359,11 @@ ConnPoolImplBase::tryCreateNewConnection(float global_preconnect_ratio) {
     incrConnectingAndConnectedStreamCapacity(client->currentUnusedCapacity(), *client);
     LinkedList::moveIntoList(std::move(client), owningList(client->state()));
     assertCapacityCountsAreCorrect();
+    if (reason == ConnectReason::Demand) {
+      host_->cluster().trafficStats()->upstream_cx_preconnect_demand_.inc();
+    } else if (reason == ConnectReason::Warm) {
+      host_->cluster().trafficStats()->upstream_cx_preconnect_warm_.inc();
+    }
     return can_create_connection ? ConnectionResult::CreatedNewConnection
                                  : ConnectionResult::CreatedButRateLimited;
   } else {
@@ -340,6 +415,7 @@ void ConnPoolImplBase::attachStreamToClient(Envoy::ConnectionPool::ActiveClient&
   num_active_streams_++;
   host_->stats().rq_total_.inc();
   host_->stats().rq_active_.inc();
+  host_->notifyActiveRequestsChanged(1, 0);
   traffic_stats.upstream_rq_total_.inc();
   traffic_stats.upstream_rq_active_.inc();
   host_->cluster().resourceManager(priority_).requests().inc();
@@ -356,6 +432,7 @@ void ConnPoolImplBase::onStreamClosed(Envoy::ConnectionPool::ActiveClient& clien
   cluster_connectivity_state_.decrActiveStreams(1);
   num_active_streams_--;
   host_->stats().rq_active_.dec();
+  host_->notifyActiveRequestsChanged(-1, 0);
   host_->cluster().trafficStats()->upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
   // We don't update the capacity for HTTP/3 as the stream count should only
@@ -402,9 +479,20 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStreamImpl(AttachContext& cont
   ASSERT(!deferred_deleting_, dumpState());
   assertCapacityCountsAreCorrect();
 
+  const std::optional<std::chrono::milliseconds> demand_time_constant =
+      host_->cluster().demandPreconnectTimeConstant();
+  if (demand_time_constant.has_value()) {
+    recordStreamArrival(demand_time_constant.value());
+  }
+  const bool count_preconnect_hits =
+      demand_time_constant.has_value() || host_->cluster().warmConnections() > 0;
+
   if (!ready_clients_.empty()) {
     ActiveClient& client = *ready_clients_.front();
     ENVOY_CONN_LOG(debug, "using existing fully connected connection", client);
+    if (count_preconnect_hits) {
+      host_->cluster().trafficStats()->upstream_rq_preconnect_hit_.inc();
+    }
     attachStreamToClient(client, context);
     // Even if there's a ready client, we may want to preconnect to handle the next incoming stream.
     tryCreateNewConnections();
@@ -414,6 +502,9 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStreamImpl(AttachContext& cont
   if (can_send_early_data && !early_data_clients_.empty()) {
     ActiveClient& client = *early_data_clients_.front();
     ENVOY_CONN_LOG(debug, "using existing early data ready connection", client);
+    if (count_preconnect_hits) {
+      host_->cluster().trafficStats()->upstream_rq_preconnect_hit_.inc();
+    }
     attachStreamToClient(client, context);
     // Even if there's an available client, we may want to preconnect to handle the next
     // incoming stream.
@@ -429,6 +520,9 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStreamImpl(AttachContext& cont
     return nullptr;
   }
 
+  if (count_preconnect_hits) {
+    host_->cluster().trafficStats()->upstream_rq_preconnect_miss_.inc();
+  }
   ConnectionPool::Cancellable* pending = newPendingStream(context, can_send_early_data);
   ENVOY_LOG(debug, "trying to create new connection");
   ENVOY_LOG(trace, fmt::format("{}", *this));
@@ -666,6 +760,9 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
 
     if (!client.hasHandshakeCompleted()) {
       client.has_handshake_completed_ = true;
+      // Stop replenishing the warm connections until a connection succeeds, rather than
+      // reconnecting in a loop to a failing upstream.
+      warm_connect_failed_ = true;
       host_->cluster().trafficStats()->upstream_cx_connect_fail_.inc();
       host_->stats().cx_connect_fail_.inc();
 
@@ -711,6 +808,8 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
       client.connection_duration_timer_.reset();
     }
 
+    const bool replace_warm_connection = event == Network::ConnectionEvent::RemoteClose &&
+                                         client.state() != ActiveClient::State::Draining;
     dispatcher_.deferredDelete(client.removeFromList(owningList(client.state())));
 
     // Check if the pool transitioned to idle state after removing closed client
@@ -728,6 +827,12 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
     // If we have pending streams and we just lost a connection we should make a new one.
     if (hasPendingStreams()) {
       tryCreateNewConnections();
+    } else if (host_->cluster().warmConnections() > 0 && replace_warm_connection &&
+               !is_draining_for_deletion_ && !destructing_ && !isIdleImpl()) {
+      // Replace a warm connection closed by the upstream, unless the pool went idle and is being
+      // deleted. Connections closed locally, by the idle timeout or once drained, are not
+      // replaced: the next stream restores the warm capacity if there is still traffic.
+      tryCreateNewConnections();
     }
     break;
   }
@@ -739,6 +844,14 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
     ENVOY_BUG(connecting_stream_capacity_ >= client.currentUnusedCapacity(), dumpState());
     connecting_stream_capacity_ -= client.currentUnusedCapacity();
     client.has_handshake_completed_ = true;
+    warm_connect_failed_ = false;
+    if (host_->cluster().demandPreconnectTimeConstant().has_value()) {
+      // The connect time includes the TLS or QUIC handshake.
+      const double sample = client.conn_connect_ms_->elapsed().count();
+      connect_latency_ms_ = connect_latency_ms_ == 0
+                                ? sample
+                                : connect_latency_ms_ + (sample - connect_latency_ms_) / 4;
+    }
     client.conn_connect_ms_->complete();
     client.conn_connect_ms_.reset();
     if (client.state() == ActiveClient::State::Connecting ||
@@ -332,9 +332,17 @@ protected:
   // be closed as excess or not.
   bool connectingConnectionIsExcess(const ActiveClient& client) const;
 
+  // Why shouldCreateNewConnection() asked for a new connection, so that the preconnect stats
+  // count only the connections actually created.
+  enum class ConnectReason {
+    Ratio,  // The pending streams or the preconnect ratio call for more capacity.
+    Demand, // Only the streams forecast by demand preconnect call for more capacity.
+    Warm,   // Only the configured warm connections call for more capacity.
+  };
+
   // A helper function which determines if a new incoming stream should trigger
   // connection preconnect.
-  bool shouldCreateNewConnection(float global_preconnect_ratio) const;
+  bool shouldCreateNewConnection(float global_preconnect_ratio, ConnectReason& reason) const;
 
   float perUpstreamPreconnectRatio() const;
 
@@ -392,6 +400,11 @@ private:
   void drainClients(std::list<ActiveClientPtr>& clients);
 
   void assertCapacityCountsAreCorrect();
+  // Demand preconnect: adds a stream arrival to the arrival rate average.
+  void recordStreamArrival(std::chrono::milliseconds time_constant);
+  // Demand preconnect: returns the number of streams expected to arrive while a new connection is
+  // being established.
+  uint64_t forecastStreams(std::chrono::milliseconds time_constant) const;
   void updateQueueOverloadedGauge();
   void clearQueueOverloadedGauge();
   size_t pendingStreamCount() const;
@@ -413,6 +426,17 @@ private:
   // The number of streams currently attached to clients.
   uint32_t num_active_streams_{0};
 
+  // Exponentially weighted moving averages of the stream arrival rate, in streams per second, and
+  // of the time it took to establish connections, in milliseconds. Only maintained when demand
+  // preconnect is configured for the cluster.
+  double stream_arrival_rate_{0};
+  MonotonicTime last_stream_arrival_;
+  double connect_latency_ms_{0};
+
+  // Whether the last connection attempt failed, which stops the replenishment of the warm
+  // connections until a connection succeeds.
+  bool warm_connect_failed_{false};
+
   // Whether the connection pool is currently in the process of closing
   // all connections so that it can be gracefully deleted.
   bool is_draining_for_deletion_{false};
@@ -420,6 +444,9 @@ private:
   // True iff this object is in the deferred delete list.
   bool deferred_deleting_{false};
 
+  // True once destructAllConnections() has been called.
+  bool destructing_{false};
+
   Event::SchedulableCallbackPtr upstream_ready_cb_;
   Common::DebugRecursionChecker recursion_checker_;
   Server::LoadShedPoint* create_new_connection_load_shed_{nullptr};
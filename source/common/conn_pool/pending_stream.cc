@@ -13,12 +13,14 @@ PendingStream::PendingStream(ConnPoolImplBase& parent, bool can_send_early_data)
   traffic_stats.upstream_rq_pending_total_.inc();
   traffic_stats.upstream_rq_pending_active_.inc();
   parent_.host()->stats().rq_pending_active_.inc();
+  parent_.host()->notifyActiveRequestsChanged(0, 1);
   parent_.host()->cluster().resourceManager(parent_.priority()).pendingRequests().inc();
 }
 
 PendingStream::~PendingStream() {
   parent_.host()->cluster().trafficStats()->upstream_rq_pending_active_.dec();
   parent_.host()->stats().rq_pending_active_.dec();
+  parent_.host()->notifyActiveRequestsChanged(0, -1);
   parent_.host()->cluster().resourceManager(parent_.priority()).pendingRequests().dec();
 }
 
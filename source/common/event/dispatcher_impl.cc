@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -16,6 +17,7 @@
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/lock_guard.h"
+#include "source/common/common/perf_tracing.h"
 #include "source/common/common/thread.h"
 #include "source/common/config/utility.h"
 #include "source/common/event/file_event_impl.h"
@@ -27,6 +29,7 @@
 #include "source/common/network/address_impl.h"
 #include "source/common/network/connection_impl.h"
 #include "source/common/network/utility.h"
+#include "source/common/profiler/scope_profiler.h"
 #include "source/common/runtime/runtime_features.h"
 
 #include "event2/event.h"
@@ -209,6 +212,7 @@ FileEventPtr DispatcherImpl::createFileEvent(os_fd_t fd, FileReadyCb cb, FileTri
       *this, fd,
       [this, cb](uint32_t events) {
         touchWatchdog();
+        SlowCallbackScope slow_callback_scope(*this, "file_event");
         return cb(events);
       },
       trigger, events)};
@@ -238,6 +242,7 @@ Event::SchedulableCallbackPtr DispatcherImpl::createSchedulableCallback(std::fun
   ASSERT(isThreadSafe());
   return base_scheduler_.createSchedulableCallback([this, cb]() {
     touchWatchdog();
+    SlowCallbackScope slow_callback_scope(*this, "schedulable_callback");
     cb();
   });
 }
@@ -246,6 +251,7 @@ TimerPtr DispatcherImpl::createTimerInternal(TimerCb cb) {
   return scheduler_->createTimer(
       [this, cb]() {
         touchWatchdog();
+        SlowCallbackScope slow_callback_scope(*this, "timer");
         cb();
       },
       *this);
@@ -384,6 +390,7 @@ void DispatcherImpl::runPostCallbacks() {
     // Touch the watchdog before executing the callback to avoid spurious watchdog miss events when
     // executing a long list of callbacks.
     touchWatchdog();
+    SlowCallbackScope slow_callback_scope(*this, "post");
     // Run the callback.
     callbacks.front()();
     // Pop the front so that the destructor of the callback that just executed runs before the next
@@ -425,8 +432,11 @@ void DispatcherImpl::touchWatchdog() {
 void DispatcherImpl::pushTrackedObject(const ScopeTrackedObject* object) {
   ASSERT(isThreadSafe());
   ASSERT(object != nullptr);
+  const ScopeTrackedObject* previous =
+      tracked_object_stack_.empty() ? nullptr : tracked_object_stack_.back();
   tracked_object_stack_.push_back(object);
   ASSERT(tracked_object_stack_.size() <= ExpectedMaxTrackedObjectStackDepth);
+  Profiler::ScopeProfiler::onTrackedObjectChange(previous, object);
 }
 
 void DispatcherImpl::popTrackedObject(const ScopeTrackedObject* expected_object) {
@@ -438,6 +448,42 @@ void DispatcherImpl::popTrackedObject(const ScopeTrackedObject* expected_object)
   tracked_object_stack_.pop_back();
   ASSERT(top == expected_object,
          "Popped the top of the tracked object stack, but it wasn't the expected object!");
+  Profiler::ScopeProfiler::onTrackedObjectChange(
+      top, tracked_object_stack_.empty() ? nullptr : tracked_object_stack_.back());
+
+  // The object is only alive until the end of its scope, so a slow callback must dump it now. The
+  // outermost object is the connection or stream, whose dump includes the nested ones.
+  if (slow_callback_timing_.has_value() && tracked_object_stack_.empty() &&
+      slow_callback_timing_->tracked_object_.empty() &&
+      time_source_.monotonicTime() - slow_callback_timing_->start_ >=
+          slow_callback_timing_->threshold_) {
+    std::ostringstream os;
+    top->dumpState(os, 1);
+    slow_callback_timing_->tracked_object_ =
+        os.str().substr(0, SlowCallbackTracker::MaxTrackedObjectStateLength);
+  }
+}
+
+DispatcherImpl* DispatcherImpl::startSlowCallbackTiming(absl::string_view kind) {
+  if (slow_callback_timing_.has_value()) {
+    return nullptr;
+  }
+  slow_callback_timing_.emplace(SlowCallbackTiming{time_source_.monotonicTime(),
+                                                   SlowCallbackTracker::threshold(), kind, ""});
+  return this;
+}
+
+void DispatcherImpl::endSlowCallbackTiming() {
+  const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      time_source_.monotonicTime() - slow_callback_timing_->start_);
+  if (duration >= slow_callback_timing_->threshold_) {
+    TRACE_COUNTER("core", "slow_callback_us", duration.count());
+    ENVOY_LOG(debug, "{} ran a slow {} for {}us", name_, slow_callback_timing_->kind_,
+              duration.count());
+    SlowCallbackTracker::record(name_, {duration, slow_callback_timing_->kind_,
+                                        std::move(slow_callback_timing_->tracked_object_)});
+  }
+  slow_callback_timing_.reset();
 }
 
 } // namespace Event
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include "envoy/api/api.h"
@@ -18,9 +21,11 @@
 #include "source/common/common/thread.h"
 #include "source/common/event/libevent.h"
 #include "source/common/event/libevent_scheduler.h"
+#include "source/common/event/slow_callback_tracker.h"
 #include "source/common/signal/fatal_error_handler.h"
 
 #include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
 
 namespace Envoy {
 namespace Event {
@@ -127,6 +132,35 @@ private:
   };
   using WatchdogRegistrationPtr = std::unique_ptr<WatchdogRegistration>;
 
+  // Times the callback run in its scope for the SlowCallbackTracker, while it is enabled.
+  class SlowCallbackScope {
+  public:
+    SlowCallbackScope(DispatcherImpl& dispatcher, absl::string_view kind)
+        : dispatcher_(SlowCallbackTracker::enabled() ? dispatcher.startSlowCallbackTiming(kind)
+                                                     : nullptr) {}
+    ~SlowCallbackScope() {
+      if (dispatcher_ != nullptr) {
+        dispatcher_->endSlowCallbackTiming();
+      }
+    }
+
+  private:
+    DispatcherImpl* const dispatcher_;
+  };
+
+  // The callback being timed for the SlowCallbackTracker.
+  struct SlowCallbackTiming {
+    MonotonicTime start_;
+    std::chrono::microseconds threshold_;
+    absl::string_view kind_;
+    std::string tracked_object_;
+  };
+
+  // @return this, or nullptr if a callback is already being timed, i.e. if the loop is run from a
+  // callback, in which case the outer callback accounts for the inner ones.
+  DispatcherImpl* startSlowCallbackTiming(absl::string_view kind);
+  void endSlowCallbackTiming();
+
   TimerPtr createTimerInternal(TimerCb cb);
   void updateApproximateMonotonicTimeInternal();
   void runPostCallbacks();
@@ -174,6 +208,7 @@ private:
       tracked_object_stack_;
   bool deferred_deleting_{};
   MonotonicTime approximate_monotonic_time_;
+  std::optional<SlowCallbackTiming> slow_callback_timing_;
   WatchdogRegistrationPtr watchdog_registration_;
   const ScaledRangeTimerManagerPtr scaled_timer_manager_;
 };
@@ -0,0 +1,78 @@
+#include "source/common/event/slow_callback_tracker.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "source/common/common/lock_guard.h"
+#include "source/common/common/macros.h"
+#include "source/common/common/thread.h"
+
+#include "absl/container/btree_map.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Event {
+
+std::atomic<int64_t> SlowCallbackTracker::threshold_us_{-1};
+
+namespace {
+
+struct SlowCallbacks {
+  Thread::MutexBasicLockable mutex_;
+  // Sorted by dispatcher name for the report, each vector slowest first.
+  absl::btree_map<std::string, std::vector<SlowCallbackTracker::SlowCallback>>
+      by_dispatcher_ ABSL_GUARDED_BY(mutex_);
+};
+
+SlowCallbacks& slowCallbacks() { MUTABLE_CONSTRUCT_ON_FIRST_USE(SlowCallbacks); }
+
+} // namespace
+
+void SlowCallbackTracker::enable(std::chrono::microseconds threshold) {
+  {
+    SlowCallbacks& all = slowCallbacks();
+    Thread::LockGuard lock(all.mutex_);
+    all.by_dispatcher_.clear();
+  }
+  threshold_us_.store(std::max<int64_t>(threshold.count(), 0), std::memory_order_relaxed);
+}
+
+void SlowCallbackTracker::disable() { threshold_us_.store(-1, std::memory_order_relaxed); }
+
+void SlowCallbackTracker::record(const std::string& dispatcher, SlowCallback&& callback) {
+  SlowCallbacks& all = slowCallbacks();
+  Thread::LockGuard lock(all.mutex_);
+  std::vector<SlowCallback>& callbacks = all.by_dispatcher_[dispatcher];
+  if (callbacks.size() == MaxCallbacksPerDispatcher &&
+      callbacks.back().duration_ >= callback.duration_) {
+    return;
+  }
+  auto it = std::upper_bound(
+      callbacks.begin(), callbacks.end(), callback.duration_,
+      [](std::chrono::microseconds duration, const SlowCallback& c) {
+        return duration > c.duration_;
+      });
+  callbacks.insert(it, std::move(callback));
+  if (callbacks.size() > MaxCallbacksPerDispatcher) {
+    callbacks.pop_back();
+  }
+}
+
+std::string SlowCallbackTracker::report() {
+  SlowCallbacks& all = slowCallbacks();
+  Thread::LockGuard lock(all.mutex_);
+  std::string out;
+  for (const auto& [dispatcher, callbacks] : all.by_dispatcher_) {
+    for (const SlowCallback& callback : callbacks) {
+      absl::StrAppend(&out, dispatcher, " ", callback.duration_.count(), "us ", callback.kind_,
+                      "\n", callback.tracked_object_);
+      if (!callback.tracked_object_.empty() && callback.tracked_object_.back() != '\n') {
+        out.push_back('\n');
+      }
+    }
+  }
+  return out;
+}
+
+} // namespace Event
+} // namespace Envoy
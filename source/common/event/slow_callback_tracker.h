@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Process wide record of the slowest event loop callbacks run by each dispatcher, with the
+ * identity of the connection, stream or filter each one was working on, to explain the loop
+ * stalls that the loop_duration_us histogram only counts.
+ *
+ * Disabled by default. While disabled, the dispatchers only load one atomic per callback. While
+ * enabled, they time each callback and, once a callback has run for longer than the threshold,
+ * dump the state of the outermost object it tracks with ScopeTrackerScopeState when leaving its
+ * scope.
+ */
+class SlowCallbackTracker {
+public:
+  // Number of callbacks kept per dispatcher; only the slowest are kept.
+  static constexpr size_t MaxCallbacksPerDispatcher = 10;
+  // Bound on the length of the dumped state of a tracked object.
+  static constexpr size_t MaxTrackedObjectStateLength = 1024;
+
+  struct SlowCallback {
+    std::chrono::microseconds duration_;
+    // The kind of the callback, e.g. "file_event" or "timer". Must be a string literal.
+    absl::string_view kind_;
+    // The dumped state of the object tracked by the callback, empty if there was none.
+    std::string tracked_object_;
+  };
+
+  /**
+   * Starts recording the callbacks running for at least the threshold, dropping the ones
+   * recorded so far so that the report covers a single interval.
+   * @param threshold the minimum duration of a recorded callback. With a zero threshold, the
+   *        slowest callbacks are recorded whatever their duration, at the cost of dumping the state
+   *        of every tracked object.
+   */
+  static void enable(std::chrono::microseconds threshold);
+
+  /**
+   * Stops recording. The callbacks recorded so far are kept until the next enable().
+   */
+  static void disable();
+
+  static bool enabled() { return threshold_us_.load(std::memory_order_relaxed) >= 0; }
+
+  /**
+   * @return the threshold; only meaningful while enabled.
+   */
+  static std::chrono::microseconds threshold() {
+    return std::chrono::microseconds(threshold_us_.load(std::memory_order_relaxed));
+  }
+
+  /**
+   * Records a callback that ran for at least the threshold, unless the dispatcher already
+   * recorded as many slower callbacks.
+   * @param dispatcher the name of the dispatcher that ran the callback.
+   * @param callback the callback.
+   */
+  static void record(const std::string& dispatcher, SlowCallback&& callback);
+
+  /**
+   * @return the recorded callbacks, grouped by dispatcher, slowest first, e.g.
+   *         "worker_0 52341us file_event" followed by the dumped state of the tracked object.
+   */
+  static std::string report();
+
+private:
+  // Negative while disabled.
+  static std::atomic<int64_t> threshold_us_;
+};
+
+} // namespace Event
+} // namespace Envoy
@@ -230,6 +230,72 @@ Api::IoCallUint64Result IoSocketHandleImpl::sendmsg(const Buffer::RawSlice* slic
   }
 }
 
+Api::IoCallUint64Result IoSocketHandleImpl::sendmmsg(absl::Span<const Buffer::RawSlice> datagrams,
+                                                     const Address::Instance& peer_address) {
+  const auto* address_base = dynamic_cast<const Address::InstanceBase*>(&peer_address);
+  sockaddr* sock_addr = const_cast<sockaddr*>(address_base->sockAddr());
+  if (sock_addr == nullptr) {
+    // Unlikely to happen unless the wrong peer address is passed.
+    return IoSocketError::ioResultSocketInvalidAddress();
+  }
+  if (datagrams.empty()) {
+    return Api::ioCallUint64ResultNoError();
+  }
+
+  absl::FixedArray<iovec> iov(datagrams.size());
+  absl::FixedArray<mmsghdr> mmsg_hdr(datagrams.size());
+  for (size_t i = 0; i < datagrams.size(); ++i) {
+    iov[i].iov_base = datagrams[i].mem_;
+    iov[i].iov_len = datagrams[i].len_;
+    mmsg_hdr[i] = {};
+    msghdr& message = mmsg_hdr[i].msg_hdr;
+    message.msg_name = reinterpret_cast<void*>(sock_addr);
+    message.msg_namelen = address_base->sockAddrLen();
+    message.msg_iov = &iov[i];
+    message.msg_iovlen = 1;
+  }
+  const Api::SysCallIntResult result =
+      Api::OsSysCallsSingleton::get().sendmmsg(fd_, mmsg_hdr.data(), datagrams.size(), 0);
+  return sysCallResultToIoCallResult(result);
+}
+
+Api::IoCallUint64Result
+IoSocketHandleImpl::sendWithControlMessage(const Buffer::RawSlice* slices, uint64_t num_slice,
+                                           int level, int type,
+                                           absl::Span<const uint8_t> control_data) {
+  if (!isOpen()) {
+    return {0, IoSocketError::getIoSocketEbadfError()};
+  }
+  absl::FixedArray<iovec> iov(num_slice);
+  uint64_t num_slices_to_write = 0;
+  for (uint64_t i = 0; i < num_slice; i++) {
+    if (slices[i].mem_ != nullptr && slices[i].len_ != 0) {
+      iov[num_slices_to_write].iov_base = slices[i].mem_;
+      iov[num_slices_to_write].iov_len = slices[i].len_;
+      num_slices_to_write++;
+    }
+  }
+
+  const size_t cmsg_space = CMSG_SPACE(control_data.size());
+  absl::FixedArray<char> cbuf(cmsg_space);
+  memset(cbuf.begin(), 0, cmsg_space);
+  msghdr message{};
+  message.msg_iov = iov.begin();
+  message.msg_iovlen = num_slices_to_write;
+  message.msg_control = cbuf.begin();
+  message.msg_controllen = cmsg_space;
+  cmsghdr* const cmsg = CMSG_FIRSTHDR(&message);
+  RELEASE_ASSERT(cmsg != nullptr, fmt::format("cbuf with size {} is not enough, cmsghdr size {}",
+                                              cmsg_space, sizeof(cmsghdr)));
+  cmsg->cmsg_level = level;
+  cmsg->cmsg_type = type;
+  cmsg->cmsg_len = CMSG_LEN(control_data.size());
+  if (!control_data.empty()) {
+    memcpy(CMSG_DATA(cmsg), control_data.data(), control_data.size());
+  }
+  return sysCallResultToIoCallResult(Api::OsSysCallsSingleton::get().sendmsg(fd_, &message, 0));
+}
+
 Address::InstanceConstSharedPtr
 IoSocketHandleImpl::getOrCreateEnvoyAddressInstance(sockaddr_storage ss, socklen_t ss_len) {
   if (!recent_received_addresses_) {
@@ -54,6 +54,13 @@ public:
                                   const Address::Ip* self_ip,
                                   const Address::Instance& peer_address) override;
 
+  Api::IoCallUint64Result sendmmsg(absl::Span<const Buffer::RawSlice> datagrams,
+                                   const Address::Instance& peer_address) override;
+
+  Api::IoCallUint64Result sendWithControlMessage(const Buffer::RawSlice* slices,
+                                                 uint64_t num_slice, int level, int type,
+                                                 absl::Span<const uint8_t> control_data) override;
+
   Api::IoCallUint64Result recvmsg(Buffer::RawSlice* slices, const uint64_t num_slice,
                                   uint32_t self_port, const UdpSaveCmsgConfig& save_cmsg_config,
                                   RecvMsgOutput& output) override;
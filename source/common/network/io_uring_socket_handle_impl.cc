@@ -151,6 +151,20 @@ Api::IoCallUint64Result IoUringSocketHandleImpl::sendmsg(const Buffer::RawSlice*
   return Network::IoSocketError::ioResultSocketInvalidAddress();
 }
 
+Api::IoCallUint64Result IoUringSocketHandleImpl::sendmmsg(absl::Span<const Buffer::RawSlice>,
+                                                          const Address::Instance&) {
+  ENVOY_LOG(trace, "sendmmsg, fd = {}, type = {}", fd_, ioUringSocketTypeStr());
+  return Network::IoSocketError::ioResultSocketInvalidAddress();
+}
+
+Api::IoCallUint64Result
+IoUringSocketHandleImpl::sendWithControlMessage(const Buffer::RawSlice*, uint64_t, int, int,
+                                                absl::Span<const uint8_t>) {
+  ENVOY_LOG(trace, "sendWithControlMessage, fd = {}, type = {}", fd_, ioUringSocketTypeStr());
+  // The data would be written out of order with the writes queued on the ring.
+  return {0, IoSocketError::create(SOCKET_ERROR_NOT_SUP)};
+}
+
 Api::IoCallUint64Result IoUringSocketHandleImpl::recvmsg(Buffer::RawSlice*, const uint64_t,
                                                          uint32_t,
                                                          const IoHandle::UdpSaveCmsgConfig&,
@@ -14,6 +14,7 @@
 #include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/assert.h"
+#include "source/common/common/cleanup.h"
 #include "source/common/common/empty_string.h"
 #include "source/common/common/fmt.h"
 #include "source/common/event/dispatcher_impl.h"
@@ -103,10 +104,16 @@ void UdpListenerImpl::onSocketEvent(short flags) {
 
 void UdpListenerImpl::handleReadCallback() {
   ENVOY_UDP_LOG(trace, "handleReadCallback");
-  cb_.onReadReady();
-  const Api::IoErrorPtr result = Utility::readPacketsFromSocket(
-      socket_->ioHandle(), *socket_->connectionInfoProvider().localAddress(), *this, time_source_,
-      config_.prefer_gro_, /*allow_mmsg=*/true, packets_dropped_);
+  Api::IoErrorPtr result;
+  {
+    cb_.onReadReady();
+    // The callbacks may hold the datagrams of the read until onReadComplete(), so it is called
+    // however the read ends.
+    Cleanup read_complete([this]() { cb_.onReadComplete(); });
+    result = Utility::readPacketsFromSocket(
+        socket_->ioHandle(), *socket_->connectionInfoProvider().localAddress(), *this,
+        time_source_, config_.prefer_gro_, /*allow_mmsg=*/true, packets_dropped_);
+  }
   if (result == nullptr) {
     // No error. The number of reads was limited by read rate. There are more packets to read.
     // Register to read more in the next event loop.
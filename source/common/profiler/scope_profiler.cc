@@ -0,0 +1,205 @@
+#include "source/common/profiler/scope_profiler.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "envoy/network/filter.h"
+#include "envoy/network/listener.h"
+#include "envoy/network/socket.h"
+#include "envoy/stream_info/stream_info.h"
+#include "envoy/upstream/upstream.h"
+
+#include "source/common/common/lock_guard.h"
+#include "source/common/common/macros.h"
+#include "source/common/common/thread.h"
+#include "source/common/common/utility.h"
+#include "source/common/profiler/profiler.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+
+#ifndef WIN32
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+namespace Envoy {
+namespace Profiler {
+
+std::atomic<bool> ScopeProfiler::running_{false};
+
+namespace {
+
+// Both members are lock-free atomics with constant initialization, so the signal handler can use
+// them without triggering the lazy initialization of the thread local.
+struct ThreadState {
+  std::atomic<const ScopeTrackedObject*> object_{nullptr};
+  std::atomic<uint32_t> pending_samples_{0};
+};
+
+thread_local ThreadState thread_state;
+
+std::atomic<uint64_t> unscoped_samples{0};
+
+struct Attributions {
+  Thread::MutexBasicLockable mutex_;
+  absl::flat_hash_map<std::string, uint64_t> samples_ ABSL_GUARDED_BY(mutex_);
+  uint64_t other_samples_ ABSL_GUARDED_BY(mutex_){};
+};
+
+Attributions& attributions() { MUTABLE_CONSTRUCT_ON_FIRST_USE(Attributions); }
+
+std::string attribution(const ScopeTrackedObject& object) {
+  OptRef<const StreamInfo::StreamInfo> stream_info = object.trackedStream();
+  if (!stream_info.has_value()) {
+    return "unknown";
+  }
+  const Network::ConnectionInfoProvider& provider = stream_info->downstreamAddressProvider();
+  absl::string_view listener;
+  absl::string_view filter_chain;
+  absl::string_view cluster;
+  if (OptRef<const Network::ListenerInfo> info = provider.listenerInfo(); info.has_value()) {
+    listener = info->name();
+  }
+  if (OptRef<const Network::FilterChainInfo> info = provider.filterChainInfo(); info.has_value()) {
+    filter_chain = info->name();
+  }
+  if (OptRef<const Upstream::ClusterInfo> info = stream_info->upstreamClusterInfo();
+      info.has_value()) {
+    cluster = info->name();
+  }
+  return absl::StrCat("listener=", listener, ";filter_chain=", filter_chain,
+                      ";route=", stream_info->getRouteName(), ";cluster=", cluster);
+}
+
+// Attributes the samples counted for the thread so far to the object, which is null when the
+// thread was not in any tracked scope.
+void flushSamples(const ScopeTrackedObject* object) {
+  const uint32_t samples = thread_state.pending_samples_.exchange(0, std::memory_order_relaxed);
+  if (samples == 0) {
+    return;
+  }
+  if (object == nullptr) {
+    unscoped_samples.fetch_add(samples, std::memory_order_relaxed);
+    return;
+  }
+  std::string key = attribution(*object);
+  Attributions& all = attributions();
+  Thread::LockGuard lock(all.mutex_);
+  auto it = all.samples_.find(key);
+  if (it != all.samples_.end()) {
+    it->second += samples;
+  } else if (all.samples_.size() < ScopeProfiler::MaxAttributions) {
+    all.samples_.emplace(std::move(key), samples);
+  } else {
+    all.other_samples_ += samples;
+  }
+}
+
+#ifndef WIN32
+void onSigprof(int) { ScopeProfiler::onSample(); }
+#endif
+
+} // namespace
+
+void ScopeProfiler::switchObject(const ScopeTrackedObject* previous,
+                                 const ScopeTrackedObject* current) {
+  // The samples taken until now belong to the previous innermost object, which the dispatcher
+  // still holds. The object of the thread state is only compared to null, as it may be stale
+  // after the profiler was stopped.
+  flushSamples(previous);
+  thread_state.object_.store(current, std::memory_order_relaxed);
+}
+
+void ScopeProfiler::onSample() {
+  if (thread_state.object_.load(std::memory_order_relaxed) != nullptr) {
+    thread_state.pending_samples_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    unscoped_samples.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+absl::Status ScopeProfiler::start(std::chrono::microseconds interval) {
+#ifdef WIN32
+  UNREFERENCED_PARAMETER(interval);
+  return absl::UnimplementedError("The scope profiler is not supported on this platform");
+#else
+  if (interval.count() <= 0) {
+    return absl::InvalidArgumentError("The sampling interval must be positive");
+  }
+  if (running()) {
+    return absl::FailedPreconditionError("The scope profiler is already running");
+  }
+  if (Cpu::profilerEnabled()) {
+    // Both profilers sample with SIGPROF.
+    return absl::FailedPreconditionError("The CPU profiler is running");
+  }
+
+  struct sigaction action {};
+  action.sa_handler = &onSigprof;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, nullptr) != 0) {
+    return absl::InternalError(absl::StrCat("sigaction failed: ", errorDetails(errno)));
+  }
+  running_.store(true, std::memory_order_relaxed);
+
+  struct itimerval timer {};
+  timer.it_interval.tv_sec = interval.count() / 1000000;
+  timer.it_interval.tv_usec = interval.count() % 1000000;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    const int error = errno;
+    stop();
+    return absl::InternalError(absl::StrCat("setitimer failed: ", errorDetails(error)));
+  }
+  return absl::OkStatus();
+#endif
+}
+
+void ScopeProfiler::stop() {
+#ifndef WIN32
+  struct itimerval timer {};
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  // A signal still in flight must not take the default action, which terminates the process.
+  signal(SIGPROF, SIG_IGN);
+#endif
+  running_.store(false, std::memory_order_relaxed);
+}
+
+std::string ScopeProfiler::report() {
+  std::vector<std::pair<std::string, uint64_t>> samples;
+  uint64_t other_samples;
+  {
+    Attributions& all = attributions();
+    Thread::LockGuard lock(all.mutex_);
+    samples.assign(all.samples_.begin(), all.samples_.end());
+    other_samples = all.other_samples_;
+  }
+  std::sort(samples.begin(), samples.end());
+
+  std::string out;
+  for (const auto& [key, count] : samples) {
+    absl::StrAppend(&out, key, " ", count, "\n");
+  }
+  if (other_samples > 0) {
+    absl::StrAppend(&out, "other ", other_samples, "\n");
+  }
+  const uint64_t unscoped = unscoped_samples.load(std::memory_order_relaxed);
+  if (unscoped > 0) {
+    absl::StrAppend(&out, "unscoped ", unscoped, "\n");
+  }
+  return out;
+}
+
+void ScopeProfiler::reset() {
+  Attributions& all = attributions();
+  Thread::LockGuard lock(all.mutex_);
+  all.samples_.clear();
+  all.other_samples_ = 0;
+  unscoped_samples.store(0, std::memory_order_relaxed);
+}
+
+} // namespace Profiler
+} // namespace Envoy
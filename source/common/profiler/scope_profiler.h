@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "envoy/common/scope_tracker.h"
+
+#include "absl/status/status.h"
+
+namespace Envoy {
+namespace Profiler {
+
+/**
+ * Process wide sampling CPU profiler attributing the samples to the listener, filter chain, route
+ * and upstream cluster of the connection or stream being worked on, as tracked on the tracked
+ * object stack of the dispatcher. Unlike the gperftools CPU profiler it collects no stacks and
+ * writes no file, so it can be left running in production to find the configuration burning CPU.
+ *
+ * Samples are taken with SIGPROF, every interval of CPU time consumed by the process. The signal
+ * handler only counts the sample for the thread it interrupted; the count is attributed to the
+ * innermost tracked object of the thread, outside of the signal handler, when the thread leaves
+ * the scope of the object or enters a nested one.
+ */
+class ScopeProfiler {
+public:
+  // Bound on the number of distinct attributions; the samples beyond it are reported as "other".
+  static constexpr size_t MaxAttributions = 10000;
+
+  /**
+   * Called by the dispatcher when the innermost tracked object of the calling thread changes. Only
+   * does work while the profiler is running.
+   * @param previous the innermost tracked object until now, or null outside of any tracked scope.
+   * @param current the innermost tracked object from now on, or null.
+   */
+  static void onTrackedObjectChange(const ScopeTrackedObject* previous,
+                                    const ScopeTrackedObject* current) {
+    if (running()) {
+      switchObject(previous, current);
+    }
+  }
+
+  /**
+   * Starts sampling.
+   * @param interval the CPU time between samples.
+   * @return an error if the profiler or the gperftools CPU profiler is already running, or if
+   *         sampling is not supported on the platform.
+   */
+  static absl::Status start(std::chrono::microseconds interval);
+
+  /**
+   * Stops sampling. The samples taken so far are kept until reset().
+   */
+  static void stop();
+
+  static bool running() { return running_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the samples attributed so far, one line per attribution, in the folded format read by
+   *         flame graph tools, e.g. "listener=l;filter_chain=f;route=r;cluster=c 42". Samples taken
+   *         outside of any tracked scope are reported as "unscoped".
+   */
+  static std::string report();
+
+  /**
+   * Drops the samples taken so far.
+   */
+  static void reset();
+
+  /**
+   * Counts a sample for the calling thread. Async-signal-safe, called from the SIGPROF handler.
+   */
+  static void onSample();
+
+private:
+  static void switchObject(const ScopeTrackedObject* previous, const ScopeTrackedObject* current);
+
+  static std::atomic<bool> running_;
+};
+
+} // namespace Profiler
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "source/common/quic/active_quic_listener.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -28,9 +29,45 @@
 #include "source/common/quic/quic_packet_writer_interface.h"
 #include "source/common/runtime/runtime_features.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Quic {
 
+namespace {
+
+// Returns the destination connection ID of a QUIC packet, or an empty view if it can't be told
+// from the packet. The connection ID of a short header packet is assumed to have the length of
+// the connection IDs issued by this listener.
+absl::string_view destinationConnectionId(const Buffer::Instance& buffer) {
+  const Buffer::RawSlice slice = buffer.frontSlice();
+  const char* data = static_cast<const char*>(slice.mem_);
+  if (slice.len_ == 0) {
+    return {};
+  }
+  if ((data[0] & 0x80) == 0) {
+    // Short header: the connection ID follows the first byte.
+    if (slice.len_ <= quic::kQuicDefaultConnectionIdLength) {
+      return {};
+    }
+    return {data + 1, quic::kQuicDefaultConnectionIdLength};
+  }
+  // Long header: the first byte, the 4-byte version and the length of the connection ID precede
+  // the connection ID.
+  constexpr size_t connection_id_offset = 6;
+  if (slice.len_ < connection_id_offset) {
+    return {};
+  }
+  const size_t length = static_cast<uint8_t>(data[connection_id_offset - 1]);
+  if (length == 0 || slice.len_ < connection_id_offset + length) {
+    return {};
+  }
+  return {data + connection_id_offset, length};
+}
+
+} // namespace
+
 bool ActiveQuicListenerFactory::disable_kernel_bpf_packet_routing_for_test_ = false;
 
 ActiveQuicListener::ActiveQuicListener(
@@ -58,7 +95,10 @@ ActiveQuicListener::ActiveQuicListener(
       packets_to_read_to_connection_count_ratio_(packets_to_read_to_connection_count_ratio),
       crypto_server_stream_factory_(crypto_server_stream_factory),
       connection_id_generator_(std::move(cid_generator)),
-      select_connection_id_worker_(std::move(worker_selector)) {
+      select_connection_id_worker_(std::move(worker_selector)),
+      quic_listener_stats_({ALL_QUIC_LISTENER_STATS(
+          POOL_COUNTER_PREFIX(listener_config.listenerScope(), "quic"),
+          POOL_HISTOGRAM_PREFIX(listener_config.listenerScope(), "quic"))}) {
   ASSERT(!GetQuicFlag(quic_header_size_limit_includes_overhead));
   ASSERT(select_connection_id_worker_ != nullptr);
 
@@ -174,6 +214,21 @@ void ActiveQuicListener::onDataWorker(Network::UdpRecvData&& data) {
     return;
   }
 
+  if (batching_packets_) {
+    packet_batch_.push_back(std::move(data));
+    return;
+  }
+
+  // A packet redirected from another worker is processed on its own.
+  processPacket(data);
+  if (quic_dispatcher_->HasChlosBuffered()) {
+    // If there are any buffered CHLOs, activate a read event for the next event loop to process
+    // them.
+    udp_listener_->activateRead();
+  }
+}
+
+void ActiveQuicListener::processPacket(Network::UdpRecvData& data) {
   quic::QuicSocketAddress peer_address(
       envoyIpAddressToQuicSocketAddress(data.addresses_.peer_->ip()));
   quic::QuicSocketAddress self_address(
@@ -197,15 +252,50 @@ void ActiveQuicListener::onDataWorker(Network::UdpRecvData&& data) {
       non_dispatched_udp_packet_handler_->handle(worker_index_, std::move(data));
     }
   }
+}
 
-  if (quic_dispatcher_->HasChlosBuffered()) {
-    // If there are any buffered CHLOs, activate a read event for the next event loop to process
-    // them.
-    udp_listener_->activateRead();
+void ActiveQuicListener::processPacketBatch() {
+  quic_listener_stats_.downstream_rx_packets_per_read_.recordValue(packet_batch_.size());
+
+  // Order the packets by the first appearance of their destination connection ID in the batch,
+  // keeping the packets of each connection in the order they were received. The packets of a
+  // connection are then processed back to back, and the writes they cause are grouped together
+  // when the connections flush their deferred sends at the end of the event loop.
+  absl::flat_hash_map<absl::string_view, uint32_t> groups;
+  std::vector<std::pair<uint32_t, uint32_t>> order;
+  order.reserve(packet_batch_.size());
+  uint32_t next_group = 0;
+  for (uint32_t i = 0; i < packet_batch_.size(); ++i) {
+    const absl::string_view connection_id = destinationConnectionId(*packet_batch_[i].buffer_);
+    // A packet without a connection ID is a batch of its own.
+    uint32_t group = next_group;
+    if (!connection_id.empty()) {
+      group = groups.try_emplace(connection_id, next_group).first->second;
+    }
+    if (group == next_group) {
+      ++next_group;
+    }
+    order.emplace_back(group, i);
   }
+  std::sort(order.begin(), order.end());
+
+  for (size_t begin = 0; begin < order.size();) {
+    size_t end = begin + 1;
+    while (end < order.size() && order[end].first == order[begin].first) {
+      ++end;
+    }
+    for (size_t i = begin; i < end; ++i) {
+      processPacket(packet_batch_[order[i].second]);
+    }
+    quic_listener_stats_.downstream_rx_packets_per_connection_batch_.recordValue(end - begin);
+    begin = end;
+  }
+  packet_batch_.clear();
 }
 
 void ActiveQuicListener::onReadReady() {
+  // Every read event is completed before the next one starts.
+  ASSERT(!batching_packets_);
   if (enabled_.has_value() && !enabled_.value().enabled()) {
     ENVOY_LOG(trace, "Quic listener {}: runtime disabled", config_->name());
     return;
@@ -234,6 +324,25 @@ void ActiveQuicListener::onReadReady() {
   if (quic_dispatcher_->HasChlosBuffered()) {
     udp_listener_->activateRead();
   }
+
+  batching_packets_ = true;
+}
+
+void ActiveQuicListener::onReadComplete() {
+  if (!batching_packets_) {
+    return;
+  }
+  batching_packets_ = false;
+  if (packet_batch_.empty()) {
+    return;
+  }
+
+  processPacketBatch();
+  if (quic_dispatcher_->HasChlosBuffered()) {
+    // If there are any buffered CHLOs, activate a read event for the next event loop to process
+    // them.
+    udp_listener_->activateRead();
+  }
 }
 
 void ActiveQuicListener::onWriteReady(const Network::Socket& /*socket*/) {
@@ -256,6 +365,7 @@ uint32_t ActiveQuicListener::destination(const Network::UdpRecvData& data) const
   if (kernel_worker_routing_) {
     uint32_t expected_worker_index = select_connection_id_worker_(*data.buffer_, worker_index_);
     if (expected_worker_index != worker_index_) {
+      quic_listener_stats_.downstream_rx_packets_misrouted_.inc();
       ENVOY_LOG_EVERY_POW_2(error, "Mismatched worker index. expected {}, actual {}",
                             expected_worker_index, worker_index_);
     }
@@ -267,7 +377,11 @@ uint32_t ActiveQuicListener::destination(const Network::UdpRecvData& data) const
 
   // Taking this path is not as performant as it could be. It means most packets are being
   // delivered by the kernel to the wrong worker, and then redirected to the correct worker.
-  return select_connection_id_worker_(*data.buffer_, worker_index_);
+  const uint32_t worker_index = select_connection_id_worker_(*data.buffer_, worker_index_);
+  if (worker_index != worker_index_) {
+    quic_listener_stats_.downstream_rx_packets_forwarded_.inc();
+  }
+  return worker_index;
 }
 
 size_t ActiveQuicListener::numPacketsExpectedPerEventLoop() const {
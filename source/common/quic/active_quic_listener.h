@@ -1,11 +1,14 @@
 #pragma once
 
+#include <vector>
+
 #include "envoy/config/listener/v3/quic_config.pb.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/network/listener.h"
 #include "envoy/network/socket.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/server/process_context.h"
+#include "envoy/stats/stats_macros.h"
 
 #include "source/common/protobuf/utility.h"
 #include "source/common/quic/envoy_quic_connection_debug_visitor_factory_interface.h"
@@ -22,6 +25,19 @@
 namespace Envoy {
 namespace Quic {
 
+#define ALL_QUIC_LISTENER_STATS(COUNTER, HISTOGRAM)                                               \
+  COUNTER(downstream_rx_packets_forwarded)                                                         \
+  COUNTER(downstream_rx_packets_misrouted)                                                         \
+  HISTOGRAM(downstream_rx_packets_per_read, Unspecified)                                           \
+  HISTOGRAM(downstream_rx_packets_per_connection_batch, Unspecified)
+
+/**
+ * Wrapper struct for QUIC listener stats. @see stats_macros.h
+ */
+struct QuicListenerStats {
+  ALL_QUIC_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
 // QUIC specific UdpListenerCallbacks implementation which delegates incoming
 // packets, write signals and listener errors to QuicDispatcher.
 class ActiveQuicListener : public Envoy::Server::ActiveUdpListenerBase,
@@ -54,6 +70,7 @@ public:
 
   // Network::UdpListenerCallbacks
   void onReadReady() override;
+  void onReadComplete() override;
   void onWriteReady(const Network::Socket& socket) override;
   void onReceiveError(Api::IoError::IoErrorCode /*error_code*/) override {
     // No-op. Quic can't do anything upon listener error.
@@ -87,6 +104,8 @@ private:
   friend class ActiveQuicListenerPeer;
 
   void closeConnectionsWithFilterChain(const Network::FilterChain* filter_chain);
+  void processPacket(Network::UdpRecvData& data);
+  void processPacketBatch();
 
   uint8_t random_seed_[16];
   std::unique_ptr<quic::QuicCryptoServerConfig> crypto_config_;
@@ -114,6 +133,11 @@ private:
   // This is an equivalent of max_connections_to_accept_per_socket_event for TCP
   // listeners.
   uint32_t max_sessions_per_event_loop_;
+  QuicListenerStats quic_listener_stats_;
+  // Whether the packets passed to onDataWorker() are read from the socket in the current read
+  // event, and are kept in packet_batch_ until onReadComplete().
+  bool batching_packets_{false};
+  std::vector<Network::UdpRecvData> packet_batch_;
 };
 
 using ActiveQuicListenerPtr = std::unique_ptr<ActiveQuicListener>;
@@ -124,8 +124,12 @@ quic::QuicSpdyStream* EnvoyQuicServerSession::CreateIncomingStream(quic::QuicStr
                   this->id(), id));
     return nullptr;
   }
+  priority_updated_on_creation_.reset();
   auto stream = new EnvoyQuicServerStream(id, this, quic::BIDIRECTIONAL, codec_stats_.value(),
                                           http3_options_.value(), headers_with_underscores_action_);
+  if (priority_updated_on_creation_ == id) {
+    stream->onPriorityUpdate();
+  }
   ActivateStream(absl::WrapUnique(stream));
   if (aboveHighWatermark()) {
     stream->runHighWatermarkCallbacks();
@@ -354,6 +358,18 @@ void EnvoyQuicServerSession::OnStreamClosed(quic::QuicStreamId id) {
   }
 }
 
+void EnvoyQuicServerSession::UpdateStreamPriority(quic::QuicStreamId id,
+                                                  const quic::QuicStreamPriority& new_priority) {
+  QuicServerSessionBase::UpdateStreamPriority(id, new_priority);
+  auto* stream = dynamic_cast<EnvoyQuicServerStream*>(GetActiveStream(id));
+  if (stream == nullptr) {
+    // The stream is being created, and QUICHE applies a PRIORITY_UPDATE frame buffered for it.
+    priority_updated_on_creation_ = id;
+    return;
+  }
+  stream->onPriorityUpdate();
+}
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 void EnvoyQuicServerSession::TerminateIdleSession() {
   ENVOY_BUG(!on_connection_closed_called_,
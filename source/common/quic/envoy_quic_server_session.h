@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <ostream>
 
 #include "source/common/http/session_idle_list_interface.h"
@@ -125,6 +126,12 @@ public:
   // closed.
   void OnStreamClosed(quic::QuicStreamId id) override;
 
+  // quic::StreamDelegateInterface
+  // Overridden to tell the stream that its priority was set, which can only be done by a
+  // PRIORITY_UPDATE frame before the request headers are received.
+  void UpdateStreamPriority(quic::QuicStreamId id,
+                            const quic::QuicStreamPriority& new_priority) override;
+
   // IdleSessionInterface
   // NOLINTNEXTLINE(readability-identifier-naming)
   void TerminateIdleSession() override;
@@ -190,6 +197,9 @@ private:
   bool h3_go_away_sent_ = false;
   bool on_connection_closed_called_ = false;
   bool is_in_idle_list_ = false;
+  // The stream whose priority was set by a buffered PRIORITY_UPDATE frame while it was being
+  // created in CreateIncomingStream().
+  std::optional<quic::QuicStreamId> priority_updated_on_creation_;
 };
 
 } // namespace Quic
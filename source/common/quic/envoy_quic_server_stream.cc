@@ -19,6 +19,7 @@
 #include "quiche/common/http/http_header_block.h"
 #include "quiche/quic/core/http/quic_header_list.h"
 #include "quiche/quic/core/quic_session.h"
+#include "quiche/quic/core/quic_stream_priority.h"
 #include "quiche/quic/core/quic_types.h"
 #include "quiche_platform_impl/quiche_mem_slice_impl.h"
 
@@ -243,6 +244,10 @@ void EnvoyQuicServerStream::OnInitialHeadersComplete(bool fin, size_t frame_len,
   }
 #endif
 
+  if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.quic_apply_priority_header")) {
+    applyPriorityHeader(*headers);
+  }
+
   Http::RequestDecoder* decoder = requestDecoderOrNull();
   if (end_stream && Runtime::runtimeFeatureEnabled(
                         "envoy.reloadable_features.quic_validate_headers_only_content_length")) {
@@ -257,6 +262,29 @@ void EnvoyQuicServerStream::OnInitialHeadersComplete(bool fin, size_t frame_len,
   ConsumeHeaderList();
 }
 
+void EnvoyQuicServerStream::applyPriorityHeader(const Http::RequestHeaderMap& headers) {
+  // A PRIORITY_UPDATE frame received before the request headers takes precedence over the header,
+  // even if it sets the default priority.
+  if (priority_update_received_) {
+    return;
+  }
+  static const Http::LowerCaseString priority_header("priority");
+  const Http::HeaderUtility::GetAllOfHeaderAsStringResult value =
+      Http::HeaderUtility::getAllOfHeaderAsString(headers, priority_header);
+  if (!value.result().has_value()) {
+    return;
+  }
+  // Invalid or unknown parameters are ignored, as RFC 9218 requires.
+  std::optional<quic::HttpStreamPriority> parsed =
+      quic::ParsePriorityFieldValue(value.result().value());
+  if (!parsed.has_value()) {
+    return;
+  }
+  ENVOY_STREAM_LOG(debug, "Setting priority urgency {} incremental {}.", *this, parsed->urgency,
+                   parsed->incremental);
+  SetPriority(quic::QuicStreamPriority(*parsed));
+}
+
 void EnvoyQuicServerStream::OnStreamFrame(const quic::QuicStreamFrame& frame) {
   uint64_t highest_byte_received = frame.data_length + frame.offset;
   if (highest_byte_received > bytesMeter()->wireBytesReceived()) {
@@ -62,6 +62,10 @@ public:
         request_header_map, response_header_map, response_trailer_map, std::move(new_stream_info));
   };
 
+  // Called by the session when the priority of the stream is set, so that the priority header of
+  // the request doesn't override a PRIORITY_UPDATE frame received before it.
+  void onPriorityUpdate() { priority_update_received_ = true; }
+
   // Http::Stream
   void resetStream(Http::StreamResetReason reason) override;
   std::optional<uint32_t> codecStreamId() const override { return id(); }
@@ -134,6 +138,10 @@ private:
   // Deliver awaiting trailers if body has been delivered.
   void maybeDecodeTrailers();
 
+  // Sets the priority of the stream from the RFC 9218 `priority` request header, which the write
+  // scheduler of the session uses to order the streams with data to send.
+  void applyPriorityHeader(const Http::RequestHeaderMap& headers);
+
 #ifdef ENVOY_ENABLE_HTTP_DATAGRAMS
   // Makes the QUIC stream use Capsule Protocol. Once this method is called, any calls to encodeData
   // are expected to contain capsules which will be sent along as HTTP Datagrams. Also, the stream
@@ -165,6 +173,8 @@ private:
 
   // True if a :path header has been seen before.
   bool saw_path_{false};
+  // True if a PRIORITY_UPDATE frame set the priority of the stream before its request headers.
+  bool priority_update_received_{false};
 };
 
 } // namespace Quic
@@ -56,7 +56,7 @@ public:
     }
   }
 
-  ~EnvoyQuicStream() override = default;
+  ~EnvoyQuicStream() override { chargeAccount(0); }
 
   // Http::StreamEncoder
   Stream& getStream() override { return *this; }
@@ -105,7 +105,10 @@ public:
   Buffer::BufferMemoryAccountSharedPtr account() const override { return buffer_memory_account_; }
 
   void setAccount(Buffer::BufferMemoryAccountSharedPtr account) override {
+    // Move the bytes already buffered over to the new account.
+    chargeAccount(0);
     buffer_memory_account_ = account;
+    chargeAccount(reported_buffered_bytes_);
   }
 
   // SendBufferMonitor
@@ -133,6 +136,7 @@ public:
     // reduction of the value in the nesting call to be reported.
     reported_buffered_bytes_ += (new_buffered_bytes - old_buffered_bytes);
     filter_manager_connection_.updateBytesBuffered(old_buffered_bytes, new_buffered_bytes);
+    chargeAccount(reported_buffered_bytes_);
   }
 
   Http::HeaderUtility::HeaderValidationResult
@@ -276,8 +280,8 @@ protected:
   const envoy::config::core::v3::Http3ProtocolOptions& http3_options_;
   bool close_connection_upon_invalid_header_{false};
   absl::string_view details_;
-  // TODO(kbaichoo): bind the account to the QUIC buffers to enable tracking of
-  // memory allocated within QUIC buffers.
+  // Charged with the bytes buffered in the QUICHE send buffer of the stream, so that the overload
+  // manager can reset the HTTP/3 streams which hold the most memory.
   Buffer::BufferMemoryAccountSharedPtr buffer_memory_account_ = nullptr;
   bool got_304_response_{false};
   bool sent_head_request_{false};
@@ -285,6 +289,20 @@ protected:
   bool saw_regular_headers_{false};
 
 private:
+  // Brings the balance charged to buffer_memory_account_ by this stream to buffered_bytes.
+  void chargeAccount(uint64_t buffered_bytes) {
+    if (buffer_memory_account_ == nullptr) {
+      account_charged_bytes_ = 0;
+      return;
+    }
+    if (buffered_bytes > account_charged_bytes_) {
+      buffer_memory_account_->charge(buffered_bytes - account_charged_bytes_);
+    } else if (buffered_bytes < account_charged_bytes_) {
+      buffer_memory_account_->credit(account_charged_bytes_ - buffered_bytes);
+    }
+    account_charged_bytes_ = buffered_bytes;
+  }
+
   // QUIC stream and session that this EnvoyQuicStream wraps.
   quic::QuicSpdyStream& quic_stream_;
   quic::QuicSession& quic_session_;
@@ -312,6 +330,8 @@ private:
   // Track the buffered bytes reported to connection in the
   // most recent call of updateBytesBuffered().
   uint64_t reported_buffered_bytes_{0u};
+  // The bytes currently charged to buffer_memory_account_.
+  uint64_t account_charged_bytes_{0u};
 };
 
 // Object used for updating a BytesMeter to track bytes sent on a QuicStream since this object was
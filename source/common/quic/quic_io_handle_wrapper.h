@@ -59,6 +59,21 @@ public:
     }
     return io_handle_.sendmsg(slices, num_slice, flags, self_ip, peer_address);
   }
+  Api::IoCallUint64Result sendmmsg(absl::Span<const Buffer::RawSlice> datagrams,
+                                   const Network::Address::Instance& peer_address) override {
+    if (closed_) {
+      return {0, Network::IoSocketError::getIoSocketEbadfError()};
+    }
+    return io_handle_.sendmmsg(datagrams, peer_address);
+  }
+  Api::IoCallUint64Result sendWithControlMessage(const Buffer::RawSlice* slices,
+                                                 uint64_t num_slice, int level, int type,
+                                                 absl::Span<const uint8_t> control_data) override {
+    if (closed_) {
+      return {0, Network::IoSocketError::getIoSocketEbadfError()};
+    }
+    return io_handle_.sendWithControlMessage(slices, num_slice, level, type, control_data);
+  }
   Api::IoCallUint64Result recvmsg(Buffer::RawSlice* slices, const uint64_t num_slice,
                                   uint32_t self_port, const UdpSaveCmsgConfig& udp_save_cmsg_config,
                                   RecvMsgOutput& output) override {
@@ -9,6 +9,7 @@
 #include "source/common/common/hash.h"
 #include "source/common/common/lock_guard.h"
 #include "source/common/common/logger.h"
+#include "source/common/common/sharded_counter.h"
 #include "source/common/common/thread.h"
 #include "source/common/common/thread_annotations.h"
 #include "source/common/common/utility.h"
@@ -164,6 +165,84 @@ private:
   std::atomic<uint64_t> pending_increment_{0};
 };
 
+// A counter whose increments go to per-thread, cache-line aligned slots, so that workers
+// incrementing it concurrently don't contend on a single cache line. The slots hold the total
+// since creation, and reads sum them. reset(), latch() and markUnused() record that total as a
+// base rather than clearing the slots, which may be concurrently written. Unlike CounterImpl, a
+// reset also drops the pending latch.
+class ShardedCounterImpl : public StatsSharedImpl<Counter> {
+public:
+  // Enough slots to spread a few dozen workers; each one is a cache line.
+  static constexpr uint32_t NumShards = 16;
+
+  ShardedCounterImpl(StatName name, Allocator& alloc, StatName tag_extracted_name,
+                     StatNameTagSpan stat_name_tags)
+      : StatsSharedImpl(name, alloc, tag_extracted_name, stat_name_tags), total_(NumShards) {}
+
+  void removeFromSetLockHeld() ABSL_EXCLUSIVE_LOCKS_REQUIRED(alloc_.mutex_) override {
+    const size_t count = alloc_.counters_.erase(statName());
+    ASSERT(count == 1);
+    alloc_.sinked_counters_.erase(this);
+  }
+
+  // Stats::Metric
+  bool used() const override {
+    if (StatsSharedImpl::used()) {
+      return true;
+    }
+    const uint64_t base = unused_base_.load();
+    return total_.value() != base;
+  }
+  void markUnused() override {
+    unused_base_ = total_.value();
+    StatsSharedImpl::markUnused();
+  }
+
+  // Stats::Counter
+  void add(uint64_t amount) override {
+    if (amount == 0) {
+      // Leaves the total unchanged, so used() can't see it.
+      flags_ |= Flags::Used;
+      return;
+    }
+    total_.add(amount);
+  }
+  void inc() override { total_.inc(); }
+  uint64_t latch() override {
+    // The bases are loaded before the total, which only grows, so the differences can't be
+    // negative.
+    uint64_t base = latch_base_.load();
+    const uint64_t total = total_.value();
+    advanceLatchBase(base, total);
+    return total > base ? total - base : 0;
+  }
+  void reset() override {
+    // The increments made before the reset are not latched afterwards either, so that the latched
+    // deltas add up to the value.
+    uint64_t base = latch_base_.load();
+    const uint64_t total = total_.value();
+    reset_base_ = total;
+    advanceLatchBase(base, total);
+  }
+  uint64_t value() const override {
+    const uint64_t base = reset_base_.load();
+    return total_.value() - base;
+  }
+
+private:
+  // Moves the latch base forward to total, unless a concurrent latch or reset already moved it
+  // further. On return, base holds the latch base found before the move.
+  void advanceLatchBase(uint64_t& base, uint64_t total) {
+    while (total > base && !latch_base_.compare_exchange_weak(base, total)) {
+    }
+  }
+
+  ShardedCounter total_;
+  std::atomic<uint64_t> latch_base_{0};
+  std::atomic<uint64_t> reset_base_{0};
+  std::atomic<uint64_t> unused_base_{0};
+};
+
 class GaugeImpl : public StatsSharedImpl<Gauge> {
 public:
   GaugeImpl(StatName name, Allocator& alloc, StatName tag_extracted_name,
@@ -296,6 +375,20 @@ private:
 
 CounterSharedPtr Allocator::makeCounter(StatName name, StatName tag_extracted_name,
                                         StatNameTagSpan stat_name_tags) {
+  // The sharded counter matcher may evaluate regexes, so it runs without the lock, and only for
+  // the counters not created yet.
+  bool sharded = false;
+  if (sharded_counter_matcher_ != nullptr) {
+    {
+      Thread::LockGuard lock(mutex_);
+      auto iter = counters_.find(name);
+      if (iter != counters_.end()) {
+        return {*iter};
+      }
+    }
+    sharded = !sharded_counter_matcher_->rejects(name);
+  }
+
   Thread::LockGuard lock(mutex_);
   ASSERT(!gauges_.contains(name));
   ASSERT(!text_readouts_.contains(name));
@@ -303,7 +396,8 @@ CounterSharedPtr Allocator::makeCounter(StatName name, StatName tag_extracted_na
   if (iter != counters_.end()) {
     return {*iter};
   }
-  auto counter = CounterSharedPtr(makeCounterInternal(name, tag_extracted_name, stat_name_tags));
+  auto counter =
+      CounterSharedPtr(makeCounterInternal(name, tag_extracted_name, stat_name_tags, sharded));
   counters_.insert(counter.get());
   // Add counter to sinked_counters_ if it matches the sink predicate.
   if (sink_predicates_ != nullptr && sink_predicates_->includeCounter(*counter)) {
@@ -362,10 +456,17 @@ bool Allocator::isMutexLockedForTest() {
 }
 
 Counter* Allocator::makeCounterInternal(StatName name, StatName tag_extracted_name,
-                                        StatNameTagSpan stat_name_tags) {
+                                        StatNameTagSpan stat_name_tags, bool sharded) {
+  if (sharded) {
+    return new ShardedCounterImpl(name, *this, tag_extracted_name, stat_name_tags);
+  }
   return new CounterImpl(name, *this, tag_extracted_name, stat_name_tags);
 }
 
+void Allocator::setShardedCounterMatcher(StatsMatcherPtr&& matcher) {
+  sharded_counter_matcher_ = std::move(matcher);
+}
+
 void Allocator::forEachCounter(SizeFn f_size, StatFn<Counter> f_stat) const {
   Thread::LockGuard lock(mutex_);
   if (f_size != nullptr) {
@@ -4,6 +4,7 @@
 
 #include "envoy/stats/sink.h"
 #include "envoy/stats/stats.h"
+#include "envoy/stats/stats_matcher.h"
 
 #include "source/common/common/thread.h"
 #include "source/common/common/thread_synchronizer.h"
@@ -80,6 +81,14 @@ public:
    * Set the predicates to filter stats for sink.
    */
   void setSinkPredicates(std::unique_ptr<SinkPredicates>&& sink_predicates);
+
+  /**
+   * Selects the counters that are created sharded: their increments go to per-thread slots that
+   * are only summed on read. Only applies to counters created afterwards. Must be called during
+   * single-threaded startup.
+   * @param matcher accepts the names of the counters to shard.
+   */
+  void setShardedCounterMatcher(StatsMatcherPtr&& matcher);
 #ifndef ENVOY_CONFIG_COVERAGE
   void debugPrint();
 #endif
@@ -107,11 +116,12 @@ public:
 
 protected:
   virtual Counter* makeCounterInternal(StatName name, StatName tag_extracted_name,
-                                       StatNameTagSpan stat_name_tags);
+                                       StatNameTagSpan stat_name_tags, bool sharded);
 
 private:
   template <class BaseClass> friend class StatsSharedImpl;
   friend class CounterImpl;
+  friend class ShardedCounterImpl;
   friend class GaugeImpl;
   friend class TextReadoutImpl;
 
@@ -133,6 +143,7 @@ private:
 
   // Predicates used to filter stats to be flushed.
   std::unique_ptr<SinkPredicates> sink_predicates_;
+  StatsMatcherPtr sharded_counter_matcher_;
   SymbolTable& symbol_table_;
 
   Thread::ThreadSynchronizer sync_;
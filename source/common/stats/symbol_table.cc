@@ -10,6 +10,8 @@
 #include "source/common/common/logger.h"
 #include "source/common/common/utility.h"
 
+#include "absl/hash/hash.h"
+#include "absl/numeric/bits.h"
 #include "absl/strings/str_cat.h"
 
 namespace Envoy {
@@ -228,11 +230,8 @@ bool StatName::startsWith(StatName prefix) const {
 
 std::vector<absl::string_view> SymbolTable::decodeStrings(StatName stat_name) const {
   std::vector<absl::string_view> strings;
-  Thread::LockGuard lock(lock_);
   Encoding::decodeTokens(
-      stat_name,
-      [this, &strings](Symbol symbol)
-          ABSL_NO_THREAD_SAFETY_ANALYSIS { strings.push_back(fromSymbol(symbol)); },
+      stat_name, [this, &strings](Symbol symbol) { strings.push_back(fromSymbol(symbol)); },
       [&strings](absl::string_view str) { strings.push_back(str); });
   return strings;
 }
@@ -249,8 +248,8 @@ void SymbolTable::Encoding::appendToMemBlock(StatName stat_name,
 }
 
 SymbolTable::SymbolTable()
-    // Have to be explicitly initialized, if we want to use the ABSL_GUARDED_BY macro.
-    : next_symbol_(FirstValidSymbol), monotonic_counter_(FirstValidSymbol) {}
+    // Has to be explicitly initialized, if we want to use the ABSL_GUARDED_BY macro.
+    : monotonic_counter_(FirstValidSymbol) {}
 
 SymbolTable::~SymbolTable() {
   // To avoid leaks into the symbol table, we expect all StatNames to be freed.
@@ -258,6 +257,16 @@ SymbolTable::~SymbolTable() {
   // is needed in production. But it would be good to ensure clean up during
   // tests.
   ASSERT(numSymbols() == 0);
+  for (uint32_t i = 0; i < NumSegments; ++i) {
+    SymbolSlot* segment = segments_[i].load(std::memory_order_relaxed);
+    if (segment == nullptr) {
+      continue;
+    }
+    for (uint64_t j = 0; j < (FirstSegmentSize << i); ++j) {
+      InlineStringPtr str(segment[j].string_.load(std::memory_order_relaxed));
+    }
+    delete[] segment;
+  }
 }
 
 // TODO(ambuc): There is a possible performance optimization here for avoiding
@@ -274,18 +283,19 @@ void SymbolTable::addTokensToEncoding(const absl::string_view name, Encoding& en
   std::vector<Symbol> symbols;
   symbols.reserve(tokens.size());
 
-  // Now take the lock and populate the Symbol objects, which involves bumping
-  // ref-counts in this.
-  {
-    Thread::LockGuard lock(lock_);
+  if (recent_lookups_enabled_.load(std::memory_order_relaxed)) {
+    Thread::LockGuard lock(recent_lookups_lock_);
     recent_lookups_.lookup(name);
-    for (auto& token : tokens) {
-      // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
-      // length below some threshold, say 4 bytes. It might be preferable not to
-      // reserve Symbols for every 3 digit number found (for example) in ipv4
-      // addresses.
-      symbols.push_back(toSymbol(token));
-    }
+  }
+
+  // Now populate the Symbol objects, which involves bumping ref-counts in
+  // this. Each token only takes the lock of its own encode shard.
+  for (auto& token : tokens) {
+    // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
+    // length below some threshold, say 4 bytes. It might be preferable not to
+    // reserve Symbols for every 3 digit number found (for example) in ipv4
+    // addresses.
+    symbols.push_back(toSymbol(token));
   }
 
   // Now efficiently encode the array of 32-bit symbols into a uint8_t array.
@@ -293,9 +303,12 @@ void SymbolTable::addTokensToEncoding(const absl::string_view name, Encoding& en
 }
 
 uint64_t SymbolTable::numSymbols() const {
-  Thread::LockGuard lock(lock_);
-  ASSERT(encode_map_.size() == decode_map_.size());
-  return encode_map_.size();
+  uint64_t num_symbols = 0;
+  for (const EncodeShard& shard : encode_shards_) {
+    Thread::LockGuard lock(shard.lock_);
+    num_symbols += shard.map_.size();
+  }
+  return num_symbols;
 }
 
 std::string SymbolTable::toString(const StatName& stat_name) const {
@@ -317,7 +330,6 @@ size_t SymbolTable::serializeToBuffer(const StatName& stat_name, char* buffer,
     bytes_required += token.size();
   };
 
-  Thread::LockGuard lock(lock_);
   Encoding::TokenIter iter(stat_name);
   bool first = true;
   for (Encoding::TokenIter::TokenType type = iter.next();
@@ -326,7 +338,6 @@ size_t SymbolTable::serializeToBuffer(const StatName& stat_name, char* buffer,
       append(".");
     }
     first = false;
-    // fromSymbol() requires lock_, which is held for the duration of this call.
     append(type == Encoding::TokenIter::TokenType::Symbol ? fromSymbol(iter.symbol())
                                                           : iter.stringView());
   }
@@ -334,50 +345,54 @@ size_t SymbolTable::serializeToBuffer(const StatName& stat_name, char* buffer,
 }
 
 void SymbolTable::incRefCount(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
+  // The caller holds a reference to every symbol of stat_name, so none of the
+  // counts can concurrently drop to zero and no lock is needed.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name);
-
-  Thread::LockGuard lock(lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-
-    ASSERT(decode_search != decode_map_.end(),
-           "Please see "
-           "https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md#"
-           "debugging-symbol-table-assertions");
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end(),
+    SymbolSlot& symbol_slot = slot(symbol);
+    ASSERT(symbol_slot.string_.load(std::memory_order_relaxed) != nullptr,
            "Please see "
            "https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md#"
            "debugging-symbol-table-assertions");
-
-    ++encode_search->second.ref_count_;
+    symbol_slot.ref_count_.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
 void SymbolTable::free(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name);
-
-  Thread::LockGuard lock(lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
-
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
-
-    // If that was the last remaining client usage of the symbol, erase the
-    // current mappings and add the now-unused symbol to the reuse pool.
-    //
-    // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
-    // symbol_table_speed_test.cc, relative to breaking out the decrement into a
-    // separate step, likely due to the non-trivial dereferences in EXPR.
-    if (--encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
-      encode_map_.erase(encode_search);
-      pool_.push(symbol);
+    SymbolSlot& symbol_slot = slot(symbol);
+
+    // Dropping a reference that is not the last one takes no lock.
+    uint32_t ref_count = symbol_slot.ref_count_.load(std::memory_order_relaxed);
+    ASSERT(ref_count > 0);
+    while (ref_count > 1 && !symbol_slot.ref_count_.compare_exchange_weak(
+                                ref_count, ref_count - 1, std::memory_order_relaxed)) {
+    }
+    if (ref_count > 1) {
+      continue;
     }
+
+    // This may be the last reference. The count only drops to zero under the
+    // shard lock, so that toSymbol() can't find and revive the symbol while it
+    // is being removed.
+    InlineString* str = symbol_slot.string_.load(std::memory_order_acquire);
+    ASSERT(str != nullptr);
+    EncodeShard& shard = encodeShard(str->toStringView());
+    {
+      Thread::LockGuard lock(shard.lock_);
+      if (symbol_slot.ref_count_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        continue;
+      }
+      const size_t erased = shard.map_.erase(str->toStringView());
+      ASSERT(erased == 1);
+      symbol_slot.string_.store(nullptr, std::memory_order_relaxed);
+    }
+
+    // If that was the last remaining client usage of the symbol, release the
+    // string and add the now-unused symbol to the reuse pool.
+    InlineStringPtr str_ptr(str);
+    releaseSymbol(symbol);
   }
 }
 
@@ -385,10 +400,10 @@ uint64_t SymbolTable::getRecentLookups(const RecentLookupsFn& iter) const {
   uint64_t total = 0;
   absl::flat_hash_map<std::string, uint64_t> name_count_map;
 
-  // We don't want to hold lock_ while calling the iterator, but we need it to
+  // We don't want to hold recent_lookups_lock_ while calling the iterator, but we need it to
   // access recent_lookups_, so we buffer in name_count_map.
   {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(recent_lookups_lock_);
     recent_lookups_.forEach(
         [&name_count_map](absl::string_view str, uint64_t count)
             ABSL_NO_THREAD_SAFETY_ANALYSIS { name_count_map[std::string(str)] += count; });
@@ -437,17 +452,18 @@ DynamicSpans SymbolTable::getDynamicSpans(StatName stat_name) const {
 }
 
 void SymbolTable::setRecentLookupCapacity(uint64_t capacity) {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   recent_lookups_.setCapacity(capacity);
+  recent_lookups_enabled_.store(capacity > 0, std::memory_order_relaxed);
 }
 
 void SymbolTable::clearRecentLookups() {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   recent_lookups_.clear();
 }
 
 uint64_t SymbolTable::recentLookupCapacity() const {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   return recent_lookups_.capacity();
 }
 
@@ -458,59 +474,77 @@ StatNameSetPtr SymbolTable::makeSet(absl::string_view name) {
 }
 
 Symbol SymbolTable::toSymbol(absl::string_view sv) {
-  Symbol result;
-  auto encode_find = encode_map_.find(sv);
-  // If the string segment doesn't already exist,
-  if (encode_find == encode_map_.end()) {
-    // We create the actual string, place it in the decode_map_, and then insert
-    // a string_view pointing to it in the encode_map_. This allows us to only
-    // store the string once. We use unique_ptr so copies are not made as
-    // flat_hash_map moves values around.
-    InlineStringPtr str = InlineString::create(sv);
-    auto encode_insert = encode_map_.insert({str->toStringView(), SharedSymbol(next_symbol_)});
-    ASSERT(encode_insert.second);
-    auto decode_insert = decode_map_.insert({next_symbol_, std::move(str)});
-    ASSERT(decode_insert.second);
-
-    result = next_symbol_;
-    newSymbol();
-  } else {
-    // If the insertion didn't take place, return the actual value at that location and up the
-    // refcount at that location
-    result = encode_find->second.symbol_;
-    ++(encode_find->second.ref_count_);
-  }
-  return result;
-}
-
-absl::string_view SymbolTable::fromSymbol(const Symbol symbol) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
-  auto search = decode_map_.find(symbol);
-  RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
-  return search->second->toStringView();
-}
-
-void SymbolTable::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+  EncodeShard& shard = encodeShard(sv);
+  Thread::LockGuard lock(shard.lock_);
+  auto encode_find = shard.map_.find(sv);
+  if (encode_find != shard.map_.end()) {
+    // If the string segment already exists, up the refcount of its symbol.
+    const Symbol symbol = encode_find->second;
+    slot(symbol).ref_count_.fetch_add(1, std::memory_order_relaxed);
+    return symbol;
+  }
+
+  // We create the actual string, place it in the decode table, and then insert
+  // a string_view pointing to it in the encode map. This allows us to only
+  // store the string once.
+  InlineStringPtr str = InlineString::create(sv);
+  const Symbol symbol = allocateSymbol();
+  SymbolSlot& symbol_slot = slot(symbol);
+  ASSERT(symbol_slot.string_.load(std::memory_order_relaxed) == nullptr);
+  symbol_slot.ref_count_.store(1, std::memory_order_relaxed);
+  auto encode_insert = shard.map_.emplace(str->toStringView(), symbol);
+  ASSERT(encode_insert.second);
+  symbol_slot.string_.store(str.release(), std::memory_order_release);
+  return symbol;
+}
+
+absl::string_view SymbolTable::fromSymbol(const Symbol symbol) const {
+  const InlineString* str = slot(symbol).string_.load(std::memory_order_acquire);
+  RELEASE_ASSERT(str != nullptr, "no such symbol");
+  return str->toStringView();
+}
+
+SymbolTable::SymbolSlot& SymbolTable::slot(Symbol symbol) const {
+  // Segment i holds the slots at indexes [2^(i + FirstSegmentBits), 2^(i + FirstSegmentBits + 1))
+  // once the symbol is offset by FirstSegmentSize.
+  const uint64_t index = uint64_t(symbol) + FirstSegmentSize;
+  const uint32_t bit = 63 - absl::countl_zero(index);
+  SymbolSlot* segment = segments_[bit - FirstSegmentBits].load(std::memory_order_acquire);
+  RELEASE_ASSERT(segment != nullptr, "no such symbol");
+  return segment[index - (uint64_t(1) << bit)];
+}
+
+SymbolTable::EncodeShard& SymbolTable::encodeShard(absl::string_view sv) const {
+  return encode_shards_[absl::Hash<absl::string_view>()(sv) % NumEncodeShards];
+}
+
+Symbol SymbolTable::allocateSymbol() {
+  Thread::LockGuard lock(symbol_lock_);
+  Symbol symbol;
   if (pool_.empty()) {
-    next_symbol_ = ++monotonic_counter_;
+    symbol = monotonic_counter_++;
+    // This should catch integer overflow for the new symbol.
+    ASSERT(monotonic_counter_ != 0);
   } else {
-    next_symbol_ = pool_.top();
+    symbol = pool_.top();
     pool_.pop();
   }
-  // This should catch integer overflow for the new symbol.
-  ASSERT(monotonic_counter_ != 0);
+
+  const uint64_t index = uint64_t(symbol) + FirstSegmentSize;
+  const uint32_t segment_index = 63 - absl::countl_zero(index) - FirstSegmentBits;
+  if (segments_[segment_index].load(std::memory_order_relaxed) == nullptr) {
+    segments_[segment_index].store(new SymbolSlot[FirstSegmentSize << segment_index],
+                                   std::memory_order_release);
+  }
+  return symbol;
 }
 
-bool SymbolTable::lessThan(const StatName& a, const StatName& b) const {
-  // Proactively take the table lock in anticipation that we'll need to
-  // convert at least one symbol to a string_view, and it's easier not to
-  // bother to lazily take the lock.
-  Thread::LockGuard lock(lock_);
-  return lessThanLockHeld(a, b);
+void SymbolTable::releaseSymbol(Symbol symbol) {
+  Thread::LockGuard lock(symbol_lock_);
+  pool_.push(symbol);
 }
 
-bool SymbolTable::lessThanLockHeld(const StatName& a, const StatName& b) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+bool SymbolTable::lessThan(const StatName& a, const StatName& b) const {
   Encoding::TokenIter a_iter(a), b_iter(b);
   while (true) {
     Encoding::TokenIter::TokenType a_type = a_iter.next();
@@ -540,16 +574,17 @@ bool SymbolTable::lessThanLockHeld(const StatName& a, const StatName& b) const
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTable::debugPrint() const {
-  Thread::LockGuard lock(lock_);
-  std::vector<Symbol> symbols;
-  for (const auto& p : decode_map_) {
-    symbols.push_back(p.first);
+  std::vector<std::pair<Symbol, absl::string_view>> symbols;
+  for (const EncodeShard& shard : encode_shards_) {
+    Thread::LockGuard lock(shard.lock_);
+    for (const auto& [token, symbol] : shard.map_) {
+      symbols.emplace_back(symbol, token);
+    }
   }
   std::sort(symbols.begin(), symbols.end());
-  for (Symbol symbol : symbols) {
-    const InlineString& token = *decode_map_.find(symbol)->second;
-    const SharedSymbol& shared_symbol = encode_map_.find(token.toStringView())->second;
-    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(), shared_symbol.ref_count_);
+  for (const auto& [symbol, token] : symbols) {
+    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token,
+                   slot(symbol).ref_count_.load(std::memory_order_relaxed));
   }
 }
 #endif
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <stack>
@@ -15,6 +17,7 @@
 #include "source/common/common/utility.h"
 #include "source/common/stats/recent_lookups.h"
 
+#include "absl/base/optimization.h"
 #include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
@@ -249,9 +252,8 @@ public:
    * caller-provided buffer, without allocating. This lets callers that already own a buffer, such
    * as stats sinks during flush, avoid the per-name std::string allocation that toString() incurs.
    *
-   * At most buffer_size bytes are written and no null terminator is added. The symbol-table lock is
-   * acquired once for the call, so this suits periodic operations such as the stats flush rather
-   * than the request hot path.
+   * At most buffer_size bytes are written and no null terminator is added. Like toString(), this
+   * takes no lock.
    *
    * @param stat_name the stat name to serialize.
    * @param buffer the destination buffer. May be null only if buffer_size is 0, which makes this a
@@ -381,8 +383,6 @@ public:
    */
   DynamicSpans getDynamicSpans(StatName stat_name) const;
 
-  bool lessThanLockHeld(const StatName& a, const StatName& b) const;
-
   template <class GetStatName, class Obj> struct StatNameCompare {
     StatNameCompare(const SymbolTable& symbol_table, GetStatName getter)
         : symbol_table_(symbol_table), getter_(getter) {}
@@ -394,9 +394,8 @@ public:
   };
 
   /**
-   * Sorts a range by StatName. This API is more efficient than
-   * calling std::sort directly as it takes a single lock for the
-   * entire sort, rather than locking on each comparison.
+   * Sorts a range by StatName. Decoding symbols takes no lock, so this is
+   * equivalent to calling std::sort with lessThan().
    *
    * @param begin the beginning of the range to sort
    * @param end the end of the range to sort
@@ -404,9 +403,6 @@ public:
    */
   template <class Obj, class Iter, class GetStatName>
   void sortByStatNames(Iter begin, Iter end, GetStatName get_stat_name) const {
-    // Grab the lock once before sorting begins, so we don't have to re-take
-    // it on every comparison.
-    Thread::LockGuard lock(lock_);
     StatNameCompare<GetStatName, Obj> compare(*this, get_stat_name);
     std::sort(begin, end, compare);
   }
@@ -452,16 +448,6 @@ private:
    */
   void incRefCount(const StatName& stat_name);
 
-  struct SharedSymbol {
-    SharedSymbol(Symbol symbol) : symbol_(symbol) {}
-
-    Symbol symbol_;
-    uint32_t ref_count_{1};
-  };
-
-  // This must be held during both encode() and free().
-  mutable Thread::MutexBasicLockable lock_;
-
   /**
    * Decodes a uint8_t array into an array of period-delimited strings. Note
    * that some of the strings may have periods in them, in the case where
@@ -479,24 +465,23 @@ private:
 
   /**
    * Convenience function for encode(), symbolizing one string segment at a time.
+   * Takes the lock of the encode shard of the string, and the allocation lock
+   * if a new symbol is needed.
    *
    * @param sv the individual string to be encoded as a symbol.
    * @return Symbol the encoded string.
    */
-  Symbol toSymbol(absl::string_view sv) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  Symbol toSymbol(absl::string_view sv);
 
   /**
-   * Convenience function for decode(), decoding one symbol at a time.
+   * Convenience function for decode(), decoding one symbol at a time. Takes no
+   * lock: the caller must hold a reference to the symbol, which keeps its
+   * string alive and unchanged.
    *
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
-
-  /**
-   * Stages a new symbol for use. To be called after a successful insertion.
-   */
-  void newSymbol();
+  absl::string_view fromSymbol(Symbol symbol) const;
 
   /**
    * Tokenizes name, finds or allocates symbols for each token, and adds them
@@ -508,30 +493,69 @@ private:
   void addTokensToEncoding(absl::string_view name, Encoding& encoding);
 
   Symbol monotonicCounter() {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(symbol_lock_);
     return monotonic_counter_;
   }
 
-  // Stores the symbol to be used at next insertion. This should exist ahead of insertion time so
-  // that if insertion succeeds, the value written is the correct one.
-  Symbol next_symbol_ ABSL_GUARDED_BY(lock_);
+  // The decode table is an array indexed by symbol, so that decoding is a
+  // couple of atomic loads. A slot's string and reference count only go back
+  // to null and zero when the last reference is dropped, and a symbol is only
+  // reused after that, so holders of a reference can read the slot without a
+  // lock.
+  struct SymbolSlot {
+    std::atomic<InlineString*> string_{nullptr};
+    std::atomic<uint32_t> ref_count_{0};
+  };
 
-  // If the free pool is exhausted, we monotonically increase this counter.
-  Symbol monotonic_counter_;
+  // The array grows without moving slots that may be read concurrently: it is
+  // made of segments that double in size, the first one holding
+  // FirstSegmentSize slots. Segments are only released by the destructor.
+  static constexpr uint32_t FirstSegmentBits = 5;
+  static constexpr uint64_t FirstSegmentSize = uint64_t(1) << FirstSegmentBits;
+  static constexpr uint32_t NumSegments = 33 - FirstSegmentBits;
+
+  SymbolSlot& slot(Symbol symbol) const;
+
+  // The encode map is split in shards by the hash of the string, each with its
+  // own lock, so that concurrent encodes of different tokens don't contend.
+  // Transitions of a reference count from or to zero are only made while
+  // holding the lock of the shard holding the symbol's string.
+  static constexpr uint32_t NumEncodeShards = 16;
+  struct alignas(ABSL_CACHELINE_SIZE) EncodeShard {
+    mutable Thread::MutexBasicLockable lock_;
+    // Using absl::string_view lets us only store the complete string once, in
+    // the decode table.
+    absl::flat_hash_map<absl::string_view, Symbol> map_ ABSL_GUARDED_BY(lock_);
+  };
+
+  EncodeShard& encodeShard(absl::string_view sv) const;
+
+  /**
+   * @return a symbol that is not in use, creating the decode table segment
+   *         holding its slot if needed.
+   */
+  Symbol allocateSymbol();
+  void releaseSymbol(Symbol symbol);
 
-  // Bitmap implementation.
-  // The encode map stores both the symbol and the ref count of that symbol.
-  // Using absl::string_view lets us only store the complete string once, in the decode map.
-  using EncodeMap = absl::flat_hash_map<absl::string_view, SharedSymbol>;
-  using DecodeMap = absl::flat_hash_map<Symbol, InlineStringPtr>;
-  EncodeMap encode_map_ ABSL_GUARDED_BY(lock_);
-  DecodeMap decode_map_ ABSL_GUARDED_BY(lock_);
+  mutable std::array<EncodeShard, NumEncodeShards> encode_shards_;
+  std::array<std::atomic<SymbolSlot*>, NumSegments> segments_{};
+
+  // Guards the allocation of symbols and of decode table segments.
+  Thread::MutexBasicLockable symbol_lock_;
+
+  // If the free pool is exhausted, we monotonically increase this counter.
+  Symbol monotonic_counter_ ABSL_GUARDED_BY(symbol_lock_);
 
   // Free pool of symbols for re-use.
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
   // using an Envoy::IntervalSet.
-  std::stack<Symbol> pool_ ABSL_GUARDED_BY(lock_);
-  RecentLookups recent_lookups_ ABSL_GUARDED_BY(lock_);
+  std::stack<Symbol> pool_ ABSL_GUARDED_BY(symbol_lock_);
+
+  // Lookups are only recorded, and recent_lookups_lock_ only taken, while
+  // tracking is enabled.
+  mutable Thread::MutexBasicLockable recent_lookups_lock_;
+  RecentLookups recent_lookups_ ABSL_GUARDED_BY(recent_lookups_lock_);
+  std::atomic<bool> recent_lookups_enabled_{false};
 };
 
 // Base class for holding the backing-storing for a StatName. The two derived
@@ -1182,7 +1206,7 @@ template <class GetStatName, class Obj>
 bool SymbolTable::StatNameCompare<GetStatName, Obj>::operator()(const Obj& a, const Obj& b) const {
   StatName a_stat_name = getter_(a);
   StatName b_stat_name = getter_(b);
-  return symbol_table_.lessThanLockHeld(a_stat_name, b_stat_name);
+  return symbol_table_.lessThan(a_stat_name, b_stat_name);
 }
 
 using SymbolTablePtr = std::unique_ptr<SymbolTable>;
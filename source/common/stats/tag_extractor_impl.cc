@@ -33,6 +33,135 @@ const std::vector<absl::string_view>& TagExtractionContext::tokens() {
   return tokens_;
 }
 
+uint32_t TagExtractionContext::tokensMatch(uint32_t pattern_index) {
+  ASSERT(tokens_matcher_ != nullptr);
+  if (tokens_matches_.empty()) {
+    tokens_matcher_->match(tokens(), tokens_matches_);
+  }
+  return tokens_matches_[pattern_index];
+}
+
+uint32_t TagExtractorTokensMatcher::addPattern(const std::vector<std::string>& tokens,
+                                               uint32_t match_index) {
+  const uint32_t pattern_index = patterns_.size();
+  Pattern& pattern = patterns_.emplace_back();
+  pattern.first_state_ = num_states_;
+  num_states_ += tokens.size() + 1;
+  for (uint32_t i = 0; i < tokens.size(); ++i) {
+    PatternToken& token = pattern.tokens_.emplace_back();
+    if (i == match_index) {
+      token.type_ = TokenType::Capture;
+    } else if (tokens[i] == "*") {
+      token.type_ = TokenType::Any;
+    } else if (tokens[i] == "**") {
+      token.type_ = i == tokens.size() - 1 ? TokenType::AnyRemaining : TokenType::AnySequence;
+    } else {
+      token.type_ = TokenType::Literal;
+      token.literal_ = tokens[i];
+    }
+  }
+  if (!pattern.tokens_.empty() && pattern.tokens_[0].type_ == TokenType::Literal) {
+    patterns_by_first_token_[pattern.tokens_[0].literal_].push_back(pattern_index);
+  } else {
+    patterns_without_first_token_.push_back(pattern_index);
+  }
+  return pattern_index;
+}
+
+void TagExtractorTokensMatcher::addThread(Threads& threads, std::vector<uint32_t>& added,
+                                          uint32_t generation, Thread thread) const {
+  const Pattern& pattern = patterns_[thread.pattern_];
+  uint32_t& state = added[pattern.first_state_ + thread.position_];
+  if (state == generation) {
+    // A thread of higher priority already reached this state for the current input token.
+    return;
+  }
+  state = generation;
+  if (thread.position_ < pattern.tokens_.size() &&
+      pattern.tokens_[thread.position_].type_ == TokenType::AnySequence) {
+    // As in the backtracking search, "**" first tries to match the rest of the pattern without
+    // consuming any token, and only then consumes one more.
+    addThread(threads, added, generation,
+              Thread{thread.pattern_, thread.position_ + 1, thread.capture_});
+  }
+  threads.push_back(thread);
+}
+
+void TagExtractorTokensMatcher::match(const std::vector<absl::string_view>& tokens,
+                                      std::vector<uint32_t>& matches) const {
+  matches.assign(patterns_.size(), NoMatch);
+  if (tokens.empty()) {
+    return;
+  }
+
+  // The generation is bumped for each input token. added[] records the generation in which a
+  // state last got a thread, and accepted[] the generation in which a pattern last matched,
+  // which cuts off the threads of the pattern with lower priority.
+  std::vector<uint32_t> added(num_states_, 0);
+  std::vector<uint32_t> accepted(patterns_.size(), 0);
+  uint32_t generation = 1;
+  Threads current, next;
+  for (const uint32_t pattern_index : patterns_without_first_token_) {
+    addThread(current, added, generation, Thread{pattern_index, 0, NoMatch});
+  }
+  auto it = patterns_by_first_token_.find(tokens[0]);
+  if (it != patterns_by_first_token_.end()) {
+    for (const uint32_t pattern_index : it->second) {
+      addThread(current, added, generation, Thread{pattern_index, 0, NoMatch});
+    }
+  }
+
+  for (uint32_t input_index = 0; input_index < tokens.size() && !current.empty(); ++input_index) {
+    ++generation;
+    next.clear();
+    for (const Thread& thread : current) {
+      if (accepted[thread.pattern_] == generation) {
+        continue;
+      }
+      const Pattern& pattern = patterns_[thread.pattern_];
+      if (thread.position_ == pattern.tokens_.size()) {
+        continue; // The pattern ended before the input.
+      }
+      const PatternToken& token = pattern.tokens_[thread.position_];
+      switch (token.type_) {
+      case TokenType::Literal:
+        if (token.literal_ == tokens[input_index]) {
+          addThread(next, added, generation,
+                    Thread{thread.pattern_, thread.position_ + 1, thread.capture_});
+        }
+        break;
+      case TokenType::Any:
+        addThread(next, added, generation,
+                  Thread{thread.pattern_, thread.position_ + 1, thread.capture_});
+        break;
+      case TokenType::Capture:
+        addThread(next, added, generation,
+                  Thread{thread.pattern_, thread.position_ + 1, input_index});
+        break;
+      case TokenType::AnySequence:
+        addThread(next, added, generation, thread);
+        break;
+      case TokenType::AnyRemaining:
+        // Matches as soon as it is reached with input tokens left. This overrides a match of the
+        // pattern by a thread of lower priority at an earlier token.
+        matches[thread.pattern_] = thread.capture_;
+        accepted[thread.pattern_] = generation;
+        break;
+      }
+    }
+    std::swap(current, next);
+  }
+
+  ++generation;
+  for (const Thread& thread : current) {
+    if (accepted[thread.pattern_] != generation &&
+        thread.position_ == patterns_[thread.pattern_].tokens_.size()) {
+      matches[thread.pattern_] = thread.capture_;
+      accepted[thread.pattern_] = generation;
+    }
+  }
+}
+
 namespace {
 
 bool regexStartsWithDot(absl::string_view regex) {
@@ -202,6 +331,10 @@ TagExtractorTokensImpl::TagExtractorTokensImpl(absl::string_view name, absl::str
   }
 }
 
+void TagExtractorTokensImpl::addToMatcher(TagExtractorTokensMatcher& matcher) {
+  matcher_pattern_index_ = matcher.addPattern(tokens_, match_index_);
+}
+
 uint32_t TagExtractorTokensImpl::findMatchIndex(const std::vector<std::string>& tokens) {
   for (uint32_t i = 0; i < tokens.size(); ++i) {
     if (tokens[i] == "$") {
@@ -217,7 +350,17 @@ bool TagExtractorTokensImpl::extractTag(TagExtractionContext& context, std::vect
   PERF_OPERATION(perf);
   const std::vector<absl::string_view>& input_tokens = context.tokens();
   uint32_t match_input_index = input_tokens.size(), start = 0;
-  if (!searchTags(input_tokens, 0, 0, 0, start, match_input_index)) {
+  bool matched;
+  if (matcher_pattern_index_.has_value() && context.hasTokensMatcher()) {
+    match_input_index = context.tokensMatch(*matcher_pattern_index_);
+    matched = match_input_index != TagExtractorTokensMatcher::NoMatch;
+    if (matched) {
+      start = input_tokens[match_input_index].data() - context.name().data();
+    }
+  } else {
+    matched = searchTags(input_tokens, 0, 0, 0, start, match_input_index);
+  }
+  if (!matched) {
     PERF_RECORD(perf, "tokens-miss", name_);
     PERF_TAG_INC(missed_);
     return false;
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
+#include <optional>
 #include <regex>
 #include <string>
+#include <vector>
 
 #ifdef ENVOY_PERF_ANNOTATION
 #include <fmt/core.h>
@@ -12,23 +15,101 @@
 
 #include "source/common/common/regex.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "re2/re2.h"
 
 namespace Envoy {
 namespace Stats {
 
+/**
+ * Matches the patterns of a set of TagExtractorTokensImpl together, in a single pass over the
+ * tokens of a stat name, rather than with one backtracking search per extractor. The patterns are
+ * simulated as one automaton whose threads are kept in the order the backtracking search would
+ * explore them, so each pattern captures the same token as the search does. Patterns starting
+ * with a literal token are only started for the names starting with that token.
+ */
+class TagExtractorTokensMatcher {
+public:
+  static constexpr uint32_t NoMatch = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * Adds a pattern, in the syntax of TagExtractorTokensImpl.
+   * @param tokens the dot-separated tokens of the pattern.
+   * @param match_index the index of the token whose value is captured.
+   * @return the index of the pattern in the results of match().
+   */
+  uint32_t addPattern(const std::vector<std::string>& tokens, uint32_t match_index);
+
+  /**
+   * Matches all the patterns against the tokens of a stat name.
+   * @param tokens the dot-separated tokens of the stat name.
+   * @param matches receives, for each pattern, the index of the captured input token, or NoMatch.
+   */
+  void match(const std::vector<absl::string_view>& tokens, std::vector<uint32_t>& matches) const;
+
+  uint32_t numPatterns() const { return patterns_.size(); }
+
+private:
+  enum class TokenType : uint8_t {
+    Literal,
+    Any,           // "*"
+    Capture,       // The "$" whose value is extracted.
+    AnySequence,   // "**" followed by more tokens.
+    AnyRemaining,  // "**" ending the pattern, which matches one or more tokens.
+  };
+  struct PatternToken {
+    TokenType type_;
+    std::string literal_;
+  };
+  struct Pattern {
+    std::vector<PatternToken> tokens_;
+    // Index of the state of the first token; a state per token, plus one for the end.
+    uint32_t first_state_;
+  };
+  struct Thread {
+    uint32_t pattern_;
+    uint32_t position_;
+    uint32_t capture_;
+  };
+  using Threads = std::vector<Thread>;
+
+  void addThread(Threads& threads, std::vector<uint32_t>& added, uint32_t generation,
+                 Thread thread) const;
+
+  std::vector<Pattern> patterns_;
+  uint32_t num_states_{0};
+  absl::flat_hash_map<std::string, std::vector<uint32_t>> patterns_by_first_token_;
+  std::vector<uint32_t> patterns_without_first_token_;
+};
+
 // Carries state across tag extractions.
 class TagExtractionContext {
 public:
-  explicit TagExtractionContext(absl::string_view name) : name_(name) {}
+  /**
+   * @param name the stat name.
+   * @param tokens_matcher if not null, matches the patterns of the token extractors registered
+   *        with it, the first time one of them needs a result.
+   */
+  explicit TagExtractionContext(absl::string_view name,
+                                const TagExtractorTokensMatcher* tokens_matcher = nullptr)
+      : name_(name), tokens_matcher_(tokens_matcher) {}
 
   absl::string_view name() { return name_; }
   const std::vector<absl::string_view>& tokens();
 
+  /**
+   * @return the index of the token captured by a pattern of the tokens matcher, or
+   *         TagExtractorTokensMatcher::NoMatch.
+   */
+  uint32_t tokensMatch(uint32_t pattern_index);
+  bool hasTokensMatcher() const { return tokens_matcher_ != nullptr; }
+
 private:
   absl::string_view name_;
   std::vector<absl::string_view> tokens_;
+  const TagExtractorTokensMatcher* const tokens_matcher_;
+  std::vector<uint32_t> tokens_matches_;
 };
 
 // To check if a tag extractor is actually used you can run
@@ -160,6 +241,12 @@ public:
   bool extractTag(TagExtractionContext& context, std::vector<Tag>& tags,
                   IntervalSet<size_t>& remove_characters) const override;
 
+  /**
+   * Registers the pattern with a matcher, which then performs the matching for the extractions
+   * whose context uses the matcher.
+   */
+  void addToMatcher(TagExtractorTokensMatcher& matcher);
+
 private:
   static uint32_t findMatchIndex(const std::vector<std::string>& tokens);
   bool searchTags(const std::vector<absl::string_view>& input_tokens, uint32_t input_index,
@@ -168,6 +255,7 @@ private:
 
   const std::vector<std::string> tokens_;
   const uint32_t match_index_;
+  std::optional<uint32_t> matcher_pattern_index_;
 };
 
 /**
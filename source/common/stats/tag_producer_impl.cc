@@ -78,7 +78,7 @@ absl::Status TagProducerImpl::addExtractorsMatching(absl::string_view name) {
   }
   for (const auto& desc : Config::TagNames::get().tokenizedDescriptorVec()) {
     if (desc.name_ == name) {
-      addExtractor(std::make_unique<TagExtractorTokensImpl>(desc.name_, desc.pattern_));
+      addTokensExtractor(desc.name_, desc.pattern_);
       ++num_found;
     }
   }
@@ -89,6 +89,12 @@ absl::Status TagProducerImpl::addExtractorsMatching(absl::string_view name) {
   return absl::OkStatus();
 }
 
+void TagProducerImpl::addTokensExtractor(absl::string_view name, absl::string_view pattern) {
+  auto extractor = std::make_unique<TagExtractorTokensImpl>(name, pattern);
+  extractor->addToMatcher(tokens_matcher_);
+  addExtractor(std::move(extractor));
+}
+
 void TagProducerImpl::addExtractor(TagExtractorPtr extractor) {
   auto insertion = extractor_map_.insert(std::make_pair(extractor->name(), std::ref(*extractor)));
   if (!insertion.second) {
@@ -126,7 +132,7 @@ void TagProducerImpl::forEachExtractorMatching(
 std::string TagProducerImpl::produceTags(absl::string_view metric_name, TagVector& tags) const {
   // TODO(jmarantz): Skip the creation of string-based tags, creating a StatNameTagVector instead.
   IntervalSetImpl<size_t> remove_characters;
-  TagExtractionContext tag_extraction_context(metric_name);
+  TagExtractionContext tag_extraction_context(metric_name, &tokens_matcher_);
   std::vector<absl::string_view> tokens;
   absl::flat_hash_set<absl::string_view> dup_set;
   forEachExtractorMatching(metric_name, [&remove_characters, &tags, &tag_extraction_context,
@@ -187,7 +193,7 @@ TagProducerImpl::addDefaultExtractors(const envoy::config::metrics::v3::StatsCon
       if (overridden_names.contains(desc.name_)) {
         continue;
       }
-      addExtractor(std::make_unique<TagExtractorTokensImpl>(desc.name_, desc.pattern_));
+      addTokensExtractor(desc.name_, desc.pattern_);
     }
   }
   return absl::OkStatus();
@@ -14,6 +14,7 @@
 #include "source/common/common/utility.h"
 #include "source/common/config/well_known_names.h"
 #include "source/common/protobuf/protobuf.h"
+#include "source/common/stats/tag_extractor_impl.h"
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_set.h"
@@ -64,6 +65,13 @@ private:
    */
   void addExtractor(TagExtractorPtr extractor);
 
+  /**
+   * Adds a TagExtractorTokensImpl, registering its pattern with tokens_matcher_.
+   * @param name absl::string_view the tag name.
+   * @param pattern absl::string_view the dot-separated token pattern.
+   */
+  void addTokensExtractor(absl::string_view name, absl::string_view pattern);
+
   /**
    * Adds all default extractors matching the specified tag name. In this model,
    * more than one TagExtractor can be used to generate a given tag. The default
@@ -119,6 +127,9 @@ private:
   // send duplicate tag names to Prometheus so this needs to be filtered out.
   absl::flat_hash_map<absl::string_view, std::reference_wrapper<TagExtractor>> extractor_map_;
 
+  // Matches the patterns of all the token extractors in one pass over the tokens of a name.
+  TagExtractorTokensMatcher tokens_matcher_;
+
   TagVector fixed_tags_;
 };
 
@@ -324,12 +324,52 @@ void ThreadLocalStoreImpl::mergeHistograms(PostMergeCb merge_complete_cb) {
 
 void ThreadLocalStoreImpl::mergeInternal(PostMergeCb merge_complete_cb) {
   if (!shutting_down_) {
-    forEachHistogram(nullptr, [](ParentHistogram& histogram) { histogram.merge(); });
+    {
+      Thread::LockGuard lock(hist_mutex_);
+      mergeParentHistogramsLockHeld();
+    }
     merge_complete_cb();
     merge_in_progress_ = false;
   }
 }
 
+void ThreadLocalStoreImpl::mergeParentHistogramsLockHeld() {
+  // Each merge thread takes batches of histograms until all are merged. Threads are only used if
+  // each gets a sizable share of the histograms, as creating them is not free.
+  static constexpr size_t MinHistogramsPerThread = 256;
+  static constexpr size_t BatchSize = 32;
+  const size_t num_threads =
+      std::min<size_t>(merge_threads_, histogram_set_.size() / MinHistogramsPerThread);
+  if (num_threads <= 1) {
+    for (ParentHistogramImpl* histogram : histogram_set_) {
+      histogram->merge();
+    }
+    return;
+  }
+
+  // The histograms can't be released while hist_mutex_ is held, so plain pointers are safe here.
+  const std::vector<ParentHistogramImpl*> histograms(histogram_set_.begin(), histogram_set_.end());
+  std::atomic<size_t> next_batch{0};
+  auto merge_batches = [&histograms, &next_batch]() {
+    for (size_t begin = next_batch.fetch_add(BatchSize); begin < histograms.size();
+         begin = next_batch.fetch_add(BatchSize)) {
+      const size_t end = std::min(begin + BatchSize, histograms.size());
+      for (size_t i = begin; i < end; ++i) {
+        histograms[i]->merge();
+      }
+    }
+  };
+  std::vector<Thread::ThreadPtr> threads;
+  threads.reserve(num_threads - 1);
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.push_back(thread_factory_->createThread(merge_batches, Thread::Options{"stats_merge"}));
+  }
+  merge_batches();
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+}
+
 ThreadLocalStoreImpl::CentralCacheEntry::~CentralCacheEntry() {
   // Assert that the symbol-table is valid, so we get good test coverage of
   // the validity of the symbol table at the time this destructor runs. This
@@ -1064,12 +1104,6 @@ void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   used_ = true;
 }
 
-void ThreadLocalHistogramImpl::merge(histogram_t* target) {
-  histogram_t** other_histogram = &histograms_[otherHistogramIndex()];
-  hist_accumulate(target, other_histogram, 1);
-  hist_clear(*other_histogram);
-}
-
 ParentHistogramImpl::ParentHistogramImpl(StatName name, Histogram::Unit unit,
                                          ThreadLocalStoreImpl& thread_local_store,
                                          StatName tag_extracted_name,
@@ -1169,18 +1203,37 @@ void ParentHistogramImpl::merge() {
   Thread::ReleasableLockGuard lock(merge_lock_);
   if (merged_ || usedLockHeld()) {
     hist_clear(interval_histogram_);
-    // Here we could copy all the pointers to TLS histograms in the tls_histogram_ list,
-    // then release the lock before we do the actual merge. However it is not a big deal
-    // because the tls_histogram merge is not that expensive as it is a single histogram
-    // merge and adding TLS histograms is rare.
+    // The TLS histograms that recorded values are merged in a single k-way pass over their bins,
+    // rather than one at a time into the growing interval histogram. Here we could copy all the
+    // pointers to TLS histograms in the tls_histogram_ list, then release the lock before we do
+    // the actual merge. However it is not a big deal because adding TLS histograms is rare.
+    merge_sources_.clear();
     for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
-      tls_histogram->merge(interval_histogram_);
+      histogram_t* source = tls_histogram->histogramToMerge();
+      if (hist_num_buckets(source) > 0) {
+        merge_sources_.push_back(source);
+      }
+    }
+    const bool interval_empty = merge_sources_.empty();
+    if (!interval_empty) {
+      hist_accumulate(interval_histogram_, merge_sources_.data(), merge_sources_.size());
+      for (histogram_t* source : merge_sources_) {
+        hist_clear(source);
+      }
     }
     // Since TLS merge is done, we can release the lock here.
     lock.release();
-    hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
-    cumulative_statistics_.refresh(cumulative_histogram_);
-    interval_statistics_.refresh(interval_histogram_);
+    // Computing the quantiles and buckets is the expensive part of the merge, so it is skipped
+    // when the statistics would not change: the cumulative histogram only changes with a
+    // non-empty interval, and an empty interval has the same statistics as the previous one.
+    if (!interval_empty) {
+      hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
+      cumulative_statistics_.refresh(cumulative_histogram_);
+    }
+    if (!interval_empty || !interval_statistics_empty_) {
+      interval_statistics_.refresh(interval_histogram_);
+    }
+    interval_statistics_empty_ = interval_empty;
     merged_ = true;
   }
 }
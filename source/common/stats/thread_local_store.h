@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -40,7 +41,11 @@ public:
                            std::optional<uint32_t> bins);
   ~ThreadLocalHistogramImpl() override;
 
-  void merge(histogram_t* target);
+  /**
+   * @return the histogram holding the values collected before the last beginMerge(). It is only
+   *         written by the merge process, which clears it once it has been merged.
+   */
+  histogram_t* histogramToMerge() { return histograms_[otherHistogramIndex()]; }
 
   /**
    * Called in the beginning of merge process. Swaps the histogram used for collection so that we do
@@ -101,7 +106,8 @@ public:
    * This method is called during the main stats flush process for each of the histograms. It
    * iterates through the TLS histograms and collects the histogram data of all of them
    * in to "interval_histogram". Then the collected "interval_histogram" is merged to a
-   * "cumulative_histogram".
+   * "cumulative_histogram". The statistics are only recomputed if values were recorded in the
+   * interval. Different histograms may be merged concurrently.
    */
   void merge() override;
 
@@ -149,7 +155,12 @@ private:
   HistogramStatisticsImpl cumulative_statistics_;
   mutable Thread::MutexBasicLockable merge_lock_;
   std::list<TlsHistogramSharedPtr> tls_histograms_ ABSL_GUARDED_BY(merge_lock_);
+  // The non-empty TLS histograms of the current merge, kept to reuse the allocation.
+  std::vector<histogram_t*> merge_sources_ ABSL_GUARDED_BY(merge_lock_);
   bool merged_{false};
+  // Whether interval_statistics_ were computed from an empty interval, in which case they don't
+  // need to be recomputed for another empty interval.
+  bool interval_statistics_empty_{true};
   std::atomic<bool> shutting_down_{false};
   std::atomic<uint32_t> ref_count_{0};
   const uint64_t id_; // Index into TlsCache::histogram_cache_.
@@ -208,6 +219,16 @@ public:
     ASSERT_IS_MAIN_OR_TEST_THREAD();
     use_explicit_tags_ = use_explicit_tags;
   }
+  void setShardedCounterMatcher(StatsMatcherPtr&& matcher) override {
+    ASSERT_IS_MAIN_OR_TEST_THREAD();
+    alloc_.setShardedCounterMatcher(std::move(matcher));
+  }
+  void setHistogramMergeThreads(uint32_t num_threads,
+                                Thread::ThreadFactory& thread_factory) override {
+    ASSERT_IS_MAIN_OR_TEST_THREAD();
+    merge_threads_ = std::max<uint32_t>(num_threads, 1);
+    thread_factory_ = &thread_factory;
+  }
   // Whether the store is using the explicit-tags logic. Exposed primarily so tests can verify the
   // value selected during server initialization.
   bool useExplicitTags() const { return use_explicit_tags_; }
@@ -589,6 +610,7 @@ private:
   void clearHistogramsFromCaches();
   void releaseScopeCrossThread(ScopeImpl* scope);
   void mergeInternal(PostMergeCb merge_cb);
+  void mergeParentHistogramsLockHeld() ABSL_EXCLUSIVE_LOCKS_REQUIRED(hist_mutex_);
   bool slowRejects(StatsMatcher::FastResult fast_reject_result, StatName name) const;
   bool rejects(StatName name) const { return stats_matcher_->rejects(name); }
   StatsMatcher::FastResult fastRejects(StatName name) const;
@@ -619,6 +641,9 @@ private:
   std::atomic<bool> threading_ever_initialized_{false};
   std::atomic<bool> shutting_down_{false};
   std::atomic<bool> merge_in_progress_{false};
+  // Number of threads merging the histograms, and the factory for the threads besides main.
+  uint32_t merge_threads_{1};
+  Thread::ThreadFactory* thread_factory_{};
   OptRef<ThreadLocal::Instance> tls_;
 
   NullCounterImpl null_counter_;
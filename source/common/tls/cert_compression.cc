@@ -9,6 +9,7 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "brotli/decode.h"
 #include "brotli/encode.h"
@@ -29,9 +30,13 @@ void CertCompression::registerZlib(SSL_CTX*) {}
 
 namespace {
 
+// The compressed certificate chains of an SSL_CTX, by algorithm and then by uncompressed chain.
+// The cache is owned by the SSL_CTX, so it is dropped with the context when an SDS update
+// replaces the certificates. The chains are looked up by string_view, so that a hit, which is
+// the case of almost every handshake, neither allocates nor copies the chain.
 struct CompressedCertCache {
   absl::Mutex mu;
-  absl::flat_hash_map<std::pair<uint16_t, std::string>, std::string>
+  absl::flat_hash_map<uint16_t, absl::flat_hash_map<std::string, std::string>>
       compressed_by_alg_and_chain ABSL_GUARDED_BY(mu);
 };
 
@@ -74,13 +79,16 @@ int compressCached(SSL* ssl, uint16_t alg,
       SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), sslCtxCacheIndex()));
   ASSERT(cache != nullptr);
 
-  std::pair<uint16_t, std::string> key(alg, std::string(reinterpret_cast<const char*>(in), in_len));
+  const absl::string_view chain(reinterpret_cast<const char*>(in), in_len);
 
   {
     absl::ReaderMutexLock lock(&cache->mu);
-    auto it = cache->compressed_by_alg_and_chain.find(key);
-    if (it != cache->compressed_by_alg_and_chain.end()) {
-      return writeToCbb(out, it->second);
+    auto alg_it = cache->compressed_by_alg_and_chain.find(alg);
+    if (alg_it != cache->compressed_by_alg_and_chain.end()) {
+      auto it = alg_it->second.find(chain);
+      if (it != alg_it->second.end()) {
+        return writeToCbb(out, it->second);
+      }
     }
   }
 
@@ -89,8 +97,9 @@ int compressCached(SSL* ssl, uint16_t alg,
     return CertCompression::FAILURE;
   }
   absl::WriterMutexLock lock(&cache->mu);
-  auto it =
-      cache->compressed_by_alg_and_chain.try_emplace(std::move(key), std::move(*compressed)).first;
+  auto it = cache->compressed_by_alg_and_chain[alg]
+                .try_emplace(std::string(chain), std::move(*compressed))
+                .first;
   return writeToCbb(out, it->second);
 }
 
@@ -107,6 +107,109 @@ std::shared_ptr<CrlCache> getCrlCache(Singleton::Manager& singleton_manager) {
                                               [] { return std::make_shared<CrlCache>(); });
 }
 
+SINGLETON_MANAGER_REGISTRATION(trusted_ca_store_cache);
+
+absl::StatusOr<TrustedCaStoreSharedPtr>
+TrustedCaStoreCache::getOrCreate(const Envoy::Ssl::CertificateValidationContextConfig& config,
+                                 CrlListSharedPtr crl) {
+  ASSERT_IS_MAIN_OR_TEST_THREAD();
+
+  // Each PEM blob is prefixed with its length so that no two configurations
+  // digest the same bytes.
+  const std::string& ca_pem = config.caCert();
+  const std::string& crl_pem = config.certificateRevocationList();
+  const uint64_t ca_length = ca_pem.size();
+  const uint64_t crl_length = crl_pem.size();
+  const uint8_t options[] = {static_cast<uint8_t>(config.onlyVerifyLeafCertificateCrl()),
+                             static_cast<uint8_t>(config.allowExpiredCertificate())};
+  std::array<uint8_t, SHA256_DIGEST_LENGTH> key;
+  SHA256_CTX sha256;
+  SHA256_Init(&sha256);
+  SHA256_Update(&sha256, &ca_length, sizeof(ca_length));
+  SHA256_Update(&sha256, ca_pem.data(), ca_pem.size());
+  SHA256_Update(&sha256, &crl_length, sizeof(crl_length));
+  SHA256_Update(&sha256, crl_pem.data(), crl_pem.size());
+  SHA256_Update(&sha256, options, sizeof(options));
+  SHA256_Final(key.data(), &sha256);
+
+  if (auto it = cache_.find(key); it != cache_.end()) {
+    if (TrustedCaStoreSharedPtr existing = it->second.lock(); existing != nullptr) {
+      return existing;
+    }
+  }
+
+  absl::erase_if(cache_, [](const auto& entry) { return entry.second.expired(); });
+
+  bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(const_cast<char*>(ca_pem.data()), ca_pem.size()));
+  RELEASE_ASSERT(bio != nullptr, "");
+  // Based on BoringSSL's X509_load_cert_crl_file().
+  bssl::UniquePtr<STACK_OF(X509_INFO)> list(
+      PEM_X509_INFO_read_bio(bio.get(), nullptr, nullptr, nullptr));
+  if (list == nullptr) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Failed to load trusted CA certificates from ", config.caCertPath()));
+  }
+
+  auto trusted_ca_store = std::make_shared<TrustedCaStore>();
+  trusted_ca_store->cache = shared_from_this();
+  trusted_ca_store->store.reset(X509_STORE_new());
+  RELEASE_ASSERT(trusted_ca_store->store != nullptr, "");
+  X509_STORE* store = trusted_ca_store->store.get();
+  X509_STORE_set_flags(store, X509_V_FLAG_PARTIAL_CHAIN);
+  bool has_crl = false;
+  for (const X509_INFO* item : list.get()) {
+    if (item->x509) {
+      X509_STORE_add_cert(store, item->x509);
+      if (trusted_ca_store->ca_cert == nullptr) {
+        trusted_ca_store->ca_cert = bssl::UpRef(item->x509);
+      }
+    }
+    if (item->crl) {
+      X509_STORE_add_crl(store, item->crl);
+      has_crl = true;
+    }
+  }
+  if (trusted_ca_store->ca_cert == nullptr) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Failed to load trusted CA certificates from ", config.caCertPath()));
+  }
+  if (crl != nullptr) {
+    for (const auto& item : crl->crls) {
+      X509_STORE_add_crl(store, item.get());
+    }
+    has_crl = true;
+  }
+  trusted_ca_store->crl = std::move(crl);
+  if (has_crl) {
+    X509_STORE_set_flags(store, config.onlyVerifyLeafCertificateCrl()
+                                    ? X509_V_FLAG_CRL_CHECK
+                                    : X509_V_FLAG_CRL_CHECK | X509_V_FLAG_CRL_CHECK_ALL);
+  }
+  if (config.allowExpiredCertificate()) {
+    X509_STORE_set_flags(store, X509_V_FLAG_NO_CHECK_TIME);
+  }
+  cache_[key] = trusted_ca_store;
+  return trusted_ca_store;
+}
+
+size_t TrustedCaStoreCache::size() const {
+  ASSERT_IS_MAIN_OR_TEST_THREAD();
+  size_t count = 0;
+  for (const auto& entry : cache_) {
+    if (!entry.second.expired()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+std::shared_ptr<TrustedCaStoreCache>
+getTrustedCaStoreCache(Singleton::Manager& singleton_manager) {
+  return singleton_manager.getTyped<TrustedCaStoreCache>(
+      SINGLETON_MANAGER_REGISTERED_NAME(trusted_ca_store_cache),
+      [] { return std::make_shared<TrustedCaStoreCache>(); });
+}
+
 DefaultCertValidator::DefaultCertValidator(
     const Envoy::Ssl::CertificateValidationContextConfig* config, SslStats& stats,
     Server::Configuration::CommonFactoryContext& context)
@@ -139,50 +242,24 @@ absl::StatusOr<int> DefaultCertValidator::initializeSslContexts(std::vector<SSL_
 
   if (config_ != nullptr && !config_->caCert().empty() && !provides_certificates) {
     ca_file_path_ = config_->caCertPath();
-    bssl::UniquePtr<BIO> bio(
-        BIO_new_mem_buf(const_cast<char*>(config_->caCert().data()), config_->caCert().size()));
-    RELEASE_ASSERT(bio != nullptr, "");
-    // Based on BoringSSL's X509_load_cert_crl_file().
-    bssl::UniquePtr<STACK_OF(X509_INFO)> list(
-        PEM_X509_INFO_read_bio(bio.get(), nullptr, nullptr, nullptr));
-    if (list == nullptr) {
-      return absl::InvalidArgumentError(
-          absl::StrCat("Failed to load trusted CA certificates from ", config_->caCertPath()));
+    if (!config_->certificateRevocationList().empty()) {
+      RETURN_IF_NOT_OK(loadSharedCrl());
     }
+    // Contexts with the same trust material share one store, so a CA bundle
+    // referenced from many filter chains is parsed and indexed only once.
+    absl::StatusOr<TrustedCaStoreSharedPtr> trusted_ca_store_or_error =
+        getTrustedCaStoreCache(context_.singletonManager())->getOrCreate(*config_, shared_crl_);
+    RETURN_IF_NOT_OK_REF(trusted_ca_store_or_error.status());
+    trusted_ca_store_ = std::move(*trusted_ca_store_or_error);
+    ca_cert_ = bssl::UpRef(trusted_ca_store_->ca_cert);
 
     for (auto& ctx : contexts) {
-      X509_STORE* store = SSL_CTX_get_cert_store(ctx);
-      X509_STORE_set_flags(store, X509_V_FLAG_PARTIAL_CHAIN);
-      bool has_crl = false;
-      for (const X509_INFO* item : list.get()) {
-        if (item->x509) {
-          X509_STORE_add_cert(store, item->x509);
-          if (ca_cert_ == nullptr) {
-            X509_up_ref(item->x509);
-            ca_cert_.reset(item->x509);
-          }
-        }
-        if (item->crl) {
-          X509_STORE_add_crl(store, item->crl);
-          has_crl = true;
-        }
-      }
-      if (ca_cert_ == nullptr) {
-        return absl::InvalidArgumentError(
-            absl::StrCat("Failed to load trusted CA certificates from ", config_->caCertPath()));
-      }
-      if (has_crl) {
-        X509_STORE_set_flags(store, config_->onlyVerifyLeafCertificateCrl()
-                                        ? X509_V_FLAG_CRL_CHECK
-                                        : X509_V_FLAG_CRL_CHECK | X509_V_FLAG_CRL_CHECK_ALL);
-      }
-      verify_mode = SSL_VERIFY_PEER;
-      verify_trusted_ca_ = true;
-
-      if (config_->allowExpiredCertificate()) {
-        X509_STORE_set_flags(store, X509_V_FLAG_NO_CHECK_TIME);
-      }
+      // SSL_CTX_set_cert_store takes ownership of the reference.
+      X509_STORE_up_ref(trusted_ca_store_->store.get());
+      SSL_CTX_set_cert_store(ctx, trusted_ca_store_->store.get());
     }
+    verify_mode = SSL_VERIFY_PEER;
+    verify_trusted_ca_ = true;
   }
 
   // Disallow insecure configuration.
@@ -191,16 +268,10 @@ absl::StatusOr<int> DefaultCertValidator::initializeSslContexts(std::vector<SSL_
         "'auto_sni_san_validation' was configured without configuring a trusted CA");
   }
 
-  if (config_ != nullptr && !config_->certificateRevocationList().empty()) {
-    // Parse the CRL through a process-wide cache so that identical CRL content
-    // referenced from many TLS contexts is materialized in memory only once. The
-    // returned CrlList keeps the cache alive, so no separate reference is needed.
-    std::shared_ptr<CrlCache> crl_cache = getCrlCache(context_.singletonManager());
-    absl::StatusOr<CrlListSharedPtr> crl_list_or_error = crl_cache->getOrCreate(
-        config_->certificateRevocationList(), config_->certificateRevocationListPath());
-    RETURN_IF_NOT_OK_REF(crl_list_or_error.status());
-    shared_crl_ = std::move(*crl_list_or_error);
-
+  // Without a trusted CA store the CRL is added to the own store of each context.
+  if (config_ != nullptr && !config_->certificateRevocationList().empty() &&
+      trusted_ca_store_ == nullptr) {
+    RETURN_IF_NOT_OK(loadSharedCrl());
     for (auto& ctx : contexts) {
       X509_STORE* store = SSL_CTX_get_cert_store(ctx);
       X509_STORE_set_flags(store, X509_V_FLAG_PARTIAL_CHAIN);
@@ -260,6 +331,21 @@ absl::StatusOr<int> DefaultCertValidator::initializeSslContexts(std::vector<SSL_
   return verify_mode;
 }
 
+absl::Status DefaultCertValidator::loadSharedCrl() {
+  if (shared_crl_ != nullptr) {
+    return absl::OkStatus();
+  }
+  // Parse the CRL through a process-wide cache so that identical CRL content
+  // referenced from many TLS contexts is materialized in memory only once. The
+  // returned CrlList keeps the cache alive, so no separate reference is needed.
+  std::shared_ptr<CrlCache> crl_cache = getCrlCache(context_.singletonManager());
+  absl::StatusOr<CrlListSharedPtr> crl_list_or_error = crl_cache->getOrCreate(
+      config_->certificateRevocationList(), config_->certificateRevocationListPath());
+  RETURN_IF_NOT_OK_REF(crl_list_or_error.status());
+  shared_crl_ = std::move(*crl_list_or_error);
+  return absl::OkStatus();
+}
+
 bool DefaultCertValidator::verifyCertAndUpdateStatus(
     X509* leaf_cert, absl::string_view sni,
     const Network::TransportSocketOptions* transport_socket_options,
@@ -90,6 +90,52 @@ private:
 // Returns the process-wide CRL cache, creating it on first use.
 std::shared_ptr<CrlCache> getCrlCache(Singleton::Manager& singleton_manager);
 
+class TrustedCaStoreCache;
+
+// A fully populated X509_STORE for one trusted CA bundle: the CA certificates
+// and CRLs of the bundle, the CRLs of `certificate_revocation_list` and the
+// verification flags. Every SSL_CTX of every TLS context configured with the
+// same trust material takes a reference to this one store instead of parsing
+// the bundle and filling a store of its own.
+struct TrustedCaStore {
+  bssl::UniquePtr<X509_STORE> store;
+  // The first CA certificate of the bundle, reported by the validator.
+  bssl::UniquePtr<X509> ca_cert;
+  CrlListSharedPtr crl;
+  std::shared_ptr<TrustedCaStoreCache> cache;
+};
+using TrustedCaStoreSharedPtr = std::shared_ptr<TrustedCaStore>;
+
+// Process-wide cache of the trusted CA stores, keyed by a SHA-256 digest of the
+// CA bundle, of the CRL and of the options that change the store flags. It
+// follows the threading and lifetime model of CrlCache: main thread only, weak
+// entries, and each TrustedCaStore keeps the cache alive.
+//
+// A shared store is never modified once built. BoringSSL reference counts
+// X509_STORE and locks its lookups, so it can be used by several SSL_CTXs on
+// all the workers.
+class TrustedCaStoreCache : public Singleton::Instance,
+                            public std::enable_shared_from_this<TrustedCaStoreCache> {
+public:
+  // Returns the shared store for the trust material of `config`, building it
+  // on first use. `crl` holds the parsed `certificate_revocation_list` of
+  // `config`, or is null if it has none. Returns an error if the CA bundle
+  // cannot be parsed or contains no certificate.
+  absl::StatusOr<TrustedCaStoreSharedPtr>
+  getOrCreate(const Envoy::Ssl::CertificateValidationContextConfig& config, CrlListSharedPtr crl);
+
+  // Number of distinct stores currently referenced by at least one context.
+  // Exposed for testing.
+  size_t size() const;
+
+private:
+  absl::flat_hash_map<std::array<uint8_t, SHA256_DIGEST_LENGTH>, std::weak_ptr<TrustedCaStore>>
+      cache_;
+};
+
+// Returns the process-wide trusted CA store cache, creating it on first use.
+std::shared_ptr<TrustedCaStoreCache> getTrustedCaStoreCache(Singleton::Manager& singleton_manager);
+
 class DefaultCertValidator : public CertValidator, Logger::Loggable<Logger::Id::connection> {
 public:
   DefaultCertValidator(const Envoy::Ssl::CertificateValidationContextConfig* config,
@@ -170,6 +216,9 @@ private:
                                  Envoy::Ssl::ClientValidationStatus& detailed_status,
                                  std::string* error_details, uint8_t* out_alert);
 
+  // Sets shared_crl_ from the process-wide CRL cache, if not set yet.
+  absl::Status loadSharedCrl();
+
   void initializeCertExpirationStats(Stats::Scope& scope);
   const Envoy::Ssl::CertificateValidationContextConfig* config_;
   SslStats& stats_;
@@ -182,6 +231,9 @@ private:
   // The parsed CRLs shared with other TLS contexts that reference the same CRL.
   // This also keeps the CRL cache alive for as long as the validator uses it.
   CrlListSharedPtr shared_crl_;
+  // The trusted CA store shared with other TLS contexts that reference the same
+  // CA bundle, CRL and verification options.
+  TrustedCaStoreSharedPtr trusted_ca_store_;
   bool allow_untrusted_certificate_{false};
   bool verify_trusted_ca_{false};
   const bool auto_sni_san_match_{false};
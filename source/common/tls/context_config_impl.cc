@@ -223,6 +223,7 @@ ContextConfigImpl::ContextConfigImpl(
       max_protocol_version_(tlsVersionFromProto(config.tls_params().tls_maximum_protocol_version(),
                                                 default_max_protocol_version)),
       factory_context_(factory_context), tls_keylog_path_(config.key_log().path()),
+      kernel_tls_offload_(config.kernel_tls_offload()),
       compliance_policy_(compliancePolicyFromProto(config.tls_params())) {
   SET_AND_RETURN_IF_NOT_OK(creation_status, creation_status);
   auto list_or_error = Network::Address::IpList::create(config.key_log().local_address_range());
@@ -438,6 +439,13 @@ ClientContextConfigImpl::ClientContextConfigImpl(
     return;
   }
 
+  // A renegotiation would need BoringSSL to write records once the kernel encrypts them.
+  if (allow_renegotiation_ && config.common_tls_context().kernel_tls_offload()) {
+    creation_status = absl::InvalidArgumentError(
+        "'kernel_tls_offload' cannot be combined with 'allow_renegotiation'");
+    return;
+  }
+
   // TODO(PiotrSikora): Support multiple TLS certificates.
   if ((config.common_tls_context().tls_certificates().size() +
        config.common_tls_context().tls_certificate_sds_secret_configs().size()) > 1 &&
@@ -65,6 +65,7 @@ public:
   AccessLog::AccessLogManager& accessLogManager() const override {
     return factory_context_.serverFactoryContext().accessLogManager();
   }
+  bool kernelTlsOffload() const override { return kernel_tls_offload_; }
 
   bool isReady() const override {
     const bool tls_is_ready =
@@ -134,6 +135,7 @@ private:
   const std::string tls_keylog_path_;
   std::unique_ptr<Network::Address::IpList> tls_keylog_local_;
   std::unique_ptr<Network::Address::IpList> tls_keylog_remote_;
+  const bool kernel_tls_offload_;
   const std::optional<
       envoy::extensions::transport_sockets::tls::v3::TlsParameters::CompliancePolicy>
       compliance_policy_;
@@ -1,5 +1,7 @@
 #include "source/common/tls/default_tls_certificate_selector.h"
 
+#include <algorithm>
+
 #include "source/common/tls/utility.h"
 
 namespace Envoy {
@@ -13,6 +15,7 @@ DefaultTlsCertificateSelector::DefaultTlsCertificateSelector(
       tls_contexts_(selector_ctx.getTlsContexts()), ocsp_staple_policy_(config.ocspStaplePolicy()),
       full_scan_certs_on_sni_mismatch_(config.fullScanCertsOnSNIMismatch()) {
   for (auto& ctx : tls_contexts_) {
+    contexts_by_curve_[ctx.ec_group_curve_name_].push_back(&ctx);
     if (ctx.cert_chain_ == nullptr) {
       continue;
     }
@@ -39,7 +42,8 @@ void DefaultTlsCertificateSelector::populateServerNamesMap(const Ssl::TlsContext
     PkeyTypesMap pkey_types_map;
     // Multiple certs with different key type are allowed for one server name pattern.
     auto sn_match = server_names_map_.try_emplace(sn_pattern, pkey_types_map).first;
-    auto pt_match = sn_match->second.find(pkey_id);
+    auto pt_match = std::find_if(sn_match->second.begin(), sn_match->second.end(),
+                                 [pkey_id](const auto& entry) { return entry.first == pkey_id; });
     if (pt_match != sn_match->second.end()) {
       // When there are duplicate names, prefer the earlier one.
       //
@@ -48,8 +52,7 @@ void DefaultTlsCertificateSelector::populateServerNamesMap(const Ssl::TlsContext
       // implemented.
       return;
     }
-    sn_match->second.emplace(
-        std::pair<int, std::reference_wrapper<const Ssl::TlsContext>>(pkey_id, ctx));
+    sn_match->second.emplace_back(pkey_id, ctx);
   };
 
   bssl::UniquePtr<GENERAL_NAMES> san_names(static_cast<GENERAL_NAMES*>(
@@ -266,16 +269,25 @@ DefaultTlsCertificateSelector::findTlsContext(absl::string_view sni,
   // Full scan certs if SNI is not provided by client;
   // Full scan certs if client provides SNI but no cert matches to it,
   // it requires full_scan_certs_on_sni_mismatch is enabled.
+  // The scan selects the first cert, in configuration order, with a curve supported by an
+  // ECDSA-capable client, and otherwise the first non-ECDSA cert, so it only needs to look at the
+  // first allowed cert of each of these curves.
   if (selected_ctx == nullptr) {
     candidate_ctx = nullptr;
-    // Skip loop when there is no cert compatible to key type
-    if (client_ecdsa_capable || (!client_ecdsa_capable && has_rsa_)) {
-      for (const auto& ctx : tls_contexts_) {
-        if (selected(ctx)) {
-          break;
-        }
+    for (const Ssl::CurveNID curve : client_ecdsa_capabilities) {
+      const Ssl::TlsContext* ctx = firstAllowedContext(curve, client_ocsp_capable);
+      if (ctx != nullptr && (selected_ctx == nullptr || ctx < selected_ctx)) {
+        selected_ctx = ctx;
       }
     }
+    // Skip lookup when there is no cert compatible to key type
+    if (selected_ctx == nullptr && (client_ecdsa_capable || has_rsa_)) {
+      selected_ctx = firstAllowedContext(Ssl::EC_CURVE_INVALID_NID, client_ocsp_capable);
+    }
+    if (selected_ctx != nullptr) {
+      ocsp_staple_action =
+          ocspStapleAction(*selected_ctx, client_ocsp_capable, ocsp_staple_policy_);
+    }
     tail_select(false);
   }
 
@@ -283,6 +295,22 @@ DefaultTlsCertificateSelector::findTlsContext(absl::string_view sni,
   return {*selected_ctx, ocsp_staple_action};
 }
 
+const Ssl::TlsContext*
+DefaultTlsCertificateSelector::firstAllowedContext(Ssl::CurveNID curve,
+                                                   bool client_ocsp_capable) const {
+  auto it = contexts_by_curve_.find(curve);
+  if (it == contexts_by_curve_.end()) {
+    return nullptr;
+  }
+  for (const Ssl::TlsContext* ctx : it->second) {
+    if (ocspStapleAction(*ctx, client_ocsp_capable, ocsp_staple_policy_) !=
+        Ssl::OcspStapleAction::Fail) {
+      return ctx;
+    }
+  }
+  return nullptr;
+}
+
 } // namespace Tls
 } // namespace TransportSockets
 } // namespace Extensions
@@ -8,6 +8,9 @@
 #include "source/common/tls/server_context_impl.h"
 #include "source/common/tls/stats.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
@@ -40,20 +43,29 @@ public:
 
 private:
   // Currently, at most one certificate of a given key type may be specified for each exact
-  // server name or wildcard domain name.
-  using PkeyTypesMap = absl::flat_hash_map<int, std::reference_wrapper<const Ssl::TlsContext>>;
+  // server name or wildcard domain name, so there are rarely more than two entries. An inlined
+  // vector keeps the map small with tens of thousands of server names.
+  using PkeyTypesMap =
+      absl::InlinedVector<std::pair<int, std::reference_wrapper<const Ssl::TlsContext>>, 2>;
   // Both exact server names and wildcard domains are part of the same map, in which wildcard
   // domains are prefixed with "." (i.e. ".example.com" for "*.example.com") to differentiate
   // between exact and wildcard entries.
   using ServerNamesMap = absl::flat_hash_map<std::string, PkeyTypesMap>;
+  // The contexts in configuration order, grouped by the curve of their ECDSA certificate, with
+  // EC_CURVE_INVALID_NID for the other key types. Used instead of scanning all the contexts when
+  // no server name matches.
+  using CurveContextsMap = absl::flat_hash_map<Ssl::CurveNID, std::vector<const Ssl::TlsContext*>>;
 
   void populateServerNamesMap(const Ssl::TlsContext& ctx, const int pkey_id);
+  // Returns the first context of the group that the OCSP staple policy does not reject.
+  const Ssl::TlsContext* firstAllowedContext(Ssl::CurveNID curve, bool client_ocsp_capable) const;
 
   // ServerContext own this selector, it's safe to use itself here.
   ServerContextImpl& server_ctx_;
   const std::vector<Ssl::TlsContext>& tls_contexts_;
 
   ServerNamesMap server_names_map_;
+  CurveContextsMap contexts_by_curve_;
   bool has_rsa_{false};
 
   const Ssl::ServerContextConfig::OcspStaplePolicy ocsp_staple_policy_;
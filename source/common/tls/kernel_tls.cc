@@ -0,0 +1,146 @@
+#include "source/common/tls/kernel_tls.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "envoy/common/platform.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/network/io_socket_error_impl.h"
+
+#include "absl/types/span.h"
+#include "openssl/mem.h"
+
+#if defined(__linux__) && !defined(ENVOY_SSL_OPENSSL)
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+
+#define ENVOY_KERNEL_TLS_SUPPORTED 1
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+#ifdef ENVOY_KERNEL_TLS_SUPPORTED
+
+namespace {
+
+// TLS record content type of alerts.
+constexpr uint8_t AlertContentType = 21;
+
+void storeBigEndian(uint64_t value, unsigned char* out) {
+  for (int i = 7; i >= 0; --i) {
+    out[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+template <class CryptoInfo>
+bool setTransmitKey(Network::IoHandle& io_handle, uint16_t cipher_type,
+                    absl::Span<const uint8_t> key, absl::Span<const uint8_t> salt,
+                    uint64_t sequence) {
+  CryptoInfo info{};
+  ASSERT(key.size() == sizeof(info.key) && salt.size() == sizeof(info.salt));
+  info.info.version = TLS_1_2_VERSION;
+  info.info.cipher_type = cipher_type;
+  memcpy(info.key, key.data(), sizeof(info.key));
+  memcpy(info.salt, salt.data(), sizeof(info.salt));
+  // BoringSSL uses the sequence number as the explicit nonce of TLS 1.2 AES-GCM records, and the
+  // kernel increments both from the values given here.
+  storeBigEndian(sequence, info.iv);
+  storeBigEndian(sequence, info.rec_seq);
+  const bool ok = io_handle.setOption(SOL_TLS, TLS_TX, &info, sizeof(info)).return_value_ == 0;
+  OPENSSL_cleanse(&info, sizeof(info));
+  return ok;
+}
+
+} // namespace
+
+bool enableTransmit(SSL* ssl, Network::IoHandle& io_handle) {
+  if (SSL_version(ssl) != TLS1_2_VERSION) {
+    return false;
+  }
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  if (cipher == nullptr) {
+    return false;
+  }
+  size_t key_length;
+  switch (SSL_CIPHER_get_cipher_nid(cipher)) {
+  case NID_aes_128_gcm:
+    key_length = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+    break;
+  case NID_aes_256_gcm:
+    key_length = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+    break;
+  default:
+    return false;
+  }
+  static_assert(TLS_CIPHER_AES_GCM_128_SALT_SIZE == TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+  constexpr size_t salt_length = TLS_CIPHER_AES_GCM_128_SALT_SIZE;
+
+  // The key block of an AEAD cipher has no MAC keys: it is the client key, the server key, the
+  // client implicit nonce and the server implicit nonce.
+  std::vector<uint8_t> block(SSL_get_key_block_len(ssl));
+  if (block.size() != 2 * (key_length + salt_length) ||
+      !SSL_generate_key_block(ssl, block.data(), block.size())) {
+    return false;
+  }
+  const bool is_server = SSL_is_server(ssl);
+  const absl::Span<const uint8_t> key(block.data() + (is_server ? key_length : 0), key_length);
+  const absl::Span<const uint8_t> salt(
+      block.data() + 2 * key_length + (is_server ? salt_length : 0), salt_length);
+  const uint64_t sequence = SSL_get_write_sequence(ssl);
+
+  // Without TLS_TX, a socket with the tls upper layer protocol behaves as a plain TCP socket, so
+  // a failure after this point leaves the connection usable by BoringSSL.
+  bool enabled = io_handle.setOption(IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")).return_value_ == 0;
+  if (enabled) {
+    enabled = key_length == TLS_CIPHER_AES_GCM_128_KEY_SIZE
+                  ? setTransmitKey<tls12_crypto_info_aes_gcm_128>(
+                        io_handle, TLS_CIPHER_AES_GCM_128, key, salt, sequence)
+                  : setTransmitKey<tls12_crypto_info_aes_gcm_256>(
+                        io_handle, TLS_CIPHER_AES_GCM_256, key, salt, sequence);
+  }
+  OPENSSL_cleanse(block.data(), block.size());
+  return enabled;
+}
+
+Api::IoCallUint64Result sendCloseNotify(Network::IoHandle& io_handle) {
+  if (!io_handle.isOpen()) {
+    return {0, Network::IoSocketError::getIoSocketEbadfError()};
+  }
+  // Warning level (1), close_notify (0).
+  uint8_t alert[] = {1, 0};
+  const Buffer::RawSlice slice{alert, sizeof(alert)};
+  // The kernel sends the data as a single record of the content type given in the control message.
+  const uint8_t record_type = AlertContentType;
+  return io_handle.sendWithControlMessage(&slice, 1, SOL_TLS, TLS_SET_RECORD_TYPE,
+                                          absl::MakeConstSpan(&record_type, 1));
+}
+
+#else
+
+bool enableTransmit(SSL*, Network::IoHandle&) { return false; }
+
+Api::IoCallUint64Result sendCloseNotify(Network::IoHandle&) {
+  return {0, Network::IoSocketError::create(SOCKET_ERROR_NOT_SUP)};
+}
+
+#endif
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
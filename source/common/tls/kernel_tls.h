@@ -0,0 +1,43 @@
+#pragma once
+
+#include "envoy/api/io_error.h"
+#include "envoy/network/io_handle.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+/**
+ * Hands the encryption of the records sent on a connection over to the kernel TLS (kTLS) socket
+ * layer, so that the application data can be written to the socket in plain text, and sent
+ * without being copied through a userspace encryption buffer.
+ *
+ * Only TLS 1.2 connections that negotiated AES-128-GCM or AES-256-GCM are supported: TLS 1.3
+ * key updates and TLS 1.2 renegotiations require BoringSSL to keep writing records after the
+ * handshake. The connection must not have sent any record since its handshake completed. Once
+ * this returns true, BoringSSL must no longer write to the socket.
+ *
+ * @param ssl the connection, whose handshake is complete.
+ * @param io_handle the socket of the connection.
+ * @return whether the kernel now encrypts the records sent on the socket. On false, nothing was
+ *         changed and the connection keeps using BoringSSL.
+ */
+bool enableTransmit(SSL* ssl, Network::IoHandle& io_handle);
+
+/**
+ * Sends a close_notify alert on a socket for which enableTransmit() returned true.
+ * @param io_handle the socket of the connection.
+ * @return the result of the write, which fails with EBADF if the socket is already closed and
+ *         with NoSupport if the handle is not backed by a kernel socket.
+ */
+Api::IoCallUint64Result sendCloseNotify(Network::IoHandle& io_handle);
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -27,6 +27,7 @@
 #include "source/common/runtime/runtime_features.h"
 #include "source/common/stats/utility.h"
 #include "source/common/tls/cert_validator/factory.h"
+#include "source/common/tls/session_store.h"
 #include "source/common/tls/stats.h"
 #include "source/common/tls/utility.h"
 
@@ -186,6 +187,17 @@ ServerContextImpl::ServerContextImpl(
 
     if (config.disableStatefulSessionResumption()) {
       SSL_CTX_set_session_cache_mode(ctx.ssl_ctx_.get(), SSL_SESS_CACHE_OFF);
+    } else if (SessionStoreSingleton::getExisting() != nullptr &&
+               !config.capabilities().handles_session_resumption) {
+      // Also keep the sessions in the store shared by all the contexts, and possibly by the
+      // processes of a hot restart, so that they can be resumed on another context with the same
+      // session ID context and after a context update. The cache of this SSL_CTX is kept for the
+      // sessions the store drops, e.g. those carrying a large peer certificate chain. There is no
+      // remove callback: that cache also calls it for the sessions it evicts and when its SSL_CTX
+      // is freed, while other contexts can still resume them. The store replaces expired sessions
+      // as it fills, and BoringSSL does not resume them in the meantime.
+      SSL_CTX_sess_set_new_cb(ctx.ssl_ctx_.get(), &ServerContextImpl::storeSession);
+      SSL_CTX_sess_set_get_cb(ctx.ssl_ctx_.get(), &ServerContextImpl::lookupStoredSession);
     }
 
     if (config.sessionTimeout() && !config.capabilities().handles_session_resumption) {
@@ -335,6 +347,44 @@ ServerContextImpl::generateHashForSessionContextId(const std::vector<std::string
   return session_id;
 }
 
+int ServerContextImpl::storeSession(SSL* ssl, SSL_SESSION* session) {
+  Ssl::SessionStore* store = SessionStoreSingleton::getExisting();
+  if (store == nullptr) {
+    return 0;
+  }
+  uint8_t* bytes;
+  size_t length;
+  if (!SSL_SESSION_to_bytes(session, &bytes, &length)) {
+    return 0;
+  }
+  unsigned int session_id_length;
+  const uint8_t* session_id = SSL_SESSION_get_id(session, &session_id_length);
+  if (!store->insert({session_id, session_id_length}, {bytes, length})) {
+    // The session can only be resumed from the cache of this context.
+    static_cast<ContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)))
+        ->stats()
+        .shared_session_cache_dropped_.inc();
+  }
+  OPENSSL_free(bytes);
+  // The session is not retained, so BoringSSL keeps its reference.
+  return 0;
+}
+
+SSL_SESSION* ServerContextImpl::lookupStoredSession(SSL* ssl, const uint8_t* session_id,
+                                                    int session_id_length, int* out_copy) {
+  // The returned session is a new reference, owned by the caller.
+  *out_copy = 0;
+  Ssl::SessionStore* store = SessionStoreSingleton::getExisting();
+  std::vector<uint8_t> bytes;
+  if (store == nullptr ||
+      !store->lookup({session_id, static_cast<size_t>(session_id_length)}, bytes)) {
+    return nullptr;
+  }
+  // BoringSSL then checks that the session ID context, version and lifetime of the session allow
+  // resuming it on this connection.
+  return SSL_SESSION_from_bytes(bytes.data(), bytes.size(), SSL_get_SSL_CTX(ssl));
+}
+
 int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv,
                                             EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx, int encrypt) {
   const EVP_MD* hmac = EVP_sha256();
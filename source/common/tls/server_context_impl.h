@@ -90,6 +90,11 @@ private:
   absl::StatusOr<SessionContextID>
   generateHashForSessionContextId(const std::vector<std::string>& server_names);
 
+  // Session cache callbacks of the contexts keeping their sessions in the SessionStoreSingleton.
+  static int storeSession(SSL* ssl, SSL_SESSION* session);
+  static SSL_SESSION* lookupStoredSession(SSL* ssl, const uint8_t* session_id,
+                                          int session_id_length, int* out_copy);
+
   Ssl::TlsCertificateSelectorPtr tls_certificate_selector_;
   const std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey> session_ticket_keys_;
 
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "envoy/ssl/session_store.h"
+
+#include "source/common/singleton/threadsafe_singleton.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+// The store of the TLS server sessions shared by all the server contexts of the process, when the
+// server installs one. Otherwise each context caches its sessions itself.
+using SessionStoreSingleton = InjectableSingleton<Ssl::SessionStore>;
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
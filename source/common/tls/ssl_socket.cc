@@ -8,6 +8,7 @@
 #include "source/common/http/headers.h"
 #include "source/common/runtime/runtime_features.h"
 #include "source/common/tls/io_handle_bio.h"
+#include "source/common/tls/kernel_tls.h"
 #include "source/common/tls/ssl_handshaker.h"
 #include "source/common/tls/utility.h"
 
@@ -203,6 +204,18 @@ void SslSocket::onSuccess(SSL* ssl) {
         callbacks_->connection().dispatcher().timeSource());
   }
 
+  if (ctx_->kernelTlsOffload()) {
+    if (KernelTls::enableTransmit(ssl, callbacks_->ioHandle())) {
+      kernel_tls_tx_ = true;
+      // An alert written by BoringSSL, e.g. on a failed read, would carry a stale sequence number
+      // now, so it is dropped instead of being sent.
+      SSL_set0_wbio(ssl, BIO_new(BIO_s_mem()));
+      ctx_->stats().kernel_tls_offload_.inc();
+    } else {
+      ctx_->stats().kernel_tls_offload_unavailable_.inc();
+    }
+  }
+
   // There is at least one assertion that reads are enabled when the connected event is raised, so
   // ensure we are in the correct state. The same operation would happen in
   // `SslSocket::doHandshake()`, but it wouldn't happen until after the event was raised.
@@ -337,6 +350,10 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  if (kernel_tls_tx_) {
+    return doKernelTlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
@@ -387,6 +404,32 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  // The kernel splits the data into records, so it is written as is, without the linearization
+  // into 16KiB chunks that SSL_write() needs.
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    Api::IoCallUint64Result result = callbacks_->ioHandle().write(write_buffer);
+    if (!result.ok()) {
+      if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        return {PostIoAction::KeepOpen, total_bytes_written, false};
+      }
+      ENVOY_CONN_LOG(trace, "kernel TLS write error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      return {PostIoAction::Close, total_bytes_written, false, result.err_->getErrorCode()};
+    }
+    ENVOY_CONN_LOG(trace, "kernel TLS write returns: {}", callbacks_->connection(),
+                   result.return_value_);
+    total_bytes_written += result.return_value_;
+  }
+
+  if (end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
 void SslSocket::onConnected() {
   ASSERT(info_->state() == Ssl::SocketState::HandshakeWaitingForConnectionData);
 }
@@ -397,6 +440,14 @@ void SslSocket::shutdownSsl() {
   ASSERT(info_->state() != Ssl::SocketState::HandshakeWaitingForConnectionData);
   if (info_->state() != Ssl::SocketState::ShutdownSent &&
       callbacks_->connection().state() != Network::Connection::State::Closed) {
+    if (kernel_tls_tx_) {
+      // SSL_shutdown() would write the alert with the keys now held by the kernel.
+      const Api::IoCallUint64Result result = KernelTls::sendCloseNotify(callbacks_->ioHandle());
+      ENVOY_CONN_LOG(debug, "kernel TLS shutdown: rc={} error={}", callbacks_->connection(),
+                     result.return_value_, result.ok() ? "" : result.err_->getErrorDetails());
+      info_->setState(Ssl::SocketState::ShutdownSent);
+      return;
+    }
     int rc = SSL_shutdown(rawSsl());
     if constexpr (Event::PlatformDefaultTriggerType == Event::FileTriggerType::EmulatedEdge) {
       // Windows operate under `EmulatedEdge`. These are level events that are artificially
@@ -96,6 +96,7 @@ private:
   ReadResult sslReadIntoSlice(Buffer::RawSlice& slice);
 
   Network::PostIoAction doHandshake();
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
   void drainErrorQueue();
   void shutdownSsl();
   void shutdownBasic();
@@ -108,6 +109,8 @@ private:
   std::string failure_reason_;
   std::optional<Api::IoError::IoErrorCode> detected_io_error_;
   bool read_disabled_{false};
+  // Whether the kernel encrypts the records sent on the connection.
+  bool kernel_tls_tx_{false};
 
   SslHandshakerImplSharedPtr info_;
 };
@@ -20,7 +20,10 @@ namespace Tls {
   COUNTER(ocsp_staple_failed)                                                                      \
   COUNTER(ocsp_staple_omitted)                                                                     \
   COUNTER(ocsp_staple_responses)                                                                   \
-  COUNTER(ocsp_staple_requests)
+  COUNTER(ocsp_staple_requests)                                                                    \
+  COUNTER(kernel_tls_offload)                                                                      \
+  COUNTER(kernel_tls_offload_unavailable)                                                          \
+  COUNTER(shared_session_cache_dropped)
 /**
  * Wrapper struct for SSL stats. @see stats_macros.h
  */
@@ -57,9 +57,14 @@ namespace Envoy {
 namespace Upstream {
 namespace {
 
+// Appends the options in to_add, if any. The options are only allocated once there is something to
+// add, so that the common case of requests without socket options doesn't allocate.
 void addOptionsIfNotNull(Network::Socket::OptionsSharedPtr& options,
                          const Network::Socket::OptionsSharedPtr& to_add) {
-  if (to_add != nullptr) {
+  if (to_add != nullptr && !to_add->empty()) {
+    if (options == nullptr) {
+      options = std::make_shared<Network::Socket::Options>();
+    }
     Network::Socket::appendOptions(options, to_add);
   }
 }
@@ -2134,6 +2139,32 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::~ClusterEntry()
   drainConnPools();
 }
 
+const ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::HttpPoolKey&
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpPoolKey(
+    const Host& host, std::optional<Http::Protocol> downstream_protocol, HttpPoolKey& storage) {
+  // The protocols only depend on the cluster configuration. Hosts are expected to belong to this
+  // cluster, but don't rely on it for the cache.
+  const bool cacheable = &host.cluster() == cluster_info_.get();
+  const size_t index = downstream_protocol.has_value()
+                           ? static_cast<size_t>(downstream_protocol.value()) + 1
+                           : 0;
+  if (cacheable && http_pool_keys_[index].has_value()) {
+    return http_pool_keys_[index].value();
+  }
+
+  // Right now, HTTP, HTTP/2 and ALPN pools are considered separate.
+  // We could do better here, and always use the ALPN pool and simply make sure
+  // we end up on a connection of the correct protocol, but for simplicity we're
+  // starting with something simpler.
+  HttpPoolKey& key = cacheable ? http_pool_keys_[index].emplace() : storage;
+  key.upstream_protocols_ = host.cluster().upstreamHttpProtocol(downstream_protocol);
+  key.hash_key_.reserve(key.upstream_protocols_.size());
+  for (auto protocol : key.upstream_protocols_) {
+    key.hash_key_.push_back(uint8_t(protocol));
+  }
+  return key;
+}
+
 Http::ConnectionPool::Instance*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImpl(
     HostConstSharedPtr host, ResourcePriority priority,
@@ -2141,21 +2172,10 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
   if (!host) {
     return nullptr;
   }
-  // Right now, HTTP, HTTP/2 and ALPN pools are considered separate.
-  // We could do better here, and always use the ALPN pool and simply make sure
-  // we end up on a connection of the correct protocol, but for simplicity we're
-  // starting with something simpler.
-  auto upstream_protocols = host->cluster().upstreamHttpProtocol(downstream_protocol);
-  std::vector<uint8_t> hash_key;
-  hash_key.reserve(upstream_protocols.size());
-  for (auto protocol : upstream_protocols) {
-    hash_key.push_back(uint8_t(protocol));
-  }
+  HttpPoolKey uncached_key;
+  const HttpPoolKey& base_key = httpPoolKey(*host, downstream_protocol, uncached_key);
 
-  std::optional<envoy::config::core::v3::AlternateProtocolsCacheOptions>
-      alternate_protocol_options =
-          host->cluster().httpProtocolOptions().alternateProtocolsCacheOptions();
-  Network::Socket::OptionsSharedPtr upstream_options(std::make_shared<Network::Socket::Options>());
+  Network::Socket::OptionsSharedPtr upstream_options;
   if (context) {
     // Inherit socket options from downstream connection, if set.
     if (context->downstreamConnection()) {
@@ -2163,25 +2183,40 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
     }
     addOptionsIfNotNull(upstream_options, context->upstreamSocketOptions());
   }
+  const bool have_transport_socket_options =
+      context != nullptr && context->upstreamTransportSocketOptions() != nullptr;
+  const bool pool_per_downstream_connection =
+      cluster_info_->connectionPoolPerDownstreamConnection() && context != nullptr &&
+      context->downstreamConnection() != nullptr;
+
+  // Requests without socket options, transport socket options or per downstream connection pools
+  // use the cached protocol key as is. Otherwise the key is extended with the hash of each.
+  const bool extend_key = upstream_options != nullptr || have_transport_socket_options ||
+                          pool_per_downstream_connection;
+  std::vector<uint8_t> extended_key;
+  if (extend_key) {
+    extended_key = base_key.hash_key_;
+
+    // Use the socket options for computing connection pool hash key, if any.
+    // This allows socket options to control connection pooling so that connections with
+    // different options are not pooled together.
+    if (upstream_options != nullptr) {
+      for (const auto& option : *upstream_options) {
+        option->hashKey(extended_key);
+      }
+    }
 
-  // Use the socket options for computing connection pool hash key, if any.
-  // This allows socket options to control connection pooling so that connections with
-  // different options are not pooled together.
-  for (const auto& option : *upstream_options) {
-    option->hashKey(hash_key);
-  }
-
-  bool have_transport_socket_options = false;
-  if (context && context->upstreamTransportSocketOptions()) {
-    host->transportSocketFactory().hashKey(hash_key, context->upstreamTransportSocketOptions());
-    have_transport_socket_options = true;
-  }
+    if (have_transport_socket_options) {
+      host->transportSocketFactory().hashKey(extended_key,
+                                             context->upstreamTransportSocketOptions());
+    }
 
-  // If configured, use the downstream connection id in pool hash key
-  if (cluster_info_->connectionPoolPerDownstreamConnection() && context &&
-      context->downstreamConnection()) {
-    context->downstreamConnection()->hashKey(hash_key);
+    // If configured, use the downstream connection id in pool hash key
+    if (pool_per_downstream_connection) {
+      context->downstreamConnection()->hashKey(extended_key);
+    }
   }
+  const std::vector<uint8_t>& hash_key = extend_key ? extended_key : base_key.hash_key_;
 
   ConnPoolsContainer& container = *parent_.getHttpConnPoolsContainer(host, true);
 
@@ -2189,9 +2224,11 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
   // function. Otherwise, we'd need to capture a few of these variables by value.
   ConnPoolsContainer::ConnPools::PoolOptRef pool =
       container.pools_->getPool(priority, hash_key, [&]() {
+        std::vector<Http::Protocol> upstream_protocols = base_key.upstream_protocols_;
         auto pool = parent_.parent_.factory_.allocateConnPool(
             parent_.thread_local_dispatcher_, host, priority, upstream_protocols,
-            alternate_protocol_options, !upstream_options->empty() ? upstream_options : nullptr,
+            host->cluster().httpProtocolOptions().alternateProtocolsCacheOptions(),
+            upstream_options,
             have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr,
             parent_.parent_.time_source_, parent_.cluster_manager_state_, quic_info_,
             parent_.getNetworkObserverRegistry());
@@ -2293,7 +2330,7 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPoolImpl
   // Use downstream connection socket options for computing connection pool hash key, if any.
   // This allows socket options to control connection pooling so that connections with
   // different options are not pooled together.
-  Network::Socket::OptionsSharedPtr upstream_options(std::make_shared<Network::Socket::Options>());
+  Network::Socket::OptionsSharedPtr upstream_options;
   if (context) {
     if (context->downstreamConnection()) {
       addOptionsIfNotNull(upstream_options, context->downstreamConnection()->socketOptions());
@@ -2301,8 +2338,10 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPoolImpl
     addOptionsIfNotNull(upstream_options, context->upstreamSocketOptions());
   }
 
-  for (const auto& option : *upstream_options) {
-    option->hashKey(hash_key);
+  if (upstream_options != nullptr) {
+    for (const auto& option : *upstream_options) {
+      option->hashKey(hash_key);
+    }
   }
 
   // If configured, use the downstream connection id in pool hash key
@@ -2329,8 +2368,7 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPoolImpl
     std::tie(pool_iter, inserted) = container.pools_.emplace(
         hash_key,
         parent_.parent_.factory_.allocateTcpConnPool(
-            parent_.thread_local_dispatcher_, host, priority,
-            !upstream_options->empty() ? upstream_options : nullptr,
+            parent_.thread_local_dispatcher_, host, priority, upstream_options,
             have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr,
             parent_.cluster_manager_state_, cluster_info_->tcpPoolIdleTimeout()));
     ASSERT(inserted);
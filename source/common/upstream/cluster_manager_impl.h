@@ -689,6 +689,19 @@ private:
         const HostMapConstSharedPtr cross_priority_host_map_;
       };
 
+      // The upstream protocols for a downstream protocol and the corresponding prefix of the HTTP
+      // connection pool hash key.
+      struct HttpPoolKey {
+        std::vector<Http::Protocol> upstream_protocols_;
+        std::vector<uint8_t> hash_key_;
+      };
+
+      // Returns the pool key for hosts of this cluster, computed once per downstream protocol.
+      // Keys of hosts belonging to another cluster info are computed into the given storage.
+      const HttpPoolKey& httpPoolKey(const Host& host,
+                                     std::optional<Http::Protocol> downstream_protocol,
+                                     HttpPoolKey& storage);
+
       Http::ConnectionPool::Instance*
       httpConnPoolImpl(HostConstSharedPtr host, ResourcePriority priority,
                        std::optional<Http::Protocol> downstream_protocol,
@@ -714,6 +727,8 @@ private:
       // Current active LB.
       LoadBalancerPtr lb_;
       Http::AsyncClientPtr lazy_http_async_client_;
+      // Cached HTTP pool keys, indexed by downstream protocol + 1 with 0 for no protocol.
+      std::array<std::optional<HttpPoolKey>, Http::NumProtocols + 1> http_pool_keys_;
       // Stores QUICHE specific objects which live through out the life time of the cluster and can
       // be shared across its hosts.
       Http::PersistentQuicInfoPtr quic_info_;
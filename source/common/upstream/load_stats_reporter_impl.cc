@@ -116,10 +116,13 @@ void LoadStatsReporterImpl::sendLoadStatsRequest() {
         locality_stats->set_priority(host_set->priority());
 
         for (const HostSharedPtr& host : hosts) {
-          uint64_t host_rq_success = host->stats().rq_success_.latch();
-          uint64_t host_rq_error = host->stats().rq_error_.latch();
-          uint64_t host_rq_active = host->stats().rq_active_.value();
-          uint64_t host_rq_issued = host->stats().rq_total_.latch();
+          // Hosts which never had their stats allocated have no load to report, and reading them
+          // must not allocate them.
+          HostStats* host_stats = host->statsIfAllocated();
+          uint64_t host_rq_success = host_stats != nullptr ? host_stats->rq_success_.latch() : 0;
+          uint64_t host_rq_error = host_stats != nullptr ? host_stats->rq_error_.latch() : 0;
+          uint64_t host_rq_active = host_stats != nullptr ? host_stats->rq_active_.value() : 0;
+          uint64_t host_rq_issued = host_stats != nullptr ? host_stats->rq_total_.latch() : 0;
 
           // Check if the host has any load stats updates. If the host has no load stats updates, we
           // skip it.
@@ -318,9 +321,11 @@ void LoadStatsReporterImpl::startLoadReportPeriod() {
     auto& cluster = it->second.get();
     for (auto& host_set : cluster.prioritySet().hostSetsPerPriority()) {
       for (const auto& host : host_set->hosts()) {
-        host->stats().rq_success_.latch();
-        host->stats().rq_error_.latch();
-        host->stats().rq_total_.latch();
+        if (HostStats* host_stats = host->statsIfAllocated(); host_stats != nullptr) {
+          host_stats->rq_success_.latch();
+          host_stats->rq_error_.latch();
+          host_stats->rq_total_.latch();
+        }
       }
     }
     cluster.info()->loadReportStats().upstream_rq_dropped_.latch();
@@ -620,6 +620,18 @@ HostDescriptionImplBase::HostDescriptionImplBase(
   }
 }
 
+HostDescriptionImplBase::~HostDescriptionImplBase() { delete stats_.load(); }
+
+HostStats& HostDescriptionImplBase::allocateStats() const {
+  auto stats = std::make_unique<HostStats>();
+  HostStats* expected = nullptr;
+  if (stats_.compare_exchange_strong(expected, stats.get(), std::memory_order_acq_rel)) {
+    return *stats.release();
+  }
+  // Another thread allocated them first.
+  return *expected;
+}
+
 HostDescription::SharedConstAddressVector HostDescriptionImplBase::makeAddressListOrNull(
     const Network::Address::InstanceConstSharedPtr& address, const AddressVector& address_list) {
   if (!address || address_list.empty()) {
@@ -1288,6 +1300,13 @@ ClusterInfoImpl::ClusterInfoImpl(
           config.preconnect_policy(), per_upstream_preconnect_ratio, 1.0)),
       peekahead_ratio_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.preconnect_policy(),
                                                        predictive_preconnect_ratio, 0)),
+      demand_preconnect_time_constant_(
+          config.preconnect_policy().has_demand_preconnect()
+              ? std::make_optional(std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(
+                    config.preconnect_policy().demand_preconnect(), arrival_rate_time_constant,
+                    1000)))
+              : std::nullopt),
+      warm_connections_(config.preconnect_policy().warm_connections()),
       preconnect_enabled_matcher_(
           config.preconnect_policy().has_preconnect_enabled_metadata()
               ? std::make_unique<const Matchers::MetadataMatcher>(
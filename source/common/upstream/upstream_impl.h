@@ -46,6 +46,7 @@
 #include "source/common/common/empty_string.h"
 #include "source/common/common/enum_to_int.h"
 #include "source/common/common/logger.h"
+#include "source/common/common/macros.h"
 #include "source/common/common/matchers.h"
 #include "source/common/common/packed_struct.h"
 #include "source/common/common/thread.h"
@@ -162,6 +163,8 @@ private:
 class HostDescriptionImplBase : virtual public HostDescription,
                                 protected Logger::Loggable<Logger::Id::upstream> {
 public:
+  ~HostDescriptionImplBase() override;
+
   Network::UpstreamTransportSocketFactory& transportSocketFactory() const override {
     absl::ReaderMutexLock lock(metadata_mutex_);
     return socket_factory_;
@@ -207,7 +210,9 @@ public:
   }
 
   bool canCreateConnection(Upstream::ResourcePriority priority) const override {
-    if (stats().cx_active_.value() >= cluster().resourceManager(priority).maxConnectionsPerHost()) {
+    const HostStats* stats = statsIfAllocated();
+    const uint64_t cx_active = stats != nullptr ? stats->cx_active_.value() : 0;
+    if (cx_active >= cluster().resourceManager(priority).maxConnectionsPerHost()) {
       return false;
     }
     return cluster().resourceManager(priority).connections().canCreate();
@@ -221,7 +226,11 @@ public:
     static DetectorHostMonitorNullImpl* null_outlier_detector = new DetectorHostMonitorNullImpl();
     return *null_outlier_detector;
   }
-  HostStats& stats() const override { return stats_; }
+  HostStats& stats() const override {
+    HostStats* stats = stats_.load(std::memory_order_acquire);
+    return stats != nullptr ? *stats : allocateStats();
+  }
+  HostStats* statsIfAllocated() const override { return stats_.load(std::memory_order_acquire); }
   LoadMetricStats& loadMetricStats() const override { return load_metric_stats_; }
   const std::string& hostnameForHealthChecks() const override { return health_checks_hostname_; }
   const std::string& hostname() const override { return hostname_; }
@@ -292,6 +301,8 @@ protected:
                                                               const AddressVector& address_list);
 
 private:
+  HostStats& allocateStats() const;
+
   ClusterInfoConstSharedPtr cluster_;
   const std::string hostname_;
   const std::string health_checks_hostname_;
@@ -302,7 +313,9 @@ private:
   const MetadataConstSharedPtr locality_metadata_;
   const std::shared_ptr<const envoy::config::core::v3::Locality> locality_;
   Stats::StatNameDynamicStorage locality_zone_stat_name_;
-  mutable HostStats stats_;
+  // Allocated on first use, so that the hosts which never see any traffic, e.g. most of the hosts
+  // of a large cluster that is rarely used, only pay for a pointer. Owned by this host.
+  mutable std::atomic<HostStats*> stats_{nullptr};
   mutable LoadMetricStatsImpl load_metric_stats_;
   Outlier::DetectorHostMonitorPtr outlier_detector_;
   HealthCheckHostMonitorPtr health_checker_;
@@ -400,7 +413,7 @@ public:
   // Upstream::Host
   std::vector<std::pair<absl::string_view, Stats::PrimitiveCounterReference>>
   counters() const override {
-    return stats().counters();
+    return statsForRead().counters();
   }
   CreateConnectionData createConnection(
       Event::Dispatcher& dispatcher, const Network::ConnectionSocket::OptionsSharedPtr& options,
@@ -417,7 +430,7 @@ public:
 
   std::vector<std::pair<absl::string_view, Stats::PrimitiveGaugeReference>>
   gauges() const override {
-    return stats().gauges();
+    return statsForRead().gauges();
   }
   void healthFlagClear(HealthFlag flag) override { health_flags_ &= ~enumToInt(flag); }
   bool healthFlagGet(HealthFlag flag) const override { return health_flags_ & enumToInt(flag); }
@@ -528,6 +541,14 @@ private:
   // Helper function to check multiple health flags at once.
   bool healthFlagsGet(uint32_t flags) const { return health_flags_ & flags; }
 
+  // Returns the stats of the host for reporting, without allocating them for a host which never
+  // used them: such hosts all share a set of zero stats.
+  HostStats& statsForRead() const {
+    HostStats* stats = statsIfAllocated();
+    return stats != nullptr ? *stats : unusedStats();
+  }
+  static HostStats& unusedStats() { MUTABLE_CONSTRUCT_ON_FIRST_USE(HostStats); }
+
   void setEdsHealthFlag(envoy::config::core::v3::HealthStatus health_status);
 
   std::atomic<uint32_t> health_flags_{0};
@@ -934,6 +955,10 @@ public:
 
   float perUpstreamPreconnectRatio() const override { return per_upstream_preconnect_ratio_; }
   float peekaheadRatio() const override { return peekahead_ratio_; }
+  std::optional<std::chrono::milliseconds> demandPreconnectTimeConstant() const override {
+    return demand_preconnect_time_constant_;
+  }
+  uint32_t warmConnections() const override { return warm_connections_; }
   bool shouldPreconnect(const Host& host) const override;
   uint32_t perConnectionBufferLimitBytes() const override {
     return per_connection_buffer_limit_bytes_;
@@ -1152,6 +1177,8 @@ private:
   OptionalTimeouts optional_timeouts_;
   const float per_upstream_preconnect_ratio_;
   const float peekahead_ratio_;
+  const std::optional<std::chrono::milliseconds> demand_preconnect_time_constant_;
+  const uint32_t warm_connections_;
   const std::unique_ptr<const Matchers::MetadataMatcher> preconnect_enabled_matcher_;
   TransportSocketMatcherPtr socket_matcher_;
   Stats::ScopeSharedPtr stats_scope_;
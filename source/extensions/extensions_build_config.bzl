@@ -452,6 +452,12 @@ EXTENSIONS = {
     "envoy.tls.cert_validator.dynamic_modules":          "//source/extensions/transport_sockets/tls/cert_validator/dynamic_modules:config",
     "envoy.tls.cert_validator.spiffe":                  "//source/extensions/transport_sockets/tls/cert_validator/spiffe:config",
 
+    #
+    # TLS private key providers
+    #
+
+    "envoy.tls.key_providers.thread_pool":              "//source/extensions/transport_sockets/tls/private_key_providers/thread_pool:config",
+
     #
     # HTTP header formatters
     #
@@ -483,11 +483,13 @@ ClientImpl::PendingRequest::PendingRequest(ClientImpl& parent, ClientCallbacks&
   parent.host_->stats().rq_total_.inc();
   parent.host_->cluster().trafficStats()->upstream_rq_active_.inc();
   parent.host_->stats().rq_active_.inc();
+  parent.host_->notifyActiveRequestsChanged(1, 0);
 }
 
 ClientImpl::PendingRequest::~PendingRequest() {
   parent_.host_->cluster().trafficStats()->upstream_rq_active_.dec();
   parent_.host_->stats().rq_active_.dec();
+  parent_.host_->notifyActiveRequestsChanged(-1, 0);
 }
 
 void ClientImpl::PendingRequest::cancel() {
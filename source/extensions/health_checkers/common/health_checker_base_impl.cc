@@ -43,7 +43,19 @@ HealthCheckerImplBase::HealthCheckerImplBase(const Cluster& cluster,
       member_update_cb_{cluster_.prioritySet().addMemberUpdateCb(
           [this](const HostVector& hosts_added, const HostVector& hosts_removed) {
             onClusterMemberUpdate(hosts_added, hosts_removed);
-          })} {}
+          })},
+      interval_batcher_(initIntervalBatcher(config, dispatcher)) {}
+
+std::unique_ptr<HealthCheckerImplBase::IntervalBatcher>
+HealthCheckerImplBase::initIntervalBatcher(const envoy::config::core::v3::HealthCheck& config,
+                                           Event::Dispatcher& dispatcher) {
+  if (!config.has_interval_batch_window()) {
+    return nullptr;
+  }
+  return std::make_unique<IntervalBatcher>(
+      dispatcher,
+      std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(config, interval_batch_window)));
+}
 
 std::shared_ptr<const Network::TransportSocketOptionsImpl>
 HealthCheckerImplBase::initTransportSocketOptions(
@@ -84,6 +96,87 @@ HealthCheckerImplBase::~HealthCheckerImplBase() {
   }
 }
 
+HealthCheckerImplBase::IntervalBatcher::IntervalBatcher(Event::Dispatcher& dispatcher,
+                                                       std::chrono::milliseconds window)
+    : dispatcher_(dispatcher), window_ms_(std::max<uint64_t>(1, window.count())),
+      timer_(dispatcher.createTimer([this]() -> void { onTimer(); })) {}
+
+uint64_t HealthCheckerImplBase::IntervalBatcher::nowMs() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             dispatcher_.timeSource().monotonicTime().time_since_epoch())
+      .count();
+}
+
+void HealthCheckerImplBase::IntervalBatcher::schedule(ActiveHealthCheckSession& session,
+                                                      std::chrono::milliseconds interval) {
+  cancel(session);
+  // A jittered or sub-millisecond interval may be 0ms. It is counted as 1ms, so that the session
+  // lands in a later batch than the running one and the slot is never RunningSlot.
+  const uint64_t due_ms = nowMs() + std::max<uint64_t>(1, interval.count());
+  const uint64_t slot = (due_ms + window_ms_ - 1) / window_ms_;
+  ASSERT(slot != RunningSlot);
+  SessionList& batch = batches_[slot];
+  session.batch_entry_ = batch.insert(batch.end(), &session);
+  session.batch_slot_ = slot;
+  enableTimer();
+}
+
+void HealthCheckerImplBase::IntervalBatcher::cancel(ActiveHealthCheckSession& session) {
+  if (!session.batch_slot_.has_value()) {
+    return;
+  }
+  const uint64_t slot = session.batch_slot_.value();
+  session.batch_slot_.reset();
+  if (slot == RunningSlot) {
+    running_.erase(session.batch_entry_);
+    return;
+  }
+  auto it = batches_.find(slot);
+  ASSERT(it != batches_.end());
+  it->second.erase(session.batch_entry_);
+  if (it->second.empty()) {
+    // The timer is left as is. If this was the next batch it fires with nothing to run and is
+    // re-armed for the following one.
+    batches_.erase(it);
+  }
+}
+
+void HealthCheckerImplBase::IntervalBatcher::onTimer() {
+  timer_slot_.reset();
+  const uint64_t now_ms = nowMs();
+  // Take every batch that is due. Sessions that are removed while the batch runs are unlinked
+  // from running_ by cancel(), and sessions that are rescheduled while it runs go to a later
+  // batch.
+  while (!batches_.empty() && batches_.begin()->first * window_ms_ <= now_ms) {
+    running_.splice(running_.end(), batches_.begin()->second);
+    batches_.erase(batches_.begin());
+  }
+  for (ActiveHealthCheckSession* session : running_) {
+    session->batch_slot_ = RunningSlot;
+  }
+  while (!running_.empty()) {
+    ActiveHealthCheckSession* session = running_.front();
+    running_.pop_front();
+    session->batch_slot_.reset();
+    session->onIntervalBase();
+  }
+  enableTimer();
+}
+
+void HealthCheckerImplBase::IntervalBatcher::enableTimer() {
+  if (batches_.empty()) {
+    return;
+  }
+  const uint64_t slot = batches_.begin()->first;
+  if (timer_slot_.has_value() && timer_slot_.value() <= slot) {
+    return;
+  }
+  const uint64_t now_ms = nowMs();
+  const uint64_t end_ms = slot * window_ms_;
+  timer_->enableTimer(std::chrono::milliseconds(end_ms > now_ms ? end_ms - now_ms : 0));
+  timer_slot_ = slot;
+}
+
 void HealthCheckerImplBase::decHealthy() { stats_.healthy_.sub(1); }
 
 void HealthCheckerImplBase::decDegraded() { stats_.degraded_.sub(1); }
@@ -252,7 +345,9 @@ void HealthCheckerImplBase::start() {
 HealthCheckerImplBase::ActiveHealthCheckSession::ActiveHealthCheckSession(
     HealthCheckerImplBase& parent, HostSharedPtr host)
     : host_(host), parent_(parent),
-      interval_timer_(parent.dispatcher_.createTimer([this]() -> void { onIntervalBase(); })),
+      interval_timer_(parent.interval_batcher_ != nullptr
+                          ? nullptr
+                          : parent.dispatcher_.createTimer([this]() -> void { onIntervalBase(); })),
       timeout_timer_(parent.dispatcher_.createTimer([this]() -> void { onTimeoutBase(); })),
       time_source_(parent.dispatcher_.timeSource()) {
 
@@ -268,7 +363,7 @@ HealthCheckerImplBase::ActiveHealthCheckSession::ActiveHealthCheckSession(
 HealthCheckerImplBase::ActiveHealthCheckSession::~ActiveHealthCheckSession() {
   // Make sure onDeferredDeleteBase() has been called. We should not reference our parent at this
   // point since we may have been deferred deleted.
-  ASSERT(interval_timer_ == nullptr && timeout_timer_ == nullptr);
+  ASSERT(interval_timer_ == nullptr && timeout_timer_ == nullptr && !batch_slot_.has_value());
 }
 
 void HealthCheckerImplBase::ActiveHealthCheckSession::onDeferredDeleteBase() {
@@ -277,6 +372,9 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::onDeferredDeleteBase() {
   // implementation specific state is destroyed.
   interval_timer_.reset();
   timeout_timer_.reset();
+  if (parent_.interval_batcher_ != nullptr) {
+    parent_.interval_batcher_->cancel(*this);
+  }
   if (!host_->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
     parent_.decHealthy();
     state = HealthState::Healthy;
@@ -355,7 +453,7 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::handleSuccess(bool degrade
   parent_.runCallbacks(host_, changed_state, HealthState::Healthy);
 
   timeout_timer_->disableTimer();
-  interval_timer_->enableTimer(parent_.interval(HealthState::Healthy, changed_state));
+  scheduleInterval(parent_.interval(HealthState::Healthy, changed_state));
 }
 
 namespace {
@@ -425,13 +523,12 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::handleFailure(
     host_->setLastHealthCheckHttpStatus(0);
   }
   // It's possible that the previous call caused this session to be deferred deleted.
-  if (timeout_timer_ != nullptr) {
-    timeout_timer_->disableTimer();
+  if (timeout_timer_ == nullptr) {
+    return;
   }
 
-  if (interval_timer_ != nullptr) {
-    interval_timer_->enableTimer(parent_.interval(HealthState::Unhealthy, changed_state));
-  }
+  timeout_timer_->disableTimer();
+  scheduleInterval(parent_.interval(HealthState::Unhealthy, changed_state));
 }
 
 HealthTransition
@@ -461,8 +558,16 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::onInitialInterval() {
   if (parent_.initial_jitter_.count() == 0) {
     onIntervalBase();
   } else {
-    interval_timer_->enableTimer(
-        std::chrono::milliseconds(parent_.intervalWithJitter(0, parent_.initial_jitter_)));
+    scheduleInterval(parent_.intervalWithJitter(0, parent_.initial_jitter_));
+  }
+}
+
+void HealthCheckerImplBase::ActiveHealthCheckSession::scheduleInterval(
+    std::chrono::milliseconds interval) {
+  if (parent_.interval_batcher_ != nullptr) {
+    parent_.interval_batcher_->schedule(*this, interval);
+  } else {
+    interval_timer_->enableTimer(interval);
   }
 }
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <list>
+#include <optional>
+
 #include "envoy/access_log/access_log.h"
 #include "envoy/common/callback.h"
 #include "envoy/common/random_generator.h"
@@ -15,6 +18,8 @@
 #include "source/common/common/matchers.h"
 #include "source/common/network/transport_socket_options_impl.h"
 
+#include "absl/container/btree_map.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -74,6 +79,9 @@ protected:
     HostSharedPtr host_;
 
   private:
+    // For IntervalBatcher, which keeps track of the batch the session is queued in.
+    friend class HealthCheckerImplBase;
+
     // Clears the pending flag if it is set. By clearing this flag we're marking the host as having
     // been health checked.
     // Returns the changed state to use following the flag update.
@@ -84,10 +92,15 @@ protected:
     void onTimeoutBase();
     virtual void onDeferredDelete() PURE;
     void onInitialInterval();
+    void scheduleInterval(std::chrono::milliseconds interval);
 
     HealthCheckerImplBase& parent_;
+    // Only used when interval batching is disabled. @see IntervalBatcher.
     Event::TimerPtr interval_timer_;
     Event::TimerPtr timeout_timer_;
+    // Batch the session is currently queued in, if any.
+    std::optional<uint64_t> batch_slot_;
+    std::list<ActiveHealthCheckSession*>::iterator batch_entry_;
     uint32_t num_unhealthy_{};
     uint32_t num_healthy_{};
     bool first_check_{true};
@@ -130,7 +143,41 @@ private:
     std::weak_ptr<Host> host_;
   };
 
+  /**
+   * Schedules the interval of all the sessions from a single timer. The monotonic time is divided
+   * in windows of a fixed size and a session that is due at some time is queued in the window
+   * that ends at or after it. When a window ends, all of its sessions run in queue order.
+   */
+  class IntervalBatcher {
+  public:
+    IntervalBatcher(Event::Dispatcher& dispatcher, std::chrono::milliseconds window);
+
+    void schedule(ActiveHealthCheckSession& session, std::chrono::milliseconds interval);
+    void cancel(ActiveHealthCheckSession& session);
+
+  private:
+    using SessionList = std::list<ActiveHealthCheckSession*>;
+
+    uint64_t nowMs() const;
+    void onTimer();
+    void enableTimer();
+
+    // Pseudo slot of the sessions of the batch that is being run.
+    static constexpr uint64_t RunningSlot = 0;
+
+    Event::Dispatcher& dispatcher_;
+    const uint64_t window_ms_;
+    const Event::TimerPtr timer_;
+    // Sessions per window, keyed by the end of the window in multiples of the window size.
+    absl::btree_map<uint64_t, SessionList> batches_;
+    SessionList running_;
+    std::optional<uint64_t> timer_slot_;
+  };
+
   void addHosts(const HostVector& hosts);
+  static std::unique_ptr<IntervalBatcher>
+  initIntervalBatcher(const envoy::config::core::v3::HealthCheck& config,
+                      Event::Dispatcher& dispatcher);
   void decHealthy();
   void decDegraded();
   HealthCheckerStats generateStats(Stats::Scope& scope);
@@ -164,6 +211,8 @@ private:
   const MetadataConstSharedPtr transport_socket_match_metadata_;
   const Common::CallbackHandlePtr member_update_cb_;
   bool started_{false};
+  // Set when interval_batch_window is configured.
+  const std::unique_ptr<IntervalBatcher> interval_batcher_;
 };
 
 } // namespace Upstream
@@ -223,6 +223,16 @@ Api::IoCallUint64Result IoHandleImpl::sendmsg(const Buffer::RawSlice*, uint64_t,
   return Network::IoSocketError::ioResultSocketInvalidAddress();
 }
 
+Api::IoCallUint64Result IoHandleImpl::sendmmsg(absl::Span<const Buffer::RawSlice>,
+                                               const Network::Address::Instance&) {
+  return Network::IoSocketError::ioResultSocketInvalidAddress();
+}
+
+Api::IoCallUint64Result IoHandleImpl::sendWithControlMessage(const Buffer::RawSlice*, uint64_t,
+                                                             int, int, absl::Span<const uint8_t>) {
+  return {0, Network::IoSocketError::create(SOCKET_ERROR_NOT_SUP)};
+}
+
 Api::IoCallUint64Result IoHandleImpl::recvmsg(Buffer::RawSlice*, const uint64_t, uint32_t,
                                               const Network::IoHandle::UdpSaveCmsgConfig&,
                                               RecvMsgOutput&) {
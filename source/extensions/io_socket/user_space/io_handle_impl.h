@@ -59,6 +59,11 @@ public:
   Api::IoCallUint64Result sendmsg(const Buffer::RawSlice* slices, uint64_t num_slice, int flags,
                                   const Network::Address::Ip* self_ip,
                                   const Network::Address::Instance& peer_address) override;
+  Api::IoCallUint64Result sendmmsg(absl::Span<const Buffer::RawSlice> datagrams,
+                                   const Network::Address::Instance& peer_address) override;
+  Api::IoCallUint64Result sendWithControlMessage(const Buffer::RawSlice* slices,
+                                                 uint64_t num_slice, int level, int type,
+                                                 absl::Span<const uint8_t> control_data) override;
   Api::IoCallUint64Result recvmsg(Buffer::RawSlice* slices, const uint64_t num_slice,
                                   uint32_t self_port,
                                   const Network::IoHandle::UdpSaveCmsgConfig& udp_save_cmsg_config,
@@ -0,0 +1,72 @@
+#include "source/extensions/load_balancing_policies/common/active_request_tracker.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace LoadBalancingPolicies {
+namespace Common {
+
+void ActiveRequestsHostLbPolicyData::reconcile(const Upstream::HostStats& stats) {
+  if (reconciling_.exchange(true, std::memory_order_acquire)) {
+    return;
+  }
+  active_.add(static_cast<int64_t>(stats.rq_active_.value()) - active_.sum());
+  pending_.add(static_cast<int64_t>(stats.rq_pending_active_.value()) - pending_.sum());
+  reconciling_.store(false, std::memory_order_release);
+}
+
+ActiveRequestTrackingThreadAwareLb::ActiveRequestTrackingThreadAwareLb(
+    Upstream::ThreadAwareLoadBalancerPtr lb, const Upstream::PrioritySet& priority_set,
+    Event::Dispatcher& main_thread_dispatcher)
+    : lb_(std::move(lb)), priority_set_(priority_set),
+      reconcile_timer_(main_thread_dispatcher.createTimer([this]() {
+        reconcileHosts();
+        reconcile_timer_->enableTimer(ReconcileInterval);
+      })) {}
+
+absl::Status ActiveRequestTrackingThreadAwareLb::initialize() {
+  for (const auto& host_set : priority_set_.hostSetsPerPriority()) {
+    addActiveRequestsDataToHosts(host_set->hosts());
+  }
+
+  priority_update_cb_ = priority_set_.addPriorityUpdateCb(
+      [](uint32_t, const Upstream::HostVector& hosts_added, const Upstream::HostVector&) {
+        addActiveRequestsDataToHosts(hosts_added);
+      });
+  reconcile_timer_->enableTimer(ReconcileInterval);
+
+  return lb_->initialize();
+}
+
+void ActiveRequestTrackingThreadAwareLb::reconcileHosts() {
+  for (const auto& host_set : priority_set_.hostSetsPerPriority()) {
+    for (const auto& host : host_set->hosts()) {
+      // A host without allocated stats never had a request, and reconciling it must not allocate
+      // its stats.
+      const Upstream::HostStats* stats = host->statsIfAllocated();
+      if (stats == nullptr) {
+        continue;
+      }
+      if (auto data = host->typedLbPolicyData<ActiveRequestsHostLbPolicyData>();
+          data.has_value()) {
+        data->reconcile(*stats);
+      }
+    }
+  }
+}
+
+void ActiveRequestTrackingThreadAwareLb::addActiveRequestsDataToHosts(
+    const Upstream::HostVector& hosts) {
+  for (const auto& host_ptr : hosts) {
+    if (!host_ptr->typedLbPolicyData<ActiveRequestsHostLbPolicyData>().has_value()) {
+      const Upstream::HostStats* stats = host_ptr->statsIfAllocated();
+      host_ptr->addLbPolicyData(std::make_unique<ActiveRequestsHostLbPolicyData>(
+          stats != nullptr ? stats->rq_active_.value() : 0,
+          stats != nullptr ? stats->rq_pending_active_.value() : 0));
+    }
+  }
+}
+
+} // namespace Common
+} // namespace LoadBalancingPolicies
+} // namespace Extensions
+} // namespace Envoy
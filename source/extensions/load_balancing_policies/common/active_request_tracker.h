@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/upstream/load_balancer.h"
+#include "envoy/upstream/upstream.h"
+
+#include "source/common/common/callback_impl.h"
+#include "source/common/common/sharded_counter.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace LoadBalancingPolicies {
+namespace Common {
+
+/**
+ * Host-attached active and pending request counts for load balancers that compare hosts by
+ * outstanding requests (least request, peak EWMA).
+ *
+ * The host's ``rq_active`` and ``rq_pending_active`` gauges are single atomics that every worker
+ * writes for every request, next to the other per-host counters. On busy hosts shared by many
+ * workers the cache line holding them is constantly bouncing, and every load balancer pick that
+ * reads them pays for that. This data mirrors the same values in per-worker, cache-line-padded
+ * slots (@see ShardedCounter) that are fed by the connection pools and summed at pick time.
+ */
+class ActiveRequestsHostLbPolicyData : public Upstream::HostLbPolicyData {
+public:
+  // The initial values seed the counters with requests that were already outstanding when the
+  // data was attached to the host, so that their completion is not under-counted.
+  explicit ActiveRequestsHostLbPolicyData(uint64_t initial_active = 0,
+                                          uint64_t initial_pending = 0) {
+    active_.add(initial_active);
+    pending_.add(initial_pending);
+  }
+
+  // Upstream::HostLbPolicyData
+  bool receivesOrcaLoadReport() const override { return false; }
+  bool tracksActiveRequests() const override { return true; }
+  void onActiveRequestsChanged(int64_t active_delta, int64_t pending_delta) override {
+    if (active_delta != 0) {
+      active_.add(active_delta);
+    }
+    if (pending_delta != 0) {
+      pending_.add(pending_delta);
+    }
+  }
+
+  uint64_t activeRequests() const { return active_.value(); }
+  uint64_t pendingRequests() const { return pending_.value(); }
+
+  /**
+   * Corrects the counts against the host's ``rq_active`` and ``rq_pending_active`` gauges, which
+   * stay the reference. The counts drift when the gauges move between the seeding and the
+   * attachment of the data, and a correction racing with requests is only as exact as a read.
+   * A call made while another one is in progress is skipped, so a drift is never corrected twice.
+   */
+  void reconcile(const Upstream::HostStats& stats);
+
+private:
+  ShardedCounter active_;
+  ShardedCounter pending_;
+  std::atomic<bool> reconciling_{false};
+};
+
+/**
+ * Thread-aware load balancer wrapper that attaches ActiveRequestsHostLbPolicyData to every host
+ * of the cluster on the main thread, including hosts added by later updates, and periodically
+ * reconciles their counts with the host stats. Worker-local load balancers created by the wrapped
+ * factory can then read the sharded counts from their hosts.
+ */
+class ActiveRequestTrackingThreadAwareLb : public Upstream::ThreadAwareLoadBalancer {
+public:
+  // How often the counts of the hosts are reconciled with their stats.
+  static constexpr std::chrono::milliseconds ReconcileInterval{1000};
+
+  ActiveRequestTrackingThreadAwareLb(Upstream::ThreadAwareLoadBalancerPtr lb,
+                                     const Upstream::PrioritySet& priority_set,
+                                     Event::Dispatcher& main_thread_dispatcher);
+
+  // Upstream::ThreadAwareLoadBalancer
+  Upstream::LoadBalancerFactorySharedPtr factory() override { return lb_->factory(); }
+  absl::Status initialize() override;
+
+  /**
+   * Attach ActiveRequestsHostLbPolicyData to the given hosts if they don't have it yet.
+   * Must be called on the main thread before the hosts are used by the workers.
+   */
+  static void addActiveRequestsDataToHosts(const Upstream::HostVector& hosts);
+
+private:
+  void reconcileHosts();
+
+  Upstream::ThreadAwareLoadBalancerPtr lb_;
+  const Upstream::PrioritySet& priority_set_;
+  Envoy::Common::CallbackHandlePtr priority_update_cb_;
+  Event::TimerPtr reconcile_timer_;
+};
+
+} // namespace Common
+} // namespace LoadBalancingPolicies
+} // namespace Extensions
+} // namespace Envoy
@@ -300,20 +300,22 @@ double ThreadAwareLoadBalancerBase::BoundedLoadHashingLoadBalancer::hostOverload
   // and alert the user if that's the case.
 
   const uint32_t overall_active = host.cluster().trafficStats()->upstream_rq_active_.value();
-  const uint32_t host_active = host.stats().rq_active_.value();
+  // Hosts which never had their stats allocated have no active requests.
+  const HostStats* host_stats = host.statsIfAllocated();
+  const uint32_t host_active = host_stats != nullptr ? host_stats->rq_active_.value() : 0;
 
   const uint32_t total_slots = ((overall_active + 1) * hash_balance_factor_ + 99) / 100;
   const uint32_t slots =
       std::max(static_cast<uint32_t>(std::ceil(total_slots * weight)), static_cast<uint32_t>(1));
 
-  if (host.stats().rq_active_.value() > slots) {
+  if (host_active > slots) {
     ENVOY_LOG_MISC(
         debug,
         "ThreadAwareLoadBalancerBase::BoundedLoadHashingLoadBalancer::chooseHost: "
         "host {} overloaded; overall_active {}, host_weight {}, host_active {} > slots {}",
         host.address()->asString(), overall_active, weight, host_active, slots);
   }
-  return static_cast<double>(host.stats().rq_active_.value()) / slots;
+  return static_cast<double>(host_active) / slots;
 }
 
 HostSelectionResponse
@@ -2,6 +2,7 @@
 
 #include "envoy/extensions/load_balancing_policies/least_request/v3/least_request.pb.h"
 
+#include "source/extensions/load_balancing_policies/common/active_request_tracker.h"
 #include "source/extensions/load_balancing_policies/least_request/least_request_lb.h"
 
 namespace Envoy {
@@ -22,8 +23,9 @@ TypedLeastRequestLbConfig::TypedLeastRequestLbConfig(const CommonLbConfigProto&
   }
 }
 
-TypedLeastRequestLbConfig::TypedLeastRequestLbConfig(const LeastRequestLbProto& lb_config)
-    : lb_config_(lb_config) {}
+TypedLeastRequestLbConfig::TypedLeastRequestLbConfig(const LeastRequestLbProto& lb_config,
+                                                     Event::Dispatcher& main_thread_dispatcher)
+    : lb_config_(lb_config), main_thread_dispatcher_(main_thread_dispatcher) {}
 
 Upstream::LoadBalancerPtr LeastRequestCreator::operator()(
     Upstream::LoadBalancerParams params, OptRef<const Upstream::LoadBalancerConfig> lb_config,
@@ -40,6 +42,22 @@ Upstream::LoadBalancerPtr LeastRequestCreator::operator()(
       typed_lb_config->lb_config_, time_source);
 }
 
+Upstream::ThreadAwareLoadBalancerPtr Factory::create(
+    OptRef<const Upstream::LoadBalancerConfig> lb_config, const Upstream::ClusterInfo& cluster_info,
+    const Upstream::PrioritySet& priority_set, Runtime::Loader& runtime,
+    Envoy::Random::RandomGenerator& random, TimeSource& time_source) {
+  auto lb =
+      FactoryBase::create(lb_config, cluster_info, priority_set, runtime, random, time_source);
+
+  const auto typed_lb_config = dynamic_cast<const TypedLeastRequestLbConfig*>(lb_config.ptr());
+  if (typed_lb_config != nullptr && typed_lb_config->lb_config_.use_sharded_request_counters()) {
+    ASSERT(typed_lb_config->main_thread_dispatcher_.has_value());
+    return std::make_unique<Common::ActiveRequestTrackingThreadAwareLb>(
+        std::move(lb), priority_set, *typed_lb_config->main_thread_dispatcher_);
+  }
+  return lb;
+}
+
 /**
  * Static registration for the Factory. @see RegisterFactory.
  */
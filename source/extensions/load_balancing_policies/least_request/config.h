@@ -1,5 +1,7 @@
 #pragma once
 
+#include "envoy/common/optref.h"
+#include "envoy/event/dispatcher.h"
 #include "envoy/extensions/load_balancing_policies/least_request/v3/least_request.pb.h"
 #include "envoy/extensions/load_balancing_policies/least_request/v3/least_request.pb.validate.h"
 #include "envoy/upstream/load_balancer.h"
@@ -24,11 +26,14 @@ using LegacyLeastRequestLbProto = envoy::config::cluster::v3::Cluster::LeastRequ
  */
 class TypedLeastRequestLbConfig : public Upstream::LoadBalancerConfig {
 public:
-  TypedLeastRequestLbConfig(const LeastRequestLbProto& lb_config);
+  TypedLeastRequestLbConfig(const LeastRequestLbProto& lb_config,
+                            Event::Dispatcher& main_thread_dispatcher);
   TypedLeastRequestLbConfig(const CommonLbConfigProto& common_lb_config,
                             const LegacyLeastRequestLbProto& lb_config);
 
   LeastRequestLbProto lb_config_;
+  // Only set by the typed config, the only one that can enable the sharded request counters.
+  OptRef<Event::Dispatcher> main_thread_dispatcher_;
 };
 
 struct LeastRequestCreator : public Logger::Loggable<Logger::Id::upstream> {
@@ -44,13 +49,21 @@ class Factory : public Common::FactoryBase<LeastRequestLbProto, LeastRequestCrea
 public:
   Factory() : FactoryBase("envoy.load_balancing_policies.least_request") {}
 
+  Upstream::ThreadAwareLoadBalancerPtr create(OptRef<const Upstream::LoadBalancerConfig> lb_config,
+                                              const Upstream::ClusterInfo& cluster_info,
+                                              const Upstream::PrioritySet& priority_set,
+                                              Runtime::Loader& runtime,
+                                              Envoy::Random::RandomGenerator& random,
+                                              TimeSource& time_source) override;
+
   absl::StatusOr<Upstream::LoadBalancerConfigPtr>
-  loadConfig(Server::Configuration::ServerFactoryContext&,
+  loadConfig(Server::Configuration::ServerFactoryContext& context,
              const Protobuf::Message& config) override {
     ASSERT(Envoy::Protobuf::DynamicCastMessage<LeastRequestLbProto>(&config) != nullptr);
     const LeastRequestLbProto& typed_config =
         Envoy::Protobuf::DynamicCastMessage<LeastRequestLbProto>(config);
-    return Upstream::LoadBalancerConfigPtr{new TypedLeastRequestLbConfig(typed_config)};
+    return Upstream::LoadBalancerConfigPtr{
+        new TypedLeastRequestLbConfig(typed_config, context.mainThreadDispatcher())};
   }
 
   absl::StatusOr<Upstream::LoadBalancerConfigPtr>
@@ -4,9 +4,28 @@ namespace Envoy {
 namespace Upstream {
 
 uint64_t LeastRequestLoadBalancer::effectiveActiveRequests(const Host& host) const {
-  uint64_t active = host.stats().rq_active_.value();
+  if (use_sharded_request_counters_) {
+    const auto data = host.typedLbPolicyData<
+        Extensions::LoadBalancingPolicies::Common::ActiveRequestsHostLbPolicyData>();
+    // Hosts always have the data attached on the main thread before the workers see them; fall
+    // back to the host stats if that invariant is ever broken.
+    if (data.has_value()) {
+      uint64_t active = data->activeRequests();
+      if (count_pending_requests_) {
+        active += data->pendingRequests();
+      }
+      return active;
+    }
+  }
+
+  // Hosts which never had their stats allocated have no active requests.
+  const HostStats* stats = host.statsIfAllocated();
+  if (stats == nullptr) {
+    return 0;
+  }
+  uint64_t active = stats->rq_active_.value();
   if (count_pending_requests_) {
-    active += host.stats().rq_pending_active_.value();
+    active += stats->rq_pending_active_.value();
   }
   return active;
 }
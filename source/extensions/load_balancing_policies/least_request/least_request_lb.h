@@ -1,6 +1,7 @@
 #pragma once
 
 #include "source/common/runtime/runtime_features.h"
+#include "source/extensions/load_balancing_policies/common/active_request_tracker.h"
 #include "source/extensions/load_balancing_policies/common/load_balancer_impl.h"
 
 namespace Envoy {
@@ -41,7 +42,8 @@ public:
                 ? std::optional<Runtime::Double>(
                       {least_request_config.active_request_bias(), runtime})
                 : std::nullopt),
-        selection_method_(least_request_config.selection_method()) {
+        selection_method_(least_request_config.selection_method()),
+        use_sharded_request_counters_(least_request_config.use_sharded_request_counters()) {
     initialize();
   }
 
@@ -90,6 +92,10 @@ private:
   const std::optional<Runtime::Double> active_request_bias_runtime_;
   const envoy::extensions::load_balancing_policies::least_request::v3::LeastRequest::SelectionMethod
       selection_method_{};
+
+  // Whether to read the per-host load from the sharded counters attached to the hosts by
+  // `ActiveRequestTrackingThreadAwareLb` instead of from the host stats.
+  const bool use_sharded_request_counters_{};
 };
 
 } // namespace Upstream
@@ -57,6 +57,7 @@ SubsetLoadBalancer::SubsetLoadBalancer(const SubsetLoadBalancerConfig& lb_config
       default_subset_metadata_(lb_config_.subsetInfo().defaultSubset().fields().begin(),
                                lb_config_.subsetInfo().defaultSubset().fields().end()),
       subset_selectors_(lb_config_.subsetInfo().subsetSelectors()),
+      metadata_index_(subset_selectors_, lb_config_.subsetInfo().listAsAny()),
       original_priority_set_(priority_set), original_local_priority_set_(local_priority_set),
       locality_weight_aware_(lb_config_.subsetInfo().localityWeightAware()),
       scale_locality_weight_(lb_config_.subsetInfo().scaleLocalityWeight()),
@@ -471,33 +472,41 @@ void SubsetLoadBalancer::initLbSubsetEntryOnce(LbSubsetEntryPtr& entry, bool sin
 
 // Iterates all the hosts of specified priority, looking up an LbSubsetEntryPtr for each and add
 // hosts to related entry. Because the metadata of host can be updated inlined, we must evaluate
-// every hosts for every update.
+// every hosts for every update. The metadata index keeps this cheap: only the hosts that have all
+// the keys of a selector are visited, and the subset trie is walked once per distinct combination
+// of values rather than once per host.
 void SubsetLoadBalancer::processSubsets(uint32_t priority, const HostVector& all_hosts) {
   absl::flat_hash_set<const LbSubsetEntry*> single_host_entries;
   uint64_t collision_count_of_single_host_entries{};
 
-  for (const auto& host : all_hosts) {
-    for (const auto& subset_selector : subset_selectors_) {
-      const auto& keys = subset_selector->selectorKeys();
-      // For each host, for each subset key, attempt to extract the metadata corresponding to the
-      // key from the host.
-      std::vector<SubsetMetadata> all_kvs = extractSubsetMetadata(keys, *host);
-      for (const auto& kvs : all_kvs) {
-        // The host has metadata for each key, find or create its subset.
-        auto entry = findOrCreateLbSubsetEntry(subsets_, kvs, 0);
-        initLbSubsetEntryOnce(entry, subset_selector->singleHostPerSubset());
-
-        if (entry->single_host_subset_) {
-          if (single_host_entries.contains(entry.get())) {
-            collision_count_of_single_host_entries++;
-            continue;
-          }
-          single_host_entries.emplace(entry.get());
-        }
+  metadata_index_.build(priority, all_hosts);
 
-        entry->lb_subset_->pushHost(priority, host);
-      }
-    }
+  for (size_t selector_index = 0; selector_index < subset_selectors_.size(); ++selector_index) {
+    const auto& subset_selector = subset_selectors_[selector_index];
+    const std::vector<uint32_t>& columns = metadata_index_.selectorColumns(selector_index);
+    absl::flat_hash_map<std::vector<uint32_t>, LbSubsetEntryPtr> entries;
+
+    metadata_index_.forEachRowWithColumns(columns, [&](uint32_t row) {
+      metadata_index_.forEachValueCombination(
+          row, columns, [&](const std::vector<uint32_t>& value_ids) {
+            // The host has metadata for each key, find or create its subset.
+            LbSubsetEntryPtr& entry = entries[value_ids];
+            if (entry == nullptr) {
+              entry = findOrCreateLbSubsetEntry(subsets_, columns, value_ids, 0);
+              initLbSubsetEntryOnce(entry, subset_selector->singleHostPerSubset());
+            }
+
+            if (entry->single_host_subset_) {
+              if (single_host_entries.contains(entry.get())) {
+                collision_count_of_single_host_entries++;
+                return;
+              }
+              single_host_entries.emplace(entry.get());
+            }
+
+            entry->lb_subset_->pushHost(priority, all_hosts[row]);
+          });
+    });
   }
 
   // This stat isn't added to `ClusterTrafficStats` because it wouldn't be used for nearly all
@@ -532,69 +541,6 @@ bool SubsetLoadBalancer::hostMatches(const SubsetMetadata& kvs, const Host& host
       kvs, host.metadata().get(), Config::MetadataFilters::get().ENVOY_LB, list_as_any_);
 }
 
-// Iterates over subset_keys looking up values from the given host's metadata. Each key-value pair
-// is appended to kvs. Returns a non-empty value if the host has a value for each key.
-std::vector<SubsetLoadBalancer::SubsetMetadata>
-SubsetLoadBalancer::extractSubsetMetadata(const std::set<std::string>& subset_keys,
-                                          const Host& host) {
-  std::vector<SubsetMetadata> all_kvs;
-  if (!host.metadata()) {
-    return all_kvs;
-  }
-  const envoy::config::core::v3::Metadata& metadata = *host.metadata();
-  const auto& filter_it = metadata.filter_metadata().find(Config::MetadataFilters::get().ENVOY_LB);
-  if (filter_it == metadata.filter_metadata().end()) {
-    return all_kvs;
-  }
-
-  const auto& fields = filter_it->second.fields();
-  for (const auto& key : subset_keys) {
-    const auto it = fields.find(key);
-    if (it == fields.end()) {
-      all_kvs.clear();
-      break;
-    }
-
-    if (list_as_any_ && it->second.kind_case() == Protobuf::Value::kListValue) {
-      // If the list of kvs is empty, we initialize one kvs for each value in the list.
-      // Otherwise, we branch the list of kvs by generating one new kvs per old kvs per
-      // new value.
-      //
-      // For example, two kvs (<a=1>, <a=2>) joined with the kv foo=[bar,baz] results in four kvs:
-      //   <a=1,foo=bar>
-      //   <a=1,foo=baz>
-      //   <a=2,foo=bar>
-      //   <a=2,foo=baz>
-      if (all_kvs.empty()) {
-        for (const auto& v : it->second.list_value().values()) {
-          all_kvs.emplace_back(SubsetMetadata({make_pair(key, v)}));
-        }
-      } else {
-        std::vector<SubsetMetadata> new_kvs;
-        for (const auto& kvs : all_kvs) {
-          for (const auto& v : it->second.list_value().values()) {
-            auto kv_copy = kvs;
-            kv_copy.emplace_back(make_pair(key, v));
-            new_kvs.emplace_back(kv_copy);
-          }
-        }
-        all_kvs = new_kvs;
-      }
-
-    } else {
-      if (all_kvs.empty()) {
-        all_kvs.emplace_back(SubsetMetadata({std::make_pair(key, it->second)}));
-      } else {
-        for (auto& kvs : all_kvs) {
-          kvs.emplace_back(std::make_pair(key, it->second));
-        }
-      }
-    }
-  }
-
-  return all_kvs;
-}
-
 std::string SubsetLoadBalancer::describeMetadata(const SubsetLoadBalancer::SubsetMetadata& kvs) {
   if (kvs.empty()) {
     return "<no metadata>";
@@ -615,16 +561,17 @@ std::string SubsetLoadBalancer::describeMetadata(const SubsetLoadBalancer::Subse
   return buf.str();
 }
 
-// Given a vector of key-values (from extractSubsetMetadata), recursively finds the matching
-// LbSubsetEntryPtr.
+// Given the metadata index columns of a selector and the value ids of a host for them, recursively
+// finds the matching LbSubsetEntryPtr.
 SubsetLoadBalancer::LbSubsetEntryPtr
-SubsetLoadBalancer::findOrCreateLbSubsetEntry(LbSubsetMap& subsets, const SubsetMetadata& kvs,
+SubsetLoadBalancer::findOrCreateLbSubsetEntry(LbSubsetMap& subsets,
+                                              const std::vector<uint32_t>& columns,
+                                              const std::vector<uint32_t>& value_ids,
                                               uint32_t idx) {
-  ASSERT(idx < kvs.size());
+  ASSERT(idx < columns.size());
 
-  const std::string& name = kvs[idx].first;
-  const Protobuf::Value& pb_value = kvs[idx].second;
-  const HashedValue value(pb_value);
+  const std::string& name = metadata_index_.key(columns[idx]);
+  const HashedValue& value = metadata_index_.value(columns[idx], value_ids[idx]);
 
   LbSubsetEntryPtr entry;
 
@@ -651,12 +598,12 @@ SubsetLoadBalancer::findOrCreateLbSubsetEntry(LbSubsetMap& subsets, const Subset
   }
 
   idx++;
-  if (idx == kvs.size()) {
+  if (idx == columns.size()) {
     // We've matched all the key-values, return the entry.
     return entry;
   }
 
-  return findOrCreateLbSubsetEntry(entry->children_, kvs, idx);
+  return findOrCreateLbSubsetEntry(entry->children_, columns, value_ids, idx);
 }
 
 // Invokes cb for each LbSubsetEntryPtr in subsets.
@@ -24,6 +24,7 @@
 #include "source/common/upstream/load_balancer_context_base.h"
 #include "source/common/upstream/upstream_impl.h"
 #include "source/extensions/load_balancing_policies/subset/subset_lb_config.h"
+#include "source/extensions/load_balancing_policies/subset/subset_metadata_index.h"
 
 #include "absl/container/node_hash_map.h"
 
@@ -331,13 +332,12 @@ private:
   LbSubsetEntryPtr
   findSubset(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& matches);
 
-  LbSubsetEntryPtr findOrCreateLbSubsetEntry(LbSubsetMap& subsets, const SubsetMetadata& kvs,
-                                             uint32_t idx);
+  LbSubsetEntryPtr findOrCreateLbSubsetEntry(LbSubsetMap& subsets,
+                                             const std::vector<uint32_t>& columns,
+                                             const std::vector<uint32_t>& value_ids, uint32_t idx);
   void forEachSubset(LbSubsetMap& subsets, std::function<void(LbSubsetEntryPtr&)> cb);
   void purgeEmptySubsets(LbSubsetMap& subsets);
 
-  std::vector<SubsetMetadata> extractSubsetMetadata(const std::set<std::string>& subset_keys,
-                                                    const Host& host);
   HostConstSharedPtr chooseHostWithMetadataFallbacks(LoadBalancerContext* context,
                                                      const MetadataFallbacks& metadata_fallbacks);
   const Protobuf::Value* getMetadataFallbackList(LoadBalancerContext* context) const;
@@ -357,6 +357,7 @@ private:
       metadata_fallback_policy_;
   const SubsetMetadata default_subset_metadata_;
   std::vector<SubsetSelectorPtr> subset_selectors_;
+  SubsetMetadataIndex metadata_index_;
 
   const PrioritySet& original_priority_set_;
   const PrioritySet* original_local_priority_set_;
@@ -0,0 +1,179 @@
+#include "source/extensions/load_balancing_policies/subset/subset_metadata_index.h"
+
+#include <algorithm>
+
+#include "source/common/config/well_known_names.h"
+
+#include "absl/numeric/bits.h"
+
+namespace Envoy {
+namespace Upstream {
+
+SubsetMetadataIndex::SubsetMetadataIndex(const std::vector<SubsetSelectorPtr>& subset_selectors,
+                                         bool list_as_any)
+    : list_as_any_(list_as_any) {
+  absl::flat_hash_map<std::string, uint32_t> column_by_key;
+  selector_columns_.reserve(subset_selectors.size());
+  for (const auto& selector : subset_selectors) {
+    std::vector<uint32_t> columns;
+    columns.reserve(selector->selectorKeys().size());
+    for (const auto& key : selector->selectorKeys()) {
+      auto [it, inserted] = column_by_key.try_emplace(key, columns_.size());
+      if (inserted) {
+        columns_.emplace_back();
+        columns_.back().key_ = key;
+      }
+      columns.push_back(it->second);
+    }
+    selector_columns_.push_back(std::move(columns));
+  }
+
+  empty_row_.offsets_.assign(columns_.size() + 1, 0);
+  present_.resize(columns_.size());
+}
+
+void SubsetMetadataIndex::build(uint32_t priority, const HostVector& hosts) {
+  const bool reset = interned_values_ > std::max<size_t>(1024, 2 * interned_values_at_reset_);
+  if (reset) {
+    for (auto& column : columns_) {
+      column.ids_.clear();
+      column.values_by_id_.clear();
+    }
+    row_caches_.clear();
+    interned_values_ = 0;
+  }
+
+  if (row_caches_.size() <= priority) {
+    row_caches_.resize(priority + 1);
+  }
+
+  RowCache new_cache;
+  new_cache.reserve(hosts.size());
+  RowCache& old_cache = row_caches_[priority];
+
+  rows_.clear();
+  rows_.reserve(hosts.size());
+  for (const auto& host : hosts) {
+    MetadataConstSharedPtr metadata = host->metadata();
+    if (metadata == nullptr) {
+      rows_.push_back(&empty_row_);
+      continue;
+    }
+
+    auto [it, inserted] = new_cache.try_emplace(metadata.get());
+    if (inserted) {
+      auto old_it = old_cache.find(metadata.get());
+      if (old_it != old_cache.end()) {
+        it->second = std::move(old_it->second);
+      } else {
+        extractRow(metadata.get(), it->second);
+        it->second.metadata_ = std::move(metadata);
+      }
+    }
+    rows_.push_back(&it->second);
+  }
+  old_cache = std::move(new_cache);
+
+  const size_t num_words = (rows_.size() + 63) / 64;
+  for (uint32_t column = 0; column < columns_.size(); ++column) {
+    auto& bits = present_[column];
+    bits.assign(num_words, 0);
+    for (uint32_t row = 0; row < rows_.size(); ++row) {
+      const Row& r = *rows_[row];
+      if (r.offsets_[column + 1] != r.offsets_[column]) {
+        bits[row / 64] |= uint64_t(1) << (row % 64);
+      }
+    }
+  }
+
+  if (reset) {
+    interned_values_at_reset_ = interned_values_;
+  }
+}
+
+void SubsetMetadataIndex::forEachRowWithColumns(const std::vector<uint32_t>& columns,
+                                                const std::function<void(uint32_t row)>& cb) const {
+  if (columns.empty() || rows_.empty()) {
+    return;
+  }
+
+  std::vector<uint64_t> bits = present_[columns[0]];
+  for (size_t i = 1; i < columns.size(); ++i) {
+    const auto& other = present_[columns[i]];
+    // Plain word-wise AND that the compiler can vectorize.
+    for (size_t word = 0; word < bits.size(); ++word) {
+      bits[word] &= other[word];
+    }
+  }
+
+  for (size_t word = 0; word < bits.size(); ++word) {
+    uint64_t w = bits[word];
+    while (w != 0) {
+      const uint32_t bit = absl::countr_zero(w);
+      cb(word * 64 + bit);
+      w &= w - 1;
+    }
+  }
+}
+
+void SubsetMetadataIndex::forEachValueCombination(
+    uint32_t row, const std::vector<uint32_t>& columns,
+    const std::function<void(const std::vector<uint32_t>&)>& cb) const {
+  std::vector<uint32_t> value_ids(columns.size());
+  forEachValueCombination(row, columns, 0, value_ids, cb);
+}
+
+void SubsetMetadataIndex::forEachValueCombination(
+    uint32_t row, const std::vector<uint32_t>& columns, size_t idx,
+    std::vector<uint32_t>& value_ids,
+    const std::function<void(const std::vector<uint32_t>&)>& cb) const {
+  if (idx == columns.size()) {
+    cb(value_ids);
+    return;
+  }
+  for (const uint32_t value_id : values(row, columns[idx])) {
+    value_ids[idx] = value_id;
+    forEachValueCombination(row, columns, idx + 1, value_ids, cb);
+  }
+}
+
+// Extracts the values of every column from the host metadata. Mirrors the former per-selector
+// extraction: a missing key leaves the column empty and, with list_as_any, every element of a
+// list value is a value of the column.
+void SubsetMetadataIndex::extractRow(const envoy::config::core::v3::Metadata* metadata, Row& row) {
+  row.offsets_.clear();
+  row.value_ids_.clear();
+  row.offsets_.reserve(columns_.size() + 1);
+  row.offsets_.push_back(0);
+
+  const auto& filter_metadata = metadata->filter_metadata();
+  const auto filter_it = filter_metadata.find(Config::MetadataFilters::get().ENVOY_LB);
+  for (auto& column : columns_) {
+    if (filter_it != filter_metadata.end()) {
+      const auto& fields = filter_it->second.fields();
+      const auto it = fields.find(column.key_);
+      if (it != fields.end()) {
+        if (list_as_any_ && it->second.kind_case() == Protobuf::Value::kListValue) {
+          for (const auto& v : it->second.list_value().values()) {
+            row.value_ids_.push_back(intern(column, v));
+          }
+        } else {
+          row.value_ids_.push_back(intern(column, it->second));
+        }
+      }
+    }
+    row.offsets_.push_back(row.value_ids_.size());
+  }
+}
+
+uint32_t SubsetMetadataIndex::intern(Column& column, const Protobuf::Value& value) {
+  auto [it, inserted] = column.ids_.try_emplace(HashedValue(value), column.values_by_id_.size());
+  if (inserted) {
+    column.values_by_id_.push_back(&it->first);
+    interned_values_++;
+  }
+  return it->second;
+}
+
+} // namespace Upstream
+} // namespace Envoy
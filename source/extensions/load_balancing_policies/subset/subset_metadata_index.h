@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "envoy/config/core/v3/base.pb.h"
+#include "envoy/upstream/upstream.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/load_balancing_policies/subset/subset_lb_config.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/types/span.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Columnar index of the ``envoy.lb`` metadata values that the subset selectors refer to.
+ *
+ * Each distinct selector key is a column. Every value seen in a column is interned once as a
+ * HashedValue and referred to by a dense id afterwards, so hashing a protobuf value (which
+ * serializes it) happens once per distinct value rather than once per host, selector and key.
+ * The values of a host (a row) are cached by the identity of its metadata object, so hosts whose
+ * metadata did not change since the previous update of the same priority are not re-extracted.
+ * For every build a presence bitset over the rows is kept per column, and the rows eligible for a
+ * selector are the AND of the bitsets of its keys.
+ */
+class SubsetMetadataIndex {
+public:
+  SubsetMetadataIndex(const std::vector<SubsetSelectorPtr>& subset_selectors, bool list_as_any);
+
+  /**
+   * Rebuild the rows from the given hosts of one priority. Rows are numbered in host order.
+   */
+  void build(uint32_t priority, const HostVector& hosts);
+
+  /**
+   * @return the columns of the given selector, in the (sorted) order of its keys.
+   */
+  const std::vector<uint32_t>& selectorColumns(size_t selector_index) const {
+    return selector_columns_[selector_index];
+  }
+
+  /**
+   * Invoke the callback with the index of every row of the last build that has at least one value
+   * for each of the given columns, in ascending order.
+   */
+  void forEachRowWithColumns(const std::vector<uint32_t>& columns,
+                             const std::function<void(uint32_t row)>& cb) const;
+
+  /**
+   * Invoke the callback with every combination of the row's value ids for the given columns, one
+   * value per column. There is exactly one combination unless ``list_as_any`` expanded a list.
+   * The vector passed to the callback is only valid for the duration of the call.
+   */
+  void forEachValueCombination(uint32_t row, const std::vector<uint32_t>& columns,
+                               const std::function<void(const std::vector<uint32_t>&)>& cb) const;
+
+  /**
+   * @return the value ids of a row for a column. Only lists expanded with ``list_as_any`` have
+   *         more than one value; rows without the key have none.
+   */
+  absl::Span<const uint32_t> values(uint32_t row, uint32_t column) const {
+    const Row& r = *rows_[row];
+    return absl::MakeConstSpan(r.value_ids_).subspan(r.offsets_[column],
+                                                     r.offsets_[column + 1] - r.offsets_[column]);
+  }
+
+  const std::string& key(uint32_t column) const { return columns_[column].key_; }
+  const HashedValue& value(uint32_t column, uint32_t value_id) const {
+    return *columns_[column].values_by_id_[value_id];
+  }
+
+  uint32_t numRows() const { return rows_.size(); }
+  uint32_t numColumns() const { return columns_.size(); }
+
+private:
+  struct Column {
+    std::string key_;
+    absl::node_hash_map<HashedValue, uint32_t> ids_;
+    std::vector<const HashedValue*> values_by_id_;
+  };
+
+  // The value ids of each column of one host, flattened. The metadata is retained so that the
+  // address used as the cache key cannot be reused for different metadata.
+  struct Row {
+    MetadataConstSharedPtr metadata_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> value_ids_;
+  };
+  // Node based so that the rows referenced from rows_ stay put while the cache is filled.
+  using RowCache = absl::node_hash_map<const envoy::config::core::v3::Metadata*, Row>;
+
+  void extractRow(const envoy::config::core::v3::Metadata* metadata, Row& row);
+  uint32_t intern(Column& column, const Protobuf::Value& value);
+  void forEachValueCombination(uint32_t row, const std::vector<uint32_t>& columns, size_t idx,
+                               std::vector<uint32_t>& value_ids,
+                               const std::function<void(const std::vector<uint32_t>&)>& cb) const;
+
+  const bool list_as_any_;
+  std::vector<Column> columns_;
+  std::vector<std::vector<uint32_t>> selector_columns_;
+
+  // Per priority cache of the rows from the last build.
+  std::vector<RowCache> row_caches_;
+  // Row used for hosts without metadata.
+  Row empty_row_;
+
+  // Rows and per column presence bitsets of the last build.
+  std::vector<const Row*> rows_;
+  std::vector<std::vector<uint64_t>> present_;
+
+  // Interned values are never released individually. When their number grows well past the size
+  // after the last reset, all the dictionaries and caches are dropped and rebuilt.
+  size_t interned_values_{};
+  size_t interned_values_at_reset_{};
+};
+
+} // namespace Upstream
+} // namespace Envoy
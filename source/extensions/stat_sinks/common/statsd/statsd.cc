@@ -14,12 +14,14 @@
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/fmt.h"
+#include "source/common/common/mem_block_builder.h"
 #include "source/common/common/utility.h"
 #include "source/common/config/utility.h"
 #include "source/common/network/socket_interface.h"
 #include "source/common/network/utility.h"
 #include "source/common/stats/symbol_table.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 
 namespace Envoy {
@@ -28,6 +30,19 @@ namespace StatSinks {
 namespace Common {
 namespace Statsd {
 
+RenderedNameCache::CachedEntry::CachedEntry(Stats::StatName stat_name) {
+  MemBlockBuilder<uint8_t> storage(stat_name.size());
+  stat_name.copyToMemBlock(storage);
+  stat_name_ = Stats::StatNameStorageBase(storage.release());
+}
+
+void RenderedNameCache::endFlush() {
+  absl::erase_if(entries_, [this](const auto& metric_and_entry) {
+    return metric_and_entry.second.last_flush_ != num_flushes_;
+  });
+  ++num_flushes_;
+}
+
 UdpStatsdSink::WriterImpl::WriterImpl(UdpStatsdSink& parent)
     : parent_(parent), io_handle_(Network::ioHandleForAddr(Network::Socket::Type::Datagram,
                                                            parent_.server_address_, {})) {}
@@ -39,8 +54,29 @@ void UdpStatsdSink::WriterImpl::write(const std::string& message) {
   Network::Utility::writeToSocket(*io_handle_, &slice, 1, nullptr, *parent_.server_address_);
 }
 
-void UdpStatsdSink::WriterImpl::writeBuffer(Buffer::Instance& data) {
-  Network::Utility::writeToSocket(*io_handle_, data, nullptr, *parent_.server_address_);
+void UdpStatsdSink::WriterImpl::writeDatagrams(absl::Span<const std::string> messages) {
+  if (!io_handle_->supportsMmsg()) {
+    Writer::writeDatagrams(messages);
+    return;
+  }
+
+  slices_.resize(messages.size());
+  for (size_t i = 0; i < messages.size(); ++i) {
+    slices_[i] = {const_cast<char*>(messages[i].data()), messages[i].size()};
+  }
+
+  const absl::Span<const Buffer::RawSlice> datagrams(slices_);
+  size_t sent = 0;
+  while (sent < datagrams.size()) {
+    const Api::IoCallUint64Result result =
+        io_handle_->sendmmsg(datagrams.subspan(sent), *parent_.server_address_);
+    if (result.ok() && result.return_value_ > 0) {
+      sent += result.return_value_;
+    } else if (result.ok() || result.err_->getErrorCode() != Api::IoError::IoErrorCode::Interrupt) {
+      // The datagram that failed is dropped, as it would be by write().
+      ++sent;
+    }
+  }
 }
 
 UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
@@ -56,62 +92,82 @@ UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
 }
 
 void UdpStatsdSink::flush(Stats::MetricSnapshot& snapshot) {
-  Writer& writer = tls_->getTyped<Writer>();
-  Buffer::OwnedImpl buffer;
+  DatagramBatch batch(tls_->getTyped<Writer>(), buffer_size_, datagrams_);
+  const auto render_name = [this](const Stats::Metric& metric, RenderedNameCache::Entry& entry) {
+    renderName(metric, entry);
+  };
 
   for (const auto& counter : snapshot.counters()) {
     if (counter.counter_.get().used()) {
-      const std::string counter_str = buildMessage(counter.counter_.get(), counter.delta_, "|c");
-      writeBuffer(buffer, writer, counter_str);
+      line_.clear();
+      appendLine(line_, rendered_names_.get(counter.counter_.get(), render_name), counter.delta_,
+                 "|c");
+      batch.add(line_);
     }
   }
 
   for (const auto& counter : snapshot.hostCounters()) {
-    const std::string counter_str = buildMessage(counter, counter.delta(), "|c");
-    writeBuffer(buffer, writer, counter_str);
+    batch.add(buildMessage(counter, counter.delta(), "|c"));
   }
 
   for (const auto& gauge : snapshot.gauges()) {
     if (gauge.get().used()) {
-      const std::string gauge_str = buildMessage(gauge.get(), gauge.get().value(), "|g");
-      writeBuffer(buffer, writer, gauge_str);
+      line_.clear();
+      appendLine(line_, rendered_names_.get(gauge.get(), render_name), gauge.get().value(), "|g");
+      batch.add(line_);
     }
   }
 
   for (const auto& gauge : snapshot.hostGauges()) {
-    const std::string gauge_str = buildMessage(gauge, gauge.value(), "|g");
-    writeBuffer(buffer, writer, gauge_str);
+    batch.add(buildMessage(gauge, gauge.value(), "|g"));
   }
 
-  flushBuffer(buffer, writer);
+  batch.write();
+  rendered_names_.endFlush();
   // TODO(efimki): Add support of text readouts stats.
 }
 
-void UdpStatsdSink::writeBuffer(Buffer::OwnedImpl& buffer, Writer& writer,
-                                const std::string& statsd_metric) const {
-  if (statsd_metric.length() >= buffer_size_) {
-    // Our statsd_metric is too large to fit into the buffer, skip buffering and write directly
-    writer.write(statsd_metric);
-  } else {
-    if ((buffer.length() + statsd_metric.length() + 1) > buffer_size_) {
-      // If we add the new statsd_metric, we'll overflow our buffer. Flush the buffer to make
-      // room for the new statsd_metric.
-      flushBuffer(buffer, writer);
-    } else if (buffer.length() > 0) {
-      // We have room and have metrics already in the buffer, add a newline to separate
-      // metric entries.
-      buffer.add("\n");
+UdpStatsdSink::DatagramBatch::DatagramBatch(Writer& writer, uint64_t buffer_size,
+                                            std::vector<std::string>& datagrams)
+    : writer_(writer), buffer_size_(buffer_size), datagrams_(datagrams) {}
+
+void UdpStatsdSink::DatagramBatch::add(absl::string_view line) {
+  if (line.size() >= buffer_size_) {
+    // The line is too large to fit into the buffer, so it is sent on its own.
+    nextDatagram().assign(line.data(), line.size());
+    return;
+  }
+  if (open_datagram_.has_value()) {
+    std::string& datagram = datagrams_[*open_datagram_];
+    if (datagram.size() + line.size() + 1 <= buffer_size_) {
+      // Separate the metric entries with a newline.
+      datagram.push_back('\n');
+      datagram.append(line.data(), line.size());
+      return;
     }
-    buffer.add(statsd_metric);
   }
+  nextDatagram().assign(line.data(), line.size());
+  open_datagram_ = num_datagrams_ - 1;
 }
 
-void UdpStatsdSink::flushBuffer(Buffer::OwnedImpl& buffer, Writer& writer) const {
-  if (buffer.length() == 0) {
-    return;
+std::string& UdpStatsdSink::DatagramBatch::nextDatagram() {
+  if (num_datagrams_ == MaxDatagramsPerWrite) {
+    write();
+  }
+  if (num_datagrams_ == datagrams_.size()) {
+    datagrams_.emplace_back();
+  }
+  std::string& datagram = datagrams_[num_datagrams_++];
+  datagram.clear();
+  return datagram;
+}
+
+void UdpStatsdSink::DatagramBatch::write() {
+  if (num_datagrams_ > 0) {
+    writer_.writeDatagrams(absl::MakeConstSpan(datagrams_.data(), num_datagrams_));
   }
-  writer.writeBuffer(buffer);
-  buffer.drain(buffer.length());
+  num_datagrams_ = 0;
+  open_datagram_.reset();
 }
 
 void UdpStatsdSink::onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) {
@@ -164,6 +220,25 @@ const std::string UdpStatsdSink::buildMessage(const StatType& metric, ValueType
   PANIC_DUE_TO_CORRUPT_ENUM;
 }
 
+template <typename ValueType>
+void UdpStatsdSink::appendLine(std::string& line, const RenderedNameCache::Entry& name,
+                               ValueType value, absl::string_view type) const {
+  absl::StrAppend(&line, name.name_, ":", value, type, name.tags_);
+}
+
+void UdpStatsdSink::renderName(const Stats::Metric& metric, RenderedNameCache::Entry& entry) const {
+  switch (tag_format_.tag_position) {
+  case Statsd::TagPosition::TagAfterValue:
+    entry.name_ = absl::StrCat(prefix_, ".", getName(metric));
+    entry.tags_ = buildTagStr(metric.tags());
+    return;
+  case Statsd::TagPosition::TagAfterName:
+    entry.name_ = absl::StrCat(prefix_, ".", getName(metric), buildTagStr(metric.tags()));
+    return;
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
 template <class StatType> const std::string UdpStatsdSink::getName(const StatType& metric) const {
   if (use_tag_) {
     return metric.tagExtractedName();
@@ -233,10 +308,10 @@ void TcpStatsdSink::flush(Stats::MetricSnapshot& snapshot) {
     if (gauge.get().used()) {
       tls_sink.flushGauge(gauge.get().name(), gauge.get().value());
     }
+  }
 
-    for (const auto& gauge : snapshot.hostGauges()) {
-      tls_sink.flushGauge(gauge.name(), gauge.value());
-    }
+  for (const auto& gauge : snapshot.hostGauges()) {
+    tls_sink.flushGauge(gauge.name(), gauge.value());
   }
   // TODO(efimki): Add support of text readouts stats.
   tls_sink.endFlush(true);
@@ -291,7 +366,7 @@ void TcpStatsdSink::TlsSink::commonFlush(const std::string& name, uint64_t value
   // This written this way for maximum perf since with a large number of stats and at a high flush
   // rate this can become expensive.
   const char* snapped_current = current_slice_mem_;
-  const std::string prefix = parent_.getPrefix();
+  const std::string& prefix = parent_.getPrefix();
   memcpy(current_slice_mem_, prefix.data(), prefix.size()); // NOLINT(safe-memcpy)
   current_slice_mem_ += prefix.size();
   *current_slice_mem_++ = '.';
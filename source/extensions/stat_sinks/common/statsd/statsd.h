@@ -1,6 +1,8 @@
 #pragma once
 
 #include <optional>
+#include <string>
+#include <vector>
 
 #include "envoy/buffer/buffer.h"
 #include "envoy/common/platform.h"
@@ -17,8 +19,12 @@
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/macros.h"
 #include "source/common/network/io_socket_handle_impl.h"
+#include "source/common/stats/symbol_table.h"
 #include "source/extensions/stat_sinks/common/statsd/tag_formats.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace StatSinks {
@@ -27,6 +33,62 @@ namespace Statsd {
 
 static const std::string& getDefaultPrefix() { CONSTRUCT_ON_FIRST_USE(std::string, "envoy"); }
 
+/**
+ * Caches, per counter and gauge, the statsd rendering of the metric's name and tags, so that
+ * flushes don't decode the name and the tags of every metric again. An entry is rendered when its
+ * metric is first flushed, and dropped by the first flush that doesn't include the metric. Only
+ * used on the main thread.
+ */
+class RenderedNameCache {
+public:
+  struct Entry {
+    // The prefixed name, followed by the tags if they are rendered before the value.
+    std::string name_;
+    // The tags, if they are rendered after the value.
+    std::string tags_;
+  };
+
+  /**
+   * @return the entry of the metric, calling render(metric, entry) to fill it in if the metric
+   *         was not part of the previous flush.
+   */
+  template <class Render> const Entry& get(const Stats::Metric& metric, Render render) {
+    auto it = entries_.find(&metric);
+    if (it != entries_.end() && it->second.stat_name_.statName() != metric.statName()) {
+      // Another metric was allocated at the same address.
+      entries_.erase(it);
+      it = entries_.end();
+    }
+    if (it == entries_.end()) {
+      it = entries_.try_emplace(&metric, metric.statName()).first;
+      render(metric, it->second.entry_);
+    }
+    it->second.last_flush_ = num_flushes_;
+    return it->second.entry_;
+  }
+
+  /**
+   * Drops the entries of the metrics that were not part of the flush.
+   */
+  void endFlush();
+
+  size_t size() const { return entries_.size(); }
+
+private:
+  struct CachedEntry {
+    explicit CachedEntry(Stats::StatName stat_name);
+
+    // A copy of the encoded name of the metric. It doesn't reference the symbols of the name, so
+    // the sink can outlive the symbol table.
+    Stats::StatNameStorageBase stat_name_;
+    Entry entry_;
+    uint64_t last_flush_{};
+  };
+
+  absl::flat_hash_map<const Stats::Metric*, CachedEntry> entries_;
+  uint64_t num_flushes_{};
+};
+
 /**
  * Implementation of Sink that writes to a UDP statsd address.
  */
@@ -38,9 +100,21 @@ public:
   class Writer : public ThreadLocal::ThreadLocalObject {
   public:
     virtual void write(const std::string& message) PURE;
-    virtual void writeBuffer(Buffer::Instance& data) PURE;
+
+    /**
+     * Writes each of the messages as a separate datagram. Writers that can send several
+     * datagrams per system call override this.
+     */
+    virtual void writeDatagrams(absl::Span<const std::string> messages) {
+      for (const std::string& message : messages) {
+        write(message);
+      }
+    }
   };
 
+  // Number of datagrams handed to the writer at once by a flush.
+  static constexpr size_t MaxDatagramsPerWrite = 64;
+
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address,
                 const bool use_tag, const std::string& prefix = getDefaultPrefix(),
                 std::optional<uint64_t> buffer_size = std::nullopt,
@@ -75,19 +149,45 @@ private:
 
     // Writer
     void write(const std::string& message) override;
-    void writeBuffer(Buffer::Instance& data) override;
+    void writeDatagrams(absl::Span<const std::string> messages) override;
 
   private:
     UdpStatsdSink& parent_;
     const Network::IoHandlePtr io_handle_;
+    std::vector<Buffer::RawSlice> slices_;
   };
 
-  void flushBuffer(Buffer::OwnedImpl& buffer, Writer& writer) const;
-  void writeBuffer(Buffer::OwnedImpl& buffer, Writer& writer, const std::string& data) const;
+  /**
+   * Packs the metric lines of a flush into datagrams of up to buffer_size bytes, and hands them
+   * to the writer MaxDatagramsPerWrite at a time. Lines that don't fit in the buffer are sent in
+   * datagrams of their own.
+   */
+  class DatagramBatch {
+  public:
+    DatagramBatch(Writer& writer, uint64_t buffer_size, std::vector<std::string>& datagrams);
+
+    void add(absl::string_view line);
+    void write();
+
+  private:
+    std::string& nextDatagram();
+
+    Writer& writer_;
+    const uint64_t buffer_size_;
+    // Reused across flushes, so that the datagrams keep their capacity.
+    std::vector<std::string>& datagrams_;
+    size_t num_datagrams_{0};
+    // The datagram lines are being packed into, if any.
+    std::optional<size_t> open_datagram_;
+  };
 
   template <class StatType, typename ValueType>
   const std::string buildMessage(const StatType& metric, ValueType value,
                                  const std::string& type) const;
+  template <typename ValueType>
+  void appendLine(std::string& line, const RenderedNameCache::Entry& name, ValueType value,
+                  absl::string_view type) const;
+  void renderName(const Stats::Metric& metric, RenderedNameCache::Entry& entry) const;
   template <class StatType> const std::string getName(const StatType& metric) const;
   const std::string buildTagStr(const std::vector<Stats::Tag>& tags) const;
 
@@ -98,6 +198,10 @@ private:
   const std::string prefix_;
   const uint64_t buffer_size_;
   const Statsd::TagFormat tag_format_;
+  // Main thread state of flushes.
+  RenderedNameCache rendered_names_;
+  std::vector<std::string> datagrams_;
+  std::string line_;
 };
 
 /**
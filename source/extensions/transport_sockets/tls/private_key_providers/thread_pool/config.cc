@@ -0,0 +1,37 @@
+#include "source/extensions/transport_sockets/tls/private_key_providers/thread_pool/config.h"
+
+#include <memory>
+
+#include "envoy/extensions/transport_sockets/tls/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+#include "envoy/extensions/transport_sockets/tls/private_key_providers/thread_pool/v3/thread_pool.pb.validate.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/transport_socket_config.h"
+
+#include "source/common/config/utility.h"
+#include "source/common/protobuf/message_validator_impl.h"
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/transport_sockets/tls/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+Ssl::PrivateKeyMethodProviderSharedPtr
+ThreadPoolPrivateKeyMethodFactory::createPrivateKeyMethodProviderInstance(
+    const envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider& proto_config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context) {
+  envoy::extensions::transport_sockets::tls::private_key_providers::thread_pool::v3::
+      ThreadPoolPrivateKeyMethodConfig config;
+  THROW_IF_NOT_OK(Config::Utility::translateOpaqueConfig(
+      proto_config.typed_config(), ProtobufMessage::getNullValidationVisitor(), config));
+  MessageUtil::validate(config, factory_context.messageValidationVisitor());
+  return std::make_shared<ThreadPoolPrivateKeyMethodProvider>(config, factory_context);
+}
+
+REGISTER_FACTORY(ThreadPoolPrivateKeyMethodFactory, Ssl::PrivateKeyMethodProviderInstanceFactory);
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
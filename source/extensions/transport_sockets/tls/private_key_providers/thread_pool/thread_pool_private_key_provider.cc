@@ -0,0 +1,385 @@
+#include "source/extensions/transport_sockets/tls/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include "envoy/common/exception.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/common/macros.h"
+#include "source/common/config/datasource.h"
+#include "source/common/protobuf/utility.h"
+
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+using envoy::extensions::transport_sockets::tls::private_key_providers::thread_pool::v3::
+    ThreadPoolPrivateKeyMethodConfig;
+
+namespace {
+
+constexpr uint32_t DefaultMaxQueuedOperations = 1024;
+
+ThreadPoolPrivateKeyConnection* getConnection(SSL* ssl) {
+  return static_cast<ThreadPoolPrivateKeyConnection*>(
+      SSL_get_ex_data(ssl, ThreadPoolPrivateKeyMethodProvider::connectionIndex()));
+}
+
+ssl_private_key_result_t privateKeySign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                        uint16_t signature_algorithm, const uint8_t* in,
+                                        size_t in_len) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl);
+  if (connection == nullptr || connection->operation_ != nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->provider_.start(*connection, PrivateKeyOperation::Type::Sign,
+                                     signature_algorithm, in, in_len, out, out_len, max_out);
+}
+
+ssl_private_key_result_t privateKeyDecrypt(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                           const uint8_t* in, size_t in_len) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl);
+  if (connection == nullptr || connection->operation_ != nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->provider_.start(*connection, PrivateKeyOperation::Type::Decrypt, 0, in,
+                                     in_len, out, out_len, max_out);
+}
+
+ssl_private_key_result_t privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                            size_t max_out) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl);
+  if (connection == nullptr || connection->operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  const ssl_private_key_result_t result = connection->operation_->result(out, out_len, max_out);
+  if (result != ssl_private_key_retry) {
+    connection->operation_ = nullptr;
+  }
+  return result;
+}
+
+} // namespace
+
+bool PrivateKeyOperation::run() {
+  switch (type_) {
+  case Type::Sign: {
+    if (EVP_PKEY_id(pkey_.get()) != SSL_get_signature_algorithm_key_type(signature_algorithm_)) {
+      return false;
+    }
+    // The digest is null for Ed25519, which signs the message itself.
+    const EVP_MD* md = SSL_get_signature_algorithm_digest(signature_algorithm_);
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx;
+    if (!EVP_DigestSignInit(ctx.get(), &pctx, md, nullptr, pkey_.get())) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm_) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1))) {
+      return false;
+    }
+    size_t out_len = EVP_PKEY_size(pkey_.get());
+    out_.resize(out_len);
+    if (!EVP_DigestSign(ctx.get(), out_.data(), &out_len, in_.data(), in_.size())) {
+      return false;
+    }
+    out_.resize(out_len);
+    return true;
+  }
+  case Type::Decrypt: {
+    RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+    if (rsa == nullptr) {
+      return false;
+    }
+    size_t out_len;
+    out_.resize(RSA_size(rsa));
+    if (!RSA_decrypt(rsa, &out_len, out_.data(), out_.size(), in_.data(), in_.size(),
+                     RSA_NO_PADDING)) {
+      return false;
+    }
+    out_.resize(out_len);
+    return true;
+  }
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+ssl_private_key_result_t PrivateKeyOperation::output(uint8_t* out, size_t* out_len,
+                                                     size_t max_out) const {
+  if (out_.size() > max_out) {
+    return ssl_private_key_failure;
+  }
+  std::copy(out_.begin(), out_.end(), out);
+  *out_len = out_.size();
+  return ssl_private_key_success;
+}
+
+void PrivateKeyOperation::complete(bool succeeded) {
+  absl::MutexLock lock(mutex_);
+  completed_ = true;
+  succeeded_ = succeeded;
+  if (cancelled_) {
+    return;
+  }
+  // Post while holding the lock: once cancel() has returned, the dispatcher may be gone.
+  dispatcher_.post([self = shared_from_this()]() { self->resume(); });
+}
+
+void PrivateKeyOperation::resume() {
+  if (!cancelled()) {
+    cb_.onPrivateKeyMethodComplete();
+  }
+}
+
+void PrivateKeyOperation::cancel() {
+  absl::MutexLock lock(mutex_);
+  cancelled_ = true;
+}
+
+bool PrivateKeyOperation::cancelled() const {
+  absl::MutexLock lock(mutex_);
+  return cancelled_;
+}
+
+ssl_private_key_result_t PrivateKeyOperation::result(uint8_t* out, size_t* out_len,
+                                                     size_t max_out) {
+  bool succeeded;
+  {
+    absl::MutexLock lock(mutex_);
+    if (!completed_) {
+      return ssl_private_key_retry;
+    }
+    succeeded = succeeded_;
+  }
+  return succeeded ? output(out, out_len, max_out) : ssl_private_key_failure;
+}
+
+SigningThreadPool::SigningThreadPool(Thread::ThreadFactory& thread_factory, uint32_t thread_count,
+                                     std::shared_ptr<SigningThreadPoolCache> cache)
+    : cache_(std::move(cache)) {
+  threads_.reserve(thread_count);
+  while (threads_.size() < thread_count) {
+    threads_.push_back(
+        thread_factory.createThread([this]() { worker(); }, Thread::Options{"tls_signing"}));
+  }
+}
+
+SigningThreadPool::~SigningThreadPool() {
+  {
+    absl::MutexLock lock(mutex_);
+    // Every provider removed its operations before releasing the pool.
+    ASSERT(queue_.empty());
+    terminate_ = true;
+  }
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+bool SigningThreadPool::enqueue(PrivateKeyOperationSharedPtr operation, SigningClient& client) {
+  absl::MutexLock lock(mutex_);
+  if (client.queued_ >= client.max_queued_operations_) {
+    return false;
+  }
+  queue_.push_back({std::move(operation), &client});
+  client.queued_++;
+  client.stats_.queue_depth_.inc();
+  return true;
+}
+
+void SigningThreadPool::removeClient(SigningClient& client) {
+  absl::MutexLock lock(mutex_);
+  // The connections of the queued operations are all closed by now.
+  queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                              [&client](const QueuedOperation& queued) {
+                                return queued.client_ == &client;
+                              }),
+               queue_.end());
+  client.stats_.queue_depth_.sub(client.queued_);
+  client.queued_ = 0;
+  // The signing threads account the operations they run on the stats of the client.
+  const auto condition = [&client]() { return client.running_ == 0; };
+  mutex_.Await(absl::Condition(&condition));
+}
+
+void SigningThreadPool::worker() {
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !queue_.empty() || terminate_;
+  };
+  while (true) {
+    QueuedOperation queued;
+    {
+      absl::MutexLock lock(mutex_);
+      mutex_.Await(absl::Condition(&condition));
+      if (terminate_) {
+        return;
+      }
+      queued = std::move(queue_.front());
+      queue_.pop_front();
+      queued.client_->queued_--;
+      queued.client_->running_++;
+      queued.client_->stats_.queue_depth_.dec();
+    }
+    ThreadPoolPrivateKeyProviderStats& stats = queued.client_->stats_;
+    if (queued.operation_->cancelled()) {
+      stats.cancelled_.inc();
+    } else {
+      const bool succeeded = queued.operation_->run();
+      if (!succeeded) {
+        stats.failed_.inc();
+      }
+      queued.operation_->complete(succeeded);
+    }
+    absl::MutexLock lock(mutex_);
+    queued.client_->running_--;
+  }
+}
+
+SINGLETON_MANAGER_REGISTRATION(thread_pool_private_key_provider_signing_pools);
+
+SigningThreadPoolSharedPtr
+SigningThreadPoolCache::getOrCreate(Thread::ThreadFactory& thread_factory, uint32_t thread_count) {
+  ASSERT_IS_MAIN_OR_TEST_THREAD();
+  if (thread_count == 0) {
+    thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  if (auto it = pools_.find(thread_count); it != pools_.end()) {
+    if (SigningThreadPoolSharedPtr existing = it->second.lock(); existing != nullptr) {
+      return existing;
+    }
+  }
+  absl::erase_if(pools_, [](const auto& entry) { return entry.second.expired(); });
+  auto pool =
+      std::make_shared<SigningThreadPool>(thread_factory, thread_count, shared_from_this());
+  pools_[thread_count] = pool;
+  return pool;
+}
+
+std::shared_ptr<SigningThreadPoolCache> getSigningThreadPoolCache(Singleton::Manager& manager) {
+  return manager.getTyped<SigningThreadPoolCache>(
+      SINGLETON_MANAGER_REGISTERED_NAME(thread_pool_private_key_provider_signing_pools),
+      [] { return std::make_shared<SigningThreadPoolCache>(); });
+}
+
+ThreadPoolPrivateKeyConnection::~ThreadPoolPrivateKeyConnection() {
+  if (operation_ != nullptr) {
+    operation_->cancel();
+  }
+}
+
+int ThreadPoolPrivateKeyMethodProvider::connectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    RELEASE_ASSERT(index >= 0, "Failed to get SSL user data index.");
+    return index;
+  }());
+}
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(
+    const ThreadPoolPrivateKeyMethodConfig& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context)
+    : overflow_action_(config.overflow_action()),
+      stats_{ALL_THREAD_POOL_PRIVATE_KEY_PROVIDER_STATS(
+          POOL_COUNTER_PREFIX(factory_context.statsScope(), "thread_pool_private_key_provider."),
+          POOL_GAUGE_PREFIX(factory_context.statsScope(), "thread_pool_private_key_provider."))},
+      client_(stats_, PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_queued_operations,
+                                                      DefaultMaxQueuedOperations)) {
+  std::string private_key = THROW_OR_RETURN_VALUE(
+      Config::DataSource::read(config.private_key(), false,
+                               factory_context.serverFactoryContext().api()),
+      std::string);
+  bssl::UniquePtr<BIO> bio(
+      BIO_new_mem_buf(const_cast<char*>(private_key.data()), private_key.size()));
+  bssl::UniquePtr<EVP_PKEY> pkey(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  if (pkey == nullptr) {
+    throw EnvoyException("Failed to read private key.");
+  }
+  const int key_type = EVP_PKEY_id(pkey.get());
+  if (key_type != EVP_PKEY_RSA && key_type != EVP_PKEY_EC && key_type != EVP_PKEY_ED25519) {
+    throw EnvoyException("Only RSA, ECDSA and Ed25519 private keys are supported.");
+  }
+  pkey_ = std::move(pkey);
+
+  pool_ = getSigningThreadPoolCache(factory_context.serverFactoryContext().singletonManager())
+              ->getOrCreate(factory_context.serverFactoryContext().api().threadFactory(),
+                            config.thread_count());
+
+  method_ = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  method_->sign = privateKeySign;
+  method_->decrypt = privateKeyDecrypt;
+  method_->complete = privateKeyComplete;
+  ENVOY_LOG(debug, "initialized thread pool private key provider sharing {} signing threads",
+            pool_->threadCount());
+}
+
+ThreadPoolPrivateKeyMethodProvider::~ThreadPoolPrivateKeyMethodProvider() {
+  pool_->removeClient(client_);
+}
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher) {
+  if (SSL_get_ex_data(ssl, connectionIndex()) != nullptr) {
+    throw EnvoyException("Registering the thread pool private key provider twice for the same SSL "
+                         "object is not supported.");
+  }
+  SSL_set_ex_data(ssl, connectionIndex(),
+                  new ThreadPoolPrivateKeyConnection(*this, cb, dispatcher));
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl);
+  SSL_set_ex_data(ssl, connectionIndex(), nullptr);
+  delete connection;
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::checkFips() {
+  switch (EVP_PKEY_id(pkey_.get())) {
+  case EVP_PKEY_RSA: {
+    RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+    return rsa != nullptr && RSA_check_fips(rsa);
+  }
+  case EVP_PKEY_EC: {
+    const EC_KEY* ec_key = EVP_PKEY_get0_EC_KEY(pkey_.get());
+    return ec_key != nullptr && EC_KEY_check_fips(ec_key);
+  }
+  default:
+    return false;
+  }
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::start(
+    ThreadPoolPrivateKeyConnection& connection, PrivateKeyOperation::Type type,
+    uint16_t signature_algorithm, const uint8_t* in, size_t in_len, uint8_t* out,
+    size_t* out_len, size_t max_out) {
+  auto operation = std::make_shared<PrivateKeyOperation>(type, bssl::UpRef(pkey_),
+                                                         signature_algorithm, in, in_len,
+                                                         connection.dispatcher_, connection.cb_);
+  if (pool_->enqueue(operation, client_)) {
+    stats_.offloaded_.inc();
+    connection.operation_ = std::move(operation);
+    return ssl_private_key_retry;
+  }
+  if (overflow_action_ == ThreadPoolPrivateKeyMethodConfig::FAIL_HANDSHAKE) {
+    stats_.rejected_.inc();
+    return ssl_private_key_failure;
+  }
+  stats_.ran_inline_.inc();
+  if (!operation->run()) {
+    stats_.failed_.inc();
+    return ssl_private_key_failure;
+  }
+  return operation->output(out, out_len, max_out);
+}
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
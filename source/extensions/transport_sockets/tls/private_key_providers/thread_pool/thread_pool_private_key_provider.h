@@ -0,0 +1,252 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/transport_sockets/tls/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+#include "envoy/server/transport_socket_config.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/singleton/manager.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+#define ALL_THREAD_POOL_PRIVATE_KEY_PROVIDER_STATS(COUNTER, GAUGE)                                 \
+  COUNTER(cancelled)                                                                               \
+  COUNTER(failed)                                                                                  \
+  COUNTER(offloaded)                                                                               \
+  COUNTER(ran_inline)                                                                              \
+  COUNTER(rejected)                                                                                \
+  GAUGE(queue_depth, NeverImport)
+
+/**
+ * Thread pool private key provider stats. @see stats_macros.h
+ */
+struct ThreadPoolPrivateKeyProviderStats {
+  ALL_THREAD_POOL_PRIVATE_KEY_PROVIDER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+// A private key operation of a handshake. It is created on the worker thread, computed by a
+// signing thread and consumed back on the worker thread.
+class PrivateKeyOperation : public std::enable_shared_from_this<PrivateKeyOperation> {
+public:
+  enum class Type { Sign, Decrypt };
+
+  PrivateKeyOperation(Type type, bssl::UniquePtr<EVP_PKEY> pkey, uint16_t signature_algorithm,
+                      const uint8_t* in, size_t in_len, Event::Dispatcher& dispatcher,
+                      Ssl::PrivateKeyConnectionCallbacks& cb)
+      : type_(type), pkey_(std::move(pkey)), signature_algorithm_(signature_algorithm),
+        in_(in, in + in_len), dispatcher_(dispatcher), cb_(cb) {}
+
+  /**
+   * Computes the result of the operation on the calling thread.
+   * @return whether the operation succeeded.
+   */
+  bool run();
+
+  /**
+   * Copies the result of a successful run().
+   */
+  ssl_private_key_result_t output(uint8_t* out, size_t* out_len, size_t max_out) const;
+
+  /**
+   * Called on a signing thread once the operation has run, to resume the handshake on the worker
+   * thread unless the connection was closed in the meantime.
+   */
+  void complete(bool succeeded) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /**
+   * Called on the worker thread when the connection is closed, so that no signing thread touches
+   * the connection or its dispatcher anymore.
+   */
+  void cancel() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  bool cancelled() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /**
+   * Called on the worker thread by BoringSSL to collect the result.
+   * @return ssl_private_key_retry until the operation has completed.
+   */
+  ssl_private_key_result_t result(uint8_t* out, size_t* out_len, size_t max_out)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+private:
+  void resume();
+
+  const Type type_;
+  const bssl::UniquePtr<EVP_PKEY> pkey_;
+  const uint16_t signature_algorithm_;
+  const std::vector<uint8_t> in_;
+  // Only written by run(), and only read on the worker thread once completed_ is set.
+  std::vector<uint8_t> out_;
+
+  Event::Dispatcher& dispatcher_;
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+
+  mutable absl::Mutex mutex_;
+  bool completed_ ABSL_GUARDED_BY(mutex_){};
+  bool succeeded_ ABSL_GUARDED_BY(mutex_){};
+  bool cancelled_ ABSL_GUARDED_BY(mutex_){};
+};
+
+using PrivateKeyOperationSharedPtr = std::shared_ptr<PrivateKeyOperation>;
+
+// The share of a signing thread pool of one provider: where its operations are accounted and how
+// many of them may wait for a signing thread. The counts are guarded by the mutex of the pool.
+struct SigningClient {
+  SigningClient(ThreadPoolPrivateKeyProviderStats& stats, uint32_t max_queued_operations)
+      : stats_(stats), max_queued_operations_(max_queued_operations) {}
+
+  ThreadPoolPrivateKeyProviderStats& stats_;
+  const uint32_t max_queued_operations_;
+  uint32_t queued_{};
+  uint32_t running_{};
+};
+
+class SigningThreadPoolCache;
+
+// A queue of private key operations served by a pool of signing threads. The pool is shared by
+// all the providers configured with the same number of threads, and bounds the queued operations
+// of each provider separately.
+class SigningThreadPool : Logger::Loggable<Logger::Id::connection> {
+public:
+  SigningThreadPool(Thread::ThreadFactory& thread_factory, uint32_t thread_count,
+                    std::shared_ptr<SigningThreadPoolCache> cache);
+  ~SigningThreadPool() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /**
+   * Queues an operation of the client, unless the client already has its maximum of queued
+   * operations.
+   * @return whether the operation was queued.
+   */
+  bool enqueue(PrivateKeyOperationSharedPtr operation, SigningClient& client)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /**
+   * Drops the queued operations of the client and waits for its running ones, so that the client
+   * can be destroyed.
+   */
+  void removeClient(SigningClient& client) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  size_t threadCount() const { return threads_.size(); }
+
+private:
+  struct QueuedOperation {
+    PrivateKeyOperationSharedPtr operation_;
+    SigningClient* client_{};
+  };
+
+  void worker() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  absl::Mutex mutex_;
+  std::deque<QueuedOperation> queue_ ABSL_GUARDED_BY(mutex_);
+  bool terminate_ ABSL_GUARDED_BY(mutex_){};
+  std::vector<Thread::ThreadPtr> threads_;
+  // Keeps the cache alive so that the providers created later find this pool.
+  const std::shared_ptr<SigningThreadPoolCache> cache_;
+};
+
+using SigningThreadPoolSharedPtr = std::shared_ptr<SigningThreadPool>;
+
+// Process-wide signing thread pools keyed by their number of threads, so that the providers of
+// every filter chain and certificate, and of every xDS update, share the same signing threads
+// rather than each starting as many threads as there are cores. Only weak_ptrs are stored, so a
+// pool is stopped once the last provider using it is destroyed. Must be used on the main thread.
+class SigningThreadPoolCache : public Singleton::Instance,
+                               public std::enable_shared_from_this<SigningThreadPoolCache> {
+public:
+  /**
+   * @return the pool with thread_count threads, or the number of concurrent threads the hardware
+   *         supports if thread_count is zero, starting it on first use.
+   */
+  SigningThreadPoolSharedPtr getOrCreate(Thread::ThreadFactory& thread_factory,
+                                         uint32_t thread_count);
+
+private:
+  absl::flat_hash_map<uint32_t, std::weak_ptr<SigningThreadPool>> pools_;
+};
+
+// Returns the process-wide signing thread pool cache, creating it on first use.
+std::shared_ptr<SigningThreadPoolCache> getSigningThreadPoolCache(Singleton::Manager& manager);
+
+class ThreadPoolPrivateKeyMethodProvider;
+
+// ThreadPoolPrivateKeyConnection holds the operation in flight for a given SSL connection.
+class ThreadPoolPrivateKeyConnection {
+public:
+  ThreadPoolPrivateKeyConnection(ThreadPoolPrivateKeyMethodProvider& provider,
+                                 Ssl::PrivateKeyConnectionCallbacks& cb,
+                                 Event::Dispatcher& dispatcher)
+      : provider_(provider), cb_(cb), dispatcher_(dispatcher) {}
+  ~ThreadPoolPrivateKeyConnection();
+
+  ThreadPoolPrivateKeyMethodProvider& provider_;
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+  Event::Dispatcher& dispatcher_;
+  PrivateKeyOperationSharedPtr operation_;
+};
+
+// ThreadPoolPrivateKeyMethodProvider runs the private key operations of the handshakes on a pool
+// of signing threads, so that they don't block the worker threads.
+class ThreadPoolPrivateKeyMethodProvider : public virtual Ssl::PrivateKeyMethodProvider,
+                                           public Logger::Loggable<Logger::Id::connection> {
+public:
+  ThreadPoolPrivateKeyMethodProvider(
+      const envoy::extensions::transport_sockets::tls::private_key_providers::thread_pool::v3::
+          ThreadPoolPrivateKeyMethodConfig& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context);
+  ~ThreadPoolPrivateKeyMethodProvider() override;
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  bool checkFips() override;
+  bool isAvailable() override { return true; }
+  Ssl::BoringSslPrivateKeyMethodSharedPtr getBoringSslPrivateKeyMethod() override {
+    return method_;
+  }
+
+  /**
+   * Starts an operation for the connection, on a signing thread when the queue has room.
+   * @return ssl_private_key_retry if the operation was queued, otherwise the result of the
+   *         operation run inline or ssl_private_key_failure.
+   */
+  ssl_private_key_result_t start(ThreadPoolPrivateKeyConnection& connection,
+                                 PrivateKeyOperation::Type type, uint16_t signature_algorithm,
+                                 const uint8_t* in, size_t in_len, uint8_t* out, size_t* out_len,
+                                 size_t max_out);
+
+  static int connectionIndex();
+
+  const ThreadPoolPrivateKeyProviderStats& stats() const { return stats_; }
+
+private:
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  const envoy::extensions::transport_sockets::tls::private_key_providers::thread_pool::v3::
+      ThreadPoolPrivateKeyMethodConfig::OverflowAction overflow_action_;
+  ThreadPoolPrivateKeyProviderStats stats_;
+  SigningClient client_;
+  SigningThreadPoolSharedPtr pool_;
+};
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -113,6 +113,8 @@ void ActiveRawUdpListener::onDataWorker(Network::UdpRecvData&& data) {
 
 void ActiveRawUdpListener::onReadReady() {}
 
+void ActiveRawUdpListener::onReadComplete() {}
+
 void ActiveRawUdpListener::onWriteReady(const Network::Socket&) {
   // TODO(sumukhs): This is not used now. When write filters are implemented, this is a
   // trigger to invoke the on write ready API on the filters which is when they can write
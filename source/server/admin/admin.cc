@@ -166,6 +166,32 @@ AdminImpl::AdminImpl(const std::string& profile_path, Server::Instance& server,
                         "enable",
                         "enable/disable the heap profiler",
                         {"y", "n"}}}),
+          makeHandler("/scopeprofiler",
+                      "enable/disable the sampling profiler attributing CPU time to the "
+                      "listeners, filter chains, routes and clusters",
+                      MAKE_ADMIN_HANDLER(profiling_handler_.handlerScopeProfiler), false, true,
+                      {{Admin::ParamDescriptor::Type::Enum,
+                        "enable",
+                        "enable/disable the scope profiler",
+                        {"y", "n"}},
+                       {Admin::ParamDescriptor::Type::String, "interval_ms",
+                        "CPU time between samples, in milliseconds. Defaults to 10."}}),
+          makeHandler("/scope_profile", "dump the samples of the scope profiler",
+                      MAKE_ADMIN_HANDLER(profiling_handler_.handlerScopeProfile), false, false),
+          makeHandler("/slowcallbacks",
+                      "enable/disable the recording of the slowest event loop callbacks of each "
+                      "thread, with the connection or stream they worked on",
+                      MAKE_ADMIN_HANDLER(profiling_handler_.handlerSlowCallbackTracker), false,
+                      true,
+                      {{Admin::ParamDescriptor::Type::Enum,
+                        "enable",
+                        "enable/disable the slow callback recording",
+                        {"y", "n"}},
+                       {Admin::ParamDescriptor::Type::String, "threshold_ms",
+                        "Minimum duration of the recorded callbacks, in milliseconds. Defaults "
+                        "to 10."}}),
+          makeHandler("/slow_callbacks", "dump the slowest event loop callbacks of each thread",
+                      MAKE_ADMIN_HANDLER(profiling_handler_.handlerSlowCallbacks), false, false),
           makeHandler("/heap_dump", "dump current Envoy heap (if supported)",
                       MAKE_ADMIN_HANDLER(tcmalloc_profiling_handler_.handlerHeapDump), false,
                       false),
@@ -236,20 +262,7 @@ AdminImpl::AdminImpl(const std::string& profile_path, Server::Instance& server,
           makeHandler("/ready", "print server state, return 200 if LIVE, otherwise return 503",
                       MAKE_ADMIN_HANDLER(server_info_handler_.handlerReady), false, false),
           stats_handler_.statsHandler(false /* not active mode */),
-          makeHandler("/stats/prometheus", "print server stats in prometheus format",
-                      MAKE_ADMIN_HANDLER(stats_handler_.handlerPrometheusStats), false, false,
-                      {{ParamDescriptor::Type::Boolean, "usedonly",
-                        "Only include stats that have been written by system since restart"},
-                       {ParamDescriptor::Type::Boolean, "text_readouts",
-                        "Render text_readouts as new gaugues with value 0 (increases Prometheus "
-                        "data size)"},
-                       {ParamDescriptor::Type::String, "filter",
-                        "Regular expression (Google re2) for filtering stats"},
-                       {ParamDescriptor::Type::Boolean, "invert_filter", "Invert the filter regex"},
-                       {ParamDescriptor::Type::Enum,
-                        "histogram_buckets",
-                        "Histogram bucket display mode",
-                        {"cumulative", "summary"}}}),
+          stats_handler_.prometheusStatsHandler(),
           makeHandler("/stats/recentlookups", "Show recent stat-name lookups",
                       MAKE_ADMIN_HANDLER(stats_handler_.handlerStatsRecentLookups), false, false),
           makeHandler("/stats/recentlookups/clear", "clear list of stat-name lookups and counter",
@@ -135,6 +135,9 @@ public:
                        });
   }
   void addAllowlistedPath(Matchers::StringMatcherPtr matcher);
+  void setPrometheusScrapeCacheFreshness(std::chrono::milliseconds freshness) {
+    stats_handler_.setPrometheusScrapeCacheFreshness(freshness);
+  }
   bool flushAccessLogOnNewRequest() override { return flush_access_log_on_new_request_; }
   bool flushAccessLogOnTunnelSuccessfullyEstablished() const override { return false; }
   const std::optional<std::chrono::milliseconds>& accessLogFlushInterval() override {
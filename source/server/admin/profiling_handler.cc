@@ -1,8 +1,12 @@
 #include "source/server/admin/profiling_handler.h"
 
+#include "source/common/event/slow_callback_tracker.h"
 #include "source/common/profiler/profiler.h"
+#include "source/common/profiler/scope_profiler.h"
 #include "source/server/admin/utils.h"
 
+#include "absl/strings/numbers.h"
+
 namespace Envoy {
 namespace Server {
 
@@ -21,6 +25,11 @@ Http::Code ProfilingHandler::handlerCpuProfiler(Http::ResponseHeaderMap&,
 
   bool enable = enableVal.value() == "y";
   if (enable && !Profiler::Cpu::profilerEnabled()) {
+    if (Profiler::ScopeProfiler::running()) {
+      // Both profilers sample with SIGPROF.
+      response.add("failure to start the profiler: the scope profiler is running");
+      return Http::Code::BadRequest;
+    }
     if (!Profiler::Cpu::startProfiler(profile_path_)) {
       response.add("failure to start the profiler");
       return Http::Code::InternalServerError;
@@ -80,6 +89,73 @@ Http::Code ProfilingHandler::handlerHeapProfiler(Http::ResponseHeaderMap&,
   return res;
 }
 
+Http::Code ProfilingHandler::handlerScopeProfiler(Http::ResponseHeaderMap&,
+                                                  Buffer::Instance& response,
+                                                  AdminStream& admin_stream) {
+  Http::Utility::QueryParamsMulti query_params = admin_stream.queryParams();
+  const auto enable_val = query_params.getFirstValue("enable");
+  const auto interval_val = query_params.getFirstValue("interval_ms");
+  uint64_t interval_ms = DefaultScopeProfilerIntervalMs;
+  if (!enable_val.has_value() || (enable_val.value() != "y" && enable_val.value() != "n") ||
+      query_params.data().size() != (interval_val.has_value() ? 2 : 1) ||
+      (interval_val.has_value() &&
+       (!absl::SimpleAtoi(interval_val.value(), &interval_ms) || interval_ms == 0))) {
+    response.add("?enable=<y|n>&interval_ms=<milliseconds>\n");
+    return Http::Code::BadRequest;
+  }
+
+  if (enable_val.value() == "y") {
+    // The samples of a previous run are dropped, so that the profile covers a single run.
+    Profiler::ScopeProfiler::reset();
+    const absl::Status status =
+        Profiler::ScopeProfiler::start(std::chrono::milliseconds(interval_ms));
+    if (!status.ok()) {
+      response.add(status.message());
+      return status.code() == absl::StatusCode::kUnimplemented ? Http::Code::NotImplemented
+                                                               : Http::Code::BadRequest;
+    }
+  } else {
+    Profiler::ScopeProfiler::stop();
+  }
+  response.add("OK\n");
+  return Http::Code::OK;
+}
+
+Http::Code ProfilingHandler::handlerScopeProfile(Http::ResponseHeaderMap&,
+                                                 Buffer::Instance& response, AdminStream&) {
+  response.add(Profiler::ScopeProfiler::report());
+  return Http::Code::OK;
+}
+
+Http::Code ProfilingHandler::handlerSlowCallbackTracker(Http::ResponseHeaderMap&,
+                                                        Buffer::Instance& response,
+                                                        AdminStream& admin_stream) {
+  Http::Utility::QueryParamsMulti query_params = admin_stream.queryParams();
+  const auto enable_val = query_params.getFirstValue("enable");
+  const auto threshold_val = query_params.getFirstValue("threshold_ms");
+  uint64_t threshold_ms = DefaultSlowCallbackThresholdMs;
+  if (!enable_val.has_value() || (enable_val.value() != "y" && enable_val.value() != "n") ||
+      query_params.data().size() != (threshold_val.has_value() ? 2 : 1) ||
+      (threshold_val.has_value() && !absl::SimpleAtoi(threshold_val.value(), &threshold_ms))) {
+    response.add("?enable=<y|n>&threshold_ms=<milliseconds>\n");
+    return Http::Code::BadRequest;
+  }
+
+  if (enable_val.value() == "y") {
+    Event::SlowCallbackTracker::enable(std::chrono::milliseconds(threshold_ms));
+  } else {
+    Event::SlowCallbackTracker::disable();
+  }
+  response.add("OK\n");
+  return Http::Code::OK;
+}
+
+Http::Code ProfilingHandler::handlerSlowCallbacks(Http::ResponseHeaderMap&,
+                                                  Buffer::Instance& response, AdminStream&) {
+  response.add(Event::SlowCallbackTracker::report());
+  return Http::Code::OK;
+}
+
 Http::Code TcmallocProfilingHandler::handlerHeapDump(Http::ResponseHeaderMap&,
                                                      Buffer::Instance& response, AdminStream&) {
   auto dump_result = Profiler::TcmallocProfiler::tcmallocHeapProfile();
@@ -13,6 +13,12 @@ namespace Server {
 class ProfilingHandler {
 
 public:
+  // Sampling interval of the scope profiler, in CPU time, when the request does not specify one.
+  static constexpr uint64_t DefaultScopeProfilerIntervalMs = 10;
+  // Minimum duration of the callbacks recorded by the slow callback tracker, when the request does
+  // not specify one.
+  static constexpr uint64_t DefaultSlowCallbackThresholdMs = 10;
+
   ProfilingHandler(const std::string& profile_path);
 
   Http::Code handlerCpuProfiler(Http::ResponseHeaderMap& response_headers,
@@ -21,6 +27,18 @@ public:
   Http::Code handlerHeapProfiler(Http::ResponseHeaderMap& response_headers,
                                  Buffer::Instance& response, AdminStream&);
 
+  Http::Code handlerScopeProfiler(Http::ResponseHeaderMap& response_headers,
+                                  Buffer::Instance& response, AdminStream&);
+
+  Http::Code handlerScopeProfile(Http::ResponseHeaderMap& response_headers,
+                                 Buffer::Instance& response, AdminStream&);
+
+  Http::Code handlerSlowCallbackTracker(Http::ResponseHeaderMap& response_headers,
+                                        Buffer::Instance& response, AdminStream&);
+
+  Http::Code handlerSlowCallbacks(Http::ResponseHeaderMap& response_headers,
+                                  Buffer::Instance& response, AdminStream&);
+
 private:
   const std::string profile_path_;
 };
@@ -0,0 +1,140 @@
+#include "source/server/admin/prometheus_scrape_cache.h"
+
+#include <algorithm>
+
+#include "source/common/http/utility.h"
+#include "source/server/admin/prometheus_stats.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Server {
+
+void PrometheusScrapeCache::setFreshness(std::chrono::milliseconds freshness) {
+  freshness_ = freshness;
+  if (!enabled()) {
+    entries_.clear();
+  }
+}
+
+std::string PrometheusScrapeCache::key(const StatsParams& params,
+                                       const Http::RequestHeaderMap& request_headers) {
+  // The query parameters are kept sorted, so their serialization does not depend on the order in
+  // which the scraper listed them. They are decoded, so they are encoded again to keep a decoded
+  // '&' or '=' from making different queries share a key.
+  std::string key =
+      PrometheusStatsFormatter::useProtobufFormat(params, request_headers) ? "protobuf" : "text";
+  for (const auto& [name, values] : params.query_.data()) {
+    for (const std::string& value : values) {
+      absl::StrAppend(&key, "&", Http::Utility::PercentEncoding::urlEncode(name), "=",
+                      Http::Utility::PercentEncoding::urlEncode(value));
+    }
+  }
+  return key;
+}
+
+PrometheusScrapeCache::EntryConstSharedPtr PrometheusScrapeCache::find(const std::string& key,
+                                                                       MonotonicTime now) const {
+  auto it = entries_.find(key);
+  if (it == entries_.end() || now - it->second.created_ >= freshness_) {
+    return nullptr;
+  }
+  return it->second.entry_;
+}
+
+void PrometheusScrapeCache::insert(const std::string& key, EntryConstSharedPtr entry,
+                                   MonotonicTime now) {
+  absl::erase_if(entries_, [this, now](const auto& key_and_entry) {
+    return now - key_and_entry.second.created_ >= freshness_;
+  });
+  entries_[key] = TimedEntry{std::move(entry), now};
+}
+
+PrometheusChangedSeries::~PrometheusChangedSeries() {
+  while (!scrapers_.empty()) {
+    removeScraper(scrapers_.begin());
+  }
+}
+
+template <class StatType>
+void PrometheusChangedSeries::filter(SeriesMap& series, uint64_t scrape,
+                                     std::vector<Stats::RefcountPtr<StatType>>& metrics) {
+  auto out = metrics.begin();
+  for (auto& metric : metrics) {
+    const uint64_t value = metric->value();
+    auto it = series.find(metric->statName());
+    if (it == series.end()) {
+      // Only the names of new series take the symbol table lock.
+      Stats::StatNameStorage name(metric->statName(), symbol_table_);
+      const Stats::StatName key = name.statName();
+      series.emplace(key, Series{std::move(name), value, scrape});
+    } else {
+      it->second.last_scrape_ = scrape;
+      if (it->second.value_ == value) {
+        continue;
+      }
+      it->second.value_ = value;
+    }
+    if (&*out != &metric) {
+      *out = std::move(metric);
+    }
+    ++out;
+  }
+  metrics.erase(out, metrics.end());
+}
+
+void PrometheusChangedSeries::removeSeries(SeriesMap& series, std::optional<uint64_t> scrape) {
+  for (auto it = series.begin(); it != series.end();) {
+    if (scrape.has_value() && it->second.last_scrape_ == scrape.value()) {
+      ++it;
+      continue;
+    }
+    it->second.name_.free(symbol_table_);
+    series.erase(it++);
+  }
+}
+
+void PrometheusChangedSeries::removeScraper(
+    absl::flat_hash_map<std::string, ScraperState>::iterator it) {
+  removeSeries(it->second.counters_, std::nullopt);
+  removeSeries(it->second.gauges_, std::nullopt);
+  scrapers_.erase(it);
+}
+
+void PrometheusChangedSeries::removeIdleScrapers() {
+  const MonotonicTime now = time_source_.monotonicTime();
+  for (auto it = scrapers_.begin(); it != scrapers_.end();) {
+    auto current = it++;
+    if (now - current->second.last_scrape_time_ >= MaxIdleTime) {
+      removeScraper(current);
+    }
+  }
+}
+
+void PrometheusChangedSeries::filterUnchanged(const std::string& scraper_id,
+                                              std::vector<Stats::CounterSharedPtr>& counters,
+                                              std::vector<Stats::GaugeSharedPtr>& gauges) {
+  removeIdleScrapers();
+  auto it = scrapers_.find(scraper_id);
+  if (it == scrapers_.end()) {
+    if (scrapers_.size() >= MaxScrapers) {
+      removeScraper(std::min_element(scrapers_.begin(), scrapers_.end(),
+                                     [](const auto& a, const auto& b) {
+                                       return a.second.last_scrape_ < b.second.last_scrape_;
+                                     }));
+    }
+    it = scrapers_.emplace(scraper_id, ScraperState()).first;
+  }
+
+  ScraperState& state = it->second;
+  state.last_scrape_ = ++num_scrapes_;
+  state.last_scrape_time_ = time_source_.monotonicTime();
+  filter(state.counters_, state.last_scrape_, counters);
+  filter(state.gauges_, state.last_scrape_, gauges);
+  // Forget the series that were deleted since the previous scrape.
+  removeSeries(state.counters_, state.last_scrape_);
+  removeSeries(state.gauges_, state.last_scrape_);
+}
+
+} // namespace Server
+} // namespace Envoy
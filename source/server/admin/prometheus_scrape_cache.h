@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/http/header_map.h"
+#include "envoy/stats/stats.h"
+
+#include "source/common/stats/symbol_table.h"
+#include "source/server/admin/stats_params.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Server {
+
+/**
+ * Short-lived cache of rendered /stats/prometheus responses, shared by all the scrapers hitting
+ * the admin endpoint. Entries are keyed by the exposition format and the query parameters, and are
+ * served until they are older than the configured freshness window, so that scrapers arriving
+ * within the same window (e.g. HA Prometheus pairs and agents) only walk and encode the stats once.
+ * Only used on the main thread.
+ */
+class PrometheusScrapeCache {
+public:
+  struct Entry {
+    std::string content_type_;
+    std::string body_;
+  };
+  using EntryConstSharedPtr = std::shared_ptr<const Entry>;
+
+  /**
+   * Sets the freshness window. A zero duration, the default, disables the cache.
+   */
+  void setFreshness(std::chrono::milliseconds freshness);
+  bool enabled() const { return freshness_.count() > 0; }
+
+  /**
+   * @return the cache key of a request.
+   * @param params the parsed query parameters.
+   * @param request_headers the request headers, which select the exposition format.
+   */
+  static std::string key(const StatsParams& params, const Http::RequestHeaderMap& request_headers);
+
+  /**
+   * @return the entry for the key if it is still fresh at the given time, nullptr otherwise.
+   */
+  EntryConstSharedPtr find(const std::string& key, MonotonicTime now) const;
+
+  /**
+   * Inserts or replaces the entry for the key, dropping the entries that expired.
+   */
+  void insert(const std::string& key, EntryConstSharedPtr entry, MonotonicTime now);
+
+  size_t size() const { return entries_.size(); }
+
+private:
+  struct TimedEntry {
+    EntryConstSharedPtr entry_;
+    MonotonicTime created_;
+  };
+
+  std::chrono::milliseconds freshness_{0};
+  absl::flat_hash_map<std::string, TimedEntry> entries_;
+};
+
+/**
+ * Tracks, per scraper, the counter and gauge values returned by the previous scrape so that a
+ * scraper that keeps the last values itself can ask only for the series that changed since.
+ * Only used on the main thread.
+ */
+class PrometheusChangedSeries {
+public:
+  // Bound on the number of scrapers tracked; the least recently seen one is dropped first.
+  static constexpr size_t MaxScrapers = 16;
+  // Scrapers that have not scraped for this long are forgotten.
+  static constexpr std::chrono::minutes MaxIdleTime{10};
+
+  PrometheusChangedSeries(Stats::SymbolTable& symbol_table, TimeSource& time_source)
+      : symbol_table_(symbol_table), time_source_(time_source) {}
+  ~PrometheusChangedSeries();
+
+  /**
+   * Removes from the vectors the counters and gauges whose value is the same as in the previous
+   * scrape of the scraper, and records the current values for the next one. The first scrape of
+   * a scraper keeps everything.
+   *
+   * @param scraper_id identifies the scraper.
+   * @param counters the counters to filter in place.
+   * @param gauges the gauges to filter in place.
+   */
+  void filterUnchanged(const std::string& scraper_id,
+                       std::vector<Stats::CounterSharedPtr>& counters,
+                       std::vector<Stats::GaugeSharedPtr>& gauges);
+
+  /**
+   * Forgets the scrapers that have not scraped for MaxIdleTime.
+   */
+  void removeIdleScrapers();
+
+  size_t numScrapers() const { return scrapers_.size(); }
+
+private:
+  // The last value of a series, with a copy of its name so that the metric itself is not held.
+  struct Series {
+    Stats::StatNameStorage name_;
+    uint64_t value_;
+    uint64_t last_scrape_;
+  };
+
+  using SeriesMap = Stats::StatNameHashMap<Series>;
+
+  // The series are keyed by the name held in their value.
+  struct ScraperState {
+    SeriesMap counters_;
+    SeriesMap gauges_;
+    uint64_t last_scrape_{};
+    MonotonicTime last_scrape_time_;
+  };
+
+  template <class StatType>
+  void filter(SeriesMap& series, uint64_t scrape,
+              std::vector<Stats::RefcountPtr<StatType>>& metrics);
+  // Drops the series not seen in the given scrape, or all of them if std::nullopt.
+  void removeSeries(SeriesMap& series, std::optional<uint64_t> scrape);
+  void removeScraper(absl::flat_hash_map<std::string, ScraperState>::iterator it);
+
+  Stats::SymbolTable& symbol_table_;
+  TimeSource& time_source_;
+  absl::flat_hash_map<std::string, ScraperState> scrapers_;
+  uint64_t num_scrapes_{};
+};
+
+} // namespace Server
+} // namespace Envoy
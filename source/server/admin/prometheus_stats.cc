@@ -1,10 +1,11 @@
 #include "source/server/admin/prometheus_stats.h"
 
 #include <cmath>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <set>
 
-#include "source/common/common/empty_string.h"
 #include "source/common/common/macros.h"
 #include "source/common/common/regex.h"
 #include "source/common/protobuf/protobuf.h"
@@ -80,6 +81,28 @@ struct PrimitiveMetricSnapshotLessThan {
   }
 };
 
+// Appends a tag value sanitized as by sanitizeValue(), without the intermediate string.
+void appendSanitizedValue(absl::string_view value, std::string& out) {
+  for (const char c : value) {
+    switch (c) {
+    case '\\':
+      out.append(R"(\\)");
+      break;
+    case '\n':
+      out.append(R"(\n)");
+      break;
+    case '"':
+      out.append(R"(\")");
+      break;
+    default:
+      out.push_back(c);
+      break;
+    }
+  }
+}
+
+// The text format renders each metric into a reused line buffer, decoding the tags directly
+// from their StatNames, so that no string is allocated per metric once the buffers have grown.
 class TextFormat : public PrometheusStatsFormatter::OutputFormat {
 public:
   void generateOutput(Buffer::Instance& output, const std::vector<const Stats::Counter*>& counters,
@@ -134,17 +157,64 @@ public:
     generateTypeOutput(output, "gauge", prefixed_tag_extracted_name);
 
     for (const auto* text_readout : text_readouts) {
-      auto tags = text_readout->tags();
-      tags.push_back(Stats::Tag{"text_value", text_readout->value()});
-      const std::string formattedTags = PrometheusStatsFormatter::formattedTags(std::move(tags));
-      output.add(fmt::format("{0}{{{1}}} 0\n", prefixed_tag_extracted_name, formattedTags));
+      line_.assign(prefixed_tag_extracted_name);
+      line_.push_back('{');
+      if (appendTags(*text_readout, line_)) {
+        line_.push_back(',');
+      }
+      line_.append("text_value=\"");
+      appendSanitizedValue(text_readout->value(), line_);
+      line_.append("\"} 0\n");
+      output.add(line_);
     }
   }
 
 private:
   void generateTypeOutput(Buffer::Instance& output, absl::string_view type,
                           const std::string& prefixed_tag_extracted_name) const {
-    output.add(fmt::format("# TYPE {0} {1}\n", prefixed_tag_extracted_name, type));
+    output.add(absl::StrCat("# TYPE ", prefixed_tag_extracted_name, " ", type, "\n"));
+  }
+
+  // Appends the tags of the metric as comma-separated name="value" pairs, as formattedTags()
+  // would. Tag names are few, so they are sanitized once per render and cached by StatName; the
+  // metrics, and therefore the StatNames, outlive the render.
+  // @return whether the metric has tags.
+  bool appendTags(const Stats::Metric& metric, std::string& out) const {
+    // Bundled so that the callback captures little enough to avoid a std::function allocation.
+    struct State {
+      const Stats::SymbolTable& symbol_table_;
+      std::string& out_;
+      bool first_{true};
+    } state{metric.constSymbolTable(), out};
+    metric.iterateTagStatNames([this, &state](Stats::StatName name, Stats::StatName value) -> bool {
+      if (!state.first_) {
+        state.out_.push_back(',');
+      }
+      state.first_ = false;
+      auto [it, inserted] = sanitized_tag_names_.try_emplace(name);
+      if (inserted) {
+        it->second = state.symbol_table_.toString(name);
+        sanitizeNameInPlace(it->second);
+      }
+      state.out_.append(it->second);
+      state.out_.append("=\"");
+      appendSanitizedValue(decode(state.symbol_table_, value), state.out_);
+      state.out_.push_back('"');
+      return true;
+    });
+    return !state.first_;
+  }
+
+  // Decodes the StatName into a reused buffer.
+  absl::string_view decode(const Stats::SymbolTable& symbol_table, Stats::StatName name) const {
+    decode_buffer_.resize(decode_buffer_.capacity());
+    size_t size =
+        symbol_table.serializeToBuffer(name, decode_buffer_.data(), decode_buffer_.size());
+    if (size > decode_buffer_.size()) {
+      decode_buffer_.resize(size);
+      size = symbol_table.serializeToBuffer(name, decode_buffer_.data(), size);
+    }
+    return {decode_buffer_.data(), size};
   }
 
   template <class StatType>
@@ -161,9 +231,11 @@ private:
 
     generateTypeOutput(output, type, prefixed_tag_extracted_name);
     for (const auto* metric : metrics) {
-      const std::string formatted_tags = PrometheusStatsFormatter::formattedTags(metric->tags());
-      output.add(fmt::format("{0}{{{1}}} {2}\n", prefixed_tag_extracted_name, formatted_tags,
-                             metric->value()));
+      line_.assign(prefixed_tag_extracted_name);
+      line_.push_back('{');
+      appendTags(*metric, line_);
+      absl::StrAppend(&line_, "} ", metric->value(), "\n");
+      output.add(line_);
     }
   }
 
@@ -199,15 +271,16 @@ private:
     generateTypeOutput(output, "histogram", prefixed_tag_extracted_name);
 
     for (const auto* histogram : histograms) {
-      auto histogram_tags = histogram->tags();
-      const bool empty_tags = histogram_tags.empty();
-
-      const std::string tags = PrometheusStatsFormatter::formattedTags(std::move(histogram_tags));
-      const std::string hist_tags = empty_tags ? EMPTY_STRING : (tags + ",");
+      tags_.clear();
+      const bool empty_tags = !appendTags(*histogram, tags_);
+      const absl::string_view tags = tags_;
+      const absl::string_view hist_tags_separator = empty_tags ? "" : ",";
 
       const Stats::HistogramStatistics& stats = histogram->cumulativeStatistics();
       Stats::ConstSupportedBuckets& supported_buckets = stats.supportedBuckets();
       const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
+      line_.clear();
+      auto out = std::back_inserter(line_);
       for (size_t i = 0; i < supported_buckets.size(); ++i) {
         double bucket = supported_buckets[i];
         uint64_t value = computed_buckets[i];
@@ -216,16 +289,17 @@ private:
         // 'g' operator which prints the number in general fixed point format or scientific format
         // with precision 50 to round the number up to 32 significant digits in fixed point format
         // which should cover pretty much all cases
-        output.add(fmt::format("{0}_bucket{{{1}le=\"{2:.32g}\"}} {3}\n",
-                               prefixed_tag_extracted_name, hist_tags, bucket, value));
+        fmt::format_to(out, "{0}_bucket{{{1}{2}le=\"{3:.32g}\"}} {4}\n",
+                       prefixed_tag_extracted_name, tags, hist_tags_separator, bucket, value);
       }
 
-      output.add(fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", prefixed_tag_extracted_name,
-                             hist_tags, stats.sampleCount()));
-      output.add(fmt::format("{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
-                             stats.sampleSum()));
-      output.add(fmt::format("{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
-                             stats.sampleCount()));
+      fmt::format_to(out, "{0}_bucket{{{1}{2}le=\"+Inf\"}} {3}\n", prefixed_tag_extracted_name,
+                     tags, hist_tags_separator, stats.sampleCount());
+      fmt::format_to(out, "{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
+                     stats.sampleSum());
+      fmt::format_to(out, "{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
+                     stats.sampleCount());
+      output.add(line_);
     }
   }
 
@@ -240,25 +314,36 @@ private:
     generateTypeOutput(output, "summary", prefixed_tag_extracted_name);
 
     for (const auto* histogram : histograms) {
-      const std::string tags = PrometheusStatsFormatter::formattedTags(histogram->tags());
-      const std::string hist_tags = histogram->tags().empty() ? EMPTY_STRING : (tags + ",");
+      tags_.clear();
+      const bool empty_tags = !appendTags(*histogram, tags_);
+      const absl::string_view tags = tags_;
+      const absl::string_view hist_tags_separator = empty_tags ? "" : ",";
 
       const Stats::HistogramStatistics& stats = histogram->intervalStatistics();
       Stats::ConstSupportedBuckets& supported_quantiles = stats.supportedQuantiles();
       const std::vector<double>& computed_quantiles = stats.computedQuantiles();
+      line_.clear();
+      auto out = std::back_inserter(line_);
       for (size_t i = 0; i < supported_quantiles.size(); ++i) {
         double quantile = supported_quantiles[i];
         double value = computed_quantiles[i];
-        output.add(fmt::format("{0}{{{1}quantile=\"{2}\"}} {3:.32g}\n", prefixed_tag_extracted_name,
-                               hist_tags, quantile, value));
+        fmt::format_to(out, "{0}{{{1}{2}quantile=\"{3}\"}} {4:.32g}\n", prefixed_tag_extracted_name,
+                       tags, hist_tags_separator, quantile, value);
       }
 
-      output.add(fmt::format("{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
-                             stats.sampleSum()));
-      output.add(fmt::format("{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
-                             stats.sampleCount()));
+      fmt::format_to(out, "{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
+                     stats.sampleSum());
+      fmt::format_to(out, "{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
+                     stats.sampleCount());
+      output.add(line_);
     }
   }
+
+  // Scratch buffers reused across metrics.
+  mutable std::string line_;
+  mutable std::string tags_;
+  mutable std::string decode_buffer_;
+  mutable absl::flat_hash_map<Stats::StatName, std::string> sanitized_tag_names_;
 };
 
 class ProtobufFormat : public PrometheusStatsFormatter::OutputFormat {
@@ -701,164 +786,14 @@ private:
   uint32_t native_histogram_max_buckets_{kDefaultMaxNativeHistogramBuckets};
 };
 
-/**
- * Processes a stat type (counter, gauge, histogram) by generating all output lines, sorting
- * them by tag-extracted metric name, and then outputting them in the correct sorted order into
- * response.
- *
- * @param response The buffer to put the output into.
- * @param used_only Whether to only output stats that are used.
- * @param regex A filter on which stats to output.
- * @param metrics The metrics to output stats for. This must contain all stats of the given type
- *        to be included in the same output.
- * @param generate_output A function which returns the output text for this metric.
- * @param type The name of the prometheus metric type for used in TYPE annotations.
- */
-template <class StatType>
-uint64_t outputStatType(Buffer::Instance& response, const StatsParams& params,
-                        const std::vector<Stats::RefcountPtr<StatType>>& metrics,
-                        const PrometheusStatsFormatter::OutputFormat& output_format,
-                        const Stats::CustomStatNamespaces& custom_namespaces) {
-
-  /*
-   * From
-   * https://github.com/prometheus/docs/blob/master/content/docs/instrumenting/exposition_formats.md#grouping-and-sorting:
-   *
-   * All lines for a given metric must be provided as one single group, with the optional HELP and
-   * TYPE lines first (in no particular order). Beyond that, reproducible sorting in repeated
-   * expositions is preferred but not required, i.e. do not sort if the computational cost is
-   * prohibitive.
-   */
-
-  // This is an unsorted collection of dumb-pointers (no need to increment then decrement every
-  // refcount; ownership is held throughout by `metrics`). It is unsorted for efficiency, but will
-  // be sorted before producing the final output to satisfy the "preferred" ordering from the
-  // prometheus spec: metrics will be sorted by their tags' textual representation, which will be
-  // consistent across calls.
-  using StatTypeUnsortedCollection = std::vector<const StatType*>;
-
-  // Return early to avoid crashing when getting the symbol table from the first metric.
-  if (metrics.empty()) {
-    return 0;
-  }
-
-  // There should only be one symbol table for all of the stats in the admin
-  // interface. If this assumption changes, the name comparisons in this function
-  // will have to change to compare to convert all StatNames to strings before
-  // comparison.
-  const Stats::SymbolTable& global_symbol_table = metrics.front()->constSymbolTable();
-
-  // Collection of metrics by their tagExtractedName.
-  // Sorting will be done on the names separately.
-  absl::flat_hash_map<Stats::StatName, StatTypeUnsortedCollection> groups;
-
-  for (const auto& metric : metrics) {
-    ASSERT(&global_symbol_table == &metric->constSymbolTable());
-    if (!params.shouldShowMetric(*metric)) {
-      continue;
-    }
-    groups[metric->tagExtractedStatName()].push_back(metric.get());
-  }
-
-  std::vector<Stats::StatName> sorted_stat_names;
-  sorted_stat_names.reserve(groups.size());
-  for (const auto& [group, _] : groups) {
-    sorted_stat_names.push_back(group);
-  }
-  Stats::StatNameLessThan comp(global_symbol_table);
-  std::sort(sorted_stat_names.begin(), sorted_stat_names.end(), comp);
-
-  auto result = groups.size();
-  for (auto& group_name : sorted_stat_names) {
-    auto& group = groups[group_name];
-    const std::optional<std::string> prefixed_tag_extracted_name =
-        PrometheusStatsFormatter::metricName(global_symbol_table.toString(group_name),
-                                             custom_namespaces);
-    if (!prefixed_tag_extracted_name.has_value()) {
-      --result;
-      continue;
-    }
-
-    // Sort before producing the final output to satisfy the "preferred" ordering from the
-    // prometheus spec: metrics will be sorted by their tags' textual representation, which will
-    // be consistent across calls.
-    std::sort(group.begin(), group.end(), MetricLessThan());
-
-    output_format.generateOutput(response, group, prefixed_tag_extracted_name.value());
-  }
-  return result;
-}
-
-template <class StatType, class OutputFormat>
-uint64_t outputPrimitiveStatType(Buffer::Instance& response, const StatsParams& params,
-                                 std::vector<StatType>&& metrics, const OutputFormat& output_format,
-                                 const Stats::CustomStatNamespaces& custom_namespaces) {
-
-  /*
-   * From
-   * https:*github.com/prometheus/docs/blob/master/content/docs/instrumenting/exposition_formats.md#grouping-and-sorting:
-   *
-   * All lines for a given metric must be provided as one single group, with the optional HELP and
-   * TYPE lines first (in no particular order). Beyond that, reproducible sorting in repeated
-   * expositions is preferred but not required, i.e. do not sort if the computational cost is
-   * prohibitive.
-   */
-
-  // This is an unsorted collection of dumb-pointers (no need to increment then decrement every
-  // refcount; ownership is held throughout by `metrics`). It is unsorted for efficiency, but will
-  // be sorted before producing the final output to satisfy the "preferred" ordering from the
-  // prometheus spec: metrics will be sorted by their tags' textual representation, which will be
-  // consistent across calls.
-  using StatTypeUnsortedCollection = std::vector<StatType*>;
-
-  // Return early to avoid crashing when getting the symbol table from the first metric.
-  if (metrics.empty()) {
-    return 0;
-  }
-
-  // Collection of metrics sorted by their tagExtractedName.
-  // We satisfy the requirements of the exposition format by iterating over the sorted keys.
-  absl::flat_hash_map<std::string, StatTypeUnsortedCollection> groups;
-
-  for (auto& metric : metrics) {
-    if (!params.shouldShowMetric(metric)) {
-      continue;
-    }
-    groups[metric.tagExtractedName()].push_back(&metric);
-  }
-
-  std::vector<std::string> sorted_group_names;
-  sorted_group_names.reserve(groups.size());
-  for (const auto& [group, _] : groups) {
-    sorted_group_names.push_back(group);
-  }
-  std::sort(sorted_group_names.begin(), sorted_group_names.end());
-
-  auto result = groups.size();
-  for (auto& group_name : sorted_group_names) {
-    auto& group = groups[group_name];
-    const std::optional<std::string> prefixed_tag_extracted_name =
-        PrometheusStatsFormatter::metricName(std::move(group_name), custom_namespaces);
-    if (!prefixed_tag_extracted_name.has_value()) {
-      --result;
-      continue;
-    }
-
-    // Sort before producing the final output to satisfy the "preferred" ordering from the
-    // prometheus spec: metrics will be sorted by their tags' textual representation, which will
-    // be consistent across calls.
-    std::sort(group.begin(), group.end(), PrimitiveMetricSnapshotLessThan());
-
-    output_format.generateOutput(response, std::move(group), prefixed_tag_extracted_name.value());
-  }
-  return result;
-}
+} // namespace
 
 // Determine the format based on Accept header, using first-match priority.
 // Per HTTP spec, clients SHOULD send media types in priority order.
 // Text format is only selected if explicitly requested as version 0.0.4 or as fallback.
 // Returns true if protobuf format should be used, false for text format.
-bool useProtobufFormat(const StatsParams& params, const Http::RequestHeaderMap& headers) {
+bool PrometheusStatsFormatter::useProtobufFormat(const StatsParams& params,
+                                                 const Http::RequestHeaderMap& headers) {
   bool use_protobuf = false; // Default to using the text format.
 
   if (auto prom_format = params.query_.getFirstValue("prom_protobuf"); prom_format.has_value()) {
@@ -899,8 +834,6 @@ bool useProtobufFormat(const StatsParams& params, const Http::RequestHeaderMap&
   return use_protobuf;
 }
 
-} // namespace
-
 std::string PrometheusStatsFormatter::formattedTags(std::vector<Stats::Tag>&& tags) {
   std::vector<std::string> buf;
   buf.reserve(tags.size());
@@ -963,119 +896,269 @@ PrometheusStatsFormatter::metricName(std::string&& extracted_name,
   return absl::StrCat("envoy_", extracted_name);
 }
 
-uint64_t PrometheusStatsFormatter::generateWithOutputFormat(
+PrometheusStatsFormatter::OutputFormatPtr
+PrometheusStatsFormatter::makeOutputFormat(const StatsParams& params,
+                                           const Http::RequestHeaderMap& request_headers,
+                                           Http::ResponseHeaderMap& response_headers) {
+  if (useProtobufFormat(params, request_headers)) {
+    response_headers.setReferenceContentType(
+        "application/vnd.google.protobuf; "
+        "proto=io.prometheus.client.MetricFamily; encoding=delimited");
+    return std::make_unique<ProtobufFormat>(params.native_histogram_max_buckets_);
+  }
+  return std::make_unique<TextFormat>();
+}
+
+uint64_t PrometheusStatsFormatter::statsAsPrometheusText(
     const std::vector<Stats::CounterSharedPtr>& counters,
     const std::vector<Stats::GaugeSharedPtr>& gauges,
     const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
     const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
     const Upstream::ClusterManager& cluster_manager, Buffer::Instance& response,
-    const StatsParams& params, const Stats::CustomStatNamespaces& custom_namespaces,
-    OutputFormat& output_format) {
+    const StatsParams& params, const Stats::CustomStatNamespaces& custom_namespaces) {
 
-  OutputFormat::HistogramType hist_type;
+  PrometheusStatsRender render(counters, gauges, histograms, text_readouts, cluster_manager, params,
+                               custom_namespaces, std::make_unique<TextFormat>());
+  render.nextChunk(response, std::numeric_limits<uint64_t>::max());
+  return render.metricNameCount();
+}
+
+uint64_t PrometheusStatsFormatter::statsAsPrometheusProtobuf(
+    const std::vector<Stats::CounterSharedPtr>& counters,
+    const std::vector<Stats::GaugeSharedPtr>& gauges,
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+    const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
+    const Upstream::ClusterManager& cluster_manager, Http::ResponseHeaderMap& response_headers,
+    Buffer::Instance& response, const StatsParams& params,
+    const Stats::CustomStatNamespaces& custom_namespaces) {
+
+  response_headers.setReferenceContentType(
+      "application/vnd.google.protobuf; "
+      "proto=io.prometheus.client.MetricFamily; encoding=delimited");
+
+  PrometheusStatsRender render(
+      counters, gauges, histograms, text_readouts, cluster_manager, params, custom_namespaces,
+      std::make_unique<ProtobufFormat>(params.native_histogram_max_buckets_));
+  render.nextChunk(response, std::numeric_limits<uint64_t>::max());
+  return render.metricNameCount();
+}
+
+uint64_t PrometheusStatsFormatter::statsAsPrometheus(
+    const std::vector<Stats::CounterSharedPtr>& counters,
+    const std::vector<Stats::GaugeSharedPtr>& gauges,
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+    const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
+    const Upstream::ClusterManager& cluster_manager, const Http::RequestHeaderMap& request_headers,
+    Http::ResponseHeaderMap& response_headers, Buffer::Instance& response,
+    const StatsParams& params, const Stats::CustomStatNamespaces& custom_namespaces) {
+
+  PrometheusStatsRender render(counters, gauges, histograms, text_readouts, cluster_manager, params,
+                               custom_namespaces,
+                               makeOutputFormat(params, request_headers, response_headers));
+  render.nextChunk(response, std::numeric_limits<uint64_t>::max());
+  return render.metricNameCount();
+}
+
+PrometheusStatsRender::PrometheusStatsRender(
+    const std::vector<Stats::CounterSharedPtr>& counters,
+    const std::vector<Stats::GaugeSharedPtr>& gauges,
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+    const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
+    const Upstream::ClusterManager& cluster_manager, const StatsParams& params,
+    const Stats::CustomStatNamespaces& custom_namespaces,
+    PrometheusStatsFormatter::OutputFormatPtr output_format)
+    : custom_namespaces_(custom_namespaces), output_format_(std::move(output_format)) {
+  using HistogramType = PrometheusStatsFormatter::OutputFormat::HistogramType;
+  HistogramType hist_type;
 
   // Validation of bucket modes is handled separately.
   switch (params.histogram_buckets_mode_) {
   case Utility::HistogramBucketsMode::Summary:
-    hist_type = OutputFormat::HistogramType::Summary;
+    hist_type = HistogramType::Summary;
     break;
   case Utility::HistogramBucketsMode::Unset:
   case Utility::HistogramBucketsMode::Cumulative:
-    hist_type = OutputFormat::HistogramType::ClassicHistogram;
+    hist_type = HistogramType::ClassicHistogram;
     break;
   case Utility::HistogramBucketsMode::PrometheusNative:
-    hist_type = OutputFormat::HistogramType::NativeHistogram;
+    hist_type = HistogramType::NativeHistogram;
     break;
   // "Detailed" and "Disjoint" don't make sense for prometheus histogram semantics. These types were
   // have been filtered out in validateParams().
   case Utility::HistogramBucketsMode::Detailed:
   case Utility::HistogramBucketsMode::Disjoint:
-    hist_type = OutputFormat::HistogramType::ClassicHistogram;
+    hist_type = HistogramType::ClassicHistogram;
     IS_ENVOY_BUG("unsupported prometheus histogram bucket mode");
     break;
   }
 
-  output_format.setHistogramType(hist_type);
-
-  uint64_t metric_name_count = 0;
-  metric_name_count +=
-      outputStatType<Stats::Counter>(response, params, counters, output_format, custom_namespaces);
-
-  metric_name_count +=
-      outputStatType<Stats::Gauge>(response, params, gauges, output_format, custom_namespaces);
+  output_format_->setHistogramType(hist_type);
 
-  metric_name_count += outputStatType<Stats::TextReadout>(response, params, text_readouts,
-                                                          output_format, custom_namespaces);
-
-  metric_name_count += outputStatType<Stats::ParentHistogram>(response, params, histograms,
-                                                              output_format, custom_namespaces);
+  counter_groups_ = makeGroups(counters, params);
+  gauge_groups_ = makeGroups(gauges, params);
+  text_readout_groups_ = makeGroups(text_readouts, params);
+  histogram_groups_ = makeGroups(histograms, params);
 
   // Note: This assumes that there is no overlap in stat name between per-endpoint stats and all
   // other stats. If this is not true, then the counters/gauges for per-endpoint need to be combined
   // with the above counter/gauge calls so that stats can be properly grouped.
-  std::vector<Stats::PrimitiveCounterSnapshot> host_counters;
-  std::vector<Stats::PrimitiveGaugeSnapshot> host_gauges;
   Upstream::HostUtility::forEachHostMetric(
       cluster_manager,
-      [&](Stats::PrimitiveCounterSnapshot&& metric) {
-        host_counters.emplace_back(std::move(metric));
+      [this](Stats::PrimitiveCounterSnapshot&& metric) {
+        host_counters_.emplace_back(std::move(metric));
       },
-      [&](Stats::PrimitiveGaugeSnapshot&& metric) { host_gauges.emplace_back(std::move(metric)); });
+      [this](Stats::PrimitiveGaugeSnapshot&& metric) {
+        host_gauges_.emplace_back(std::move(metric));
+      });
+  host_counter_groups_ = makePrimitiveGroups(host_counters_, params);
+  host_gauge_groups_ = makePrimitiveGroups(host_gauges_, params);
+}
 
-  metric_name_count += outputPrimitiveStatType(response, params, std::move(host_counters),
-                                               output_format, custom_namespaces);
-  metric_name_count += outputPrimitiveStatType(response, params, std::move(host_gauges),
-                                               output_format, custom_namespaces);
+/*
+ * From
+ * https://github.com/prometheus/docs/blob/master/content/docs/instrumenting/exposition_formats.md#grouping-and-sorting:
+ *
+ * All lines for a given metric must be provided as one single group, with the optional HELP and
+ * TYPE lines first (in no particular order). Beyond that, reproducible sorting in repeated
+ * expositions is preferred but not required, i.e. do not sort if the computational cost is
+ * prohibitive.
+ *
+ * The groups are sorted by tag-extracted name here. The metrics of a group are only sorted when
+ * the group is rendered.
+ */
+template <class StatType>
+PrometheusStatsRender::Groups<StatType>
+PrometheusStatsRender::makeGroups(const std::vector<Stats::RefcountPtr<StatType>>& metrics,
+                                  const StatsParams& params) {
+  Groups<StatType> groups;
+  // Return early to avoid crashing when getting the symbol table from the first metric.
+  if (metrics.empty()) {
+    return groups;
+  }
 
-  return metric_name_count;
+  const Stats::SymbolTable& global_symbol_table = metrics.front()->constSymbolTable();
+  absl::flat_hash_map<Stats::StatName, size_t> group_index;
+  for (const auto& metric : metrics) {
+    ASSERT(&global_symbol_table == &metric->constSymbolTable());
+    if (!params.shouldShowMetric(*metric)) {
+      continue;
+    }
+    auto [it, inserted] = group_index.try_emplace(metric->tagExtractedStatName(), groups.size());
+    if (inserted) {
+      groups.emplace_back(metric->tagExtractedStatName(), std::vector<const StatType*>());
+    }
+    groups[it->second].second.push_back(metric.get());
+  }
+
+  Stats::StatNameLessThan comp(global_symbol_table);
+  std::sort(groups.begin(), groups.end(),
+            [&comp](const auto& a, const auto& b) { return comp(a.first, b.first); });
+  return groups;
 }
 
-uint64_t PrometheusStatsFormatter::statsAsPrometheusText(
-    const std::vector<Stats::CounterSharedPtr>& counters,
-    const std::vector<Stats::GaugeSharedPtr>& gauges,
-    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
-    const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
-    const Upstream::ClusterManager& cluster_manager, Buffer::Instance& response,
-    const StatsParams& params, const Stats::CustomStatNamespaces& custom_namespaces) {
+template <class StatType>
+PrometheusStatsRender::PrimitiveGroups<StatType>
+PrometheusStatsRender::makePrimitiveGroups(std::vector<StatType>& metrics,
+                                           const StatsParams& params) {
+  PrimitiveGroups<StatType> groups;
+  absl::flat_hash_map<std::string, size_t> group_index;
+  for (auto& metric : metrics) {
+    if (!params.shouldShowMetric(metric)) {
+      continue;
+    }
+    auto [it, inserted] = group_index.try_emplace(metric.tagExtractedName(), groups.size());
+    if (inserted) {
+      groups.emplace_back(metric.tagExtractedName(), std::vector<StatType*>());
+    }
+    groups[it->second].second.push_back(&metric);
+  }
 
-  TextFormat output_format;
-  return generateWithOutputFormat(counters, gauges, histograms, text_readouts, cluster_manager,
-                                  response, params, custom_namespaces, output_format);
+  std::sort(groups.begin(), groups.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  return groups;
 }
 
-uint64_t PrometheusStatsFormatter::statsAsPrometheusProtobuf(
-    const std::vector<Stats::CounterSharedPtr>& counters,
-    const std::vector<Stats::GaugeSharedPtr>& gauges,
-    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
-    const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
-    const Upstream::ClusterManager& cluster_manager, Http::ResponseHeaderMap& response_headers,
-    Buffer::Instance& response, const StatsParams& params,
-    const Stats::CustomStatNamespaces& custom_namespaces) {
+bool PrometheusStatsRender::nextChunk(Buffer::Instance& response, uint64_t chunk_size) {
+  const uint64_t limit = chunk_size > std::numeric_limits<uint64_t>::max() - response.length()
+                             ? std::numeric_limits<uint64_t>::max()
+                             : response.length() + chunk_size;
+  while (phase_ != Phase::Done) {
+    if (!renderPhase(response, limit)) {
+      return true;
+    }
+    phase_ = static_cast<Phase>(static_cast<int>(phase_) + 1);
+    next_group_ = 0;
+  }
+  return false;
+}
 
-  response_headers.setReferenceContentType(
-      "application/vnd.google.protobuf; "
-      "proto=io.prometheus.client.MetricFamily; encoding=delimited");
+bool PrometheusStatsRender::renderPhase(Buffer::Instance& response, uint64_t limit) {
+  switch (phase_) {
+  case Phase::Counters:
+    return renderGroups(counter_groups_, response, limit);
+  case Phase::Gauges:
+    return renderGroups(gauge_groups_, response, limit);
+  case Phase::TextReadouts:
+    return renderGroups(text_readout_groups_, response, limit);
+  case Phase::Histograms:
+    return renderGroups(histogram_groups_, response, limit);
+  case Phase::HostCounters:
+    return renderPrimitiveGroups(host_counter_groups_, response, limit);
+  case Phase::HostGauges:
+    return renderPrimitiveGroups(host_gauge_groups_, response, limit);
+  case Phase::Done:
+    break;
+  }
+  return true;
+}
 
-  ProtobufFormat output_format(params.native_histogram_max_buckets_);
-  return generateWithOutputFormat(counters, gauges, histograms, text_readouts, cluster_manager,
-                                  response, params, custom_namespaces, output_format);
+template <class StatType>
+bool PrometheusStatsRender::renderGroups(Groups<StatType>& groups, Buffer::Instance& response,
+                                         uint64_t limit) {
+  for (; next_group_ < groups.size(); ++next_group_) {
+    if (response.length() >= limit) {
+      return false;
+    }
+    auto& [group_name, group] = groups[next_group_];
+    const std::optional<std::string> prefixed_tag_extracted_name =
+        PrometheusStatsFormatter::metricName(group.front()->constSymbolTable().toString(group_name),
+                                             custom_namespaces_);
+    if (!prefixed_tag_extracted_name.has_value()) {
+      continue;
+    }
+    ++metric_name_count_;
+
+    // Sort before producing the final output to satisfy the "preferred" ordering from the
+    // prometheus spec: metrics will be sorted by their tags' textual representation, which will
+    // be consistent across calls.
+    std::sort(group.begin(), group.end(), MetricLessThan());
+    output_format_->generateOutput(response, group, prefixed_tag_extracted_name.value());
+  }
+  // Release the memory of the rendered groups before moving on to the next phase.
+  Groups<StatType>().swap(groups);
+  return true;
 }
 
-uint64_t PrometheusStatsFormatter::statsAsPrometheus(
-    const std::vector<Stats::CounterSharedPtr>& counters,
-    const std::vector<Stats::GaugeSharedPtr>& gauges,
-    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
-    const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
-    const Upstream::ClusterManager& cluster_manager, const Http::RequestHeaderMap& request_headers,
-    Http::ResponseHeaderMap& response_headers, Buffer::Instance& response,
-    const StatsParams& params, const Stats::CustomStatNamespaces& custom_namespaces) {
+template <class StatType>
+bool PrometheusStatsRender::renderPrimitiveGroups(PrimitiveGroups<StatType>& groups,
+                                                  Buffer::Instance& response, uint64_t limit) {
+  for (; next_group_ < groups.size(); ++next_group_) {
+    if (response.length() >= limit) {
+      return false;
+    }
+    auto& [group_name, group] = groups[next_group_];
+    const std::optional<std::string> prefixed_tag_extracted_name =
+        PrometheusStatsFormatter::metricName(std::move(group_name), custom_namespaces_);
+    if (!prefixed_tag_extracted_name.has_value()) {
+      continue;
+    }
+    ++metric_name_count_;
 
-  return useProtobufFormat(params, request_headers)
-             ? statsAsPrometheusProtobuf(counters, gauges, histograms, text_readouts,
-                                         cluster_manager, response_headers, response, params,
-                                         custom_namespaces)
-             : statsAsPrometheusText(counters, gauges, histograms, text_readouts, cluster_manager,
-                                     response, params, custom_namespaces);
+    std::sort(group.begin(), group.end(), PrimitiveMetricSnapshotLessThan());
+    output_format_->generateOutput(response, std::move(group), prefixed_tag_extracted_name.value());
+  }
+  PrimitiveGroups<StatType>().swap(groups);
+  return true;
 }
 
 } // namespace Server
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/buffer/buffer.h"
+#include "envoy/http/header_map.h"
 #include "envoy/stats/custom_stat_namespaces.h"
 #include "envoy/stats/histogram.h"
+#include "envoy/stats/primitive_stats.h"
 #include "envoy/stats/stats.h"
 
 #include "source/server/admin/stats_params.h"
@@ -67,6 +71,21 @@ public:
   private:
     HistogramType histogram_type_;
   };
+  using OutputFormatPtr = std::unique_ptr<OutputFormat>;
+
+  /**
+   * @return true if the params or the Accept header select the protobuf exposition format,
+   *         false for the text format.
+   */
+  static bool useProtobufFormat(const StatsParams& params, const Http::RequestHeaderMap& headers);
+
+  /**
+   * Creates the output format requested by the params and the Accept header, and sets the
+   * matching content type on the response.
+   */
+  static OutputFormatPtr makeOutputFormat(const StatsParams& params,
+                                          const Http::RequestHeaderMap& request_headers,
+                                          Http::ResponseHeaderMap& response_headers);
 
   /**
    * Extracts counters and gauges and relevant tags, appending them to
@@ -103,16 +122,6 @@ public:
                             const StatsParams& params,
                             const Stats::CustomStatNamespaces& custom_namespaces);
 
-  static uint64_t
-  generateWithOutputFormat(const std::vector<Stats::CounterSharedPtr>& counters,
-                           const std::vector<Stats::GaugeSharedPtr>& gauges,
-                           const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
-                           const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
-                           const Upstream::ClusterManager& cluster_manager,
-                           Buffer::Instance& response, const StatsParams& params,
-                           const Stats::CustomStatNamespaces& custom_namespaces,
-                           OutputFormat& output_format);
-
   /**
    * Format the given tags, returning a string as a comma-separated list
    * of <tag_name>="<tag_value>" pairs.
@@ -136,5 +145,78 @@ public:
              const Stats::CustomStatNamespaces& custom_namespace_factory);
 };
 
+/**
+ * Renders the prometheus exposition of a set of stats incrementally, so that it can be streamed
+ * in chunks rather than buffered whole. The constructor groups the metrics by tag-extracted name,
+ * which only takes a pointer per metric, and each nextChunk() renders whole groups, in the same
+ * order as the buffered output, until the chunk size is reached.
+ *
+ * The metric vectors are not copied: the caller must keep them alive until rendering is done.
+ */
+class PrometheusStatsRender {
+public:
+  PrometheusStatsRender(const std::vector<Stats::CounterSharedPtr>& counters,
+                        const std::vector<Stats::GaugeSharedPtr>& gauges,
+                        const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+                        const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
+                        const Upstream::ClusterManager& cluster_manager, const StatsParams& params,
+                        const Stats::CustomStatNamespaces& custom_namespaces,
+                        PrometheusStatsFormatter::OutputFormatPtr output_format);
+
+  /**
+   * Renders the next groups of metrics into response, until at least chunk_size bytes have been
+   * added or all the groups are rendered.
+   * @return true if there are more groups to render.
+   */
+  bool nextChunk(Buffer::Instance& response, uint64_t chunk_size);
+
+  /**
+   * @return the number of metric names rendered so far.
+   */
+  uint64_t metricNameCount() const { return metric_name_count_; }
+
+private:
+  template <class StatType>
+  using Groups = std::vector<std::pair<Stats::StatName, std::vector<const StatType*>>>;
+  template <class StatType>
+  using PrimitiveGroups = std::vector<std::pair<std::string, std::vector<StatType*>>>;
+
+  // Ordered as the buffered output always was.
+  enum class Phase { Counters, Gauges, TextReadouts, Histograms, HostCounters, HostGauges, Done };
+
+  template <class StatType>
+  static Groups<StatType> makeGroups(const std::vector<Stats::RefcountPtr<StatType>>& metrics,
+                                     const StatsParams& params);
+  template <class StatType>
+  static PrimitiveGroups<StatType> makePrimitiveGroups(std::vector<StatType>& metrics,
+                                                       const StatsParams& params);
+  // These return true once all the groups are rendered.
+  template <class StatType>
+  bool renderGroups(Groups<StatType>& groups, Buffer::Instance& response, uint64_t limit);
+  template <class StatType>
+  bool renderPrimitiveGroups(PrimitiveGroups<StatType>& groups, Buffer::Instance& response,
+                             uint64_t limit);
+  bool renderPhase(Buffer::Instance& response, uint64_t limit);
+
+  const Stats::CustomStatNamespaces& custom_namespaces_;
+  const PrometheusStatsFormatter::OutputFormatPtr output_format_;
+
+  Groups<Stats::Counter> counter_groups_;
+  Groups<Stats::Gauge> gauge_groups_;
+  Groups<Stats::TextReadout> text_readout_groups_;
+  Groups<Stats::ParentHistogram> histogram_groups_;
+  // Per-endpoint stats are snapshotted when the render is created.
+  std::vector<Stats::PrimitiveCounterSnapshot> host_counters_;
+  std::vector<Stats::PrimitiveGaugeSnapshot> host_gauges_;
+  PrimitiveGroups<Stats::PrimitiveCounterSnapshot> host_counter_groups_;
+  PrimitiveGroups<Stats::PrimitiveGaugeSnapshot> host_gauge_groups_;
+
+  Phase phase_{Phase::Counters};
+  size_t next_group_{0};
+  uint64_t metric_name_count_{0};
+};
+
+using PrometheusStatsRenderPtr = std::unique_ptr<PrometheusStatsRender>;
+
 } // namespace Server
 } // namespace Envoy
@@ -1,5 +1,6 @@
 #include "source/server/admin/stats_handler.h"
 
+#include <algorithm>
 #include <functional>
 #include <vector>
 
@@ -8,6 +9,7 @@
 
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/empty_string.h"
+#include "source/common/http/header_map_impl.h"
 #include "source/common/http/headers.h"
 #include "source/common/http/utility.h"
 #include "source/server/admin/prometheus_stats.h"
@@ -21,33 +23,84 @@ namespace Server {
 const uint64_t RecentLookupsCapacity = 100;
 
 namespace {
-// Implements a chunked request for Prometheus stats.
+// Implements a chunked request for Prometheus stats. The stats are collected and grouped in
+// start(), and each chunk renders the next groups, so the whole exposition is never buffered.
 class PrometheusRequest : public Admin::Request {
 public:
-  PrometheusRequest(StatsHandler& handler, const StatsParams& params, AdminStream& admin_stream)
-      : handler_(handler), params_(params), admin_stream_(admin_stream) {}
+  PrometheusRequest(Stats::Store& stats, const Stats::CustomStatNamespaces& custom_namespaces,
+                    const Upstream::ClusterManager& cluster_manager, const StatsParams& params,
+                    const Http::RequestHeaderMap& request_headers,
+                    PrometheusChangedSeries* changed_series)
+      : stats_(stats), custom_namespaces_(custom_namespaces), cluster_manager_(cluster_manager),
+        params_(params), request_headers_(request_headers), changed_series_(changed_series) {}
 
   Http::Code start(Http::ResponseHeaderMap& response_headers) override {
-    code_ = handler_.prometheusFlushAndRender(params_, admin_stream_.getRequestHeaders(),
-                                              response_headers, response_);
-    return code_;
+    counters_ = stats_.counters();
+    gauges_ = stats_.gauges();
+    histograms_ = stats_.histograms();
+    if (params_.prometheus_text_readouts_) {
+      text_readouts_ = stats_.textReadouts();
+    }
+    if (changed_series_ != nullptr) {
+      changed_series_->filterUnchanged(params_.scraper_id_, counters_, gauges_);
+    }
+    render_ = std::make_unique<PrometheusStatsRender>(
+        counters_, gauges_, histograms_, text_readouts_, cluster_manager_, params_,
+        custom_namespaces_,
+        PrometheusStatsFormatter::makeOutputFormat(params_, request_headers_, response_headers));
+    return Http::Code::OK;
   }
 
   bool nextChunk(Buffer::Instance& response) override {
-    response.move(response_);
-    return false;
+    return render_->nextChunk(response, StatsRequest::DefaultChunkSize);
   }
 
 private:
-  StatsHandler& handler_;
+  Stats::Store& stats_;
+  const Stats::CustomStatNamespaces& custom_namespaces_;
+  const Upstream::ClusterManager& cluster_manager_;
   const StatsParams params_;
-  AdminStream& admin_stream_;
-  Buffer::OwnedImpl response_;
-  Http::Code code_{Http::Code::OK};
+  const Http::RequestHeaderMap& request_headers_;
+  PrometheusChangedSeries* changed_series_;
+  // Hold the stats alive while they are rendered.
+  std::vector<Stats::CounterSharedPtr> counters_;
+  std::vector<Stats::GaugeSharedPtr> gauges_;
+  std::vector<Stats::ParentHistogramSharedPtr> histograms_;
+  std::vector<Stats::TextReadoutSharedPtr> text_readouts_;
+  PrometheusStatsRenderPtr render_;
+};
+
+// Streams a response of the prometheus scrape cache. The entry is shared with the cache and the
+// other requests serving it.
+class CachedPrometheusRequest : public Admin::Request {
+public:
+  explicit CachedPrometheusRequest(PrometheusScrapeCache::EntryConstSharedPtr entry)
+      : entry_(std::move(entry)) {}
+
+  Http::Code start(Http::ResponseHeaderMap& response_headers) override {
+    if (!entry_->content_type_.empty()) {
+      response_headers.setContentType(entry_->content_type_);
+    }
+    return Http::Code::OK;
+  }
+
+  bool nextChunk(Buffer::Instance& response) override {
+    const absl::string_view body = entry_->body_;
+    const uint64_t size = std::min<uint64_t>(body.size() - offset_, StatsRequest::DefaultChunkSize);
+    response.add(body.substr(offset_, size));
+    offset_ += size;
+    return offset_ < body.size();
+  }
+
+private:
+  const PrometheusScrapeCache::EntryConstSharedPtr entry_;
+  uint64_t offset_{0};
 };
 } // namespace
 
-StatsHandler::StatsHandler(Server::Instance& server) : HandlerContextBase(server) {}
+StatsHandler::StatsHandler(Server::Instance& server)
+    : HandlerContextBase(server),
+      changed_series_(server.stats().symbolTable(), server.timeSource()) {}
 
 Http::Code StatsHandler::handlerResetCounters(Http::ResponseHeaderMap&, Buffer::Instance& response,
                                               AdminStream&) {
@@ -107,14 +160,7 @@ Admin::RequestPtr StatsHandler::makeRequest(AdminStream& admin_stream) {
   }
 
   if (params.format_ == StatsFormat::Prometheus) {
-    // TODO(#16139): modify streaming algorithm to cover Prometheus.
-    //
-    // This may be easiest to accomplish by populating the set
-    // with tagExtractedName(), and allowing for vectors of
-    // stats as multiples will have the same tag-extracted names.
-    // Ideally we'd find a way to do this without slowing down
-    // the non-Prometheus implementations.
-    return std::make_unique<PrometheusRequest>(*this, params, admin_stream);
+    return makePrometheusRequest(params, admin_stream);
   }
 
   if (params.histogram_buckets_mode_ == Utility::HistogramBucketsMode::PrometheusNative) {
@@ -143,10 +189,72 @@ Admin::RequestPtr StatsHandler::makeRequest(Stats::Store& stats, const StatsPara
   return std::make_unique<StatsRequest>(stats, params, cluster_manager, url_handler_fn);
 }
 
-Http::Code StatsHandler::handlerPrometheusStats(Http::ResponseHeaderMap& response_headers,
-                                                Buffer::Instance& response,
-                                                AdminStream& admin_stream) {
-  return prometheusStats(admin_stream.getRequestHeaders(), response_headers, response);
+Admin::RequestPtr StatsHandler::makePrometheusRequest(AdminStream& admin_stream) {
+  StatsParams params;
+  Buffer::OwnedImpl response;
+  Http::Code code = params.parse(admin_stream.getRequestHeaders().getPathValue(), response);
+  if (code != Http::Code::OK) {
+    return Admin::makeStaticTextRequest(response, code);
+  }
+  return makePrometheusRequest(params, admin_stream);
+}
+
+Admin::RequestPtr StatsHandler::makePrometheusRequest(const StatsParams& params,
+                                                      AdminStream& admin_stream) {
+  const Http::RequestHeaderMap& request_headers = admin_stream.getRequestHeaders();
+  absl::Status params_status = PrometheusStatsFormatter::validateParams(params, request_headers);
+  if (!params_status.ok()) {
+    return Admin::makeStaticTextRequest(params_status.message(), Http::Code::BadRequest);
+  }
+
+  // Forget the changed-only scrapers that went away, even if only full scrapes keep coming.
+  changed_series_.removeIdleScrapers();
+
+  // Changed-only scrapes depend on the scraper, so they are neither served from nor added to the
+  // shared cache.
+  std::string cache_key;
+  if (scrape_cache_.enabled() && !params.changed_only_) {
+    cache_key = PrometheusScrapeCache::key(params, request_headers);
+    PrometheusScrapeCache::EntryConstSharedPtr entry =
+        scrape_cache_.find(cache_key, server_.timeSource().monotonicTime());
+    if (entry != nullptr) {
+      return std::make_unique<CachedPrometheusRequest>(std::move(entry));
+    }
+  }
+
+  if (server_.statsConfig().flushOnAdmin()) {
+    server_.flushStats();
+  }
+
+  if (cache_key.empty()) {
+    return makePrometheusRequest(server_.stats(), server_.api().customStatNamespaces(),
+                                 server_.clusterManager(), params, request_headers,
+                                 params.changed_only_ ? &changed_series_ : nullptr);
+  }
+
+  // The response is rendered as a whole so that it is in the cache for the requests that arrive
+  // while it is being streamed.
+  auto entry = std::make_shared<PrometheusScrapeCache::Entry>();
+  Http::ResponseHeaderMapPtr response_headers = Http::ResponseHeaderMapImpl::create();
+  Buffer::OwnedImpl response;
+  prometheusRender(server_.stats(), server_.api().customStatNamespaces(), server_.clusterManager(),
+                   params, request_headers, *response_headers, response);
+  entry->content_type_ = std::string(response_headers->getContentTypeValue());
+  entry->body_ = response.toString();
+  scrape_cache_.insert(cache_key, entry, server_.timeSource().monotonicTime());
+  return std::make_unique<CachedPrometheusRequest>(std::move(entry));
+}
+
+Admin::RequestPtr StatsHandler::makePrometheusRequest(
+    Stats::Store& stats, const Stats::CustomStatNamespaces& custom_namespaces,
+    const Upstream::ClusterManager& cluster_manager, const StatsParams& params,
+    const Http::RequestHeaderMap& request_headers, PrometheusChangedSeries* changed_series) {
+  return std::make_unique<PrometheusRequest>(stats, custom_namespaces, cluster_manager, params,
+                                             request_headers, changed_series);
+}
+
+void StatsHandler::setPrometheusScrapeCacheFreshness(std::chrono::milliseconds freshness) {
+  scrape_cache_.setFreshness(freshness);
 }
 
 Http::Code StatsHandler::prometheusStats(const Http::RequestHeaderMap& request_headers,
@@ -211,6 +319,33 @@ Http::Code StatsHandler::handlerContention(Http::ResponseHeaderMap& response_hea
   return Http::Code::OK;
 }
 
+Admin::UrlHandler StatsHandler::prometheusStatsHandler() {
+  return {"/stats/prometheus",
+          "print server stats in prometheus format",
+          [this](AdminStream& admin_stream) -> Admin::RequestPtr {
+            return makePrometheusRequest(admin_stream);
+          },
+          false,
+          false,
+          {{Admin::ParamDescriptor::Type::Boolean, "usedonly",
+            "Only include stats that have been written by system since restart"},
+           {Admin::ParamDescriptor::Type::Boolean, "text_readouts",
+            "Render text_readouts as new gaugues with value 0 (increases Prometheus "
+            "data size)"},
+           {Admin::ParamDescriptor::Type::String, "filter",
+            "Regular expression (Google re2) for filtering stats"},
+           {Admin::ParamDescriptor::Type::Boolean, "invert_filter", "Invert the filter regex"},
+           {Admin::ParamDescriptor::Type::Enum,
+            "histogram_buckets",
+            "Histogram bucket display mode",
+            {"cumulative", "summary"}},
+           {Admin::ParamDescriptor::Type::Boolean, "changedonly",
+            "Only include the counters and gauges that changed since the previous scrape with the "
+            "same scraper_id"},
+           {Admin::ParamDescriptor::Type::String, "scraper_id",
+            "Identifies the scraper for changedonly"}}};
+}
+
 Admin::UrlHandler StatsHandler::statsHandler(bool active_mode) {
   Admin::ParamDescriptor usedonly{
       Admin::ParamDescriptor::Type::Boolean, "usedonly",
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <regex>
 #include <string>
 
@@ -10,6 +11,7 @@
 #include "envoy/server/instance.h"
 
 #include "source/server/admin/handler_ctx.h"
+#include "source/server/admin/prometheus_scrape_cache.h"
 #include "source/server/admin/stats_request.h"
 #include "source/server/admin/utils.h"
 
@@ -33,8 +35,6 @@ public:
                                               Buffer::Instance& response, AdminStream&);
   Http::Code handlerStatsRecentLookupsEnable(Http::ResponseHeaderMap& response_headers,
                                              Buffer::Instance& response, AdminStream&);
-  Http::Code handlerPrometheusStats(Http::ResponseHeaderMap& response_headers,
-                                    Buffer::Instance& response, AdminStream&);
 
   /**
    * Parses and executes a prometheus stats request.
@@ -92,10 +92,49 @@ public:
    */
   Admin::UrlHandler statsHandler(bool active_mode);
 
+  /**
+   * @return a URL handler for /stats/prometheus, which streams the stats in chunks.
+   */
+  Admin::UrlHandler prometheusStatsHandler();
+
   static Admin::RequestPtr makeRequest(Stats::Store& stats, const StatsParams& params,
                                        const Upstream::ClusterManager& cm,
                                        StatsRequest::UrlHandlerFn url_handler_fn = nullptr);
   Admin::RequestPtr makeRequest(AdminStream&);
+
+  /**
+   * Creates a request streaming the prometheus exposition of the stats: the stats are grouped
+   * when the request starts, and each chunk renders the next groups. This is broken out as a
+   * separately callable API to facilitate the benchmark
+   * (test/server/admin/stats_handler_speed_test.cc) which does not have a server object.
+   *
+   * @param stats the stats store to read
+   * @param custom_namespaces namespace mappings used for prometheus
+   * @param params the already-parsed and validated parameters.
+   * @param request_headers the request headers selecting the exposition format, which must
+   *        outlive the request.
+   * @param changed_series if non-null, only the counters and gauges that changed since the
+   *        previous scrape of the params' scraper_id are rendered.
+   */
+  static Admin::RequestPtr
+  makePrometheusRequest(Stats::Store& stats, const Stats::CustomStatNamespaces& custom_namespaces,
+                        const Upstream::ClusterManager& cluster_manager, const StatsParams& params,
+                        const Http::RequestHeaderMap& request_headers,
+                        PrometheusChangedSeries* changed_series = nullptr);
+  Admin::RequestPtr makePrometheusRequest(AdminStream& admin_stream);
+
+  /**
+   * Sets how long rendered prometheus scrapes are shared with the scrapes that have the same
+   * format and query parameters. Zero disables the sharing.
+   */
+  void setPrometheusScrapeCacheFreshness(std::chrono::milliseconds freshness);
+
+private:
+  // Validates the params and flushes the stats if configured before creating the request.
+  Admin::RequestPtr makePrometheusRequest(const StatsParams& params, AdminStream& admin_stream);
+
+  PrometheusScrapeCache scrape_cache_;
+  PrometheusChangedSeries changed_series_;
 };
 
 } // namespace Server
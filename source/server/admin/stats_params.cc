@@ -28,6 +28,13 @@ Http::Code StatsParams::parse(absl::string_view url, Buffer::Instance& response)
   }
   filter_inverted_ = has_invert_filter;
 
+  changed_only_ = query_.getFirstValue("changedonly").has_value();
+  scraper_id_ = query_.getFirstValue("scraper_id").value_or("");
+  if (changed_only_ && scraper_id_.empty()) {
+    response.add("changedonly can only be used if scraper_id is also provided");
+    return Http::Code::BadRequest;
+  }
+
   absl::Status status = Utility::histogramBucketsParam(query_, histogram_buckets_mode_);
   if (!status.ok()) {
     response.add(status.message());
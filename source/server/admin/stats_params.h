@@ -72,6 +72,10 @@ struct StatsParams {
   Utility::HistogramBucketsMode histogram_buckets_mode_{Utility::HistogramBucketsMode::Unset};
   // If set, emit native histograms with at most this many buckets per histogram.
   std::optional<uint32_t> native_histogram_max_buckets_;
+  // If set, prometheus scrapes only include the counters and gauges that changed since the
+  // previous scrape by the same scraper_id_.
+  bool changed_only_{false};
+  std::string scraper_id_;
   Http::Utility::QueryParamsMulti query_;
 
   /**
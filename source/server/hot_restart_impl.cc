@@ -4,8 +4,10 @@
 #include <sys/types.h>
 #include <sys/un.h>
 
+#include <algorithm>
 #include <csignal>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 
@@ -16,6 +18,7 @@
 #include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/api/os_sys_calls_impl_hot_restart.h"
 #include "source/common/common/fmt.h"
+#include "source/common/common/hash.h"
 #include "source/common/common/lock_guard.h"
 
 #include "absl/strings/string_view.h"
@@ -61,6 +64,7 @@ SharedMemory* attachSharedMemory(uint32_t base_id, uint32_t restart_epoch) {
     shmem->version_ = HOT_RESTART_VERSION;
     initializeMutex(shmem->log_lock_);
     initializeMutex(shmem->access_log_lock_);
+    initializeMutex(shmem->tls_sessions_.lock_);
   } else {
     RELEASE_ASSERT(shmem->size_ == sizeof(SharedMemory),
                    "Hot restart SharedMemory size mismatch! You must have hot restarted into a "
@@ -90,6 +94,68 @@ void initializeMutex(pthread_mutex_t& mutex) {
   pthread_mutex_init(&mutex, &attribute);
 }
 
+namespace {
+
+// The slots a session can be stored in. The hash must be the same in all the processes.
+SharedTlsSessions::Slot* setOf(SharedTlsSessions& sessions, absl::Span<const uint8_t> session_id) {
+  const uint64_t hash = HashUtil::xxHash64(
+      absl::string_view(reinterpret_cast<const char*>(session_id.data()), session_id.size()));
+  return sessions.slots_[hash % SharedTlsSessions::NumSets];
+}
+
+} // namespace
+
+SharedTlsSessions::Slot* SharedMemorySessionStore::find(absl::Span<const uint8_t> session_id) {
+  if (session_id.size() > Ssl::SessionStore::MaxSessionIdLength) {
+    return nullptr;
+  }
+  SharedTlsSessions::Slot* set = setOf(sessions_, session_id);
+  for (size_t i = 0; i < SharedTlsSessions::SlotsPerSet; ++i) {
+    SharedTlsSessions::Slot& slot = set[i];
+    if (slot.last_used_ != 0 && slot.session_id_length_ == session_id.size() &&
+        std::memcmp(slot.session_id_, session_id.data(), session_id.size()) == 0) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+bool SharedMemorySessionStore::insert(absl::Span<const uint8_t> session_id,
+                                      absl::Span<const uint8_t> session) {
+  if (session_id.empty() || session_id.size() > Ssl::SessionStore::MaxSessionIdLength ||
+      session.size() > SharedTlsSessions::MaxSessionLength) {
+    return false;
+  }
+  Thread::LockGuard lock(lock_);
+  SharedTlsSessions::Slot* slot = find(session_id);
+  if (slot == nullptr) {
+    // Empty slots are the least recently used ones.
+    SharedTlsSessions::Slot* set = setOf(sessions_, session_id);
+    slot = std::min_element(set, set + SharedTlsSessions::SlotsPerSet,
+                            [](const SharedTlsSessions::Slot& a, const SharedTlsSessions::Slot& b) {
+                              return a.last_used_ < b.last_used_;
+                            });
+    slot->session_id_length_ = session_id.size();
+    std::memcpy(slot->session_id_, session_id.data(), session_id.size());
+  }
+  slot->last_used_ = ++sessions_.clock_;
+  slot->session_length_ = session.size();
+  std::memcpy(slot->session_, session.data(), session.size());
+  return true;
+}
+
+bool SharedMemorySessionStore::lookup(absl::Span<const uint8_t> session_id,
+                                      std::vector<uint8_t>& session) {
+  Thread::LockGuard lock(lock_);
+  SharedTlsSessions::Slot* slot = find(session_id);
+  if (slot == nullptr) {
+    return false;
+  }
+  slot->last_used_ = ++sessions_.clock_;
+  session.assign(slot->session_, slot->session_ + slot->session_length_);
+  return true;
+}
+
 // The base id is automatically scaled by 10 to prevent overlap of domain socket names when
 // multiple Envoys with different base-ids run on a single host. Note that older versions of Envoy
 // performed the multiplication in OptionsImpl which produced incorrect server info output.
@@ -103,7 +169,7 @@ HotRestartImpl::HotRestartImpl(uint32_t base_id, uint32_t restart_epoch,
                                    skip_hot_restart_on_no_parent, skip_parent_stats)),
       as_parent_(HotRestartingParent(scaled_base_id_, restart_epoch, socket_path, socket_mode)),
       shmem_(attachSharedMemory(scaled_base_id_, restart_epoch)), log_lock_(shmem_->log_lock_),
-      access_log_lock_(shmem_->access_log_lock_) {
+      access_log_lock_(shmem_->access_log_lock_), tls_session_store_(shmem_->tls_sessions_) {
   // If our parent ever goes away just terminate us so that we don't have to rely on ops/launching
   // logic killing the entire process tree. We should never exist without our parent.
   int rc = prctl(PR_SET_PDEATHSIG, SIGTERM);
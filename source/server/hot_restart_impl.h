@@ -7,21 +7,50 @@
 #include <atomic>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "envoy/common/platform.h"
 #include "envoy/server/hot_restart.h"
+#include "envoy/ssl/session_store.h"
 
 #include "source/common/common/assert.h"
 #include "source/common/stats/allocator.h"
 #include "source/server/hot_restarting_child.h"
 #include "source/server/hot_restarting_parent.h"
 
+#include "absl/types/span.h"
+
 namespace Envoy {
 namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t HOT_RESTART_VERSION = 11;
+const uint64_t HOT_RESTART_VERSION = 12;
+
+/**
+ * TLS server sessions kept in shared memory, in a set associative table: a session can only be in
+ * the slots of the set selected by the hash of its ID, and replaces the least recently used one.
+ */
+struct SharedTlsSessions {
+  static constexpr size_t NumSets = 1024;
+  static constexpr size_t SlotsPerSet = 4;
+  // Sessions are typically a few hundred bytes; larger ones, e.g. carrying a client certificate
+  // chain, are not shared.
+  static constexpr size_t MaxSessionLength = 1024 - 48;
+
+  struct Slot {
+    // Value of clock_ when the slot was last used, 0 if the slot is empty.
+    uint64_t last_used_;
+    uint32_t session_id_length_;
+    uint32_t session_length_;
+    uint8_t session_id_[Ssl::SessionStore::MaxSessionIdLength];
+    uint8_t session_[MaxSessionLength];
+  };
+
+  pthread_mutex_t lock_;
+  uint64_t clock_;
+  Slot slots_[NumSets][SlotsPerSet];
+};
 
 /**
  * Shared memory segment. This structure is laid directly into shared memory and is used amongst
@@ -33,6 +62,7 @@ struct SharedMemory {
   pthread_mutex_t log_lock_;
   pthread_mutex_t access_log_lock_;
   std::atomic<uint64_t> flags_;
+  SharedTlsSessions tls_sessions_;
 };
 static const uint64_t SHMEM_FLAGS_INITIALIZING = 0x1;
 
@@ -91,6 +121,26 @@ private:
   pthread_mutex_t& mutex_;
 };
 
+/**
+ * Ssl::SessionStore in shared memory, so that the TLS sessions survive hot restarts.
+ */
+class SharedMemorySessionStore : public Ssl::SessionStore {
+public:
+  explicit SharedMemorySessionStore(SharedTlsSessions& sessions)
+      : sessions_(sessions), lock_(sessions.lock_) {}
+
+  // Ssl::SessionStore
+  bool insert(absl::Span<const uint8_t> session_id, absl::Span<const uint8_t> session) override;
+  bool lookup(absl::Span<const uint8_t> session_id, std::vector<uint8_t>& session) override;
+
+private:
+  SharedTlsSessions::Slot* find(absl::Span<const uint8_t> session_id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  SharedTlsSessions& sessions_;
+  ProcessSharedMutex lock_;
+};
+
 /**
  * Implementation of HotRestart built for Linux. Most of the "protocol" type logic is split out into
  * HotRestarting{Base,Parent,Child}. This class ties all that to shared memory and version logic.
@@ -118,6 +168,7 @@ public:
   std::string version() override;
   Thread::BasicLockable& logLock() override { return log_lock_; }
   Thread::BasicLockable& accessLogLock() override { return access_log_lock_; }
+  Ssl::SessionStore* tlsSessionStore() override { return &tls_session_store_; }
   bool isInitializing() const override;
 
   /**
@@ -137,6 +188,7 @@ private:
   SharedMemory* shmem_;
   ProcessSharedMutex log_lock_;
   ProcessSharedMutex access_log_lock_;
+  SharedMemorySessionStore tls_session_store_;
 };
 
 } // namespace Server
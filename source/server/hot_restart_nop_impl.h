@@ -38,6 +38,7 @@ public:
   std::string version() override { return "disabled"; }
   Thread::BasicLockable& logLock() override { return log_lock_; }
   Thread::BasicLockable& accessLogLock() override { return access_log_lock_; }
+  Ssl::SessionStore* tlsSessionStore() override { return nullptr; }
   bool isInitializing() const override { return false; }
 
 private:
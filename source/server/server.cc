@@ -50,6 +50,7 @@
 #include "source/common/stats/thread_local_store.h"
 #include "source/common/stats/timespan_impl.h"
 #include "source/common/tls/context_manager_impl.h"
+#include "source/common/tls/session_store.h"
 #include "source/common/upstream/cluster_manager_impl.h"
 #include "source/common/version/version.h"
 #include "source/server/cgroup_cpu_util.h"
@@ -114,6 +115,7 @@ InstanceBase::~InstanceBase() {
 
   // Clear the server factory context on the main thread.
   Configuration::ServerFactoryContextInstance::clear();
+  Extensions::TransportSockets::Tls::SessionStoreSingleton::clear();
 
   // Stop logging to file before all the AccessLogManager and its dependencies are
   // destructed to avoid crashing at shutdown.
@@ -565,8 +567,16 @@ absl::Status InstanceBase::initializeOrThrow(Network::Address::InstanceConstShar
   stats_store_.setTagProducer(std::move(producer_or_error.value()));
   stats_store_.setStatsMatcher(std::make_unique<Stats::StatsMatcherImpl>(
       bootstrap_.stats_config(), stats_store_.symbolTable(), server_contexts_));
+  if (bootstrap_.stats_config().has_sharded_counters()) {
+    stats_store_.setShardedCounterMatcher(std::make_unique<Stats::StatsMatcherImpl>(
+        bootstrap_.stats_config().sharded_counters(), stats_store_.symbolTable(),
+        server_contexts_));
+  }
   stats_store_.setHistogramSettings(
       std::make_unique<Stats::HistogramSettingsImpl>(bootstrap_.stats_config(), server_contexts_));
+  stats_store_.setHistogramMergeThreads(
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(bootstrap_.stats_config(), histogram_merge_threads, 1),
+      api_->threadFactory());
 
   const std::string server_stats_prefix = "server.";
   const std::string server_compilation_settings_stats_prefix = "server.compilation_settings";
@@ -678,6 +688,8 @@ absl::Status InstanceBase::initializeOrThrow(Network::Address::InstanceConstShar
     admin_impl->addAllowlistedPath(
         std::make_unique<Matchers::StringMatcherImpl>(allowlisted_path, server_contexts_));
   }
+  admin_impl->setPrometheusScrapeCacheFreshness(std::chrono::milliseconds(
+      PROTOBUF_GET_MS_OR_DEFAULT(bootstrap_.admin(), prometheus_scrape_cache_duration, 0)));
 
   admin_ = admin_impl;
   config_tracker = admin_->getConfigTracker();
@@ -831,7 +843,13 @@ absl::Status InstanceBase::initializeOrThrow(Network::Address::InstanceConstShar
     admin_->addListenerToHandler(handler_.get());
   }
 
-  // Once we have runtime we can initialize the SSL context manager.
+  // Once we have runtime we can initialize the SSL context manager, and share the TLS server
+  // sessions with the other processes of the hot restart.
+  if (Ssl::SessionStore* store = restarter_.tlsSessionStore();
+      store != nullptr &&
+      Runtime::runtimeFeatureEnabled("envoy.restart_features.shared_tls_session_cache")) {
+    Extensions::TransportSockets::Tls::SessionStoreSingleton::initialize(store);
+  }
   ssl_context_manager_ =
       std::make_unique<Extensions::TransportSockets::Tls::ContextManagerImpl>(server_contexts_);
 
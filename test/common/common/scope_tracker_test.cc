@@ -3,8 +3,10 @@
 #include "source/common/api/api_impl.h"
 #include "source/common/common/scope_tracker.h"
 #include "source/common/event/dispatcher_impl.h"
+#include "source/common/profiler/scope_profiler.h"
 
 #include "test/mocks/common.h"
+#include "test/mocks/stream_info/mocks.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -13,6 +15,7 @@
 namespace Envoy {
 
 using testing::_;
+using testing::Return;
 
 TEST(ScopeTrackerScopeStateTest, ShouldManageTrackedObjectOnDispatcherStack) {
   Api::ApiPtr api(Api::createApiForTest());
@@ -32,4 +35,73 @@ TEST(ScopeTrackerScopeStateTest, ShouldManageTrackedObjectOnDispatcherStack) {
   static_cast<Event::DispatcherImpl*>(dispatcher.get())->onFatalError(std::cerr);
 }
 
+#ifndef WIN32
+// Samples are attributed to the innermost tracked object of the thread when they were taken.
+TEST(ScopeTrackerScopeStateTest, AttributesProfilerSamples) {
+  Api::ApiPtr api(Api::createApiForTest());
+  Event::DispatcherPtr dispatcher(api->allocateDispatcher("test_thread"));
+  testing::NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  stream_info.route_name_ = "tenant_route";
+  stream_info.upstream_cluster_info_ = nullptr;
+  testing::NiceMock<MockScopeTrackedObject> stream;
+  ON_CALL(stream, trackedStream())
+      .WillByDefault(Return(OptRef<const StreamInfo::StreamInfo>(stream_info)));
+  testing::NiceMock<MockScopeTrackedObject> untracked;
+
+  Profiler::ScopeProfiler::reset();
+  // The samples are taken explicitly, so the interval is long enough for the timer not to fire.
+  ASSERT_TRUE(Profiler::ScopeProfiler::start(std::chrono::hours(1)).ok());
+  Profiler::ScopeProfiler::onSample();
+  {
+    ScopeTrackerScopeState scope(&stream, *dispatcher);
+    Profiler::ScopeProfiler::onSample();
+    {
+      ScopeTrackerScopeState nested_scope(&untracked, *dispatcher);
+      Profiler::ScopeProfiler::onSample();
+    }
+    Profiler::ScopeProfiler::onSample();
+  }
+  Profiler::ScopeProfiler::stop();
+
+  EXPECT_EQ("listener=;filter_chain=;route=tenant_route;cluster= 2\n"
+            "unknown 1\n"
+            "unscoped 1\n",
+            Profiler::ScopeProfiler::report());
+  Profiler::ScopeProfiler::reset();
+  EXPECT_EQ("", Profiler::ScopeProfiler::report());
+}
+
+// The samples taken in a scope entered before the profiler started are attributed to it as well.
+TEST(ScopeTrackerScopeStateTest, AttributesProfilerSamplesOfScopeEnteredBeforeStart) {
+  Api::ApiPtr api(Api::createApiForTest());
+  Event::DispatcherPtr dispatcher(api->allocateDispatcher("test_thread"));
+  testing::NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  stream_info.route_name_ = "tenant_route";
+  stream_info.upstream_cluster_info_ = nullptr;
+  testing::NiceMock<MockScopeTrackedObject> stream;
+  ON_CALL(stream, trackedStream())
+      .WillByDefault(Return(OptRef<const StreamInfo::StreamInfo>(stream_info)));
+  testing::NiceMock<MockScopeTrackedObject> untracked;
+
+  Profiler::ScopeProfiler::reset();
+  {
+    ScopeTrackerScopeState scope(&stream, *dispatcher);
+    ASSERT_TRUE(Profiler::ScopeProfiler::start(std::chrono::hours(1)).ok());
+    {
+      ScopeTrackerScopeState nested_scope(&untracked, *dispatcher);
+      Profiler::ScopeProfiler::onSample();
+    }
+    Profiler::ScopeProfiler::onSample();
+  }
+  Profiler::ScopeProfiler::stop();
+
+  EXPECT_EQ("listener=;filter_chain=;route=tenant_route;cluster= 1
+"
+            "unknown 1
+",
+            Profiler::ScopeProfiler::report());
+  Profiler::ScopeProfiler::reset();
+}
+#endif
+
 } // namespace Envoy
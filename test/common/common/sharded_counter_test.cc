@@ -0,0 +1,92 @@
+#include <vector>
+
+#include "source/common/common/sharded_counter.h"
+#include "source/common/common/thread.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+TEST(ShardedCounterTest, SingleThread) {
+  ShardedCounter counter;
+  EXPECT_EQ(ShardedCounter::kDefaultShards, counter.numShards());
+  EXPECT_EQ(0, counter.value());
+
+  counter.inc();
+  counter.add(5);
+  EXPECT_EQ(6, counter.value());
+
+  counter.dec();
+  counter.sub(2);
+  EXPECT_EQ(3, counter.value());
+}
+
+TEST(ShardedCounterTest, SingleShard) {
+  ShardedCounter counter(1);
+  EXPECT_EQ(1, counter.numShards());
+  counter.add(3);
+  EXPECT_EQ(3, counter.value());
+}
+
+TEST(ShardedCounterTest, ThreadIndexIsStable) {
+  EXPECT_EQ(ShardedCounter::threadIndex(), ShardedCounter::threadIndex());
+}
+
+// A value incremented on one thread and decremented on another sums correctly even though the
+// individual slots go negative.
+TEST(ShardedCounterTest, CrossThreadDecrement) {
+  ShardedCounter counter(64);
+  counter.add(10);
+
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+  auto thread = thread_factory.createThread([&counter]() { counter.sub(4); });
+  thread->join();
+
+  EXPECT_EQ(6, counter.value());
+}
+
+// Reads never report a negative value while a decrement is visible before its increment.
+TEST(ShardedCounterTest, ClampsAtZero) {
+  ShardedCounter counter(64);
+
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+  auto thread = thread_factory.createThread([&counter]() { counter.dec(); });
+  thread->join();
+  EXPECT_EQ(0, counter.value());
+  EXPECT_EQ(-1, counter.sum());
+
+  counter.inc();
+  EXPECT_EQ(0, counter.value());
+  EXPECT_EQ(0, counter.sum());
+  counter.inc();
+  EXPECT_EQ(1, counter.value());
+}
+
+TEST(ShardedCounterTest, ConcurrentUpdates) {
+  constexpr uint32_t num_threads = 16;
+  constexpr uint32_t iterations = 10000;
+  ShardedCounter counter;
+
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([&counter]() {
+      for (uint32_t j = 0; j < iterations; ++j) {
+        counter.inc();
+        counter.add(2);
+        counter.dec();
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  EXPECT_EQ(2 * num_threads * iterations, counter.value());
+}
+
+} // namespace
+} // namespace Envoy
@@ -585,6 +585,155 @@ TEST_F(ConnPoolImplBaseTest, ExplicitPreconnectNotEligible) {
   EXPECT_EQ(1U, cluster_->trafficStats()->upstream_cx_preconnect_skipped_.value());
 }
 
+TEST_F(ConnPoolImplBaseTest, NoDemandPreconnectStatsByDefault) {
+  EXPECT_CALL(pool_, instantiateActiveClient);
+  auto cancelable = pool_.newStreamImpl(context_, /*can_send_early_data=*/false);
+  CHECK_STATE(0 /*active*/, 1 /*pending*/, 1 /*connecting capacity*/);
+  EXPECT_EQ(0U, cluster_->trafficStats()->upstream_rq_preconnect_miss_.value());
+
+  cancelable->cancel(ConnectionPool::CancelPolicy::CloseExcess);
+  pool_.destructAllConnections();
+}
+
+TEST_F(ConnPoolImplDispatcherBaseTest, DemandPreconnect) {
+  ON_CALL(*cluster_, demandPreconnectTimeConstant)
+      .WillByDefault(Return(std::chrono::milliseconds(1000)));
+
+  // Without a connect latency sample there is no forecast, so the first stream only gets its own
+  // connection.
+  newConnectingClient();
+  EXPECT_EQ(1U, cluster_->trafficStats()->upstream_rq_preconnect_miss_.value());
+
+  // The connection takes a second to establish.
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_CALL(pool_, onPoolReady);
+  clients_.back()->onEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(ActiveClient::State::Busy, clients_.back()->state());
+
+  // The next stream waits for a new connection. At about 1.4 streams per second, one more stream
+  // is expected to arrive while that connection is established, so a second one is preconnected.
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(2);
+  AttachContext second_context;
+  EXPECT_NE(nullptr, pool_.newStreamImpl(second_context, /*can_send_early_data=*/false));
+  ASSERT_EQ(3, clients_.size());
+  EXPECT_EQ(2U, cluster_->trafficStats()->upstream_rq_preconnect_miss_.value());
+  EXPECT_EQ(1U, cluster_->trafficStats()->upstream_cx_preconnect_demand_.value());
+
+  // Once connected, the preconnected connection serves the next stream without waiting.
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(AnyNumber());
+  EXPECT_CALL(pool_, onPoolReady);
+  clients_[1]->onEvent(Network::ConnectionEvent::Connected);
+  clients_[2]->onEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(ActiveClient::State::Ready, clients_[2]->state());
+
+  AttachContext third_context;
+  EXPECT_CALL(pool_, onPoolReady);
+  EXPECT_EQ(nullptr, pool_.newStreamImpl(third_context, /*can_send_early_data=*/false));
+  EXPECT_EQ(1U, cluster_->trafficStats()->upstream_rq_preconnect_hit_.value());
+  EXPECT_EQ(2U, cluster_->trafficStats()->upstream_rq_preconnect_miss_.value());
+
+  EXPECT_CALL(pool_, onPoolFailure).Times(AnyNumber());
+  pool_.destructAllConnections();
+}
+
+TEST_F(ConnPoolImplDispatcherBaseTest, DemandPreconnectCircuitBroken) {
+  ON_CALL(*cluster_, demandPreconnectTimeConstant)
+      .WillByDefault(Return(std::chrono::milliseconds(1000)));
+  cluster_->resetResourceManager(2, 1024, 1024, 1, 1);
+
+  newConnectingClient();
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_CALL(pool_, onPoolReady);
+  clients_.back()->onEvent(Network::ConnectionEvent::Connected);
+
+  // The forecast asks for a preconnected connection, but the circuit breaker only allows the one
+  // the next stream waits for, so no demand preconnect is counted.
+  EXPECT_CALL(pool_, instantiateActiveClient);
+  AttachContext second_context;
+  EXPECT_NE(nullptr, pool_.newStreamImpl(second_context, /*can_send_early_data=*/false));
+  ASSERT_EQ(2, clients_.size());
+  EXPECT_EQ(1U, cluster_->trafficStats()->upstream_cx_overflow_.value());
+  EXPECT_EQ(0U, cluster_->trafficStats()->upstream_cx_preconnect_demand_.value());
+
+  EXPECT_CALL(pool_, onPoolFailure).Times(AnyNumber());
+  pool_.destructAllConnections();
+}
+
+TEST_F(ConnPoolImplDispatcherBaseTest, WarmConnections) {
+  ON_CALL(*cluster_, warmConnections).WillByDefault(Return(2));
+
+  // The first stream waits for its own connection, and two warm connections are opened with it.
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(3);
+  EXPECT_NE(nullptr, pool_.newStreamImpl(context_, /*can_send_early_data=*/false));
+  ASSERT_EQ(3, clients_.size());
+  EXPECT_EQ(1U, cluster_->trafficStats()->upstream_rq_preconnect_miss_.value());
+  EXPECT_EQ(2U, cluster_->trafficStats()->upstream_cx_preconnect_warm_.value());
+
+  EXPECT_CALL(pool_, onPoolReady);
+  for (TestActiveClient* client : clients_) {
+    client->onEvent(Network::ConnectionEvent::Connected);
+  }
+
+  // The next stream takes a warm connection without waiting, and another one is opened to
+  // replace it.
+  AttachContext second_context;
+  EXPECT_CALL(pool_, onPoolReady);
+  EXPECT_CALL(pool_, instantiateActiveClient);
+  EXPECT_EQ(nullptr, pool_.newStreamImpl(second_context, /*can_send_early_data=*/false));
+  ASSERT_EQ(4, clients_.size());
+  EXPECT_EQ(1U, cluster_->trafficStats()->upstream_rq_preconnect_hit_.value());
+  EXPECT_EQ(3U, cluster_->trafficStats()->upstream_cx_preconnect_warm_.value());
+
+  // A closed warm connection is replaced.
+  auto ready = std::find_if(clients_.begin(), clients_.end(), [](TestActiveClient* client) {
+    return client->state() == ActiveClient::State::Ready;
+  });
+  ASSERT_NE(clients_.end(), ready);
+  EXPECT_CALL(pool_, instantiateActiveClient);
+  (*ready)->onEvent(Network::ConnectionEvent::RemoteClose);
+  ASSERT_EQ(5, clients_.size());
+  EXPECT_EQ(4U, cluster_->trafficStats()->upstream_cx_preconnect_warm_.value());
+
+  // Once a connection fails, the warm connections are no longer replenished.
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(0);
+  clients_.back()->onEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(5, clients_.size());
+  EXPECT_EQ(4U, cluster_->trafficStats()->upstream_cx_preconnect_warm_.value());
+
+  EXPECT_CALL(pool_, onPoolFailure).Times(AnyNumber());
+  pool_.destructAllConnections();
+}
+
+TEST_F(ConnPoolImplDispatcherBaseTest, WarmConnectionsNotReplacedOnIdleTimeout) {
+  ON_CALL(*cluster_, warmConnections).WillByDefault(Return(3));
+
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(4);
+  EXPECT_NE(nullptr, pool_.newStreamImpl(context_, /*can_send_early_data=*/false));
+  ASSERT_EQ(4, clients_.size());
+  EXPECT_EQ(3U, cluster_->trafficStats()->upstream_cx_preconnect_warm_.value());
+
+  EXPECT_CALL(pool_, onPoolReady);
+  for (TestActiveClient* client : clients_) {
+    client->onEvent(Network::ConnectionEvent::Connected);
+  }
+
+  // The idle timeout closes the unused warm connections locally, which does not open new ones
+  // while the pool still has the busy connection.
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(0);
+  for (TestActiveClient* client : clients_) {
+    if (client->state() == ActiveClient::State::Ready) {
+      client->close(Network::ConnectionCloseType::NoFlush,
+                    StreamInfo::LocalCloseReasons::get().IdleTimeoutOnConnection);
+    }
+  }
+  EXPECT_EQ(4, clients_.size());
+  EXPECT_EQ(ActiveClient::State::Busy, clients_.front()->state());
+  EXPECT_EQ(3U, cluster_->trafficStats()->upstream_cx_preconnect_warm_.value());
+
+  EXPECT_CALL(pool_, onPoolFailure).Times(AnyNumber());
+  pool_.destructAllConnections();
+}
+
 TEST_F(ConnPoolImplDispatcherBaseTest, MaxConnectionDurationTimerNull) {
   // Force a null max connection duration optional.
   // newActiveClientAndStream() will expect the connection duration timer to remain null.
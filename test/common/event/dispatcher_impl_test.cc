@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <functional>
 
 #include "envoy/common/scope_tracker.h"
@@ -10,6 +11,7 @@
 #include "source/common/common/utility.h"
 #include "source/common/event/deferred_task.h"
 #include "source/common/event/dispatcher_impl.h"
+#include "source/common/event/slow_callback_tracker.h"
 #include "source/common/event/timer_impl.h"
 #include "source/common/network/address_impl.h"
 #include "source/common/stats/isolated_store_impl.h"
@@ -23,6 +25,7 @@
 #include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/match.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -1390,6 +1393,68 @@ TEST(DispatcherWithScaledTimerFactoryTest, CreateScaledTimerWithTimerType) {
   dispatcher->createScaledTimer(ScaledTimerType::UnscaledRealTimerForTest, []() {});
 }
 
+class DispatcherSlowCallbackTest : public testing::Test {
+protected:
+  DispatcherSlowCallbackTest()
+      : api_(Api::createApiForTest(time_system_)),
+        dispatcher_(api_->allocateDispatcher("test_thread")) {
+    SlowCallbackTracker::enable(std::chrono::milliseconds(50));
+  }
+  ~DispatcherSlowCallbackTest() override { SlowCallbackTracker::disable(); }
+
+  // Posts a callback running for the duration, in simulated time.
+  void postCallback(std::chrono::milliseconds duration) {
+    dispatcher_->post([this, duration]() { time_system_.advanceTimeAsyncImpl(duration); });
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+};
+
+TEST_F(DispatcherSlowCallbackTest, RecordsOutermostTrackedObjectOfSlowCallback) {
+  dispatcher_->post([this]() {
+    MessageTrackedObject fast{"fast"};
+    ScopeTrackerScopeState fast_state{&fast, *dispatcher_};
+  });
+  dispatcher_->post([this]() {
+    {
+      // Done before the callback became slow.
+      MessageTrackedObject quick{"quick"};
+      ScopeTrackerScopeState quick_state{&quick, *dispatcher_};
+    }
+    MessageTrackedObject slow{"slow"};
+    ScopeTrackerScopeState slow_state{&slow, *dispatcher_};
+    MessageTrackedObject nested{"nested"};
+    ScopeTrackerScopeState nested_state{&nested, *dispatcher_};
+    time_system_.advanceTimeAsyncImpl(std::chrono::milliseconds(60));
+  });
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+
+  EXPECT_EQ("test_thread 60000us post\nslow\n", SlowCallbackTracker::report());
+}
+
+TEST_F(DispatcherSlowCallbackTest, KeepsSlowestCallbacks) {
+  for (size_t i = 0; i < SlowCallbackTracker::MaxCallbacksPerDispatcher + 2; ++i) {
+    postCallback(std::chrono::milliseconds(50 + i));
+  }
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+
+  const std::string report = SlowCallbackTracker::report();
+  EXPECT_EQ(SlowCallbackTracker::MaxCallbacksPerDispatcher,
+            static_cast<size_t>(std::count(report.begin(), report.end(), '\n')));
+  EXPECT_TRUE(absl::StartsWith(report, "test_thread 61000us post\ntest_thread 60000us post\n"));
+  EXPECT_THAT(report, testing::Not(testing::HasSubstr("51000us")));
+}
+
+TEST_F(DispatcherSlowCallbackTest, NothingRecordedWhileDisabled) {
+  SlowCallbackTracker::disable();
+  postCallback(std::chrono::milliseconds(60));
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+
+  EXPECT_EQ("", SlowCallbackTracker::report());
+}
+
 class DispatcherWithWatchdogTest : public testing::Test {
 protected:
   DispatcherWithWatchdogTest()
@@ -497,6 +497,42 @@ TEST_P(UdpListenerImplTest, UdpListenerRecvMsgError) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+/**
+ * Tests that a read stopped early by an error is still completed, after the datagrams read before
+ * the error and before the error callback.
+ */
+TEST_P(UdpListenerImplTest, UdpListenerRecvMsgErrorCompletesRead) {
+  setup();
+
+  const std::string first("first");
+  client_.write(first, *send_to_addr_);
+
+  EXPECT_CALL(listener_callbacks_, onWriteReady(_));
+  EXPECT_CALL(listener_callbacks_, numPacketsExpectedPerEventLoop()).WillRepeatedly(Return(32u));
+  {
+    testing::InSequence s;
+    EXPECT_CALL(listener_callbacks_, onReadReady());
+    EXPECT_CALL(listener_callbacks_, onData(_)).WillOnce(Invoke([&](const UdpRecvData& data) {
+      EXPECT_EQ(first, data.buffer_->toString());
+    }));
+    EXPECT_CALL(listener_callbacks_, onReadComplete());
+    EXPECT_CALL(listener_callbacks_, onReceiveError(Api::IoError::IoErrorCode::NoSupport))
+        .WillOnce(Invoke([&](Api::IoError::IoErrorCode) { dispatcher_->exit(); }));
+  }
+  // The first read gets the datagram, and the second one fails.
+  Api::OsSysCallsImpl real_os_sys_calls;
+  Api::MockOsSysCalls os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  EXPECT_CALL(os_sys_calls, supportsMmsg()).WillRepeatedly(Return(false));
+  EXPECT_CALL(os_sys_calls, recvmsg(_, _, _))
+      .WillOnce(Invoke([&](os_fd_t socket, msghdr* msg, int flags) {
+        return real_os_sys_calls.recvmsg(socket, msg, flags);
+      }))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, SOCKET_ERROR_NOT_SUP}));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+}
+
 /**
  * Tests UDP listener for sending datagrams to destination.
  *  1. Setup a udp listener and client socket
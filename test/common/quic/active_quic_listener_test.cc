@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 #include "envoy/buffer/buffer.h"
@@ -203,7 +205,10 @@ protected:
     // The state of whether client hellos can be buffered or not is different before and after
     // the first packet processed by the listener. This only matters in tests. Force an event
     // to get it into a consistent state.
-    dispatcher_->post([this]() { quic_listener_->onReadReady(); });
+    dispatcher_->post([this]() {
+      quic_listener_->onReadReady();
+      quic_listener_->onReadComplete();
+    });
 
     // Run until one read has been processed: the fake listener handles loop exit.
     dispatcher_->run(Event::Dispatcher::RunType::Block);
@@ -582,6 +587,43 @@ TEST_P(ActiveQuicListenerTest, ProcessBufferedChlos) {
   readFromClientSockets();
 }
 
+TEST_P(ActiveQuicListenerTest, BatchesPacketsPerConnection) {
+  ON_CALL(listener_config_, listenerScope()).WillByDefault(ReturnRef(*store_.rootScope()));
+  initialize();
+  const uint32_t count = 3;
+  maybeConfigureMocks(count);
+  uint64_t packet_count = 0;
+  uint64_t max_packets_per_connection = 0;
+  for (size_t i = 1; i <= count; ++i) {
+    const uint64_t packets =
+        generateChloPacketsToSend(quic_version_, quic_config_, quic::test::TestConnectionId(i))
+            .size();
+    packet_count += packets;
+    max_packets_per_connection = std::max(max_packets_per_connection, packets);
+    sendCHLO(quic::test::TestConnectionId(i));
+  }
+  // Wait for 1ms so that as many packets as possible are read in the same read event.
+  absl::SleepFor(absl::Milliseconds(1));
+  while (quic_dispatcher_->NumSessions() < count) {
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  const std::vector<uint64_t> per_read =
+      store_.histogramValues("quic.downstream_rx_packets_per_read", false);
+  const std::vector<uint64_t> per_connection =
+      store_.histogramValues("quic.downstream_rx_packets_per_connection_batch", false);
+  EXPECT_EQ(packet_count, std::accumulate(per_read.begin(), per_read.end(), uint64_t(0)));
+  EXPECT_EQ(packet_count,
+            std::accumulate(per_connection.begin(), per_connection.end(), uint64_t(0)));
+  // The packets of different connections are never batched together.
+  EXPECT_GE(per_connection.size(), count);
+  for (uint64_t batch_size : per_connection) {
+    EXPECT_LE(batch_size, max_packets_per_connection);
+  }
+
+  readFromClientSockets();
+}
+
 TEST_P(ActiveQuicListenerTest, QuicProcessingDisabledAndEnabled) {
   initialize();
   maybeConfigureMocks(/* connection_count = */ 2);
@@ -353,6 +353,39 @@ TEST_F(EnvoyQuicServerSessionTest, NewStream) {
   stream->OnStreamHeaderList(/*fin=*/true, headers.uncompressed_header_bytes(), headers);
 }
 
+TEST_F(EnvoyQuicServerSessionTest, DefaultPriorityUpdateNotOverriddenByPriorityHeader) {
+  installReadFilter();
+
+  Http::MockRequestDecoder request_decoder;
+  setupRequestDecoderMock(request_decoder);
+  quic::QuicHeaderList headers;
+  headers.OnHeader(":authority", "www.abc.com");
+  headers.OnHeader(":method", "GET");
+  headers.OnHeader(":path", "/");
+  headers.OnHeader(":scheme", "https");
+  headers.OnHeader("priority", "u=1, i");
+  headers.OnHeaderBlockEnd(/*uncompressed_header_bytes=*/0, /*compressed_header_bytes=*/0);
+  EXPECT_CALL(http_connection_callbacks_, newStream(_, false))
+      .Times(2)
+      .WillRepeatedly(testing::ReturnRef(request_decoder));
+  EXPECT_CALL(request_decoder, accessLogHandlers()).Times(2);
+  EXPECT_CALL(request_decoder, decodeHeaders_(_, /*end_stream=*/true)).Times(2);
+
+  // The PRIORITY_UPDATE frame is received after the stream is created.
+  auto stream = dynamic_cast<EnvoyQuicServerStream*>(envoy_quic_session_.GetOrCreateStream(4u));
+  ASSERT_NE(stream, nullptr);
+  EXPECT_TRUE(envoy_quic_session_.OnPriorityUpdateForRequestStream(4u, quic::HttpStreamPriority()));
+  stream->OnStreamHeaderList(/*fin=*/true, headers.uncompressed_header_bytes(), headers);
+  EXPECT_EQ(quic::QuicStreamPriority(), stream->priority());
+
+  // The PRIORITY_UPDATE frame is buffered until the stream is created.
+  EXPECT_TRUE(envoy_quic_session_.OnPriorityUpdateForRequestStream(8u, quic::HttpStreamPriority()));
+  stream = dynamic_cast<EnvoyQuicServerStream*>(envoy_quic_session_.GetOrCreateStream(8u));
+  ASSERT_NE(stream, nullptr);
+  stream->OnStreamHeaderList(/*fin=*/true, headers.uncompressed_header_bytes(), headers);
+  EXPECT_EQ(quic::QuicStreamPriority(), stream->priority());
+}
+
 TEST_F(EnvoyQuicServerSessionTest, ProtocolStreamId) {
   installReadFilter();
 
@@ -36,6 +36,20 @@ using testing::Invoke;
 
 constexpr unsigned int kStreamId = 4u;
 
+// Records the balance charged by the stream.
+class TestBufferMemoryAccount : public Buffer::BufferMemoryAccount {
+public:
+  void charge(uint64_t amount) override { balance_ += amount; }
+  void credit(uint64_t amount) override {
+    ASSERT_GE(balance_, amount);
+    balance_ -= amount;
+  }
+  void clearDownstream() override {}
+  void resetDownstream() override {}
+
+  uint64_t balance_{0};
+};
+
 } // namespace
 
 class EnvoyQuicServerStreamTest : public testing::Test {
@@ -797,6 +811,59 @@ TEST_F(EnvoyQuicServerStreamTest, HeadersContributeToWatermarkIquic) {
   quic_stream_->encodeTrailers(response_trailers_);
 }
 
+TEST_F(EnvoyQuicServerStreamTest, SendBufferChargedToAccount) {
+  receiveRequest(request_body_, true, request_body_.size() * 2);
+  auto account = std::make_shared<TestBufferMemoryAccount>();
+  quic_stream_->setAccount(account);
+
+  // Make the stream blocked by congestion control so that the response stays buffered.
+  EXPECT_CALL(quic_session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(
+          Invoke([](quic::QuicStreamId, size_t, quic::QuicStreamOffset,
+                    quic::StreamSendingState state, bool, std::optional<quic::EncryptionLevel>) {
+            return quic::QuicConsumedData{0u, state != quic::NO_FIN};
+          }));
+  quic_stream_->encodeHeaders(response_headers_, /*end_stream=*/false);
+  std::string response(1024, 'a');
+  Buffer::OwnedImpl buffer(response);
+  quic_stream_->encodeData(buffer, false);
+  EXPECT_LT(1024u, account->balance_);
+  EXPECT_EQ(quic_stream_->BufferedDataBytes(), account->balance_);
+
+  // The buffered bytes move over to a new account.
+  auto other_account = std::make_shared<TestBufferMemoryAccount>();
+  quic_stream_->setAccount(other_account);
+  EXPECT_EQ(0u, account->balance_);
+  EXPECT_EQ(quic_stream_->BufferedDataBytes(), other_account->balance_);
+
+  // Writing the buffered data out credits the account.
+  EXPECT_CALL(quic_session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(
+          Invoke([](quic::QuicStreamId, size_t write_length, quic::QuicStreamOffset,
+                    quic::StreamSendingState state, bool, std::optional<quic::EncryptionLevel>) {
+            return quic::QuicConsumedData{write_length, state != quic::NO_FIN};
+          }));
+  quic_session_.OnCanWrite();
+  EXPECT_EQ(0u, quic_stream_->BufferedDataBytes());
+  EXPECT_EQ(0u, other_account->balance_);
+
+  // The stream is left open; TearDown closes the connection, which resets it.
+  EXPECT_CALL(stream_callbacks_, onResetStream(_, _));
+}
+
+TEST_F(EnvoyQuicServerStreamTest, PriorityHeaderSetsStreamPriority) {
+  spdy_request_headers_["priority"] = "u=1, i";
+  receiveRequest(request_body_, true, request_body_.size() * 2);
+  EXPECT_EQ(1, quic_stream_->priority().http().urgency);
+  EXPECT_TRUE(quic_stream_->priority().http().incremental);
+}
+
+TEST_F(EnvoyQuicServerStreamTest, InvalidPriorityHeaderIgnored) {
+  spdy_request_headers_["priority"] = "u=";
+  receiveRequest(request_body_, true, request_body_.size() * 2);
+  EXPECT_EQ(quic::QuicStreamPriority(), quic_stream_->priority());
+}
+
 TEST_F(EnvoyQuicServerStreamTest, RequestHeaderTooLarge) {
   // Bump stream flow control window to allow request headers larger than 16K.
   quic::QuicWindowUpdateFrame window_update1(quic::kInvalidControlFrameId, quic_stream_->id(),
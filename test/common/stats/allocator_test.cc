@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <string>
@@ -87,6 +88,149 @@ TEST_F(AllocatorTest, GaugesWithSameName) {
   EXPECT_EQ(0, g2->value());
 }
 
+// Accepts only the given stat names.
+class TestShardedCounterMatcher : public StatsMatcher {
+public:
+  explicit TestShardedCounterMatcher(std::vector<StatName> names) : names_(std::move(names)) {}
+
+  bool rejects(StatName name) const override {
+    return std::find(names_.begin(), names_.end(), name) == names_.end();
+  }
+  FastResult fastRejects(StatName) const override { return FastResult::NoMatch; }
+  bool slowRejects(FastResult, StatName name) const override { return rejects(name); }
+  bool acceptsAll() const override { return false; }
+  bool rejectsAll() const override { return false; }
+
+private:
+  const std::vector<StatName> names_;
+};
+
+// Sharded counters behave like regular counters from a single thread.
+TEST_F(AllocatorTest, ShardedCounter) {
+  StatName sharded_name = makeStat("sharded.counter");
+  StatName regular_name = makeStat("regular.counter");
+  alloc_.setShardedCounterMatcher(
+      std::make_unique<TestShardedCounterMatcher>(std::vector<StatName>{sharded_name}));
+
+  for (StatName name : {sharded_name, regular_name}) {
+    CounterSharedPtr counter = alloc_.makeCounter(name, StatName(), {});
+    EXPECT_EQ(counter.get(), alloc_.makeCounter(name, StatName(), {}).get());
+    EXPECT_FALSE(counter->used());
+    EXPECT_EQ(0, counter->value());
+
+    counter->add(0);
+    EXPECT_TRUE(counter->used());
+    counter->markUnused();
+    EXPECT_FALSE(counter->used());
+
+    counter->inc();
+    counter->add(4);
+    EXPECT_TRUE(counter->used());
+    EXPECT_EQ(5, counter->value());
+    EXPECT_EQ(5, counter->latch());
+    EXPECT_EQ(0, counter->latch());
+    EXPECT_EQ(5, counter->value());
+
+    counter->markUnused();
+    EXPECT_FALSE(counter->used());
+    counter->add(2);
+    EXPECT_TRUE(counter->used());
+
+    counter->reset();
+    EXPECT_EQ(0, counter->value());
+    counter->inc();
+    EXPECT_EQ(1, counter->value());
+    // Only a regular counter keeps the increments made before the reset pending.
+    EXPECT_EQ(name == sharded_name ? 1 : 3, counter->latch());
+  }
+}
+
+// A reset of a sharded counter also drops the pending latch, so that the latched deltas add up to
+// the value.
+TEST_F(AllocatorTest, ShardedCounterResetThenLatch) {
+  StatName counter_name = makeStat("sharded.counter");
+  alloc_.setShardedCounterMatcher(
+      std::make_unique<TestShardedCounterMatcher>(std::vector<StatName>{counter_name}));
+  CounterSharedPtr counter = alloc_.makeCounter(counter_name, StatName(), {});
+
+  counter->add(5);
+  counter->reset();
+  EXPECT_EQ(0, counter->latch());
+  counter->add(3);
+  EXPECT_EQ(3, counter->latch());
+  EXPECT_EQ(3, counter->value());
+
+  // Increments latched before the reset are not latched again.
+  counter->add(2);
+  EXPECT_EQ(2, counter->latch());
+  counter->reset();
+  counter->inc();
+  EXPECT_EQ(1, counter->latch());
+  EXPECT_EQ(1, counter->value());
+}
+
+// The sharded counter matcher runs without holding the allocator lock, since it may evaluate
+// regexes.
+TEST_F(AllocatorTest, ShardedCounterMatcherRunsUnlocked) {
+  class LockCheckingMatcher : public TestShardedCounterMatcher {
+  public:
+    LockCheckingMatcher(std::vector<StatName> names, Allocator& alloc)
+        : TestShardedCounterMatcher(std::move(names)), alloc_(alloc) {}
+
+    bool rejects(StatName name) const override {
+      EXPECT_FALSE(alloc_.isMutexLockedForTest());
+      ++calls_;
+      return TestShardedCounterMatcher::rejects(name);
+    }
+
+    Allocator& alloc_;
+    mutable uint32_t calls_{};
+  };
+  StatName counter_name = makeStat("sharded.counter");
+  auto matcher =
+      std::make_unique<LockCheckingMatcher>(std::vector<StatName>{counter_name}, alloc_);
+  LockCheckingMatcher& matcher_ref = *matcher;
+  alloc_.setShardedCounterMatcher(std::move(matcher));
+
+  CounterSharedPtr counter = alloc_.makeCounter(counter_name, StatName(), {});
+  EXPECT_EQ(1, matcher_ref.calls_);
+  // Looking up an existing counter doesn't run the matcher.
+  EXPECT_EQ(counter.get(), alloc_.makeCounter(counter_name, StatName(), {}).get());
+  EXPECT_EQ(1, matcher_ref.calls_);
+}
+
+// Concurrent increments of a sharded counter from several threads are all accounted.
+TEST_F(AllocatorTest, ShardedCounterConcurrentIncrements) {
+  StatName counter_name = makeStat("sharded.counter");
+  alloc_.setShardedCounterMatcher(
+      std::make_unique<TestShardedCounterMatcher>(std::vector<StatName>{counter_name}));
+  CounterSharedPtr counter = alloc_.makeCounter(counter_name, StatName(), {});
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+
+  const uint32_t num_threads = 12;
+  const uint32_t iters = 10000;
+  std::vector<Thread::ThreadPtr> threads;
+  absl::Notification go;
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([&]() {
+      go.WaitForNotification();
+      for (uint32_t i = 0; i < iters; ++i) {
+        counter->inc();
+        counter->add(2);
+      }
+    }));
+  }
+  go.Notify();
+  uint64_t latched = 0;
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    latched += counter->latch();
+    threads[i]->join();
+  }
+  latched += counter->latch();
+  EXPECT_EQ(3 * num_threads * iters, counter->value());
+  EXPECT_EQ(3 * num_threads * iters, latched);
+}
+
 // Test for a race-condition where we may decrement the ref-count of a stat to
 // zero at the same time as we are allocating another instance of that
 // stat. This test reproduces that race organically by having a 12 threads each
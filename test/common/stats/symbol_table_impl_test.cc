@@ -328,7 +328,6 @@ TEST_F(StatNameTest, TestSuccessfulDecode) {
 class StatNameDeathTest : public StatNameTest {
 public:
   void decodeSymbolVec(const SymbolVec& symbol_vec) {
-    Thread::LockGuard lock(table_.lock_);
     for (Symbol symbol : symbol_vec) {
       table_.fromSymbol(symbol);
     }
@@ -756,6 +755,38 @@ TEST_F(StatNameTest, MutexContentionOnExistingSymbols) {
   }
 }
 
+// Races the last references of symbols being dropped against the same strings
+// being encoded again and against lock-free decodes, which must all see
+// consistent strings and reference counts.
+TEST_F(StatNameTest, RacingDecodeAndFree) {
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+  StatNameManagedStorage shared("shared.prefix", table_);
+
+  constexpr int num_threads = 8;
+  std::vector<Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  ConditionalInitializer start;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([this, i, &start, &shared]() {
+      start.wait();
+      for (int count = 0; count < 1000; ++count) {
+        // Neighbouring threads share half of their names.
+        const std::string name =
+            absl::StrCat("shared.prefix.t", (i + count % 2) / 2, ".", count % 4);
+        StatNameManagedStorage storage(name, table_);
+        EXPECT_EQ(name, table_.toString(storage.statName()));
+        EXPECT_EQ("shared.prefix", table_.toString(shared.statName()));
+      }
+    }));
+  }
+  start.setReady();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  EXPECT_EQ(2, table_.numSymbols());
+}
+
 TEST_F(StatNameTest, SharedStatNameStorageSetInsertAndFind) {
   StatNameStorageSet set;
   const int iters = 10;
@@ -15,6 +15,7 @@
 #include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "benchmark/benchmark.h"
 
@@ -65,6 +66,72 @@ static void bmCreateRace(benchmark::State& state) {
 }
 BENCHMARK(bmCreateRace)->Unit(::benchmark::kMillisecond);
 
+// Runs body(thread_index) on the given number of threads, released together, and waits for them.
+template <class Body> static void runThreads(int num_threads, Body body) {
+  Envoy::Thread::ThreadFactory& thread_factory = Envoy::Thread::threadFactoryForTest();
+  std::vector<Envoy::Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  Envoy::ConditionalInitializer start;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([&start, &body, i]() {
+      start.wait();
+      body(i);
+    }));
+  }
+  start.setReady();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+}
+
+// Decodes existing names from many threads at once, as sinks and admin do while workers run.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmToStringRace(benchmark::State& state) {
+  const int num_threads = state.range(0);
+  Envoy::Stats::SymbolTableImpl table;
+  Envoy::Stats::StatNameStorage name("cluster.service_a.upstream_rq_2xx", table);
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    runThreads(num_threads, [&table, &name](int) {
+      for (int count = 0; count < 10000; ++count) {
+        benchmark::DoNotOptimize(table.toString(name.statName()));
+      }
+    });
+  }
+  name.free(table);
+}
+BENCHMARK(bmToStringRace)->Arg(1)->Arg(4)->Arg(16)->Unit(::benchmark::kMillisecond);
+
+// Encodes and frees names whose symbols already exist from many threads at once, as dynamic
+// stat-name creation on workers does. Threads use names with different tokens, which are spread
+// over the encode shards.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmEncodeExistingRace(benchmark::State& state) {
+  const int num_threads = state.range(0);
+  Envoy::Stats::SymbolTableImpl table;
+  std::vector<std::string> names;
+  std::vector<Envoy::Stats::StatNameStorage> initial;
+  names.reserve(num_threads);
+  initial.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    names.push_back(absl::StrCat("cluster.service_", i, ".route_", i, ".upstream_rq_total"));
+    initial.emplace_back(names.back(), table);
+  }
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    runThreads(num_threads, [&table, &names](int i) {
+      for (int count = 0; count < 1000; ++count) {
+        Envoy::Stats::StatNameStorage storage(names[i], table);
+        storage.free(table);
+      }
+    });
+  }
+  for (auto& storage : initial) {
+    storage.free(table);
+  }
+}
+BENCHMARK(bmEncodeExistingRace)->Arg(1)->Arg(4)->Arg(16)->Unit(::benchmark::kMillisecond);
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void bmJoinStatNames(benchmark::State& state) {
   Envoy::Stats::SymbolTableImpl symbol_table;
@@ -108,6 +108,32 @@ void BM_ExtractTags(benchmark::State& state) {
 }
 BENCHMARK(BM_ExtractTags)->DenseRange(0, 26, 1);
 
+// Produces the tags of a mix of names, as when a large number of stats is created, e.g. on a
+// cluster update. Most names hit several token extractors, which share a single match per name.
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_ExtractTagsManyNames(benchmark::State& state) {
+  const Stats::TagVector tags;
+  auto tag_extractors =
+      TagProducerImpl::createTagProducer(envoy::config::metrics::v3::StatsConfig(), tags).value();
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < 100; ++i) {
+    names.push_back(absl::StrCat("cluster.cluster_", i, ".upstream_rq_2xx"));
+    names.push_back(absl::StrCat("cluster.cluster_", i, ".grpc.service.method_", i, ".success"));
+    names.push_back(absl::StrCat("http.ingress_", i, ".rds.route_", i, ".update_success"));
+    names.push_back(absl::StrCat("listener.10.0.0.", i, "_443.downstream_cx_total"));
+    names.push_back(absl::StrCat("vhost.vhost_", i, ".vcluster.other.upstream_rq_200"));
+  }
+
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    for (const std::string& name : names) {
+      TagVector tags;
+      benchmark::DoNotOptimize(tag_extractors->produceTags(name, tags));
+    }
+  }
+}
+BENCHMARK(BM_ExtractTagsManyNames);
+
 } // namespace
 } // namespace Stats
 } // namespace Envoy
@@ -9,6 +9,7 @@
 
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_split.h"
 #include "gtest/gtest.h"
 
 using ::testing::ElementsAre;
@@ -611,6 +612,20 @@ protected:
     } else {
       tag_extracted_name_.clear();
     }
+
+    // Extracting through a matcher must give the same result as the backtracking search.
+    TagExtractorTokensMatcher matcher;
+    tokens.addToMatcher(matcher);
+    IntervalSetImpl<size_t> matcher_remove_characters;
+    std::vector<Tag> matcher_tags;
+    TagExtractionContext matcher_context(stat_name, &matcher);
+    EXPECT_EQ(extracted,
+              tokens.extractTag(matcher_context, matcher_tags, matcher_remove_characters));
+    EXPECT_EQ(tags_, matcher_tags);
+    if (extracted) {
+      EXPECT_EQ(tag_extracted_name_,
+                StringUtil::removeCharacters(stat_name, matcher_remove_characters));
+    }
     return extracted;
   }
 
@@ -708,5 +723,41 @@ TEST_F(TagExtractorTokensTest, TokensMismatchPatternTooLong) {
   EXPECT_FALSE(extract("article", "now.$.the.time.to", "now.is.the.time"));
 }
 
+// All the patterns of a matcher are matched in one pass, each capturing the token its own
+// backtracking search would.
+TEST(TagExtractorTokensMatcherTest, MultiplePatterns) {
+  TagExtractorTokensMatcher matcher;
+  const auto add = [&matcher](absl::string_view pattern) {
+    const std::vector<std::string> tokens = absl::StrSplit(pattern, '.');
+    uint32_t match_index = 0;
+    while (tokens[match_index] != "$") {
+      ++match_index;
+    }
+    return matcher.addPattern(tokens, match_index);
+  };
+  const uint32_t first = add("a.$.**");
+  const uint32_t wild = add("*.$.c");
+  const uint32_t late = add("a.**.b.$");
+  const uint32_t other_prefix = add("x.$");
+  const uint32_t ends_early = add("a.$");
+  EXPECT_EQ(5, matcher.numPatterns());
+
+  const std::vector<absl::string_view> tokens = {"a", "b", "b", "c", "b", "d"};
+  std::vector<uint32_t> matches;
+  matcher.match(tokens, matches);
+  ASSERT_EQ(5, matches.size());
+  EXPECT_EQ(1, matches[first]);
+  EXPECT_EQ(TagExtractorTokensMatcher::NoMatch, matches[wild]);
+  EXPECT_EQ(5, matches[late]);
+  EXPECT_EQ(TagExtractorTokensMatcher::NoMatch, matches[other_prefix]);
+  EXPECT_EQ(TagExtractorTokensMatcher::NoMatch, matches[ends_early]);
+
+  matcher.match({"x", "b", "c"}, matches);
+  EXPECT_EQ(TagExtractorTokensMatcher::NoMatch, matches[first]);
+  EXPECT_EQ(1, matches[wild]);
+  EXPECT_EQ(TagExtractorTokensMatcher::NoMatch, matches[late]);
+  EXPECT_EQ(TagExtractorTokensMatcher::NoMatch, matches[other_prefix]);
+}
+
 } // namespace Stats
 } // namespace Envoy
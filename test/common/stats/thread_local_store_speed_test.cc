@@ -18,6 +18,7 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "benchmark/benchmark.h"
 
 namespace Envoy {
@@ -65,6 +66,35 @@ public:
     store_.initializeThreading(*dispatcher_, *tls_);
   }
 
+  void initHistograms(uint32_t num_histograms) {
+    Stats::Scope& scope = *store_.rootScope();
+    for (uint32_t i = 0; i < num_histograms; ++i) {
+      histograms_.push_back(&scope.histogramFromString(absl::StrCat("histogram.", i),
+                                                       Stats::Histogram::Unit::Unspecified));
+    }
+  }
+
+  void setHistogramMergeThreads(uint32_t num_threads) {
+    store_.setHistogramMergeThreads(num_threads, api_->threadFactory());
+  }
+
+  // Records a few values in one histogram out of every `stride`.
+  void recordHistogramValues(uint32_t stride) {
+    for (uint32_t i = 0; i < histograms_.size(); i += stride) {
+      for (uint64_t value = 1; value <= 1000; value *= 3) {
+        histograms_[i]->recordValue(value + i);
+      }
+    }
+  }
+
+  void mergeHistograms() {
+    bool merged = false;
+    store_.mergeHistograms([&merged]() { merged = true; });
+    while (!merged) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
   void initPrefixRejections(const std::string& prefix) {
     stats_config_.mutable_stats_matcher()->mutable_exclusion_list()->add_patterns()->set_prefix(
         prefix);
@@ -83,6 +113,7 @@ private:
   Api::ApiPtr api_;
   envoy::config::metrics::v3::StatsConfig stats_config_;
   std::vector<std::unique_ptr<Stats::StatNameManagedStorage>> stat_names_;
+  std::vector<Stats::Histogram*> histograms_;
 };
 
 } // namespace Envoy
@@ -137,5 +168,26 @@ static void BM_StatsWithTlsAndRejectionsWithoutDot(benchmark::State& state) {
 }
 BENCHMARK(BM_StatsWithTlsAndRejectionsWithoutDot);
 
+// Tests merging the histograms at a stats flush. Arguments are the number of histograms, the
+// number of merge threads, and the stride of the histograms that recorded values in the interval.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_HistogramMerge(benchmark::State& state) {
+  Envoy::ThreadLocalStorePerf context;
+  context.initThreading();
+  context.initHistograms(state.range(0));
+  context.setHistogramMergeThreads(state.range(1));
+  const uint32_t stride = state.range(2);
+
+  for (auto _ : state) { // NOLINT
+    state.PauseTiming();
+    context.recordHistogramValues(stride);
+    state.ResumeTiming();
+    context.mergeHistograms();
+  }
+}
+BENCHMARK(BM_HistogramMerge)
+    ->ArgsProduct({{1000, 10000}, {1, 4}, {1, 10}})
+    ->Unit(benchmark::kMillisecond);
+
 // TODO(jmarantz): add multi-threaded variant of this test, that aggressively
 // looks up stats in multiple threads to try to trigger contention issues.
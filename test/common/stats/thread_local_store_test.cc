@@ -27,6 +27,7 @@
 #include "test/mocks/stats/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/logging.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "absl/strings/str_split.h"
@@ -2213,6 +2214,41 @@ TEST_F(HistogramTest, BasicHistogramMergeSummary) {
             name_histogram_map["h1"]->cumulativeStatistics().bucketSummary());
 }
 
+// With enough histograms, the merge is spread over several threads.
+TEST_F(HistogramTest, MultiThreadedMerge) {
+  store_->setHistogramMergeThreads(4, Thread::threadFactoryForTest());
+  constexpr size_t num_histograms = 2048;
+  std::vector<Histogram*> histograms;
+  for (size_t i = 0; i < num_histograms; ++i) {
+    histograms.push_back(
+        &scope_.histogramFromString(absl::StrCat("h", i), Histogram::Unit::Unspecified));
+  }
+  EXPECT_CALL(sink_, onHistogramComplete(_, _)).Times(num_histograms + num_histograms / 2);
+  for (size_t i = 0; i < num_histograms; ++i) {
+    histograms[i]->recordValue(i);
+    if (i % 2 == 0) {
+      histograms[i]->recordValue(i + 1);
+    }
+  }
+
+  store_->mergeHistograms([]() -> void {});
+  for (size_t i = 0; i < num_histograms; ++i) {
+    const auto& histogram = dynamic_cast<const ParentHistogram&>(*histograms[i]);
+    const uint64_t expected_count = i % 2 == 0 ? 2 : 1;
+    EXPECT_TRUE(histogram.used());
+    EXPECT_EQ(expected_count, histogram.intervalStatistics().sampleCount());
+    EXPECT_EQ(expected_count, histogram.cumulativeStatistics().sampleCount());
+  }
+
+  // Nothing was recorded in the second interval.
+  store_->mergeHistograms([]() -> void {});
+  for (size_t i = 0; i < num_histograms; ++i) {
+    const auto& histogram = dynamic_cast<const ParentHistogram&>(*histograms[i]);
+    EXPECT_EQ(0, histogram.intervalStatistics().sampleCount());
+    EXPECT_EQ(i % 2 == 0 ? 2 : 1, histogram.cumulativeStatistics().sampleCount());
+  }
+}
+
 TEST_F(HistogramTest, BasicHistogramUsed) {
   ScopeSharedPtr scope1 = store_->createScope("scope1.");
 
@@ -1163,6 +1163,91 @@ TEST(DefaultCertValidatorTest, SharesCrlAcrossContexts) {
   EXPECT_EQ(getCrlCache(context.singletonManager())->size(), 2);
 }
 
+// Validators configured with the same CA bundle install one shared store in all
+// their SSL_CTXs instead of parsing the bundle into a store per SSL_CTX.
+TEST(DefaultCertValidatorTest, SharesTrustedCaStoreAcrossContexts) {
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+  Stats::TestUtil::TestStore store;
+  SslStats stats = generateSslStats(*store.rootScope());
+
+  const std::string ca_cert = TestEnvironment::readFileToStringForTest(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/tls/test_data/ca_cert.pem"));
+  auto config1 = makeSuppressConfig(ca_cert, false);
+  auto config2 = makeSuppressConfig(ca_cert, false);
+  DefaultCertValidator validator1(config1.get(), stats, context);
+  DefaultCertValidator validator2(config2.get(), stats, context);
+
+  bssl::UniquePtr<SSL_CTX> ssl_ctx1(SSL_CTX_new(TLS_method()));
+  bssl::UniquePtr<SSL_CTX> ssl_ctx2(SSL_CTX_new(TLS_method()));
+  bssl::UniquePtr<SSL_CTX> ssl_ctx3(SSL_CTX_new(TLS_method()));
+  std::vector<SSL_CTX*> contexts1 = {ssl_ctx1.get(), ssl_ctx2.get()};
+  std::vector<SSL_CTX*> contexts2 = {ssl_ctx3.get()};
+  ASSERT_OK(validator1.initializeSslContexts(contexts1, false, *store.rootScope()));
+  ASSERT_OK(validator2.initializeSslContexts(contexts2, false, *store.rootScope()));
+
+  X509_STORE* shared_store = SSL_CTX_get_cert_store(ssl_ctx1.get());
+  EXPECT_EQ(SSL_CTX_get_cert_store(ssl_ctx2.get()), shared_store);
+  EXPECT_EQ(SSL_CTX_get_cert_store(ssl_ctx3.get()), shared_store);
+  EXPECT_EQ(getTrustedCaStoreCache(context.singletonManager())->size(), 1);
+  EXPECT_NE(validator1.getCaCertInformation(), nullptr);
+
+  // A different CA bundle gets a store of its own.
+  const std::string other_ca_cert = TestEnvironment::readFileToStringForTest(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/tls/test_data/fake_ca_cert.pem"));
+  auto config3 = makeSuppressConfig(other_ca_cert, false);
+  DefaultCertValidator validator3(config3.get(), stats, context);
+  bssl::UniquePtr<SSL_CTX> ssl_ctx4(SSL_CTX_new(TLS_method()));
+  std::vector<SSL_CTX*> contexts3 = {ssl_ctx4.get()};
+  ASSERT_OK(validator3.initializeSslContexts(contexts3, false, *store.rootScope()));
+  EXPECT_NE(SSL_CTX_get_cert_store(ssl_ctx4.get()), shared_store);
+  EXPECT_EQ(getTrustedCaStoreCache(context.singletonManager())->size(), 2);
+}
+
+// Options that change the store flags are part of the key, so a context that
+// allows expired certificates does not share the store of one that does not.
+TEST(TrustedCaStoreCacheTest, SeparatesDistinctOptions) {
+  auto cache = std::make_shared<TrustedCaStoreCache>();
+  const std::string ca_cert = TestEnvironment::readFileToStringForTest(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/tls/test_data/ca_cert.pem"));
+  envoy::config::core::v3::TypedExtensionConfig typed_conf;
+  TestCertificateValidationContextConfig config(typed_conf, /*allow_expired_certificate=*/false,
+                                                {}, ca_cert);
+  TestCertificateValidationContextConfig expired_config(
+      typed_conf, /*allow_expired_certificate=*/true, {}, ca_cert);
+
+  absl::StatusOr<TrustedCaStoreSharedPtr> first = cache->getOrCreate(config, nullptr);
+  ASSERT_OK(first);
+  absl::StatusOr<TrustedCaStoreSharedPtr> second = cache->getOrCreate(config, nullptr);
+  ASSERT_OK(second);
+  absl::StatusOr<TrustedCaStoreSharedPtr> expired = cache->getOrCreate(expired_config, nullptr);
+  ASSERT_OK(expired);
+
+  EXPECT_EQ(first->get(), second->get());
+  EXPECT_NE(first->get(), expired->get());
+  EXPECT_EQ(cache->size(), 2);
+  const X509_VERIFY_PARAM* param = X509_STORE_get0_param((*expired)->store.get());
+  EXPECT_NE(X509_VERIFY_PARAM_get_flags(param) & X509_V_FLAG_NO_CHECK_TIME, 0);
+
+  // Entries are released with their last reference.
+  first->reset();
+  second->reset();
+  EXPECT_EQ(cache->size(), 1);
+}
+
+// A bundle without any certificate is rejected and not cached.
+TEST(TrustedCaStoreCacheTest, ReturnsErrorForBundleWithoutCertificate) {
+  auto cache = std::make_shared<TrustedCaStoreCache>();
+  const std::string crl_only = TestEnvironment::readFileToStringForTest(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/tls/test_data/ca_cert.crl"));
+  envoy::config::core::v3::TypedExtensionConfig typed_conf;
+  TestCertificateValidationContextConfig config(typed_conf, false, {}, crl_only);
+
+  absl::StatusOr<TrustedCaStoreSharedPtr> result = cache->getOrCreate(config, nullptr);
+  EXPECT_THAT(result, HasStatusMessage(testing::HasSubstr(
+                          "Failed to load trusted CA certificates from TEST_CA_CERT_PATH")));
+  EXPECT_EQ(cache->size(), 0);
+}
+
 } // namespace Tls
 } // namespace TransportSockets
 } // namespace Extensions
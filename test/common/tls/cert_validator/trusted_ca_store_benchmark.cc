@@ -0,0 +1,131 @@
+// Measures the cost of installing the trusted CA bundle of many TLS contexts, as done at startup
+// and on each listener update, with and without the shared stores of TrustedCaStoreCache.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/common/common/assert.h"
+#include "source/common/tls/cert_validator/default_validator.h"
+
+#include "test/common/tls/cert_validator/test_common.h"
+#include "test/test_common/environment.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "openssl/pem.h"
+#include "openssl/ssl.h"
+#include "tools/cpp/runfiles/runfiles.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+// A bundle of about a hundred certificates, the size of a public root store, made of copies of
+// the test CAs.
+const std::string& caBundle() {
+  static const std::string* bundle = [] {
+    std::string error;
+    static std::unique_ptr<bazel::tools::cpp::runfiles::Runfiles> runfiles(
+        bazel::tools::cpp::runfiles::Runfiles::Create("trusted_ca_store_benchmark",
+                                                      BAZEL_CURRENT_REPOSITORY, &error));
+    TestEnvironment::setRunfiles(runfiles.get());
+    std::string pems;
+    for (const char* file : {"ca_cert.pem", "intermediate_ca_cert.pem", "fake_ca_cert.pem"}) {
+      pems += TestEnvironment::readFileToStringForTest(
+          TestEnvironment::runfilesPath(absl::StrCat("test/common/tls/test_data/", file)));
+    }
+    auto* result = new std::string();
+    for (int i = 0; i < 32; ++i) {
+      absl::StrAppend(result, pems);
+    }
+    return result;
+  }();
+  return *bundle;
+}
+
+std::vector<bssl::UniquePtr<SSL_CTX>> makeContexts(int64_t count) {
+  std::vector<bssl::UniquePtr<SSL_CTX>> contexts;
+  contexts.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    contexts.emplace_back(SSL_CTX_new(TLS_method()));
+  }
+  return contexts;
+}
+
+// Baseline: every SSL_CTX parses the bundle into a store of its own.
+void bmStorePerContext(benchmark::State& state) {
+  const std::string& bundle = caBundle();
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<bssl::UniquePtr<SSL_CTX>> contexts = makeContexts(state.range(0));
+    state.ResumeTiming();
+    for (const auto& ctx : contexts) {
+      bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(bundle.data(), bundle.size()));
+      bssl::UniquePtr<STACK_OF(X509_INFO)> list(
+          PEM_X509_INFO_read_bio(bio.get(), nullptr, nullptr, nullptr));
+      RELEASE_ASSERT(list != nullptr, "");
+      X509_STORE* store = SSL_CTX_get_cert_store(ctx.get());
+      X509_STORE_set_flags(store, X509_V_FLAG_PARTIAL_CHAIN);
+      for (const X509_INFO* item : list.get()) {
+        if (item->x509) {
+          X509_STORE_add_cert(store, item->x509);
+        }
+      }
+    }
+  }
+}
+BENCHMARK(bmStorePerContext)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+// Startup: the first context builds the shared store and the others reference it.
+void bmSharedStoreStartup(benchmark::State& state) {
+  envoy::config::core::v3::TypedExtensionConfig typed_conf;
+  TestCertificateValidationContextConfig config(typed_conf, false, {}, caBundle());
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<bssl::UniquePtr<SSL_CTX>> contexts = makeContexts(state.range(0));
+    auto cache = std::make_shared<TrustedCaStoreCache>();
+    std::vector<TrustedCaStoreSharedPtr> stores;
+    state.ResumeTiming();
+    for (const auto& ctx : contexts) {
+      absl::StatusOr<TrustedCaStoreSharedPtr> store = cache->getOrCreate(config, nullptr);
+      RELEASE_ASSERT(store.ok(), "");
+      X509_STORE_up_ref((*store)->store.get());
+      SSL_CTX_set_cert_store(ctx.get(), (*store)->store.get());
+      stores.push_back(std::move(*store));
+    }
+  }
+}
+BENCHMARK(bmSharedStoreStartup)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+// Update: the contexts of the previous listener version still hold the store while the new ones
+// are built, so every lookup hits.
+void bmSharedStoreUpdate(benchmark::State& state) {
+  envoy::config::core::v3::TypedExtensionConfig typed_conf;
+  TestCertificateValidationContextConfig config(typed_conf, false, {}, caBundle());
+  auto cache = std::make_shared<TrustedCaStoreCache>();
+  absl::StatusOr<TrustedCaStoreSharedPtr> previous = cache->getOrCreate(config, nullptr);
+  RELEASE_ASSERT(previous.ok(), "");
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<bssl::UniquePtr<SSL_CTX>> contexts = makeContexts(state.range(0));
+    std::vector<TrustedCaStoreSharedPtr> stores;
+    state.ResumeTiming();
+    for (const auto& ctx : contexts) {
+      absl::StatusOr<TrustedCaStoreSharedPtr> store = cache->getOrCreate(config, nullptr);
+      RELEASE_ASSERT(store.ok(), "");
+      X509_STORE_up_ref((*store)->store.get());
+      SSL_CTX_set_cert_store(ctx.get(), (*store)->store.get());
+      stores.push_back(std::move(*store));
+    }
+  }
+}
+BENCHMARK(bmSharedStoreUpdate)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
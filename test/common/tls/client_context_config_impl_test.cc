@@ -78,6 +78,21 @@ TEST_F(ClientContextConfigImplTest, EmptyServerNameIndication) {
             "SNI names containing NULL-byte are not allowed");
 }
 
+// Validate that kernel TLS offload cannot be combined with renegotiation, which would need
+// BoringSSL to write records once the kernel encrypts them.
+TEST_F(ClientContextConfigImplTest, KernelTlsOffloadWithRenegotiation) {
+  envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context;
+
+  tls_context.mutable_common_tls_context()->set_kernel_tls_offload(true);
+  auto client_context_config = *ClientContextConfigImpl::create(tls_context, factory_context);
+  EXPECT_TRUE(client_context_config->kernelTlsOffload());
+
+  tls_context.set_allow_renegotiation(true);
+  EXPECT_EQ(ClientContextConfigImpl::create(tls_context, factory_context).status().message(),
+            "'kernel_tls_offload' cannot be combined with 'allow_renegotiation'");
+}
+
 // Validate that it is an error configure `auto_sni_san_validation` without configuring
 // a validation context.
 TEST_F(ClientContextConfigImplTest, AutoSniSanValidationWithoutValidationContext) {
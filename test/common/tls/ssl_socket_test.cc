@@ -1,4 +1,5 @@
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
@@ -27,6 +28,7 @@
 #include "source/common/tls/private_key/private_key_manager_impl.h"
 #include "source/common/tls/server_context_config_impl.h"
 #include "source/common/tls/server_ssl_socket.h"
+#include "source/common/tls/session_store.h"
 
 #include "test/common/tls/cert_validator/timed_cert_validator.h"
 #include "test/common/tls/ssl_certs_test.h"
@@ -64,6 +66,7 @@
 #include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
@@ -72,6 +75,14 @@
 #include "openssl/crypto.h"
 #include "openssl/ssl.h"
 
+#if defined(__linux__) && !defined(ENVOY_SSL_OPENSSL)
+#include <netinet/tcp.h>
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#endif
+
 using testing::_;
 using testing::ContainsRegex;
 using testing::DoAll;
@@ -1410,6 +1421,8 @@ protected:
                                               const std::string& client_ctx_yaml,
                                               const std::vector<uint64_t>& expected_reuse_counts,
                                               const Network::Address::IpVersion version);
+  void testKernelTlsOffloadShutdown(Stats::TestUtil::TestStore& server_stats_store,
+                                    Stats::TestUtil::TestStore& client_stats_store);
 
   Network::ListenerPtr createListener(Network::SocketSharedPtr&& socket,
                                       Network::TcpListenerCallbacks& cb, Runtime::Loader& runtime,
@@ -2188,6 +2201,44 @@ TEST_P(SslSocketTest, MultiCertPreferEcdsaWithoutSni) {
   testUtil(test_options);
 }
 
+// Without SNI, the first ECDSA certificate with a curve supported by the client is preferred, even
+// when an ECDSA certificate with another curve comes first.
+TEST_P(SslSocketTest, MultiCertPreferEcdsaWithSupportedCurveWithoutSni) {
+  const std::string client_ctx_yaml = absl::StrCat(R"EOF(
+    common_tls_context:
+      tls_params:
+        tls_minimum_protocol_version: TLSv1_2
+        tls_maximum_protocol_version: TLSv1_2
+        cipher_suites:
+        - ECDHE-ECDSA-AES128-GCM-SHA256
+        - ECDHE-RSA-AES128-GCM-SHA256
+        ecdh_curves:
+        - P-256
+      validation_context:
+        verify_certificate_hash: )EOF",
+                                                   TEST_SELFSIGNED_ECDSA_P256_CERT_256_HASH);
+
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/selfsigned_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/selfsigned_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/selfsigned_ecdsa_p384_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/selfsigned_ecdsa_p384_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/selfsigned_ecdsa_p256_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/selfsigned_ecdsa_p256_key.pem"
+)EOF";
+
+  TestUtilOptions test_options(client_ctx_yaml, server_ctx_yaml, true, version_);
+  testUtil(test_options);
+}
+
 // When client supports SNI, exact match is preferred over wildcard match.
 TEST_P(SslSocketTest, MultiCertPreferExactSniMatch) {
   const std::string client_ctx_yaml = absl::StrCat(R"EOF(
@@ -4292,6 +4343,155 @@ TEST_P(SslSocketTest, ShutdownWithCloseNotify) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+namespace {
+
+// Whether the kernel can encrypt the records sent on a TCP socket, i.e. whether the `tls` upper
+// layer protocol can be attached to a connected socket.
+bool kernelTlsAvailable(Network::Address::IpVersion version) {
+#if defined(__linux__) && !defined(ENVOY_SSL_OPENSSL)
+  Network::Test::TcpListenSocketImmediateListen listen_socket(
+      Network::Test::getCanonicalLoopbackAddress(version));
+  const auto& address = listen_socket.connectionInfoProvider().localAddress();
+  Network::ClientSocketImpl client_socket(address, nullptr);
+  client_socket.setBlockingForTest(true);
+  if (client_socket.ioHandle().connect(address).return_value_ != 0) {
+    return false;
+  }
+  return client_socket.setSocketOption(IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")).return_value_ ==
+         0;
+#else
+  UNREFERENCED_PARAMETER(version);
+  return false;
+#endif
+}
+
+} // namespace
+
+// Writes data and closes a connection whose server has kernel TLS offload enabled, and checks that
+// the client receives both the data and the close_notify alert.
+void SslSocketTest::testKernelTlsOffloadShutdown(Stats::TestUtil::TestStore& server_stats_store,
+                                                 Stats::TestUtil::TestStore& client_stats_store) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    kernel_tls_offload: true
+    tls_params:
+      tls_maximum_protocol_version: TLSv1_2
+      cipher_suites:
+      - ECDHE-RSA-AES128-GCM-SHA256
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/unittest_key.pem"
+    validation_context:
+      trusted_ca:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/ca_certificates.pem"
+)EOF";
+
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext server_tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), server_tls_context);
+  auto server_cfg =
+      *ServerContextConfigImpl::create(server_tls_context, factory_context_, {}, false);
+  NiceMock<Server::Configuration::MockServerFactoryContext> server_factory_context;
+  ContextManagerImpl manager(server_factory_context);
+  auto server_ssl_socket_factory = *ServerSslSocketFactory::create(std::move(server_cfg), manager,
+                                                                   *server_stats_store.rootScope());
+
+  auto socket = std::make_shared<Network::Test::TcpListenSocketImmediateListen>(
+      Network::Test::getCanonicalLoopbackAddress(version_));
+  Network::MockTcpListenerCallbacks listener_callbacks;
+  NiceMock<Network::MockListenerConfig> listener_config;
+  Server::ThreadLocalOverloadStateOptRef overload_state;
+  Network::ListenerPtr listener = createListener(socket, listener_callbacks, runtime_,
+                                                 listener_config, overload_state, *dispatcher_);
+  std::shared_ptr<Network::MockReadFilter> server_read_filter(new Network::MockReadFilter());
+  std::shared_ptr<Network::MockReadFilter> client_read_filter(new Network::MockReadFilter());
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+  )EOF";
+
+  envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(client_ctx_yaml), tls_context);
+  auto client_cfg = *ClientContextConfigImpl::create(tls_context, factory_context_);
+  auto client_ssl_socket_factory = *ClientSslSocketFactory::create(std::move(client_cfg), manager,
+                                                                   *client_stats_store.rootScope());
+  Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket->connectionInfoProvider().localAddress(), Network::Address::InstanceConstSharedPtr(),
+      client_ssl_socket_factory->createTransportSocket(nullptr, nullptr), nullptr, nullptr);
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->enableHalfClose(true);
+  client_connection->addReadFilter(client_read_filter);
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+  client_connection->connect();
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(listener_callbacks, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+        server_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory->createDownstreamTransportSocket(),
+            stream_info_);
+        server_connection->enableHalfClose(true);
+        server_connection->addReadFilter(server_read_filter);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+      }));
+  EXPECT_CALL(listener_callbacks, recordConnectionsAcceptedOnSocketEvent(_));
+  EXPECT_CALL(*server_read_filter, onNewConnection());
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        Buffer::OwnedImpl data("hello");
+        server_connection->write(data, true);
+        EXPECT_EQ(data.length(), 0);
+      }));
+
+  EXPECT_CALL(*client_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+  EXPECT_CALL(*client_read_filter, onData(BufferString("hello"), true))
+      .WillOnce(Invoke([&](Buffer::Instance& read_buffer, bool) -> Network::FilterStatus {
+        read_buffer.drain(read_buffer.length());
+        client_connection->close(Network::ConnectionCloseType::NoFlush);
+        return Network::FilterStatus::StopIteration;
+      }));
+  EXPECT_CALL(*server_read_filter, onData(_, true));
+
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        server_connection->close(Network::ConnectionCloseType::NoFlush);
+        dispatcher_->exit();
+      }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+}
+
+// With kernel TLS offload, the data and the close_notify alert written after the handshake are
+// encrypted by the kernel where it supports it, and by BoringSSL otherwise.
+TEST_P(SslSocketTest, KernelTlsOffloadShutdownWithCloseNotify) {
+  Stats::TestUtil::TestStore server_stats_store;
+  Stats::TestUtil::TestStore client_stats_store;
+  testKernelTlsOffloadShutdown(server_stats_store, client_stats_store);
+
+  EXPECT_EQ(1UL, server_stats_store.counter("ssl.kernel_tls_offload").value() +
+                     server_stats_store.counter("ssl.kernel_tls_offload_unavailable").value());
+  EXPECT_EQ(0UL, client_stats_store.counter("ssl.kernel_tls_offload").value());
+}
+
+// Where the kernel supports it, the records are encrypted by the kernel, and the close_notify
+// alert it sends is accepted by the BoringSSL client.
+TEST_P(SslSocketTest, KernelTlsOffloadEnabled) {
+  if (!kernelTlsAvailable(version_)) {
+    GTEST_SKIP() << "the tls kernel module is not available";
+  }
+  Stats::TestUtil::TestStore server_stats_store;
+  Stats::TestUtil::TestStore client_stats_store;
+  testKernelTlsOffloadShutdown(server_stats_store, client_stats_store);
+
+  EXPECT_EQ(1UL, server_stats_store.counter("ssl.kernel_tls_offload").value());
+  EXPECT_EQ(0UL, server_stats_store.counter("ssl.kernel_tls_offload_unavailable").value());
+}
+
 TEST_P(SslSocketTest, ShutdownWithoutCloseNotify) {
   const std::string server_ctx_yaml = R"EOF(
   common_tls_context:
@@ -4648,7 +4848,8 @@ void testTicketSessionResumption(const std::string& server_ctx_yaml1,
                                  const std::vector<std::string>& server_names2,
                                  const std::string& client_ctx_yaml, bool expect_reuse,
                                  const Network::Address::IpVersion ip_version,
-                                 const uint32_t expected_lifetime_hint = 0) {
+                                 const uint32_t expected_lifetime_hint = 0,
+                                 const uint64_t expected_shared_session_cache_dropped = 0) {
   Event::SimulatedTimeSystem time_system;
   NiceMock<Server::Configuration::MockTransportSocketFactoryContext>
       transport_socket_factory_context;
@@ -4804,6 +5005,8 @@ void testTicketSessionResumption(const std::string& server_ctx_yaml1,
 
   EXPECT_EQ(expect_reuse ? 1UL : 0UL, server_stats_store.counter("ssl.session_reused").value());
   EXPECT_EQ(expect_reuse ? 1UL : 0UL, client_stats_store.counter("ssl.session_reused").value());
+  EXPECT_EQ(expected_shared_session_cache_dropped,
+            server_stats_store.counter("ssl.shared_session_cache_dropped").value());
 }
 
 void testSupportForSessionResumption(const std::string& server_ctx_yaml,
@@ -4881,6 +5084,9 @@ void testSupportForSessionResumption(const std::string& server_ctx_yaml,
         if (expect_stateful) {
           EXPECT_EQ(SSL_SESS_CACHE_SERVER,
                     (SSL_CTX_get_session_cache_mode(server_ssl_context) & SSL_SESS_CACHE_SERVER));
+          // The internal cache is kept, even with a shared session store.
+          EXPECT_EQ(0, (SSL_CTX_get_session_cache_mode(server_ssl_context) &
+                        SSL_SESS_CACHE_NO_INTERNAL));
         } else {
           EXPECT_EQ(SSL_SESS_CACHE_OFF, SSL_CTX_get_session_cache_mode(server_ssl_context));
         }
@@ -5433,6 +5639,98 @@ TEST_P(SslSocketTest, SessionResumptionEnabledByDefault) {
   testSupportForSessionResumption(server_ctx_yaml, client_ctx_yaml, true, true, version_);
 }
 
+namespace {
+
+// Ssl::SessionStore in memory, used on the test thread only. Drops the sessions longer than
+// max_session_length.
+class TestSessionStore : public Ssl::SessionStore {
+public:
+  explicit TestSessionStore(size_t max_session_length = std::numeric_limits<size_t>::max())
+      : max_session_length_(max_session_length) {}
+
+  bool insert(absl::Span<const uint8_t> session_id, absl::Span<const uint8_t> session) override {
+    if (session.size() > max_session_length_) {
+      return false;
+    }
+    sessions_[key(session_id)].assign(session.begin(), session.end());
+    return true;
+  }
+  bool lookup(absl::Span<const uint8_t> session_id, std::vector<uint8_t>& session) override {
+    auto it = sessions_.find(key(session_id));
+    if (it == sessions_.end()) {
+      return false;
+    }
+    session = it->second;
+    return true;
+  }
+
+private:
+  static std::string key(absl::Span<const uint8_t> session_id) {
+    return {session_id.begin(), session_id.end()};
+  }
+
+  const size_t max_session_length_;
+  absl::flat_hash_map<std::string, std::vector<uint8_t>> sessions_;
+};
+
+} // namespace
+
+// Test that without session tickets, a session can only be resumed on another context with the
+// same session ID context when the contexts keep their sessions in a shared store.
+TEST_P(SslSocketTest, StatefulSessionResumptionAcrossContexts) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_maximum_protocol_version: TLSv1_2
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/unittest_key.pem"
+  disable_stateless_session_resumption: true
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+  )EOF";
+
+  testTicketSessionResumption(server_ctx_yaml, {}, server_ctx_yaml, {}, client_ctx_yaml, false,
+                              version_);
+
+  StackedScopedInjectableLoaderForTest<Ssl::SessionStore> session_store(
+      std::make_unique<TestSessionStore>());
+  testTicketSessionResumption(server_ctx_yaml, {}, server_ctx_yaml, {}, client_ctx_yaml, true,
+                              version_);
+}
+
+// Test that the sessions the shared store drops are counted, and that the contexts keep their own
+// cache for them.
+TEST_P(SslSocketTest, StatefulSessionDroppedBySharedStore) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_maximum_protocol_version: TLSv1_2
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/common/tls/test_data/unittest_key.pem"
+  disable_stateless_session_resumption: true
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+  )EOF";
+
+  // Both full handshakes create a session that the store drops, so the second context cannot
+  // resume the first session.
+  StackedScopedInjectableLoaderForTest<Ssl::SessionStore> session_store(
+      std::make_unique<TestSessionStore>(0));
+  testTicketSessionResumption(server_ctx_yaml, {}, server_ctx_yaml, {}, client_ctx_yaml, false,
+                              version_, 0, 2);
+  testSupportForSessionResumption(server_ctx_yaml, client_ctx_yaml, false, true, version_);
+}
+
 // Test that if two listeners use the same cert and session ticket key, but
 // different client CA, that sessions cannot be resumed.
 TEST_P(SslSocketTest, ClientAuthCrossListenerSessionResumption) {
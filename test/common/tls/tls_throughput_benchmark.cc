@@ -1,4 +1,9 @@
+#include <fcntl.h>
+#include <netinet/in.h>
+
 #include "source/common/buffer/buffer_impl.h"
+#include "source/common/network/io_socket_handle_impl.h"
+#include "source/common/tls/kernel_tls.h"
 
 #include "test/test_common/environment.h"
 
@@ -64,18 +69,14 @@ static void addFullSlices(Buffer::Instance& output_buffer, unsigned num_slices,
   }
 }
 
-static void testThroughput(benchmark::State& state) {
+static bssl::UniquePtr<SSL_CTX> newServerContext() {
   std::string error;
-  std::unique_ptr<bazel::tools::cpp::runfiles::Runfiles> runfiles(
+  static std::unique_ptr<bazel::tools::cpp::runfiles::Runfiles> runfiles(
       bazel::tools::cpp::runfiles::Runfiles::Create("tls_throughput_benchmark",
                                                     BAZEL_CURRENT_REPOSITORY, &error));
   Envoy::TestEnvironment::setRunfiles(runfiles.get());
 
-  int sockets[2];
-  socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets);
-
   bssl::UniquePtr<SSL_CTX> server_ctx(SSL_CTX_new(TLS_method()));
-  bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
   std::string cert_path =
       Envoy::TestEnvironment::runfilesPath("test/common/tls/test_data/san_dns_cert.pem");
   std::string key_path =
@@ -85,28 +86,41 @@ static void testThroughput(benchmark::State& state) {
   RELEASE_ASSERT(err > 0, "SSL_CTX_use_certificate_file");
   err = SSL_CTX_use_PrivateKey_file(server_ctx.get(), key_path.c_str(), SSL_FILETYPE_PEM);
   RELEASE_ASSERT(err > 0, "SSL_CTX_use_PrivateKey_file");
+  return server_ctx;
+}
 
-  bssl::UniquePtr<SSL> server_ssl(SSL_new(server_ctx.get()));
-  SSL_set_fd(server_ssl.get(), sockets[0]);
-  SSL_set_accept_state(server_ssl.get());
-
-  bssl::UniquePtr<SSL> client_ssl(SSL_new(client_ctx.get()));
-  SSL_set_fd(client_ssl.get(), sockets[1]);
-  SSL_set_connect_state(client_ssl.get());
-
+static void doHandshake(SSL* client_ssl, SSL* server_ssl) {
   bool handshake_success = false;
   for (int i = 0; i < 50; i++) {
-    int client_err = SSL_do_handshake(client_ssl.get());
-    int server_err = SSL_do_handshake(server_ssl.get());
+    int client_err = SSL_do_handshake(client_ssl);
+    int server_err = SSL_do_handshake(server_ssl);
     if (client_err == 1 && server_err == 1) {
       handshake_success = true;
       break;
     }
-    handleSslError(client_ssl.get(), client_err, false);
-    handleSslError(server_ssl.get(), server_err, true);
+    handleSslError(client_ssl, client_err, false);
+    handleSslError(server_ssl, server_err, true);
   }
 
   RELEASE_ASSERT(handshake_success, "handshake completed successfully");
+}
+
+static void testThroughput(benchmark::State& state) {
+  int sockets[2];
+  socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets);
+
+  bssl::UniquePtr<SSL_CTX> server_ctx = newServerContext();
+  bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+
+  bssl::UniquePtr<SSL> server_ssl(SSL_new(server_ctx.get()));
+  SSL_set_fd(server_ssl.get(), sockets[0]);
+  SSL_set_accept_state(server_ssl.get());
+
+  bssl::UniquePtr<SSL> client_ssl(SSL_new(client_ctx.get()));
+  SSL_set_fd(client_ssl.get(), sockets[1]);
+  SSL_set_connect_state(client_ssl.get());
+
+  doHandshake(client_ssl.get(), server_ssl.get());
 
   static uint8_t read_buf[1024 * 1024];
 
@@ -159,7 +173,7 @@ static void testThroughput(benchmark::State& state) {
         ++num_times_linearize_did_something;
       }
 
-      err = SSL_write(client_ssl.get(), mem, len);
+      int err = SSL_write(client_ssl.get(), mem, len);
       RELEASE_ASSERT(err == static_cast<int>(len),
                      absl::StrCat("SSL_write got: ", err, " expected: ", len));
       write_buf.drain(len);
@@ -193,5 +207,102 @@ static void testParams(benchmark::internal::Benchmark* b) {
 
 BENCHMARK(testThroughput)->Unit(::benchmark::kMicrosecond)->Apply(testParams);
 
+// Connects a pair of non-blocking TCP sockets over loopback, as kernel TLS needs TCP.
+static void tcpSocketPair(int sockets[2]) {
+  int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_length = sizeof(address);
+  RELEASE_ASSERT(::bind(listener, reinterpret_cast<sockaddr*>(&address), address_length) == 0 &&
+                     ::getsockname(listener, reinterpret_cast<sockaddr*>(&address),
+                                   &address_length) == 0 &&
+                     ::listen(listener, 1) == 0,
+                 "listen");
+  sockets[1] = ::socket(AF_INET, SOCK_STREAM, 0);
+  RELEASE_ASSERT(
+      ::connect(sockets[1], reinterpret_cast<sockaddr*>(&address), address_length) == 0,
+      "connect");
+  sockets[0] = ::accept(listener, nullptr, nullptr);
+  RELEASE_ASSERT(sockets[0] >= 0, "accept");
+  ::close(listener);
+  for (int i = 0; i < 2; i++) {
+    ::fcntl(sockets[i], F_SETFL, ::fcntl(sockets[i], F_GETFL) | O_NONBLOCK);
+  }
+}
+
+// Sends large writes over TLS 1.2 AES-128-GCM, encrypting them either with SSL_write(), or in the
+// kernel once the handshake completes, as SslSocket does with `kernel_tls_offload`. The receiver
+// decrypts with BoringSSL in both cases, outside of the measured time.
+static void testKernelTlsThroughput(benchmark::State& state) {
+  const bool kernel_tls = state.range(0);
+
+  int sockets[2];
+  tcpSocketPair(sockets);
+  Network::IoSocketHandleImpl server_handle(sockets[0]);
+  Network::IoSocketHandleImpl client_handle(sockets[1]);
+
+  bssl::UniquePtr<SSL_CTX> server_ctx = newServerContext();
+  bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+  SSL_CTX_set_max_proto_version(client_ctx.get(), TLS1_2_VERSION);
+  RELEASE_ASSERT(SSL_CTX_set_strict_cipher_list(client_ctx.get(), "ECDHE-RSA-AES128-GCM-SHA256"),
+                 "SSL_CTX_set_strict_cipher_list");
+
+  bssl::UniquePtr<SSL> server_ssl(SSL_new(server_ctx.get()));
+  SSL_set_fd(server_ssl.get(), sockets[0]);
+  SSL_set_accept_state(server_ssl.get());
+
+  bssl::UniquePtr<SSL> client_ssl(SSL_new(client_ctx.get()));
+  SSL_set_fd(client_ssl.get(), sockets[1]);
+  SSL_set_connect_state(client_ssl.get());
+
+  doHandshake(client_ssl.get(), server_ssl.get());
+  if (kernel_tls && !KernelTls::enableTransmit(client_ssl.get(), client_handle)) {
+    state.SkipWithError("kernel TLS is not available");
+    return;
+  }
+
+  static uint8_t read_buf[1024 * 1024];
+  auto drain_receiver = [&]() {
+    state.PauseTiming();
+    while (SSL_read(server_ssl.get(), read_buf, sizeof(read_buf)) > 0) {
+    }
+    state.ResumeTiming();
+  };
+
+  uint64_t bytes_written = 0;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    state.PauseTiming();
+    Buffer::OwnedImpl write_buf;
+    addFullSlices(write_buf, 64, false);
+    bytes_written += write_buf.length();
+    state.ResumeTiming();
+
+    while (write_buf.length() > 0) {
+      if (kernel_tls) {
+        Api::IoCallUint64Result result = client_handle.write(write_buf);
+        if (!result.ok()) {
+          RELEASE_ASSERT(result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again,
+                         result.err_->getErrorDetails());
+          drain_receiver();
+        }
+        continue;
+      }
+      size_t len = std::min<uint64_t>(write_buf.length(), 16384);
+      int err = SSL_write(client_ssl.get(), write_buf.linearize(len), len);
+      if (err > 0) {
+        write_buf.drain(err);
+        continue;
+      }
+      RELEASE_ASSERT(SSL_get_error(client_ssl.get(), err) == SSL_ERROR_WANT_WRITE, "SSL_write");
+      drain_receiver();
+    }
+  }
+  state.counters["throughput"] = benchmark::Counter(bytes_written, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(testKernelTlsThroughput)->Unit(::benchmark::kMicrosecond)->Arg(0)->Arg(1);
+
 } // namespace Extensions::TransportSockets::Tls
 } // namespace Envoy
@@ -1817,6 +1817,35 @@ TEST_F(ClusterManagerImplTest, UpstreamSocketOptionsNullIsOkay) {
   EXPECT_TRUE(opt_cp.has_value());
 }
 
+// Requests without socket options, or with an empty set of them, share the same pool, which is
+// created without socket options. The pool key only depends on the resulting upstream protocols.
+TEST_F(ClusterManagerImplTest, EmptyUpstreamSocketOptionsUseDefaultPool) {
+  createWithBasicStaticCluster();
+  NiceMock<MockLoadBalancerContext> context;
+
+  Http::ConnectionPool::MockInstance* to_create =
+      new NiceMock<Http::ConnectionPool::MockInstance>();
+  EXPECT_CALL(factory_, allocateConnPool_(_, _, ::testing::IsNull(), _, _, _, _))
+      .WillOnce(Return(to_create));
+
+  ThreadLocalCluster* cluster = cluster_manager_->getThreadLocalCluster("cluster_1");
+  HostConstSharedPtr host = cluster->chooseHost(nullptr).host;
+  Http::ConnectionPool::Instance* cp = HttpPoolDataPeer::getPool(
+      cluster->httpConnPool(host, ResourcePriority::Default, Http::Protocol::Http11, nullptr));
+  EXPECT_NE(nullptr, cp);
+
+  EXPECT_CALL(context, upstreamSocketOptions())
+      .WillOnce(Return(std::make_shared<Network::Socket::Options>()));
+  EXPECT_EQ(cp, HttpPoolDataPeer::getPool(cluster->httpConnPool(
+                    host, ResourcePriority::Default, Http::Protocol::Http11, &context)));
+
+  // The cluster only speaks HTTP/1.1 upstream, whatever the downstream protocol.
+  EXPECT_EQ(cp, HttpPoolDataPeer::getPool(cluster->httpConnPool(
+                    host, ResourcePriority::Default, Http::Protocol::Http2, nullptr)));
+  EXPECT_EQ(cp, HttpPoolDataPeer::getPool(
+                    cluster->httpConnPool(host, ResourcePriority::Default, {}, nullptr)));
+}
+
 TEST_F(ClusterManagerImplTest, HttpPoolDataForwardsCallsToConnectionPool) {
   createWithBasicStaticCluster();
   NiceMock<MockLoadBalancerContext> context;
@@ -1384,6 +1384,65 @@ TEST_F(ClusterManagerImplTest, ShouldPreconnectDefaultsToEligible) {
   EXPECT_TRUE(info->shouldPreconnect(*with_metadata));
 }
 
+TEST_F(ClusterManagerImplTest, DemandPreconnectConfig) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      lb_policy: ROUND_ROBIN
+      type: STATIC
+      preconnect_policy:
+        demand_preconnect: {}
+    - name: cluster_2
+      connect_timeout: 0.250s
+      lb_policy: ROUND_ROBIN
+      type: STATIC
+      preconnect_policy:
+        demand_preconnect:
+          arrival_rate_time_constant: 0.5s
+    - name: cluster_3
+      connect_timeout: 0.250s
+      lb_policy: ROUND_ROBIN
+      type: STATIC
+  )EOF";
+  create(parseBootstrapFromV3Yaml(yaml));
+
+  EXPECT_EQ(std::chrono::milliseconds(1000),
+            cluster_manager_->getThreadLocalCluster("cluster_1")
+                ->info()
+                ->demandPreconnectTimeConstant());
+  EXPECT_EQ(std::chrono::milliseconds(500),
+            cluster_manager_->getThreadLocalCluster("cluster_2")
+                ->info()
+                ->demandPreconnectTimeConstant());
+  EXPECT_FALSE(cluster_manager_->getThreadLocalCluster("cluster_3")
+                   ->info()
+                   ->demandPreconnectTimeConstant()
+                   .has_value());
+}
+
+TEST_F(ClusterManagerImplTest, WarmConnectionsConfig) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      lb_policy: ROUND_ROBIN
+      type: STATIC
+      preconnect_policy:
+        warm_connections: 4
+    - name: cluster_2
+      connect_timeout: 0.250s
+      lb_policy: ROUND_ROBIN
+      type: STATIC
+  )EOF";
+  create(parseBootstrapFromV3Yaml(yaml));
+
+  EXPECT_EQ(4, cluster_manager_->getThreadLocalCluster("cluster_1")->info()->warmConnections());
+  EXPECT_EQ(0, cluster_manager_->getThreadLocalCluster("cluster_2")->info()->warmConnections());
+}
+
 class PreconnectTest : public ClusterManagerImplTest {
 public:
   void initialize(float ratio) {
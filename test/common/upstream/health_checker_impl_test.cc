@@ -4996,6 +4996,93 @@ TEST_F(TcpHealthCheckerImplTest, ConnectionCreateFailure) {
   EXPECT_GE(cluster_->info_->stats_store_.counter("health_check.failure").value(), 1UL);
 }
 
+// Tests that with interval_batch_window the sessions due in the same window are run from a
+// single shared timer, and that a removed host is dropped from its batch.
+TEST_F(TcpHealthCheckerImplTest, IntervalBatching) {
+  Event::MockTimer* batch_timer = new Event::MockTimer(&dispatcher_);
+  allocHealthChecker(R"EOF(
+    timeout: 1s
+    interval: 1s
+    interval_batch_window: 1s
+    unhealthy_threshold: 2
+    healthy_threshold: 2
+    tcp_health_check: {}
+    )EOF");
+  HostSharedPtr host1 = makeTestHost(cluster_->info_, "tcp://127.0.0.1:80");
+  HostSharedPtr host2 = makeTestHost(cluster_->info_, "tcp://127.0.0.1:81");
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {host1, host2};
+
+  // Sessions only create their timeout timer.
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  std::vector<NiceMock<Network::MockClientConnection>*> connections;
+  EXPECT_CALL(dispatcher_, createClientConnection_(_, _, _, _))
+      .Times(3)
+      .WillRepeatedly(InvokeWithoutArgs([&connections]() {
+        connections.push_back(new NiceMock<Network::MockClientConnection>());
+        return connections.back();
+      }));
+  health_checker_->start();
+  ASSERT_EQ(2, connections.size());
+
+  // Both hosts are next due in the same window, so the batch timer is armed once. Without traffic
+  // the no traffic interval of 60s is used.
+  EXPECT_CALL(*batch_timer,
+              enableTimer(testing::AllOf(testing::Ge(std::chrono::milliseconds(60000)),
+                                         testing::Lt(std::chrono::milliseconds(61000))),
+                          _));
+  connections[0]->raiseEvent(Network::ConnectionEvent::Connected);
+  connections[1]->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(2UL, cluster_->info_->stats_store_.counter("health_check.success").value());
+
+  cluster_->prioritySet().runUpdateCallbacks(0, {}, {host2});
+
+  // Nothing is run before the window ends, and the timer is armed again.
+  EXPECT_CALL(*batch_timer, enableTimer(_, _));
+  batch_timer->invokeCallback();
+  EXPECT_EQ(2, connections.size());
+
+  simTime().advanceTimeWait(std::chrono::seconds(61));
+  batch_timer->invokeCallback();
+  EXPECT_EQ(3, connections.size());
+  EXPECT_EQ(3UL, cluster_->info_->stats_store_.counter("health_check.attempt").value());
+}
+
+// Tests that a session whose interval rounds down to 0ms is run from the next window.
+TEST_F(TcpHealthCheckerImplTest, IntervalBatchingZeroInterval) {
+  Event::MockTimer* batch_timer = new Event::MockTimer(&dispatcher_);
+  allocHealthChecker(R"EOF(
+    timeout: 1s
+    interval: 0.0001s
+    no_traffic_interval: 0.0001s
+    interval_batch_window: 0.001s
+    unhealthy_threshold: 2
+    healthy_threshold: 2
+    tcp_health_check: {}
+    )EOF");
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  std::vector<NiceMock<Network::MockClientConnection>*> connections;
+  EXPECT_CALL(dispatcher_, createClientConnection_(_, _, _, _))
+      .Times(2)
+      .WillRepeatedly(InvokeWithoutArgs([&connections]() {
+        connections.push_back(new NiceMock<Network::MockClientConnection>());
+        return connections.back();
+      }));
+  health_checker_->start();
+  ASSERT_EQ(1, connections.size());
+
+  EXPECT_CALL(*batch_timer, enableTimer(std::chrono::milliseconds(1), _));
+  connections[0]->raiseEvent(Network::ConnectionEvent::Connected);
+
+  simTime().advanceTimeWait(std::chrono::milliseconds(1));
+  batch_timer->invokeCallback();
+  EXPECT_EQ(2, connections.size());
+  EXPECT_EQ(2UL, cluster_->info_->stats_store_.counter("health_check.attempt").value());
+}
+
 TEST_F(TcpHealthCheckerImplTest, SuccessProxyProtocol) {
   InSequence s;
 
@@ -666,6 +666,61 @@ TEST_F(LoadStatsReporterImplTest, ReportLoadForNonZeroStatsRqSuccess) {
   response_timer_cb_();
 }
 
+// Validate that reporting the load of a cluster does not allocate the stats of its hosts which
+// never had any traffic.
+TEST_F(LoadStatsReporterImplTest, UnusedHostStatsNotAllocated) {
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage({});
+  createLoadStatsReporter();
+  time_system_.setMonotonicTime(std::chrono::microseconds(100));
+
+  NiceMock<MockClusterMockPrioritySet> cluster;
+  MockHostSet& host_set = *cluster.prioritySet().getMockHostSet(0);
+  ::envoy::config::core::v3::Locality locality;
+  locality.set_region("test_region");
+
+  HostSharedPtr used_host = Upstream::makeTestHost(cluster.info_, "tcp://127.0.0.1:80", locality);
+  HostSharedPtr unused_host =
+      Upstream::makeTestHost(cluster.info_, "tcp://127.0.0.2:80", locality);
+  host_set.hosts_ = {used_host, unused_host};
+  host_set.hosts_per_locality_ = makeHostsPerLocality({{used_host, unused_host}});
+
+  cluster.info_->eds_service_name_ = "eds_service_for_foo";
+
+  ON_CALL(cm_, getActiveCluster("foo"))
+      .WillByDefault(Return(OptRef<const Upstream::Cluster>(cluster)));
+  deliverLoadStatsResponse({"foo"});
+  EXPECT_EQ(nullptr, used_host->statsIfAllocated());
+  EXPECT_EQ(nullptr, unused_host->statsIfAllocated());
+
+  used_host->stats().rq_total_.inc();
+  used_host->stats().rq_success_.inc();
+  time_system_.setMonotonicTime(std::chrono::microseconds(101));
+  {
+    envoy::config::endpoint::v3::ClusterStats expected_cluster_stats;
+
+    expected_cluster_stats.set_cluster_name("foo");
+    expected_cluster_stats.set_cluster_service_name("eds_service_for_foo");
+    expected_cluster_stats.mutable_load_report_interval()->MergeFrom(
+        Protobuf::util::TimeUtil::MicrosecondsToDuration(1));
+
+    auto* expected_locality_stats = expected_cluster_stats.add_upstream_locality_stats();
+    expected_locality_stats->mutable_locality()->MergeFrom(locality);
+    expected_locality_stats->set_priority(0);
+    expected_locality_stats->set_total_successful_requests(1);
+    expected_locality_stats->set_total_error_requests(0);
+    expected_locality_stats->set_total_requests_in_progress(0);
+    expected_locality_stats->set_total_issued_requests(1);
+
+    expectSendMessage({expected_cluster_stats});
+  }
+  EXPECT_CALL(*response_timer_, enableTimer(std::chrono::milliseconds(42000), _));
+  response_timer_cb_();
+
+  EXPECT_NE(nullptr, used_host->statsIfAllocated());
+  EXPECT_EQ(nullptr, unused_host->statsIfAllocated());
+}
+
 // Validate that when envoy.reloadable_features.report_load_for_non_zero_stats is true, a load
 // report is sent if only rq_error is non-zero.
 TEST_F(LoadStatsReporterImplTest, ReportLoadForNonZeroStatsRqError) {
@@ -1914,6 +1914,41 @@ TEST_F(HostImplTest, HostCluster) {
   EXPECT_EQ("", host->locality().zone());
 }
 
+// The stats of a host are only allocated when they are first used; until then, reporting them
+// gives zeros without allocating them.
+TEST_F(HostImplTest, StatsAllocatedOnFirstUse) {
+  MockClusterMockPrioritySet cluster;
+  HostSharedPtr host = makeTestHost(cluster.info_, "tcp://10.0.0.1:1234", 1);
+  HostSharedPtr other_host = makeTestHost(cluster.info_, "tcp://10.0.0.2:1234", 1);
+  EXPECT_EQ(nullptr, host->statsIfAllocated());
+  EXPECT_TRUE(host->canCreateConnection(ResourcePriority::Default));
+  for (const auto& [name, counter] : host->counters()) {
+    EXPECT_EQ(0, counter.get().value()) << name;
+  }
+  for (const auto& [name, gauge] : host->gauges()) {
+    EXPECT_EQ(0, gauge.get().value()) << name;
+  }
+  EXPECT_EQ(nullptr, host->statsIfAllocated());
+
+  host->stats().rq_total_.inc();
+  host->stats().cx_active_.inc();
+  ASSERT_NE(nullptr, host->statsIfAllocated());
+  EXPECT_EQ(&host->stats(), host->statsIfAllocated());
+  EXPECT_EQ(1, host->statsIfAllocated()->rq_total_.value());
+  for (const auto& [name, counter] : host->counters()) {
+    EXPECT_EQ(name == "rq_total" ? 1 : 0, counter.get().value()) << name;
+  }
+  for (const auto& [name, gauge] : host->gauges()) {
+    EXPECT_EQ(name == "cx_active" ? 1 : 0, gauge.get().value()) << name;
+  }
+
+  // The stats of the other host are still unused.
+  EXPECT_EQ(nullptr, other_host->statsIfAllocated());
+  for (const auto& [name, counter] : other_host->counters()) {
+    EXPECT_EQ(0, counter.get().value()) << name;
+  }
+}
+
 TEST_F(HostImplTest, Weight) {
   MockClusterMockPrioritySet cluster;
 
@@ -1239,6 +1239,17 @@ TEST_F(IoHandleImplNotImplementedTest, ErrorOnSendmsg) {
               IsInvalidAddress());
 }
 
+TEST_F(IoHandleImplNotImplementedTest, ErrorOnSendmmsg) {
+  EXPECT_THAT(io_handle_->sendmmsg(absl::MakeConstSpan(&slice_, 1),
+                                   Network::Address::EnvoyInternalInstance("listener_id")),
+              IsInvalidAddress());
+}
+
+TEST_F(IoHandleImplNotImplementedTest, ErrorOnSendWithControlMessage) {
+  const Api::IoCallUint64Result result = io_handle_->sendWithControlMessage(&slice_, 1, 0, 0, {});
+  EXPECT_EQ(Api::IoError::IoErrorCode::NoSupport, result.err_->getErrorCode());
+}
+
 TEST_F(IoHandleImplNotImplementedTest, ErrorOnRecvmsg) {
   Network::IoHandle::RecvMsgOutput output_is_ignored(1, nullptr);
   EXPECT_THAT(io_handle_->recvmsg(&slice_, 0, 0, {}, output_is_ignored), IsInvalidAddress());
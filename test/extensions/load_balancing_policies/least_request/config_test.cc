@@ -1,7 +1,11 @@
 #include "envoy/config/core/v3/extension.pb.h"
 
+#include "source/extensions/load_balancing_policies/common/active_request_tracker.h"
 #include "source/extensions/load_balancing_policies/least_request/config.h"
 
+#include "test/common/upstream/utility.h"
+
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/server/server_factory_context.h"
 #include "test/mocks/upstream/cluster_info.h"
 #include "test/mocks/upstream/priority_set.h"
@@ -44,6 +48,150 @@ TEST(LeastRequestConfigTest, ValidateFail) {
   EXPECT_NE(nullptr, thread_local_lb);
 }
 
+TEST(LeastRequestConfigTest, ShardedRequestCountersAttachHostData) {
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+  auto cluster_info = std::make_shared<NiceMock<Upstream::MockClusterInfo>>();
+  NiceMock<Upstream::MockPrioritySet> main_thread_priority_set;
+
+  envoy::extensions::load_balancing_policies::least_request::v3::LeastRequest config_msg;
+  config_msg.set_use_sharded_request_counters(true);
+
+  auto& factory = Config::Utility::getAndCheckFactoryByName<Upstream::TypedLoadBalancerFactory>(
+      "envoy.load_balancing_policies.least_request");
+  auto lb_config = factory.loadConfig(context, config_msg).value();
+
+  auto host = Upstream::makeTestHost(cluster_info, "tcp://127.0.0.1:80");
+  host->stats().rq_active_.set(3);
+  main_thread_priority_set.getMockHostSet(0)->hosts_ = {host};
+
+  auto thread_aware_lb =
+      factory.create(*lb_config, *cluster_info, main_thread_priority_set, context.runtime_loader_,
+                     context.api_.random_, context.time_system_);
+  ASSERT_OK(thread_aware_lb->initialize());
+  EXPECT_NE(nullptr, thread_aware_lb->factory());
+
+  // Existing hosts get the data on initialization, seeded from the host stats.
+  auto data = host->typedLbPolicyData<Common::ActiveRequestsHostLbPolicyData>();
+  ASSERT_TRUE(data.has_value());
+  EXPECT_EQ(3, data->activeRequests());
+  EXPECT_EQ(0, data->pendingRequests());
+
+  host->notifyActiveRequestsChanged(1, 2);
+  EXPECT_EQ(4, data->activeRequests());
+  EXPECT_EQ(2, data->pendingRequests());
+
+  // Hosts added later get the data too.
+  auto new_host = Upstream::makeTestHost(cluster_info, "tcp://127.0.0.1:81");
+  main_thread_priority_set.runUpdateCallbacks(0, {new_host}, {});
+  EXPECT_TRUE(new_host->typedLbPolicyData<Common::ActiveRequestsHostLbPolicyData>().has_value());
+}
+
+TEST(LeastRequestConfigTest, ShardedRequestCountersReconciled) {
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+  auto* reconcile_timer = new NiceMock<Event::MockTimer>(&context.dispatcher_);
+  auto cluster_info = std::make_shared<NiceMock<Upstream::MockClusterInfo>>();
+  NiceMock<Upstream::MockPrioritySet> main_thread_priority_set;
+
+  envoy::extensions::load_balancing_policies::least_request::v3::LeastRequest config_msg;
+  config_msg.set_use_sharded_request_counters(true);
+
+  auto& factory = Config::Utility::getAndCheckFactoryByName<Upstream::TypedLoadBalancerFactory>(
+      "envoy.load_balancing_policies.least_request");
+  auto lb_config = factory.loadConfig(context, config_msg).value();
+
+  auto host = Upstream::makeTestHost(cluster_info, "tcp://127.0.0.1:80");
+  host->stats().rq_active_.set(3);
+  host->stats().rq_pending_active_.set(1);
+  main_thread_priority_set.getMockHostSet(0)->hosts_ = {host};
+
+  auto thread_aware_lb =
+      factory.create(*lb_config, *cluster_info, main_thread_priority_set, context.runtime_loader_,
+                     context.api_.random_, context.time_system_);
+  ASSERT_OK(thread_aware_lb->initialize());
+  EXPECT_TRUE(reconcile_timer->enabled());
+
+  auto data = host->typedLbPolicyData<Common::ActiveRequestsHostLbPolicyData>();
+  ASSERT_TRUE(data.has_value());
+  EXPECT_EQ(3, data->activeRequests());
+  EXPECT_EQ(1, data->pendingRequests());
+
+  // The counts drift when the stats move without the data seeing it, e.g. between the seeding and
+  // the attachment, and are corrected by the next reconciliation.
+  host->notifyActiveRequestsChanged(-5, -3);
+  host->stats().rq_active_.set(2);
+  host->stats().rq_pending_active_.set(4);
+  EXPECT_EQ(0, data->activeRequests());
+  EXPECT_EQ(0, data->pendingRequests());
+  reconcile_timer->invokeCallback();
+  EXPECT_EQ(2, data->activeRequests());
+  EXPECT_EQ(4, data->pendingRequests());
+  EXPECT_TRUE(reconcile_timer->enabled());
+
+  host->notifyActiveRequestsChanged(1, -1);
+  EXPECT_EQ(3, data->activeRequests());
+  EXPECT_EQ(3, data->pendingRequests());
+}
+
+// Attaching the data to hosts and reconciling their counts does not allocate the stats of the
+// hosts which never had a request.
+TEST(LeastRequestConfigTest, ShardedRequestCountersKeepIdleHostStatsUnallocated) {
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+  auto* reconcile_timer = new NiceMock<Event::MockTimer>(&context.dispatcher_);
+  auto cluster_info = std::make_shared<NiceMock<Upstream::MockClusterInfo>>();
+  NiceMock<Upstream::MockPrioritySet> main_thread_priority_set;
+
+  envoy::extensions::load_balancing_policies::least_request::v3::LeastRequest config_msg;
+  config_msg.set_use_sharded_request_counters(true);
+
+  auto& factory = Config::Utility::getAndCheckFactoryByName<Upstream::TypedLoadBalancerFactory>(
+      "envoy.load_balancing_policies.least_request");
+  auto lb_config = factory.loadConfig(context, config_msg).value();
+
+  auto busy_host = Upstream::makeTestHost(cluster_info, "tcp://127.0.0.1:80");
+  auto idle_host = Upstream::makeTestHost(cluster_info, "tcp://127.0.0.1:81");
+  main_thread_priority_set.getMockHostSet(0)->hosts_ = {busy_host, idle_host};
+
+  auto thread_aware_lb =
+      factory.create(*lb_config, *cluster_info, main_thread_priority_set, context.runtime_loader_,
+                     context.api_.random_, context.time_system_);
+  ASSERT_OK(thread_aware_lb->initialize());
+  auto new_idle_host = Upstream::makeTestHost(cluster_info, "tcp://127.0.0.1:82");
+  main_thread_priority_set.getMockHostSet(0)->hosts_.push_back(new_idle_host);
+  main_thread_priority_set.runUpdateCallbacks(0, {new_idle_host}, {});
+
+  auto data = idle_host->typedLbPolicyData<Common::ActiveRequestsHostLbPolicyData>();
+  ASSERT_TRUE(data.has_value());
+  EXPECT_EQ(0, data->activeRequests());
+  EXPECT_TRUE(
+      new_idle_host->typedLbPolicyData<Common::ActiveRequestsHostLbPolicyData>().has_value());
+
+  busy_host->stats().rq_active_.set(2);
+  reconcile_timer->invokeCallback();
+  EXPECT_EQ(2, busy_host->typedLbPolicyData<Common::ActiveRequestsHostLbPolicyData>()
+                   ->activeRequests());
+  EXPECT_EQ(nullptr, idle_host->statsIfAllocated());
+  EXPECT_EQ(nullptr, new_idle_host->statsIfAllocated());
+}
+
+TEST(LeastRequestConfigTest, NoHostDataByDefault) {
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+  auto cluster_info = std::make_shared<NiceMock<Upstream::MockClusterInfo>>();
+  NiceMock<Upstream::MockPrioritySet> main_thread_priority_set;
+
+  auto& factory = Config::Utility::getAndCheckFactoryByName<Upstream::TypedLoadBalancerFactory>(
+      "envoy.load_balancing_policies.least_request");
+  auto lb_config = factory.loadConfig(context, *factory.createEmptyConfigProto()).value();
+
+  auto host = Upstream::makeTestHost(cluster_info, "tcp://127.0.0.1:80");
+  main_thread_priority_set.getMockHostSet(0)->hosts_ = {host};
+
+  auto thread_aware_lb =
+      factory.create(*lb_config, *cluster_info, main_thread_priority_set, context.runtime_loader_,
+                     context.api_.random_, context.time_system_);
+  ASSERT_OK(thread_aware_lb->initialize());
+  EXPECT_EQ(0, host->lbPolicyDataCount());
+}
+
 } // namespace
 } // namespace LeastRequest
 } // namespace LoadBalancingPolicies
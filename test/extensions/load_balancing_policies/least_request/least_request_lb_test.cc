@@ -86,6 +86,30 @@ TEST_P(LeastRequestLoadBalancerTest, Normal) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr).host);
 }
 
+// Picking hosts reads their active requests without allocating the stats of hosts which never had
+// any.
+TEST_P(LeastRequestLoadBalancerTest, UnusedHostStatsNotAllocated) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                              makeTestHost(info_, "tcp://127.0.0.1:81")};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(1);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr).host);
+  EXPECT_EQ(nullptr, hostSet().healthy_hosts_[0]->statsIfAllocated());
+
+  // Unequal weights go through the weighted scheduler instead.
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 2)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {});
+  EXPECT_CALL(random_, random()).WillRepeatedly(Return(0));
+  EXPECT_NE(nullptr, lb_.chooseHost(nullptr).host);
+  EXPECT_EQ(nullptr, hostSet().healthy_hosts_[0]->statsIfAllocated());
+  EXPECT_EQ(nullptr, hostSet().healthy_hosts_[1]->statsIfAllocated());
+}
+
 TEST_P(LeastRequestLoadBalancerTest, PNC) {
   hostSet().healthy_hosts_ = {
       makeTestHost(info_, "tcp://127.0.0.1:80"), makeTestHost(info_, "tcp://127.0.0.1:81"),
@@ -773,6 +797,57 @@ TEST_P(LeastRequestLoadBalancerTest, PendingCountedWeighted) {
   EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr).host);
 }
 
+TEST_P(LeastRequestLoadBalancerTest, ShardedRequestCounters) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.least_request_lb_count_pending_requests", "true"}});
+
+  envoy::extensions::load_balancing_policies::least_request::v3::LeastRequest lr_lb_config;
+  lr_lb_config.set_use_sharded_request_counters(true);
+  LeastRequestLoadBalancer lb{priority_set_, nullptr, stats_,       runtime_,
+                              random_,       50,      lr_lb_config, simTime()};
+
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                              makeTestHost(info_, "tcp://127.0.0.1:81")};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  Extensions::LoadBalancingPolicies::Common::ActiveRequestTrackingThreadAwareLb::
+      addActiveRequestsDataToHosts(hostSet().hosts_);
+  hostSet().runCallbacks({}, {});
+
+  // The host stats are not consulted when the sharded counters are attached.
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(10);
+  hostSet().healthy_hosts_[0]->notifyActiveRequestsChanged(1, 0);
+  hostSet().healthy_hosts_[1]->notifyActiveRequestsChanged(2, 0);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0)).WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb.chooseHost(nullptr).host);
+
+  // Pending requests are counted as well.
+  hostSet().healthy_hosts_[0]->notifyActiveRequestsChanged(0, 5);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0)).WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb.chooseHost(nullptr).host);
+
+  hostSet().healthy_hosts_[0]->notifyActiveRequestsChanged(-1, -5);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0)).WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb.chooseHost(nullptr).host);
+}
+
+TEST_P(LeastRequestLoadBalancerTest, ShardedRequestCountersFallBackToHostStats) {
+  envoy::extensions::load_balancing_policies::least_request::v3::LeastRequest lr_lb_config;
+  lr_lb_config.set_use_sharded_request_counters(true);
+  LeastRequestLoadBalancer lb{priority_set_, nullptr, stats_,       runtime_,
+                              random_,       50,      lr_lb_config, simTime()};
+
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                              makeTestHost(info_, "tcp://127.0.0.1:81")};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {});
+
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(2);
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(1);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0)).WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb.chooseHost(nullptr).host);
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
@@ -0,0 +1,216 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/core/v3/base.pb.h"
+
+#include "source/common/config/metadata.h"
+#include "source/common/config/well_known_names.h"
+#include "source/extensions/load_balancing_policies/subset/subset_metadata_index.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/upstream/cluster_info.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+class SubsetMetadataIndexTest : public testing::Test {
+protected:
+  void addSelector(const std::vector<std::string>& keys) {
+    Protobuf::RepeatedPtrField<std::string> selector_keys;
+    for (const auto& key : keys) {
+      selector_keys.Add(std::string(key));
+    }
+    selectors_.push_back(std::make_shared<SubsetSelector>(
+        selector_keys,
+        envoy::config::cluster::v3::Cluster::LbSubsetConfig::LbSubsetSelector::NOT_DEFINED,
+        Protobuf::RepeatedPtrField<std::string>(), false));
+  }
+
+  HostSharedPtr makeHost(const std::vector<std::pair<std::string, std::string>>& metadata) {
+    envoy::config::core::v3::Metadata m;
+    for (const auto& [key, value] : metadata) {
+      Config::Metadata::mutableMetadataValue(m, Config::MetadataFilters::get().ENVOY_LB, key)
+          .set_string_value(value);
+    }
+    return makeTestHost(info_, absl::StrCat("tcp://127.0.0.1:", port_++), m);
+  }
+
+  HostSharedPtr
+  makeListHost(const std::string& key, const std::vector<std::string>& values,
+               const std::vector<std::pair<std::string, std::string>>& metadata = {}) {
+    envoy::config::core::v3::Metadata m;
+    for (const auto& [k, v] : metadata) {
+      Config::Metadata::mutableMetadataValue(m, Config::MetadataFilters::get().ENVOY_LB, k)
+          .set_string_value(v);
+    }
+    auto& list =
+        Config::Metadata::mutableMetadataValue(m, Config::MetadataFilters::get().ENVOY_LB, key);
+    list.mutable_list_value();  // An empty list is still a list.
+    for (const auto& value : values) {
+      list.mutable_list_value()->add_values()->set_string_value(value);
+    }
+    return makeTestHost(info_, absl::StrCat("tcp://127.0.0.1:", port_++), m);
+  }
+
+  std::vector<uint32_t> rowsWithColumns(const SubsetMetadataIndex& index,
+                                        const std::vector<uint32_t>& columns) {
+    std::vector<uint32_t> rows;
+    index.forEachRowWithColumns(columns, [&rows](uint32_t row) { rows.push_back(row); });
+    return rows;
+  }
+
+  std::string stringValue(const SubsetMetadataIndex& index, uint32_t row, uint32_t column) {
+    auto values = index.values(row, column);
+    EXPECT_EQ(1, values.size());
+    return index.value(column, values[0]).value().string_value();
+  }
+
+  std::shared_ptr<testing::NiceMock<MockClusterInfo>> info_{
+      new testing::NiceMock<MockClusterInfo>()};
+  std::vector<SubsetSelectorPtr> selectors_;
+  uint32_t port_{80};
+};
+
+// Keys shared by several selectors map to a single column.
+TEST_F(SubsetMetadataIndexTest, SharedKeysShareColumns) {
+  addSelector({"version"});
+  addSelector({"stage", "version"});
+  SubsetMetadataIndex index(selectors_, false);
+
+  EXPECT_EQ(2, index.numColumns());
+  ASSERT_EQ(1, index.selectorColumns(0).size());
+  ASSERT_EQ(2, index.selectorColumns(1).size());
+  EXPECT_EQ("version", index.key(index.selectorColumns(0)[0]));
+  EXPECT_EQ("stage", index.key(index.selectorColumns(1)[0]));
+  EXPECT_EQ(index.selectorColumns(0)[0], index.selectorColumns(1)[1]);
+}
+
+TEST_F(SubsetMetadataIndexTest, RowsWithAllKeys) {
+  addSelector({"version"});
+  addSelector({"stage", "version"});
+  SubsetMetadataIndex index(selectors_, false);
+
+  HostVector hosts = {
+      makeHost({{"version", "1.0"}}),
+      makeHost({{"version", "1.1"}, {"stage", "prod"}}),
+      makeHost({{"stage", "dev"}}),
+      makeTestHost(info_, "tcp://127.0.0.1:1"),
+      makeHost({{"version", "1.0"}, {"stage", "dev"}}),
+  };
+  index.build(0, hosts);
+
+  EXPECT_EQ(5, index.numRows());
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 4}), rowsWithColumns(index, index.selectorColumns(0)));
+  EXPECT_EQ(std::vector<uint32_t>({1, 4}), rowsWithColumns(index, index.selectorColumns(1)));
+
+  const uint32_t version = index.selectorColumns(0)[0];
+  EXPECT_EQ("1.0", stringValue(index, 0, version));
+  EXPECT_EQ("1.1", stringValue(index, 1, version));
+  EXPECT_EQ("1.0", stringValue(index, 4, version));
+  // Equal values are interned to the same id.
+  EXPECT_EQ(index.values(0, version)[0], index.values(4, version)[0]);
+  EXPECT_TRUE(index.values(2, version).empty());
+  EXPECT_TRUE(index.values(3, version).empty());
+}
+
+// The bitsets span more than one word.
+TEST_F(SubsetMetadataIndexTest, ManyRows) {
+  addSelector({"version"});
+  SubsetMetadataIndex index(selectors_, false);
+
+  HostVector hosts;
+  std::vector<uint32_t> expected;
+  for (uint32_t i = 0; i < 200; ++i) {
+    if (i % 3 == 0) {
+      expected.push_back(i);
+      hosts.push_back(makeHost({{"version", absl::StrCat(i % 5)}}));
+    } else {
+      hosts.push_back(makeHost({{"stage", "prod"}}));
+    }
+  }
+  index.build(0, hosts);
+
+  EXPECT_EQ(expected, rowsWithColumns(index, index.selectorColumns(0)));
+}
+
+TEST_F(SubsetMetadataIndexTest, ListAsAny) {
+  addSelector({"stage", "version"});
+  SubsetMetadataIndex index(selectors_, true);
+
+  HostVector hosts = {
+      makeListHost("version", {"1.0", "1.1"}, {{"stage", "prod"}}),
+      makeListHost("stage", {}, {{"version", "1.0"}}),
+  };
+  index.build(0, hosts);
+
+  const auto& columns = index.selectorColumns(0);
+  // An empty list is the same as a missing key.
+  EXPECT_EQ(std::vector<uint32_t>({0}), rowsWithColumns(index, columns));
+
+  std::vector<std::string> combinations;
+  index.forEachValueCombination(0, columns, [&](const std::vector<uint32_t>& value_ids) {
+    combinations.push_back(
+        absl::StrCat(index.value(columns[0], value_ids[0]).value().string_value(), "/",
+                     index.value(columns[1], value_ids[1]).value().string_value()));
+  });
+  EXPECT_THAT(combinations, testing::ElementsAre("prod/1.0", "prod/1.1"));
+}
+
+// Rows are cached by metadata identity: hosts keeping their metadata are not re-extracted, and
+// hosts whose metadata was replaced are.
+TEST_F(SubsetMetadataIndexTest, RebuildAfterMetadataUpdate) {
+  addSelector({"version"});
+  SubsetMetadataIndex index(selectors_, false);
+
+  HostVector hosts = {makeHost({{"version", "1.0"}}), makeHost({{"version", "1.0"}})};
+  index.build(0, hosts);
+  const uint32_t version = index.selectorColumns(0)[0];
+  EXPECT_EQ(std::vector<uint32_t>({0, 1}), rowsWithColumns(index, {version}));
+
+  envoy::config::core::v3::Metadata m;
+  Config::Metadata::mutableMetadataValue(m, Config::MetadataFilters::get().ENVOY_LB, "stage")
+      .set_string_value("prod");
+  hosts[1]->metadata(std::make_shared<envoy::config::core::v3::Metadata>(m));
+  hosts.push_back(makeHost({{"version", "2.0"}}));
+  index.build(0, hosts);
+
+  EXPECT_EQ(std::vector<uint32_t>({0, 2}), rowsWithColumns(index, {version}));
+  EXPECT_EQ("1.0", stringValue(index, 0, version));
+  EXPECT_EQ("2.0", stringValue(index, 2, version));
+
+  // Other priorities are independent.
+  index.build(1, {makeHost({{"stage", "dev"}})});
+  EXPECT_TRUE(rowsWithColumns(index, {version}).empty());
+  index.build(0, hosts);
+  EXPECT_EQ(std::vector<uint32_t>({0, 2}), rowsWithColumns(index, {version}));
+}
+
+// Interned values are dropped once there are many more than after the last reset, and the rows
+// are re-extracted against the new dictionaries.
+TEST_F(SubsetMetadataIndexTest, DictionaryReset) {
+  addSelector({"version"});
+  SubsetMetadataIndex index(selectors_, false);
+  const uint32_t version = index.selectorColumns(0)[0];
+
+  HostSharedPtr stable = makeHost({{"version", "stable"}});
+  for (uint32_t round = 0; round < 4; ++round) {
+    HostVector hosts = {stable};
+    for (uint32_t i = 0; i < 600; ++i) {
+      hosts.push_back(makeHost({{"version", absl::StrCat(round, ".", i)}}));
+    }
+    index.build(0, hosts);
+
+    EXPECT_EQ(601, rowsWithColumns(index, {version}).size());
+    EXPECT_EQ("stable", stringValue(index, 0, version));
+    EXPECT_EQ(absl::StrCat(round, ".599"), stringValue(index, 600, version));
+  }
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
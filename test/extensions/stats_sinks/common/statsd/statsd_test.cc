@@ -122,6 +122,37 @@ TEST_F(TcpStatsdSinkTest, BasicFlow) {
   tls_.shutdownThread();
 }
 
+TEST_F(TcpStatsdSinkTest, HostGaugesFlushedOnce) {
+  InSequence s;
+  NiceMock<Stats::MockGauge> gauge_1;
+  gauge_1.name_ = "test_gauge_1";
+  gauge_1.value_ = 1;
+  gauge_1.used_ = true;
+  snapshot_.gauges_.push_back(gauge_1);
+
+  NiceMock<Stats::MockGauge> gauge_2;
+  gauge_2.name_ = "test_gauge_2";
+  gauge_2.value_ = 2;
+  gauge_2.used_ = true;
+  snapshot_.gauges_.push_back(gauge_2);
+
+  Stats::PrimitiveGauge host_gauge;
+  host_gauge.add(4);
+  Stats::PrimitiveGaugeSnapshot host_gauge_snap(host_gauge);
+  host_gauge_snap.setName("test_host_gauge");
+  snapshot_.host_gauges_.push_back(host_gauge_snap);
+
+  expectCreateConnection();
+  EXPECT_CALL(*connection_, write(BufferString("envoy.test_gauge_1:1|g\n"
+                                               "envoy.test_gauge_2:2|g\n"
+                                               "envoy.test_host_gauge:4|g\n"),
+                                  _));
+  sink_->flush(snapshot_);
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::NoFlush));
+  tls_.shutdownThread();
+}
+
 TEST_F(TcpStatsdSinkTest, SiSuffix) {
   InSequence s;
   expectCreateConnection();
@@ -10,17 +10,22 @@
 #include "source/extensions/stat_sinks/common/statsd/statsd.h"
 #include "source/extensions/stat_sinks/common/statsd/tag_formats.h"
 
+#include "test/mocks/api/mocks.h"
 #include "test/mocks/stats/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "spdlog/spdlog.h"
 
+using testing::_;
+using testing::InSequence;
 using testing::NiceMock;
+using testing::Return;
 
 namespace Envoy {
 namespace Extensions {
@@ -32,17 +37,29 @@ namespace {
 class MockWriter : public UdpStatsdSink::Writer {
 public:
   MOCK_METHOD(void, write, (const std::string& message));
-  MOCK_METHOD(void, writeBuffer, (Buffer::Instance & buffer));
 
   void delegateBufferFake() {
-    ON_CALL(*this, writeBuffer).WillByDefault([this](Buffer::Instance& buffer) {
-      this->buffer_writes.push_back(buffer.toString());
+    ON_CALL(*this, write).WillByDefault([this](const std::string& message) {
+      this->buffer_writes.push_back(message);
     });
   }
 
   std::vector<std::string> buffer_writes;
 };
 
+// Records the number of datagrams of each batch handed to the writer.
+class BatchRecordingWriter : public UdpStatsdSink::Writer {
+public:
+  void write(const std::string& message) override { messages_.push_back(message); }
+  void writeDatagrams(absl::Span<const std::string> messages) override {
+    batch_sizes_.push_back(messages.size());
+    UdpStatsdSink::Writer::writeDatagrams(messages);
+  }
+
+  std::vector<std::string> messages_;
+  std::vector<size_t> batch_sizes_;
+};
+
 // Skipping this test as Datagram sockets are not currently supported by UDS on Windows
 #ifndef WIN32
 // Regression test for https://github.com/envoyproxy/envoy/issues/8911
@@ -229,7 +246,7 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
   counter.latch_ = 1;
   snapshot.counters_.push_back({1, counter});
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), write(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter:1|c");
@@ -241,7 +258,7 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
   gauge.used_ = true;
   snapshot.gauges_.push_back(gauge);
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), write(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 2);
   EXPECT_EQ(writer_ptr->buffer_writes.at(1), "envoy.test_gauge:1|g");
@@ -310,7 +327,7 @@ TEST(UdpStatsdSinkTest, CheckBufferedWritesWithinBufferSize) {
   snapshot.gauges_.push_back(gauge);
 
   // Expect both metrics to be present in single write
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), write(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter:1|c\nenvoy.test_gauge:1|g");
@@ -345,7 +362,7 @@ TEST(UdpStatsdSinkTest, CheckBufferedWritesExceedingBufferSize) {
   snapshot.gauges_.push_back(gauge);
 
   // Expect both metrics to be present in single write
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_))
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), write(_))
       .Times(2);
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 2);
@@ -355,6 +372,72 @@ TEST(UdpStatsdSinkTest, CheckBufferedWritesExceedingBufferSize) {
   tls_.shutdownThread();
 }
 
+TEST(UdpStatsdSinkTest, DatagramsWrittenInBatches) {
+  NiceMock<Stats::MockMetricSnapshot> snapshot;
+  auto writer_ptr = std::make_shared<BatchRecordingWriter>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  const size_t num_counters = 2 * UdpStatsdSink::MaxDatagramsPerWrite + 1;
+  std::vector<std::unique_ptr<NiceMock<Stats::MockCounter>>> counters;
+  for (size_t i = 0; i < num_counters; ++i) {
+    counters.push_back(std::make_unique<NiceMock<Stats::MockCounter>>());
+    counters.back()->name_ = absl::StrCat("counter_", i);
+    counters.back()->used_ = true;
+    counters.back()->latch_ = 1;
+    snapshot.counters_.push_back({1, *counters.back()});
+  }
+  UdpStatsdSink sink(tls_, writer_ptr, false);
+
+  sink.flush(snapshot);
+  EXPECT_EQ(std::vector<size_t>({UdpStatsdSink::MaxDatagramsPerWrite,
+                                 UdpStatsdSink::MaxDatagramsPerWrite, 1}),
+            writer_ptr->batch_sizes_);
+  ASSERT_EQ(num_counters, writer_ptr->messages_.size());
+  EXPECT_EQ("envoy.counter_0:1|c", writer_ptr->messages_.front());
+  EXPECT_EQ(absl::StrCat("envoy.counter_", num_counters - 1, ":1|c"),
+            writer_ptr->messages_.back());
+
+  tls_.shutdownThread();
+}
+
+// A datagram whose sendmmsg() fails is dropped, and the following ones are still sent.
+TEST(UdpStatsdSinkTest, SendmmsgFailureDropsDatagram) {
+  NiceMock<Stats::MockMetricSnapshot> snapshot;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Network::Address::InstanceConstSharedPtr address =
+      Network::Utility::parseInternetAddressNoThrow("127.0.0.1", 8125);
+  std::vector<std::unique_ptr<NiceMock<Stats::MockCounter>>> counters;
+  for (size_t i = 0; i < 3; ++i) {
+    counters.push_back(std::make_unique<NiceMock<Stats::MockCounter>>());
+    counters.back()->name_ = absl::StrCat("counter_", i);
+    counters.back()->used_ = true;
+    counters.back()->latch_ = 1;
+    snapshot.counters_.push_back({1, *counters.back()});
+  }
+  UdpStatsdSink sink(tls_, address, false);
+
+  {
+    NiceMock<Api::MockOsSysCalls> os_sys_calls;
+    TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+    ON_CALL(os_sys_calls, supportsMmsg()).WillByDefault(Return(true));
+    InSequence s;
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 3, _))
+        .WillOnce(Return(Api::SysCallIntResult{1, 0}));
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 2, _))
+        .WillOnce(Return(Api::SysCallIntResult{-1, SOCKET_ERROR_INTR}))
+        .WillOnce(Return(Api::SysCallIntResult{-1, SOCKET_ERROR_AGAIN}));
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 1, _))
+        .WillOnce([](os_fd_t, struct mmsghdr* msgvec, unsigned int, int) {
+          const struct iovec& iov = msgvec[0].msg_hdr.msg_iov[0];
+          EXPECT_EQ("envoy.counter_2:1|c",
+                    absl::string_view(static_cast<const char*>(iov.iov_base), iov.iov_len));
+          return Api::SysCallIntResult{1, 0};
+        });
+    sink.flush(snapshot);
+  }
+
+  tls_.shutdownThread();
+}
+
 TEST(UdpStatsdSinkTest, CheckActualStatsWithCustomPrefix) {
   NiceMock<Stats::MockMetricSnapshot> snapshot;
   auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
@@ -368,7 +451,7 @@ TEST(UdpStatsdSinkTest, CheckActualStatsWithCustomPrefix) {
   counter.latch_ = 1;
   snapshot.counters_.push_back({1, counter});
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), write(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "test_prefix.test_counter:1|c");
@@ -450,7 +533,7 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   counter.setTags(tags);
   snapshot.counters_.push_back({1, counter});
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), write(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter:1|c|#key1:value1,key2:value2");
@@ -463,7 +546,7 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   gauge.setTags(tags);
   snapshot.gauges_.push_back(gauge);
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), write(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 2);
   EXPECT_EQ(writer_ptr->buffer_writes.at(1), "envoy.test_gauge:1|g|#key1:value1,key2:value2");
@@ -525,6 +608,39 @@ TEST(UdpStatsdSinkWithTagsTest, SiSuffix) {
   tls_.shutdownThread();
 }
 
+// The rendered names and tags are reused until a flush doesn't include the metric.
+TEST(UdpStatsdSinkWithTagsTest, RenderedNamesCachedWhileFlushed) {
+  NiceMock<Stats::MockMetricSnapshot> snapshot;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  writer_ptr->delegateBufferFake();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, writer_ptr, true);
+
+  NiceMock<Stats::MockCounter> counter;
+  counter.name_ = "test_counter";
+  counter.used_ = true;
+  counter.latch_ = 1;
+  counter.setTags(std::vector<Stats::Tag>{Stats::Tag{"key1", "value1"}});
+  snapshot.counters_.push_back({1, counter});
+
+  sink.flush(snapshot);
+  counter.setTags(std::vector<Stats::Tag>{Stats::Tag{"key1", "value2"}});
+  sink.flush(snapshot);
+
+  // Not part of this flush, so the rendering is dropped.
+  counter.used_ = false;
+  sink.flush(snapshot);
+  counter.used_ = true;
+  sink.flush(snapshot);
+
+  EXPECT_EQ(std::vector<std::string>({"envoy.test_counter:1|c|#key1:value1",
+                                      "envoy.test_counter:1|c|#key1:value1",
+                                      "envoy.test_counter:1|c|#key1:value2"}),
+            writer_ptr->buffer_writes);
+
+  tls_.shutdownThread();
+}
+
 TEST(UdpStatsdSinkWithTagsTest, GraphiteTagSyntax) {
   NiceMock<Stats::MockMetricSnapshot> snapshot;
   auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
@@ -540,7 +656,7 @@ TEST(UdpStatsdSinkWithTagsTest, GraphiteTagSyntax) {
   counter.setTags(tags);
   snapshot.counters_.push_back({1, counter});
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), write(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter;key1=value1;key2=value2:1|c");
@@ -553,7 +669,7 @@ TEST(UdpStatsdSinkWithTagsTest, GraphiteTagSyntax) {
   gauge.setTags(tags);
   snapshot.gauges_.push_back(gauge);
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), write(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 2);
   EXPECT_EQ(writer_ptr->buffer_writes.at(1), "envoy.test_gauge;key1=value1;key2=value2:1|g");
@@ -0,0 +1,340 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/transport_sockets/tls/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+#include "envoy/ssl/private_key/private_key_config.h"
+
+#include "source/extensions/transport_sockets/tls/private_key_providers/thread_pool/config.h"
+#include "source/extensions/transport_sockets/tls/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+#include "test/mocks/server/server_factory_context.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/ssl.h"
+
+using envoy::extensions::transport_sockets::tls::private_key_providers::thread_pool::v3::
+    ThreadPoolPrivateKeyMethodConfig;
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+namespace {
+
+class MockPrivateKeyConnectionCallbacks : public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  MOCK_METHOD(void, onPrivateKeyMethodComplete, ());
+};
+
+// Starts the signing threads only once released, so that the tests control when the queue drains.
+class GatedThreadFactory : public Thread::ThreadFactory {
+public:
+  Thread::ThreadPtr createThread(std::function<void()> thread_routine,
+                                 Thread::OptionsOptConstRef options) override {
+    threads_created_++;
+    return Thread::threadFactoryForTest().createThread(
+        [this, thread_routine]() {
+          released_.WaitForNotification();
+          thread_routine();
+        },
+        options);
+  }
+  Thread::ThreadId currentThreadId() const override {
+    return Thread::threadFactoryForTest().currentThreadId();
+  }
+
+  void release() {
+    if (!released_.HasBeenNotified()) {
+      released_.Notify();
+    }
+  }
+
+  uint32_t threadsCreated() const { return threads_created_; }
+
+private:
+  absl::Notification released_;
+  uint32_t threads_created_{};
+};
+
+class ThreadPoolPrivateKeyProviderTest : public testing::Test {
+protected:
+  ThreadPoolPrivateKeyProviderTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        ssl_ctx_(SSL_CTX_new(TLS_method())) {
+    ON_CALL(factory_context_.server_context_.api_, threadFactory())
+        .WillByDefault(ReturnRef(thread_factory_));
+  }
+
+  ~ThreadPoolPrivateKeyProviderTest() override {
+    thread_factory_.release();
+    for (auto& ssl : ssls_) {
+      if (provider_ != nullptr) {
+        provider_->unregisterPrivateKeyMethod(ssl.get());
+      }
+    }
+  }
+
+  void createProvider(const std::string& key_file, uint32_t max_queued_operations = 0,
+                      ThreadPoolPrivateKeyMethodConfig::OverflowAction overflow_action =
+                          ThreadPoolPrivateKeyMethodConfig::RUN_INLINE,
+                      uint32_t thread_count = 2) {
+    ThreadPoolPrivateKeyMethodConfig config;
+    config.mutable_private_key()->set_inline_string(readKey(key_file));
+    config.set_thread_count(thread_count);
+    if (max_queued_operations > 0) {
+      config.mutable_max_queued_operations()->set_value(max_queued_operations);
+    }
+    config.set_overflow_action(overflow_action);
+    envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider provider_config;
+    provider_config.set_provider_name("envoy.tls.key_providers.thread_pool");
+    provider_config.mutable_typed_config()->PackFrom(config);
+
+    auto* factory =
+        Registry::FactoryRegistry<Ssl::PrivateKeyMethodProviderInstanceFactory>::getFactory(
+            provider_config.provider_name());
+    ASSERT_NE(nullptr, factory);
+    provider_ = std::dynamic_pointer_cast<ThreadPoolPrivateKeyMethodProvider>(
+        factory->createPrivateKeyMethodProviderInstance(provider_config, factory_context_));
+    ASSERT_NE(nullptr, provider_);
+    method_ = provider_->getBoringSslPrivateKeyMethod();
+  }
+
+  static std::string readKey(const std::string& key_file) {
+    return TestEnvironment::readFileToStringForTest(
+        TestEnvironment::substitute("{{ test_rundir }}/test/common/tls/test_data/" + key_file));
+  }
+
+  SSL* newConnection(MockPrivateKeyConnectionCallbacks& cb) {
+    ssls_.emplace_back(SSL_new(ssl_ctx_.get()));
+    provider_->registerPrivateKeyMethod(ssls_.back().get(), cb, *dispatcher_);
+    return ssls_.back().get();
+  }
+
+  // Runs the dispatcher until the operation of the connection completes.
+  void waitForCompletion(MockPrivateKeyConnectionCallbacks& cb) {
+    EXPECT_CALL(cb, onPrivateKeyMethodComplete()).WillOnce([this]() { dispatcher_->exit(); });
+    dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  }
+
+  ssl_private_key_result_t sign(SSL* ssl, uint16_t signature_algorithm) {
+    out_.resize(1024);
+    return method_->sign(ssl, out_.data(), &out_len_, out_.size(), signature_algorithm,
+                         reinterpret_cast<const uint8_t*>(message_.data()), message_.size());
+  }
+
+  ssl_private_key_result_t complete(SSL* ssl) {
+    out_.resize(1024);
+    return method_->complete(ssl, out_.data(), &out_len_, out_.size());
+  }
+
+  bool verify(uint16_t signature_algorithm, const std::string& key_file) {
+    const std::string pem = readKey(key_file);
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(pem.data(), pem.size()));
+    bssl::UniquePtr<EVP_PKEY> pkey(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx;
+    if (!EVP_DigestVerifyInit(ctx.get(), &pctx,
+                              SSL_get_signature_algorithm_digest(signature_algorithm), nullptr,
+                              pkey.get())) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1))) {
+      return false;
+    }
+    return EVP_DigestVerify(ctx.get(), out_.data(), out_len_,
+                            reinterpret_cast<const uint8_t*>(message_.data()), message_.size());
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(factory_context_.store_,
+                                    "thread_pool_private_key_provider." + name)
+        ->value();
+  }
+
+  uint64_t queueDepth() {
+    return TestUtility::findGauge(factory_context_.store_,
+                                  "thread_pool_private_key_provider.queue_depth")
+        ->value();
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  GatedThreadFactory thread_factory_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  std::shared_ptr<ThreadPoolPrivateKeyMethodProvider> provider_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  std::vector<bssl::UniquePtr<SSL>> ssls_;
+  const std::string message_{"message signed during the handshake"};
+  std::vector<uint8_t> out_;
+  size_t out_len_{};
+};
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, RsaSignOffloaded) {
+  createProvider("selfsigned_key.pem");
+  EXPECT_TRUE(provider_->isAvailable());
+  NiceMock<MockPrivateKeyConnectionCallbacks> cb;
+  SSL* ssl = newConnection(cb);
+
+  EXPECT_EQ(ssl_private_key_retry, sign(ssl, SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  EXPECT_EQ(1, counter("offloaded"));
+  thread_factory_.release();
+  waitForCompletion(cb);
+  EXPECT_EQ(ssl_private_key_success, complete(ssl));
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PSS_RSAE_SHA256, "selfsigned_key.pem"));
+  EXPECT_EQ(0, queueDepth());
+
+  // The connection can run another operation once the first one is consumed.
+  EXPECT_EQ(ssl_private_key_retry, sign(ssl, SSL_SIGN_RSA_PKCS1_SHA256));
+  waitForCompletion(cb);
+  EXPECT_EQ(ssl_private_key_success, complete(ssl));
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PKCS1_SHA256, "selfsigned_key.pem"));
+  EXPECT_EQ(2, counter("offloaded"));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, EcdsaSignOffloaded) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  NiceMock<MockPrivateKeyConnectionCallbacks> cb;
+  SSL* ssl = newConnection(cb);
+
+  EXPECT_EQ(ssl_private_key_retry, sign(ssl, SSL_SIGN_ECDSA_SECP256R1_SHA256));
+  EXPECT_EQ(ssl_private_key_retry, complete(ssl));
+  thread_factory_.release();
+  waitForCompletion(cb);
+  EXPECT_EQ(ssl_private_key_success, complete(ssl));
+  EXPECT_TRUE(verify(SSL_SIGN_ECDSA_SECP256R1_SHA256, "selfsigned_ecdsa_p256_key.pem"));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, SignWithWrongKeyTypeFails) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  NiceMock<MockPrivateKeyConnectionCallbacks> cb;
+  SSL* ssl = newConnection(cb);
+
+  EXPECT_EQ(ssl_private_key_retry, sign(ssl, SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  thread_factory_.release();
+  waitForCompletion(cb);
+  EXPECT_EQ(ssl_private_key_failure, complete(ssl));
+  EXPECT_EQ(1, counter("failed"));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, QueueFullRunsInline) {
+  createProvider("selfsigned_key.pem", 1);
+  NiceMock<MockPrivateKeyConnectionCallbacks> queued_cb;
+  NiceMock<MockPrivateKeyConnectionCallbacks> inline_cb;
+  SSL* queued = newConnection(queued_cb);
+  SSL* inline_ssl = newConnection(inline_cb);
+
+  EXPECT_EQ(ssl_private_key_retry, sign(queued, SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  EXPECT_EQ(1, queueDepth());
+  EXPECT_CALL(inline_cb, onPrivateKeyMethodComplete()).Times(0);
+  EXPECT_EQ(ssl_private_key_success, sign(inline_ssl, SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PSS_RSAE_SHA256, "selfsigned_key.pem"));
+  EXPECT_EQ(1, counter("ran_inline"));
+  EXPECT_EQ(0, counter("rejected"));
+
+  thread_factory_.release();
+  waitForCompletion(queued_cb);
+  EXPECT_EQ(ssl_private_key_success, complete(queued));
+  EXPECT_EQ(0, queueDepth());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, QueueFullFailsHandshake) {
+  createProvider("selfsigned_key.pem", 1, ThreadPoolPrivateKeyMethodConfig::FAIL_HANDSHAKE);
+  NiceMock<MockPrivateKeyConnectionCallbacks> queued_cb;
+  NiceMock<MockPrivateKeyConnectionCallbacks> rejected_cb;
+  SSL* queued = newConnection(queued_cb);
+  SSL* rejected = newConnection(rejected_cb);
+
+  EXPECT_EQ(ssl_private_key_retry, sign(queued, SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  EXPECT_EQ(ssl_private_key_failure, sign(rejected, SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  EXPECT_EQ(1, counter("rejected"));
+  EXPECT_EQ(0, counter("ran_inline"));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, ClosedConnectionNotResumed) {
+  createProvider("selfsigned_key.pem");
+  MockPrivateKeyConnectionCallbacks cb;
+  SSL* ssl = newConnection(cb);
+
+  EXPECT_EQ(ssl_private_key_retry, sign(ssl, SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  provider_->unregisterPrivateKeyMethod(ssl);
+  ssls_.pop_back();
+
+  // The signing threads skip or complete the operation without resuming the connection.
+  EXPECT_CALL(cb, onPrivateKeyMethodComplete()).Times(0);
+  thread_factory_.release();
+  provider_.reset();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, ProvidersShareSigningThreads) {
+  createProvider("selfsigned_key.pem");
+  auto first = provider_;
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  EXPECT_EQ(2, thread_factory_.threadsCreated());
+
+  // Providers configured with another number of threads get their own pool.
+  createProvider("selfsigned_key.pem", 0, ThreadPoolPrivateKeyMethodConfig::RUN_INLINE, 1);
+  EXPECT_EQ(3, thread_factory_.threadsCreated());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, QueueBoundPerProvider) {
+  createProvider("selfsigned_key.pem", 1, ThreadPoolPrivateKeyMethodConfig::FAIL_HANDSHAKE);
+  auto first = provider_;
+  MockPrivateKeyConnectionCallbacks first_cb;
+  SSL* first_ssl = newConnection(first_cb);
+  EXPECT_EQ(ssl_private_key_retry, sign(first_ssl, SSL_SIGN_RSA_PSS_RSAE_SHA256));
+
+  // The operation queued by the first provider does not count against the second one.
+  createProvider("selfsigned_key.pem", 1, ThreadPoolPrivateKeyMethodConfig::FAIL_HANDSHAKE);
+  NiceMock<MockPrivateKeyConnectionCallbacks> cb;
+  SSL* ssl = newConnection(cb);
+  EXPECT_EQ(ssl_private_key_retry, sign(ssl, SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  EXPECT_EQ(2, queueDepth());
+  EXPECT_EQ(0, counter("rejected"));
+
+  // Destroying the first provider drops its operation and leaves the other one queued.
+  first->unregisterPrivateKeyMethod(first_ssl);
+  ssls_.erase(ssls_.begin());
+  EXPECT_CALL(first_cb, onPrivateKeyMethodComplete()).Times(0);
+  first.reset();
+  EXPECT_EQ(1, queueDepth());
+
+  thread_factory_.release();
+  waitForCompletion(cb);
+  EXPECT_EQ(ssl_private_key_success, complete(ssl));
+  EXPECT_EQ(0, queueDepth());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, RegisterTwiceThrows) {
+  createProvider("selfsigned_key.pem");
+  NiceMock<MockPrivateKeyConnectionCallbacks> cb;
+  SSL* ssl = newConnection(cb);
+  EXPECT_THROW_WITH_MESSAGE(provider_->registerPrivateKeyMethod(ssl, cb, *dispatcher_),
+                            EnvoyException,
+                            "Registering the thread pool private key provider twice for the same "
+                            "SSL object is not supported.");
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, InvalidPrivateKey) {
+  EXPECT_THROW_WITH_MESSAGE(createProvider("selfsigned_cert.pem"), EnvoyException,
+                            "Failed to read private key.");
+}
+
+} // namespace
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
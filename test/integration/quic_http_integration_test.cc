@@ -282,6 +282,12 @@ TEST_P(QuicHttpIntegrationTest, MultipleQuicConnectionsNoBPF) {
 
   DisableBpf disable;
   testMultipleQuicConnections();
+  // Without kernel routing, the connections the kernel hashed to another worker are forwarded.
+  const std::string listener_prefix =
+      version_ == Network::Address::IpVersion::v4 ? "listener.127.0.0.1_0" : "listener.[__1]_0";
+  EXPECT_LT(0u, test_server_->counter(absl::StrCat(listener_prefix,
+                                                   ".quic.downstream_rx_packets_forwarded"))
+                    ->value());
 }
 
 TEST_P(QuicHttpMultiAddressesIntegrationTest, MultipleQuicConnectionsNoBPF) {
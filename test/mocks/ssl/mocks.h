@@ -132,6 +132,7 @@ public:
   MOCK_METHOD(const Network::Address::IpList&, tlsKeyLogRemote, (), (const));
   MOCK_METHOD(const std::string&, tlsKeyLogPath, (), (const));
   MOCK_METHOD(AccessLog::AccessLogManager&, accessLogManager, (), (const));
+  MOCK_METHOD(bool, kernelTlsOffload, (), (const));
   MOCK_METHOD(
       std::optional<envoy::extensions::transport_sockets::tls::v3::TlsParameters::CompliancePolicy>,
       compliancePolicy, (), (const));
@@ -180,6 +181,7 @@ public:
   MOCK_METHOD(const Network::Address::IpList&, tlsKeyLogRemote, (), (const));
   MOCK_METHOD(const std::string&, tlsKeyLogPath, (), (const));
   MOCK_METHOD(AccessLog::AccessLogManager&, accessLogManager, (), (const));
+  MOCK_METHOD(bool, kernelTlsOffload, (), (const));
   MOCK_METHOD(bool, fullScanCertsOnSNIMismatch, (), (const));
   MOCK_METHOD(
       std::optional<envoy::extensions::transport_sockets::tls::v3::TlsParameters::CompliancePolicy>,
@@ -114,6 +114,9 @@ public:
   MOCK_METHOD(const std::optional<std::chrono::milliseconds>, grpcTimeoutHeaderOffset, (), (const));
   MOCK_METHOD(float, perUpstreamPreconnectRatio, (), (const));
   MOCK_METHOD(float, peekaheadRatio, (), (const));
+  MOCK_METHOD(std::optional<std::chrono::milliseconds>, demandPreconnectTimeConstant, (),
+              (const));
+  MOCK_METHOD(uint32_t, warmConnections, (), (const));
   MOCK_METHOD(bool, shouldPreconnect, (const Host& host), (const));
   MOCK_METHOD(uint32_t, perConnectionBufferLimitBytes, (), (const));
   MOCK_METHOD(std::chrono::milliseconds, perConnectionBufferHighWatermarkTimeout, (), (const));
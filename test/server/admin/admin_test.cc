@@ -184,7 +184,15 @@ TEST_P(AdminInstanceTest, Help) {
   /reset_counters (POST): reset all counters to zero
   /runtime: print runtime values
   /runtime_modify (POST): Adds or modifies runtime values as passed in query parameters. To delete a previously added key, use an empty string as the value. Note that deletion only applies to overrides added via this endpoint; values loaded from disk can be modified via override but not deleted. E.g. ?key1=value1&key2=value2...
+  /scope_profile: dump the samples of the scope profiler
+  /scopeprofiler (POST): enable/disable the sampling profiler attributing CPU time to the listeners, filter chains, routes and clusters
+      enable: enable/disable the scope profiler; One of (y, n)
+      interval_ms: CPU time between samples, in milliseconds. Defaults to 10.
   /server_info: print server version/status information
+  /slow_callbacks: dump the slowest event loop callbacks of each thread
+  /slowcallbacks (POST): enable/disable the recording of the slowest event loop callbacks of each thread, with the connection or stream they worked on
+      enable: enable/disable the slow callback recording; One of (y, n)
+      threshold_ms: Minimum duration of the recorded callbacks, in milliseconds. Defaults to 10.
   /stats: print server stats
       usedonly: Only include stats that have been written by system since restart
       filter: Regular expression (Google re2) for filtering stats
@@ -198,6 +206,8 @@ TEST_P(AdminInstanceTest, Help) {
       filter: Regular expression (Google re2) for filtering stats
       invert_filter: Invert the filter regex
       histogram_buckets: Histogram bucket display mode; One of (cumulative, summary)
+      changedonly: Only include the counters and gauges that changed since the previous scrape with the same scraper_id
+      scraper_id: Identifies the scraper for changedonly
   /stats/recentlookups: Show recent stat-name lookups
   /stats/recentlookups/clear (POST): clear list of stat-name lookups and counter
   /stats/recentlookups/disable (POST): disable recording of reset stat-name lookup names
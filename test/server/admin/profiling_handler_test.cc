@@ -1,4 +1,6 @@
+#include "source/common/event/slow_callback_tracker.h"
 #include "source/common/profiler/profiler.h"
+#include "source/common/profiler/scope_profiler.h"
 
 #include "test/server/admin/admin_instance.h"
 #include "test/test_common/logging.h"
@@ -119,5 +121,64 @@ TEST_P(AdminInstanceTest, AdminAllocationDump) {
 #endif
 }
 
+TEST_P(AdminInstanceTest, AdminScopeProfiler) {
+  Buffer::OwnedImpl data;
+  Http::TestResponseHeaderMapImpl header_map;
+
+  EXPECT_EQ(Http::Code::BadRequest, postCallback("/scopeprofiler", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest,
+            postCallback("/scopeprofiler?enable=y&interval_ms=0", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest,
+            postCallback("/scopeprofiler?enable=y&other=1", header_map, data));
+  EXPECT_FALSE(Profiler::ScopeProfiler::running());
+
+#ifdef WIN32
+  EXPECT_EQ(Http::Code::NotImplemented,
+            postCallback("/scopeprofiler?enable=y", header_map, data));
+#else
+  EXPECT_EQ(Http::Code::OK,
+            postCallback("/scopeprofiler?enable=y&interval_ms=1", header_map, data));
+  EXPECT_TRUE(Profiler::ScopeProfiler::running());
+  EXPECT_EQ(Http::Code::BadRequest, postCallback("/scopeprofiler?enable=y", header_map, data));
+  // The CPU profiler cannot run at the same time, as both sample with SIGPROF.
+  EXPECT_EQ(Http::Code::BadRequest, postCallback("/cpuprofiler?enable=y", header_map, data));
+  EXPECT_FALSE(Profiler::Cpu::profilerEnabled());
+
+  Profiler::ScopeProfiler::onSample();
+  Buffer::OwnedImpl profile;
+  EXPECT_EQ(Http::Code::OK, getCallback("/scope_profile", header_map, profile));
+  EXPECT_THAT(profile.toString(), testing::HasSubstr("unscoped "));
+#endif
+
+  EXPECT_EQ(Http::Code::OK, postCallback("/scopeprofiler?enable=n", header_map, data));
+  EXPECT_FALSE(Profiler::ScopeProfiler::running());
+}
+
+TEST_P(AdminInstanceTest, AdminSlowCallbacks) {
+  Buffer::OwnedImpl data;
+  Http::TestResponseHeaderMapImpl header_map;
+
+  EXPECT_EQ(Http::Code::BadRequest, postCallback("/slowcallbacks", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest,
+            postCallback("/slowcallbacks?enable=y&threshold_ms=-1", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest,
+            postCallback("/slowcallbacks?enable=y&other=1", header_map, data));
+  EXPECT_FALSE(Event::SlowCallbackTracker::enabled());
+
+  EXPECT_EQ(Http::Code::OK,
+            postCallback("/slowcallbacks?enable=y&threshold_ms=50", header_map, data));
+  EXPECT_TRUE(Event::SlowCallbackTracker::enabled());
+  EXPECT_EQ(std::chrono::milliseconds(50), Event::SlowCallbackTracker::threshold());
+
+  Event::SlowCallbackTracker::record("worker_0",
+                                     {std::chrono::microseconds(52000), "timer", "  stream\n"});
+  Buffer::OwnedImpl slow_callbacks;
+  EXPECT_EQ(Http::Code::OK, getCallback("/slow_callbacks", header_map, slow_callbacks));
+  EXPECT_EQ("worker_0 52000us timer\n  stream\n", slow_callbacks.toString());
+
+  EXPECT_EQ(Http::Code::OK, postCallback("/slowcallbacks?enable=n", header_map, data));
+  EXPECT_FALSE(Event::SlowCallbackTracker::enabled());
+}
+
 } // namespace Server
 } // namespace Envoy
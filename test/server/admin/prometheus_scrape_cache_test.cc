@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/server/admin/prometheus_scrape_cache.h"
+
+#include "test/common/stats/stat_test_utility.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Server {
+namespace {
+
+StatsParams parseParams(absl::string_view url) {
+  StatsParams params;
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(Http::Code::OK, params.parse(url, response));
+  return params;
+}
+
+PrometheusScrapeCache::EntryConstSharedPtr makeEntry(absl::string_view body) {
+  auto entry = std::make_shared<PrometheusScrapeCache::Entry>();
+  entry->body_ = std::string(body);
+  return entry;
+}
+
+TEST(PrometheusScrapeCacheTest, Key) {
+  Http::TestRequestHeaderMapImpl text_headers;
+  Http::TestRequestHeaderMapImpl protobuf_headers{
+      {"accept", "application/vnd.google.protobuf;proto=io.prometheus.client.MetricFamily;"
+                 "encoding=delimited"}};
+
+  const std::string key = PrometheusScrapeCache::key(
+      parseParams("/stats/prometheus?usedonly&filter=foo"), text_headers);
+  // The order of the query parameters doesn't matter.
+  EXPECT_EQ(key, PrometheusScrapeCache::key(parseParams("/stats/prometheus?filter=foo&usedonly"),
+                                            text_headers));
+  EXPECT_NE(key, PrometheusScrapeCache::key(parseParams("/stats/prometheus?filter=foo"),
+                                            text_headers));
+  EXPECT_NE(key, PrometheusScrapeCache::key(parseParams("/stats/prometheus?usedonly&filter=foo"),
+                                            protobuf_headers));
+  // Decoded separators in the values do not make different queries share a key.
+  EXPECT_NE(PrometheusScrapeCache::key(parseParams("/stats/prometheus?filter=a%26usedonly%3D"),
+                                       text_headers),
+            PrometheusScrapeCache::key(parseParams("/stats/prometheus?filter=a&usedonly="),
+                                       text_headers));
+}
+
+TEST(PrometheusScrapeCacheTest, Freshness) {
+  PrometheusScrapeCache cache;
+  EXPECT_FALSE(cache.enabled());
+  cache.setFreshness(std::chrono::milliseconds(500));
+  EXPECT_TRUE(cache.enabled());
+
+  const MonotonicTime start;
+  cache.insert("a", makeEntry("body-a"), start);
+  EXPECT_EQ(nullptr, cache.find("b", start));
+  ASSERT_NE(nullptr, cache.find("a", start + std::chrono::milliseconds(499)));
+  EXPECT_EQ("body-a", cache.find("a", start)->body_);
+  EXPECT_EQ(nullptr, cache.find("a", start + std::chrono::milliseconds(500)));
+
+  // Expired entries are dropped on insertion.
+  cache.insert("b", makeEntry("body-b"), start + std::chrono::milliseconds(100));
+  EXPECT_EQ(2, cache.size());
+  cache.insert("c", makeEntry("body-c"), start + std::chrono::milliseconds(550));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(nullptr, cache.find("a", start + std::chrono::milliseconds(550)));
+
+  cache.setFreshness(std::chrono::milliseconds(0));
+  EXPECT_FALSE(cache.enabled());
+  EXPECT_EQ(0, cache.size());
+}
+
+class PrometheusChangedSeriesTest : public testing::Test {
+protected:
+  std::vector<std::string> names(absl::string_view scraper_id) {
+    std::vector<Stats::CounterSharedPtr> counters = store_.counters();
+    std::vector<Stats::GaugeSharedPtr> gauges = store_.gauges();
+    changed_series_.filterUnchanged(std::string(scraper_id), counters, gauges);
+    std::vector<std::string> names;
+    for (const auto& counter : counters) {
+      names.push_back(counter->name());
+    }
+    for (const auto& gauge : gauges) {
+      names.push_back(gauge->name());
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::TestUtil::TestStore store_;
+  PrometheusChangedSeries changed_series_{store_.symbolTable(), time_system_};
+};
+
+TEST_F(PrometheusChangedSeriesTest, OnlyChangedSeries) {
+  Stats::Counter& c1 = store_.counter("c1");
+  store_.counter("c2");
+  Stats::Gauge& g1 = store_.gauge("g1", Stats::Gauge::ImportMode::Accumulate);
+
+  EXPECT_EQ(std::vector<std::string>({"c1", "c2", "g1"}), names("a"));
+  EXPECT_TRUE(names("a").empty());
+
+  c1.inc();
+  g1.set(5);
+  store_.counter("c3");
+  EXPECT_EQ(std::vector<std::string>({"c1", "c3", "g1"}), names("a"));
+  EXPECT_TRUE(names("a").empty());
+
+  // Each scraper has its own baseline.
+  EXPECT_EQ(std::vector<std::string>({"c1", "c2", "c3", "g1"}), names("b"));
+  g1.set(0);
+  EXPECT_EQ(std::vector<std::string>({"g1"}), names("a"));
+  EXPECT_EQ(std::vector<std::string>({"g1"}), names("b"));
+}
+
+TEST_F(PrometheusChangedSeriesTest, LeastRecentlySeenScraperDropped) {
+  store_.counter("c1");
+  for (size_t i = 0; i < PrometheusChangedSeries::MaxScrapers; ++i) {
+    names(absl::StrCat("scraper-", i));
+  }
+  // Scraper 0 is refreshed, so scraper 1 is the one dropped for the new scraper.
+  names("scraper-0");
+  names("new");
+  EXPECT_EQ(PrometheusChangedSeries::MaxScrapers, changed_series_.numScrapers());
+  EXPECT_TRUE(names("scraper-0").empty());
+  EXPECT_EQ(std::vector<std::string>({"c1"}), names("scraper-1"));
+}
+
+TEST_F(PrometheusChangedSeriesTest, MetricsNotHeld) {
+  Stats::Counter& c1 = store_.counter("c1");
+  const uint32_t use_count = c1.use_count();
+  EXPECT_EQ(std::vector<std::string>({"c1"}), names("a"));
+  // Only the names and values of the series are kept between scrapes.
+  EXPECT_EQ(use_count, c1.use_count());
+  EXPECT_TRUE(names("a").empty());
+}
+
+TEST_F(PrometheusChangedSeriesTest, IdleScraperRemoved) {
+  store_.counter("c1");
+  names("a");
+  time_system_.advanceTimeWait(PrometheusChangedSeries::MaxIdleTime / 2);
+  names("b");
+  time_system_.advanceTimeWait(PrometheusChangedSeries::MaxIdleTime / 2);
+
+  // Scraper a has been idle for too long, so its next scrape has everything again.
+  changed_series_.removeIdleScrapers();
+  EXPECT_EQ(1, changed_series_.numScrapers());
+  EXPECT_EQ(std::vector<std::string>({"c1"}), names("a"));
+  EXPECT_TRUE(names("b").empty());
+}
+
+} // namespace
+} // namespace Server
+} // namespace Envoy
@@ -600,6 +600,55 @@ envoy_cluster_endpoint_healthy{another_tag_name="another_tag-value",envoy_cluste
   EXPECT_EQ(expected_output, response.toString());
 }
 
+// The chunked render produces the same output as the buffered one, one group at a time when the
+// chunk size is tiny.
+TEST_F(PrometheusStatsFormatterTest, ChunkedOutputMatchesBuffered) {
+  Stats::CustomStatNamespacesImpl custom_namespaces;
+
+  addCounter("cluster.test_1.upstream_cx_total", {{makeStat("cluster"), makeStat("c1")}});
+  addCounter("cluster.test_1.upstream_cx_total", {{makeStat("cluster"), makeStat("c2")}});
+  addCounter("cluster.test_2.upstream_cx_total", {{makeStat("cluster"), makeStat("c1")}});
+  addGauge("cluster.test_3.upstream_cx_active", {{makeStat("cluster"), makeStat("c1")}});
+  addTextReadout("control_plane.identifier", "CP-1", {{makeStat("cluster"), makeStat("c1")}});
+  addClusterEndpoints("cluster1", 2, {{"a.tag-name", "a.tag-value"}});
+
+  HistogramWrapper h1_cumulative;
+  h1_cumulative.setHistogramValues({50, 20, 30});
+  Stats::HistogramStatisticsImpl h1_cumulative_statistics(h1_cumulative.getHistogram());
+  auto histogram1 =
+      makeHistogram("cluster.test_1.upstream_rq_time", {{makeStat("key1"), makeStat("value1")}});
+  addHistogram(histogram1);
+  ON_CALL(*histogram1, cumulativeStatistics()).WillByDefault(ReturnRef(h1_cumulative_statistics));
+
+  StatsParams params;
+  params.prometheus_text_readouts_ = true;
+  Buffer::OwnedImpl buffered;
+  const uint64_t size = PrometheusStatsFormatter::statsAsPrometheusText(
+      counters_, gauges_, histograms_, textReadouts_, endpoints_helper_->cm_, buffered, params,
+      custom_namespaces);
+  // 2 counters, 1 gauge, 1 text readout, 1 histogram and 5 per-endpoint stats.
+  EXPECT_EQ(10UL, size);
+
+  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestResponseHeaderMapImpl response_headers;
+  PrometheusStatsRender render(
+      counters_, gauges_, histograms_, textReadouts_, endpoints_helper_->cm_, params,
+      custom_namespaces,
+      PrometheusStatsFormatter::makeOutputFormat(params, request_headers, response_headers));
+  std::string chunked;
+  uint64_t num_chunks = 0;
+  bool more = true;
+  while (more) {
+    Buffer::OwnedImpl chunk;
+    more = render.nextChunk(chunk, 1);
+    chunked += chunk.toString();
+    ++num_chunks;
+  }
+  EXPECT_EQ(buffered.toString(), chunked);
+  EXPECT_EQ(size, render.metricNameCount());
+  EXPECT_EQ(size, num_chunks);
+}
+
 TEST_F(PrometheusStatsFormatterTest, OutputWithTextReadoutsInGaugeFormat) {
   Stats::CustomStatNamespacesImpl custom_namespaces;
 
@@ -1,6 +1,9 @@
 // Note: this should be run with --compilation_mode=opt, and would benefit from a
 // quiescent system with disabled cstate power management.
 
+#include <algorithm>
+#include <tuple>
+
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/http/header_map_impl.h"
 #include "source/common/stats/custom_stat_namespaces_impl.h"
@@ -219,6 +222,29 @@ public:
     return count;
   }
 
+  /**
+   * Issues a chunked prometheus request against the stats saved in store_.
+   * @return the total output size and the size of the largest chunk.
+   */
+  std::pair<uint64_t, uint64_t> handlerPrometheusChunked(const StatsParams& params) {
+    Buffer::OwnedImpl data;
+    auto request_headers = Http::RequestHeaderMapImpl::create();
+    auto response_headers = Http::ResponseHeaderMapImpl::create();
+    Admin::RequestPtr request = StatsHandler::makePrometheusRequest(*store_, custom_namespaces_,
+                                                                    cm_, params, *request_headers);
+    request->start(*response_headers);
+    uint64_t count = 0;
+    uint64_t max_chunk = 0;
+    bool more = true;
+    do {
+      more = request->nextChunk(data);
+      count += data.length();
+      max_chunk = std::max(max_chunk, data.length());
+      data.drain(data.length());
+    } while (more);
+    return {count, max_chunk};
+  }
+
   std::vector<Stats::ScopeSharedPtr> scopes_;
   Envoy::Stats::CustomStatNamespacesImpl custom_namespaces_;
   FastMockClusterManager cm_;
@@ -459,6 +485,34 @@ BENCHMARK_CAPTURE(BM_PrometheusFull, per_endpoint_stats_disabled, false)
 BENCHMARK_CAPTURE(BM_PrometheusFull, per_endpoint_stats_enabled, true)
     ->Unit(benchmark::kMillisecond);
 
+// Streams the same output as BM_PrometheusFull in chunks: 1M counters, plus the per-endpoint
+// stats of 100k hosts when enabled. Chunks end on group boundaries, so the largest chunk is
+// bounded by the largest group, which with per-endpoint stats holds one line per host.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_PrometheusFullChunked(benchmark::State& state, bool per_endpoint_stats) {
+  Envoy::Server::StatsHandlerTest& test_context = testContext(per_endpoint_stats);
+  Envoy::Server::StatsParams params;
+  Envoy::Buffer::OwnedImpl response;
+  params.parse("?format=prometheus", response);
+  const uint64_t lower_limit = per_endpoint_stats ? 400 * 1000 * 1000 : 200 * 1000 * 1000;
+  const uint64_t upper_limit = per_endpoint_stats ? 420 * 1000 * 1000 : 300 * 1000 * 1000;
+
+  uint64_t count;
+  uint64_t max_chunk;
+  for (auto _ : state) { // NOLINT
+    std::tie(count, max_chunk) = test_context.handlerPrometheusChunked(params);
+    RELEASE_ASSERT(count > lower_limit, "expected count > lower_limit");
+    RELEASE_ASSERT(count < upper_limit, "expected count < upper_limit");
+  }
+
+  auto label = absl::StrCat("output per iteration: ", count, ", largest chunk: ", max_chunk);
+  state.SetLabel(label);
+}
+BENCHMARK_CAPTURE(BM_PrometheusFullChunked, per_endpoint_stats_disabled, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PrometheusFullChunked, per_endpoint_stats_enabled, true)
+    ->Unit(benchmark::kMillisecond);
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_HistogramsJson(benchmark::State& state, bool per_endpoint_stats) {
   Envoy::Server::StatsHandlerTest& test_context = testContext(per_endpoint_stats);
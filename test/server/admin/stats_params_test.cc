@@ -128,5 +128,16 @@ TEST(StatsParamsTest, ShouldShowMetric) {
   }
 }
 
+TEST(StatsParamsTest, ParseParamsChangedOnly) {
+  Buffer::OwnedImpl response;
+  StatsParams params;
+
+  ASSERT_EQ(Http::Code::OK, params.parse("?changedonly&scraper_id=prom-a", response));
+  EXPECT_TRUE(params.changed_only_);
+  EXPECT_EQ("prom-a", params.scraper_id_);
+  EXPECT_EQ(Http::Code::BadRequest, params.parse("?changedonly", response));
+  EXPECT_EQ("changedonly can only be used if scraper_id is also provided", response.toString());
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -2,6 +2,7 @@
 
 #include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/api/os_sys_calls_impl_hot_restart.h"
+#include "source/common/common/hash.h"
 #include "source/common/common/hex.h"
 #include "source/common/network/utility.h"
 #include "source/server/hot_restart_impl.h"
@@ -17,6 +18,7 @@
 #include "test/test_common/threadsafe_singleton_injector.h"
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "gtest/gtest.h"
 
@@ -249,6 +251,80 @@ TEST_F(HotRestartUdpForwardingContextTest,
   EXPECT_FALSE(result.has_value());
 }
 
+class SharedMemorySessionStoreTest : public testing::Test {
+protected:
+  SharedMemorySessionStoreTest() { initializeMutex(sessions_->lock_); }
+
+  static absl::Span<const uint8_t> bytes(absl::string_view s) {
+    return {reinterpret_cast<const uint8_t*>(s.data()), s.size()};
+  }
+
+  std::string lookup(Ssl::SessionStore& store, absl::string_view session_id) {
+    std::vector<uint8_t> session;
+    if (!store.lookup(bytes(session_id), session)) {
+      return "<none>";
+    }
+    return {session.begin(), session.end()};
+  }
+
+  // Zero initialized, like the shared memory of the first process.
+  std::unique_ptr<SharedTlsSessions> sessions_ = std::make_unique<SharedTlsSessions>();
+};
+
+TEST_F(SharedMemorySessionStoreTest, InsertLookup) {
+  SharedMemorySessionStore store(*sessions_);
+  EXPECT_EQ("<none>", lookup(store, "id1"));
+  EXPECT_TRUE(store.insert(bytes("id1"), bytes("session1")));
+  EXPECT_TRUE(store.insert(bytes("id2"), bytes("session2")));
+  EXPECT_EQ("session1", lookup(store, "id1"));
+  EXPECT_EQ("session2", lookup(store, "id2"));
+
+  EXPECT_TRUE(store.insert(bytes("id1"), bytes("replaced")));
+  EXPECT_EQ("replaced", lookup(store, "id1"));
+
+  // The sessions are visible to the stores of the other processes.
+  SharedMemorySessionStore other_store(*sessions_);
+  EXPECT_EQ("session2", lookup(other_store, "id2"));
+}
+
+TEST_F(SharedMemorySessionStoreTest, OversizedNotStored) {
+  SharedMemorySessionStore store(*sessions_);
+  EXPECT_FALSE(store.insert(bytes("id1"),
+                            bytes(std::string(SharedTlsSessions::MaxSessionLength + 1, 'x'))));
+  EXPECT_EQ("<none>", lookup(store, "id1"));
+  const std::string long_id(Ssl::SessionStore::MaxSessionIdLength + 1, 'i');
+  EXPECT_FALSE(store.insert(bytes(long_id), bytes("session")));
+  EXPECT_EQ("<none>", lookup(store, long_id));
+  EXPECT_FALSE(store.insert(bytes(""), bytes("session")));
+  EXPECT_EQ("<none>", lookup(store, ""));
+}
+
+TEST_F(SharedMemorySessionStoreTest, LeastRecentlyUsedOfSetReplaced) {
+  // Find session IDs that all map to the same set.
+  std::vector<std::string> ids;
+  const uint64_t set = HashUtil::xxHash64("id0") % SharedTlsSessions::NumSets;
+  for (int i = 0; ids.size() < SharedTlsSessions::SlotsPerSet + 1; ++i) {
+    std::string id = absl::StrCat("id", i);
+    if (HashUtil::xxHash64(id) % SharedTlsSessions::NumSets == set) {
+      ids.push_back(std::move(id));
+    }
+  }
+
+  SharedMemorySessionStore store(*sessions_);
+  for (size_t i = 0; i < SharedTlsSessions::SlotsPerSet; ++i) {
+    store.insert(bytes(ids[i]), bytes(ids[i]));
+  }
+  // The first session is used again, so the second one is the least recently used.
+  EXPECT_EQ(ids[0], lookup(store, ids[0]));
+  store.insert(bytes(ids.back()), bytes(ids.back()));
+
+  EXPECT_EQ(ids[0], lookup(store, ids[0]));
+  EXPECT_EQ("<none>", lookup(store, ids[1]));
+  for (size_t i = 2; i < ids.size(); ++i) {
+    EXPECT_EQ(ids[i], lookup(store, ids[i]));
+  }
+}
+
 TEST_F(HotRestartImplTest, IsInitializingReflectsLifecyclePhases) {
   const mode_t mode = S_IRUSR | S_IWUSR;
   const std::string socket_path = testDomainSocketName();